@@ -1,18 +1,23 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <functional>
-#include <sys/epoll.h>
 #include <libwebsockets.h>
 #include <mosquitto.h>
 #include <openssl/ssl.h>
 #include "../../../thermal-monitoring/ThermalIsolationTracker.h"
+#include "../../../thermal-monitoring/SensorWireFormat.h"
+#include "../../../thermal-monitoring/Metrics.h"
+#include "../../../thermal-monitoring/TopicTrie.h"
 
 namespace mqtt_ws {
 
@@ -21,6 +26,15 @@ namespace mqtt_ws {
  * Optimized for Linux with epoll and zero-copy message handling
  */
 
+/**
+ * What a connection does when its send queue is full
+ */
+enum class OverflowPolicy {
+    DROP_OLDEST,        // Discard the oldest queued frame
+    COALESCE_LATEST,    // Replace a queued frame on the same topic, else drop oldest
+    DISCONNECT          // Close clients that fall this far behind
+};
+
 struct BridgeConfig {
     // MQTT Configuration
     std::string mqtt_host = "localhost";
@@ -35,17 +49,25 @@ struct BridgeConfig {
     
     // Connection Settings
     int max_connections = 1000;
-    int worker_threads = std::thread::hardware_concurrency();
-    int message_buffer_size = 4096;
+    int worker_threads = std::thread::hardware_concurrency();  // libwebsockets service threads
+    int message_buffer_size = 4096;  // Also each connection's send queue budget (bytes)
     int connection_timeout = 30;
+    int mqtt_pool_size = 2;          // Upstream MQTT clients shared by all connections
+    int max_subscriptions_per_connection = 64;  // URL and $subscribe filters together
     
     // Optimization flags
-    bool use_epoll = true;
     bool zero_copy_enabled = true;
     bool connection_pooling = true;
+    OverflowPolicy send_overflow_policy = OverflowPolicy::DROP_OLDEST;
+    
+    // Prometheus text exposition served over plain HTTP on the WebSocket port
+    bool metrics_enabled = true;
+    std::string metrics_path = "/metrics";
+    int metrics_refresh_ms = 1000;   // Scrapes are served from a snapshot at most this old
     
     // Thermal Monitoring Configuration
     bool thermal_monitoring_enabled = true;
+    std::string sensor_topic_filter = "sensors/#";  // Ingested once at bridge level
     thermal_monitoring::ThermalConfig thermal_config;
 };
 
@@ -53,6 +75,10 @@ struct BridgeConfig {
 class MqttClient;
 class WebSocketConnection;
 class MessageBuffer;
+class OutboundFrame;
+class SubscriptionManager;
+
+using FramePtr = std::shared_ptr<const OutboundFrame>;
 
 /**
  * Message buffer with zero-copy optimization
@@ -81,6 +107,53 @@ public:
     void format_mqtt_message(const std::string& topic, const std::vector<uint8_t>& payload);
 };
 
+/**
+ * Immutable, pre-framed WebSocket message ("topic|payload")
+ * Serialised once together with its WebSocket frame header and queued by
+ * reference on every connection it is sent to; written whole with
+ * LWS_WRITE_RAW from LWS_CALLBACK_SERVER_WRITEABLE, so no service thread
+ * ever writes into the shared buffer. Topics ending in "/bin" carry the
+ * packed wire format and go out as binary frames
+ */
+class OutboundFrame {
+private:
+    static constexpr size_t MAX_HEADER_SIZE = 10;  // Unmasked server frame, 64-bit length
+    
+    std::vector<uint8_t> storage_;                 // Header right-aligned in MAX_HEADER_SIZE, then payload
+    size_t header_offset_;
+    size_t topic_len_;
+    bool binary_;
+    std::chrono::steady_clock::time_point created_;  // Fan-out latency is measured from here
+    
+public:
+    OutboundFrame(const std::string& topic, const uint8_t* payload, size_t len);
+    
+    static FramePtr create(const std::string& topic, const uint8_t* payload, size_t len);
+    static FramePtr create(const std::string& topic, const std::string& payload);
+    
+    const uint8_t* payload() const { return storage_.data() + MAX_HEADER_SIZE; }
+    size_t size() const { return storage_.size() - MAX_HEADER_SIZE; }
+    // Header and payload, as they go on the wire
+    const uint8_t* wire_data() const { return storage_.data() + header_offset_; }
+    size_t wire_size() const { return storage_.size() - header_offset_; }
+    bool is_binary() const { return binary_; }
+    std::chrono::steady_clock::time_point created() const { return created_; }
+    std::string_view topic() const {
+        return std::string_view(reinterpret_cast<const char*>(payload()), topic_len_);
+    }
+};
+
+/**
+ * Send queue counters, per connection or summed over the bridge
+ */
+struct SendQueueStats {
+    size_t queued_frames = 0;
+    size_t queued_bytes = 0;
+    uint64_t dropped_frames = 0;
+    uint64_t coalesced_frames = 0;
+    uint64_t overflow_disconnects = 0;
+};
+
 /**
  * MQTT Client wrapper with connection pooling
  */
@@ -92,6 +165,7 @@ private:
     int port_;
     std::atomic<bool> connected_;
     std::function<void(const std::string&, const std::vector<uint8_t>&)> message_callback_;
+    std::function<void()> connect_callback_;
     
 public:
     MqttClient(const std::string& client_id, const std::string& host, int port);
@@ -106,6 +180,7 @@ public:
     bool publish(const std::string& topic, const std::vector<uint8_t>& payload, int qos = 0);
     
     void set_message_callback(std::function<void(const std::string&, const std::vector<uint8_t>&)> callback);
+    void set_connect_callback(std::function<void()> callback);
     
     // Static callbacks for mosquitto
     static void on_connect_callback(struct mosquitto*, void*, int);
@@ -113,36 +188,164 @@ public:
     static void on_disconnect_callback(struct mosquitto*, void*, int);
 };
 
+/**
+ * Bridge-wide MQTT subscription multiplexer
+ * Shares a small pool of upstream MQTT clients between all WebSocket
+ * connections, reference-counts broker subscriptions and fans each
+ * incoming message out to every connection subscribed to its topic.
+ * Subscribers are found through a topic trie, so routing a message costs
+ * time in its topic depth, not in the number of filters or viewers
+ */
+class SubscriptionManager {
+private:
+    // One upstream (broker) subscription per distinct filter
+    struct TopicSubscription {
+        size_t client_index;
+    };
+    
+    // One per (filter, connection); client_index is the filter's upstream client
+    struct Route {
+        size_t client_index;
+        const WebSocketConnection* key;
+        std::weak_ptr<WebSocketConnection> connection;
+    };
+    
+    BridgeConfig config_;
+    struct lws_context* service_context_;
+    std::vector<std::unique_ptr<MqttClient>> clients_;
+    std::unordered_map<std::string, TopicSubscription> topics_;
+    thermal_monitoring::TopicTrie<Route> routes_;
+    mutable std::mutex topics_mutex_;
+    
+    // Topics under this prefix arrive through deliver() from the ingestion stage
+    std::string ingested_prefix_;
+    
+    static constexpr size_t ANY_CLIENT = static_cast<size_t>(-1);
+    
+    bool is_ingested(const std::string& topic) const;
+    size_t select_client(const std::string& topic) const;
+    void resubscribe_client(size_t client_index);
+    void collect(const std::string& topic, size_t client_index,
+                 std::vector<std::shared_ptr<WebSocketConnection>>& targets) const;
+    void dispatch(size_t client_index, const std::string& topic, const std::vector<uint8_t>& payload);
+    void fan_out(const std::vector<std::shared_ptr<WebSocketConnection>>& targets,
+                 const std::string& topic, const std::vector<uint8_t>& payload);
+    
+public:
+    // service_context is woken after frames are queued; the bridge owns it
+    // and keeps it alive until every connection and pool client is gone
+    SubscriptionManager(const BridgeConfig& config, struct lws_context* service_context);
+    ~SubscriptionManager();
+    
+    bool start();
+    void stop();
+    
+    // Subscriptions are reference-counted per filter across all connections;
+    // filters may use MQTT '+' and '#' wildcards
+    bool subscribe(const std::string& topic, const std::shared_ptr<WebSocketConnection>& subscriber);
+    void unsubscribe(const std::string& topic, const WebSocketConnection* subscriber);
+    bool publish(const std::string& topic, const std::vector<uint8_t>& payload, int qos = 0);
+    
+    // Connections with a filter matching topic, each once (bridge-generated frames such as alerts)
+    std::vector<std::shared_ptr<WebSocketConnection>> route(const std::string& topic) const;
+    
+    // Bridge-level ingestion: messages under the prefix are delivered once via deliver()
+    void set_ingested_prefix(const std::string& prefix);
+    void deliver(const std::string& topic, const std::vector<uint8_t>& payload);
+    
+    size_t get_topic_count() const;
+    size_t get_subscriber_count() const;
+};
+
+/**
+ * Connections of one service thread with frames waiting for a writable callback
+ * WebSocketConnection::send_frame() adds its wsi when the send ring goes from
+ * empty to non-empty; the service thread takes the list in
+ * LWS_CALLBACK_EVENT_WAIT_CANCELLED, so a wake-up costs O(connections with new
+ * frames) rather than O(connections). The lock is taken inside a connection's
+ * send lock and never together with the shard lock
+ */
+class PendingWrites {
+private:
+    std::vector<struct lws*> wsis_;
+    std::mutex mutex_;
+    
+public:
+    void push(struct lws* wsi);
+    // Swaps the list into out (cleared first), keeping both capacities
+    void take(std::vector<struct lws*>& out);
+};
+
 /**
  * WebSocket Connection with optimized message handling
  */
-class WebSocketConnection {
+class WebSocketConnection : public std::enable_shared_from_this<WebSocketConnection> {
 private:
     struct lws* wsi_;
-    std::string topic_;
-    std::unique_ptr<MqttClient> mqtt_client_;
+    std::string topic_;                           // From the URL path; selects the encoding
+    std::vector<std::string> filters_;            // Every active subscription, topic_ first
+    size_t max_filters_;
+    mutable std::mutex filters_mutex_;
+    std::unique_ptr<MqttClient> mqtt_client_;     // Only used when connection pooling is disabled
+    std::string ingested_prefix_;                 // Without pooling: topics the bridge routes itself
+    SubscriptionManager* subscriptions_;
     std::unique_ptr<MessageBuffer> buffer_;
+    std::string rx_topic_;                        // Parse targets reused for every receive
+    std::vector<uint8_t> rx_payload_;
     std::atomic<bool> active_;
     std::string client_address_;
     
+    // Bounded ring of frames waiting for LWS_CALLBACK_SERVER_WRITEABLE
+    std::vector<FramePtr> send_ring_;
+    size_t send_head_;
+    size_t send_count_;
+    size_t send_budget_bytes_;
+    OverflowPolicy overflow_policy_;
+    SendQueueStats send_stats_;
+    bool overflowed_;
+    mutable std::mutex send_mutex_;
+    PendingWrites* pending_writes_;               // The service thread's list, owned by the bridge
+    struct lws_context* service_context_;         // Owned by the bridge and outlives the wsi
+    
+    void pop_front_frame();
+    bool make_room(const FramePtr& frame);
+    void send_control_reply(const std::string& topic, const std::string& filter);
+    bool is_ingested(const std::string& topic) const;
+    void wake_service() const;
+    
 public:
-    WebSocketConnection(struct lws* wsi, const std::string& topic);
+    WebSocketConnection(struct lws* wsi, const std::string& topic, struct lws_context* service_context);
     ~WebSocketConnection();
     
-    bool initialize(const BridgeConfig& config);
+    bool initialize(const BridgeConfig& config, SubscriptionManager* subscriptions = nullptr,
+                    PendingWrites* pending_writes = nullptr);
     void cleanup();
     
     // Message handling
+    // "topic|payload" publishes; "$subscribe|filter" and "$unsubscribe|filter" are control messages
     void handle_websocket_message(const uint8_t* data, size_t len);
     void handle_mqtt_message(const std::string& topic, const std::vector<uint8_t>& payload);
     
+    // Adds or drops one MQTT filter ('+'/'#' allowed) on top of the URL topic
+    bool subscribe(const std::string& filter);
+    bool unsubscribe(const std::string& filter);
+    std::vector<std::string> get_filters() const;
+    bool matches(const std::string& topic) const;
+    
     // Connection management
     bool is_active() const { return active_.load(); }
     const std::string& get_topic() const { return topic_; }
     const std::string& get_client_address() const { return client_address_; }
+    bool wants_binary() const { return thermal_monitoring::wire::is_binary_topic(topic_); }
     
     // WebSocket operations
-    bool send_to_websocket(const std::vector<uint8_t>& data);
+    // Queueing is thread-safe; writes happen on the connection's service
+    // thread once the service loops have been woken through the bridge's
+    // lws_context. True when the service thread has work: a frame to write
+    // or an overflowed connection to close
+    bool send_frame(const FramePtr& frame);
+    int write_pending_frame();
+    SendQueueStats get_send_stats() const;
     void close_connection();
 };
 
@@ -157,24 +360,53 @@ private:
     struct lws_context* lws_context_;
     struct lws_context_creation_info lws_info_;
     
-    // Connection management
-    std::unordered_map<struct lws*, std::unique_ptr<WebSocketConnection>> connections_;
-    std::mutex connections_mutex_;
+    // Shared upstream MQTT clients (must outlive connections_)
+    std::unique_ptr<SubscriptionManager> subscription_manager_;
+    
+    // Connection management, sharded per libwebsockets service thread:
+    // a connection is only ever touched by the thread that services it,
+    // so receives and closes on different threads never contend
+    struct ConnectionShard {
+        std::unordered_map<struct lws*, std::shared_ptr<WebSocketConnection>> connections;
+        std::mutex mutex;
+        PendingWrites pending_writes;
+        std::vector<struct lws*> writes_to_request;   // Service thread only, reused across wake-ups
+    };
+    std::vector<std::unique_ptr<ConnectionShard>> connection_shards_;
     std::atomic<int> connection_count_;
     
+    // Send queue counters of connections that have already closed
+    std::atomic<uint64_t> closed_dropped_frames_;
+    std::atomic<uint64_t> closed_coalesced_frames_;
+    std::atomic<uint64_t> closed_overflow_disconnects_;
+    
     // Threading
+    int service_thread_count_;
     std::vector<std::thread> worker_threads_;
     std::atomic<bool> running_;
     
-    // Epoll for I/O
-    int epoll_fd_;
-    struct epoll_event* events_;
-    
     // SSL context
     SSL_CTX* ssl_ctx_;
     
     // Thermal monitoring
     std::unique_ptr<thermal_monitoring::ThermalIsolationTracker> thermal_tracker_;
+    std::unique_ptr<MqttClient> ingest_client_;
+    
+    // Scrape-time reads of the state above; removed before it is torn down
+    thermal_monitoring::metrics::CallbackHandle metrics_callbacks_;
+    
+    // Exposition re-rendered on its own thread, so a scrape never walks the
+    // registry on a service thread that also carries WebSocket traffic
+    std::thread metrics_thread_;
+    std::mutex metrics_mutex_;
+    std::condition_variable metrics_cv_;
+    std::shared_ptr<const std::string> metrics_snapshot_;
+    
+    // libwebsockets per-session data of a plain HTTP request (zero-filled)
+    struct HttpSession {
+        std::string* body;
+        size_t offset;
+    };
     
 public:
     MqttWebSocketBridge(const BridgeConfig& config);
@@ -189,28 +421,46 @@ public:
     static int websocket_callback(struct lws* wsi, enum lws_callback_reasons reason,
                                  void* user, void* in, size_t len);
     
+    // Outgoing queue depth and loss across all connections
+    SendQueueStats get_send_queue_stats();
+    
     // Sensor message processing (public for integration)
     void process_sensor_message(const std::string& topic, const std::string& payload);
+    void process_sensor_message(const std::string& topic, const uint8_t* payload, size_t len);
     
 private:
     // Internal methods
     bool setup_ssl_context();
     bool setup_libwebsockets();
-    bool setup_epoll();
+    bool setup_subscription_manager();
+    void setup_metrics();
     
-    void worker_thread_loop();
-    void handle_new_connection(struct lws* wsi, const std::string& topic);
+    void worker_thread_loop(int tsi);
+    ConnectionShard& shard_for(struct lws* wsi);
+    void handle_new_connection(struct lws* wsi, const std::string& topic,
+                               const std::vector<std::string>& extra_filters = {});
     void handle_connection_close(struct lws* wsi);
     
     // Message processing
     void process_websocket_message(struct lws* wsi, const uint8_t* data, size_t len);
+    void deliver_ingested(const std::string& topic, const std::vector<uint8_t>& payload);
+    void request_pending_writes(struct lws* wsi);
+    int write_pending_frame(struct lws* wsi);
+    
+    // Metrics endpoint
+    int begin_metrics_response(struct lws* wsi, HttpSession* session);
+    int write_metrics_body(struct lws* wsi, HttpSession* session);
+    void metrics_render_loop();
     
     // Thermal monitoring
     bool setup_thermal_monitoring();
-    void handle_thermal_alert(const thermal_monitoring::Alert& alert);
+    bool setup_sensor_ingestion();
+    void handle_ingested_message(const std::string& topic, const std::vector<uint8_t>& payload);
+    void handle_thermal_alert(const thermal_monitoring::AlertRecord& record);
     
     // Utility methods
     std::string extract_topic_from_url(const std::string& url);
+    std::vector<std::string> extract_filters_from_args(struct lws* wsi);
     std::string get_client_address(struct lws* wsi);
     
     // Cleanup
@@ -1,4 +1,5 @@
 #include "../include/mqtt_ws_bridge.h"
+#include "../../../thermal-monitoring/Log.h"
 #include <iostream>
 #include <signal.h>
 #include <fstream>
@@ -39,6 +40,8 @@ BridgeConfig load_config(const std::string& config_file) {
         auto mqtt = root["mqtt"];
         if (mqtt.isMember("host")) config.mqtt_host = mqtt["host"].asString();
         if (mqtt.isMember("port")) config.mqtt_port = mqtt["port"].asInt();
+        if (mqtt.isMember("pool_size")) config.mqtt_pool_size = mqtt["pool_size"].asInt();
+        if (mqtt.isMember("connection_pooling")) config.connection_pooling = mqtt["connection_pooling"].asBool();
     }
     
     // Parse WebSocket settings
@@ -48,6 +51,30 @@ BridgeConfig load_config(const std::string& config_file) {
         if (ws.isMember("host")) config.websocket_host = ws["host"].asString();
         if (ws.isMember("ssl_cert")) config.ssl_cert_path = ws["ssl_cert"].asString();
         if (ws.isMember("ssl_key")) config.ssl_key_path = ws["ssl_key"].asString();
+        if (ws.isMember("message_buffer_size")) config.message_buffer_size = ws["message_buffer_size"].asInt();
+        if (ws.isMember("overflow_policy")) {
+            std::string policy = ws["overflow_policy"].asString();
+            if (policy == "drop_oldest") config.send_overflow_policy = OverflowPolicy::DROP_OLDEST;
+            else if (policy == "coalesce") config.send_overflow_policy = OverflowPolicy::COALESCE_LATEST;
+            else if (policy == "disconnect") config.send_overflow_policy = OverflowPolicy::DISCONNECT;
+            else std::cerr << "Warning: Unknown overflow_policy '" << policy << "', using drop_oldest" << std::endl;
+        }
+    }
+    
+    // Parse metrics endpoint settings
+    if (root.isMember("metrics")) {
+        auto metrics = root["metrics"];
+        if (metrics.isMember("enabled")) config.metrics_enabled = metrics["enabled"].asBool();
+        if (metrics.isMember("path")) config.metrics_path = metrics["path"].asString();
+        if (metrics.isMember("refresh_ms")) config.metrics_refresh_ms = metrics["refresh_ms"].asInt();
+    }
+    
+    // Parse warm restart settings
+    if (root.isMember("state_snapshot")) {
+        auto snapshot = root["state_snapshot"];
+        auto& thermal = config.thermal_config;
+        if (snapshot.isMember("path")) thermal.state_snapshot_path = snapshot["path"].asString();
+        if (snapshot.isMember("interval_ms")) thermal.state_snapshot_interval_ms = snapshot["interval_ms"].asInt();
     }
     
     return config;
@@ -62,6 +89,8 @@ void print_usage(const char* program_name) {
     std::cout << "  -p, --port PORT      MQTT broker port (default: 1883)" << std::endl;
     std::cout << "  -l, --listen PORT    WebSocket listen port (default: 8080)" << std::endl;
     std::cout << "  -t, --threads NUM    Number of worker threads (default: auto)" << std::endl;
+    std::cout << "  --log-level LEVEL    trace, debug, info, warn, error or off (default: info)" << std::endl;
+    std::cout << "  --state-file FILE    Keep tracker state in FILE for warm restarts (default: off)" << std::endl;
 
     std::cout << "  --help               Show this help message" << std::endl;
 }
@@ -92,6 +121,16 @@ int main(int argc, char* argv[]) {
             if (i + 1 < argc) config_file = argv[++i];
         } else if (arg == "-t" || arg == "--threads") {
             if (i + 1 < argc) config.worker_threads = std::atoi(argv[++i]);
+        } else if (arg == "--log-level") {
+            thermal_monitoring::LogLevel level;
+            if (i + 1 < argc && thermal_monitoring::Log::parse_level(argv[++i], level)) {
+                thermal_monitoring::Log::set_level(level);
+            } else {
+                std::cerr << "Warning: Unknown log level, keeping " 
+                          << thermal_monitoring::Log::level_name(thermal_monitoring::Log::get_level()) << std::endl;
+            }
+        } else if (arg == "--state-file") {
+            if (i + 1 < argc) config.thermal_config.state_snapshot_path = argv[++i];
         } else if (arg == "--help") {
             print_usage(argv[0]);
             return 0;
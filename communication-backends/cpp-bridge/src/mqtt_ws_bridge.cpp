@@ -1,7 +1,9 @@
 #include "../include/mqtt_ws_bridge.h"
-#include <iostream>
+#include "../../../thermal-monitoring/Log.h"
 #include <sstream>
+#include <array>
 #include <chrono>
+#include <optional>
 #include <thread>
 #include <algorithm>
 #include <cstring>
@@ -14,6 +16,85 @@ namespace mqtt_ws {
 // Global bridge instance for libwebsockets callback
 static MqttWebSocketBridge* g_bridge_instance = nullptr;
 
+namespace metrics = thermal_monitoring::metrics;
+
+namespace {
+
+/**
+ * Hot-path instruments, registered once per process. Everything here is
+ * recorded without locks; per-bridge state is exported by
+ * MqttWebSocketBridge::setup_metrics() as scrape-time callbacks.
+ */
+struct BridgeMetrics {
+    metrics::Counter& ingested_messages;
+    metrics::Counter& parse_errors;
+    metrics::Counter& frames_sent;
+    metrics::Counter& bytes_sent;
+    metrics::Histogram& parse_seconds;
+    metrics::Histogram& tracker_update_seconds;
+    metrics::Histogram& fanout_latency_seconds;
+    std::array<metrics::Counter*, 6> alerts;  // Indexed by AlertType
+};
+
+BridgeMetrics& bridge_metrics() {
+    static BridgeMetrics instance = [] {
+        metrics::Registry& registry = metrics::Registry::global();
+        const auto latency_buckets = metrics::latency_buckets_seconds();
+        BridgeMetrics m{
+            registry.counter("thermal_bridge_ingested_messages_total", "Sensor messages ingested from MQTT"),
+            registry.counter("thermal_bridge_parse_errors_total", "Ingested sensor messages that failed to parse"),
+            registry.counter("thermal_bridge_frames_sent_total", "WebSocket frames written to clients"),
+            registry.counter("thermal_bridge_bytes_sent_total", "WebSocket payload bytes written to clients"),
+            registry.histogram("thermal_bridge_parse_seconds", "Time to parse one sensor message", latency_buckets),
+            registry.histogram("thermal_bridge_tracker_update_seconds",
+                               "Time to apply one reading to the thermal tracker", latency_buckets),
+            registry.histogram("thermal_bridge_fanout_latency_seconds",
+                               "Time from frame creation to its write on a client connection", latency_buckets),
+            {}
+        };
+        static const char* const alert_types[] = {
+            "TEMP_TOO_LOW", "TEMP_TOO_HIGH", "HUMIDITY_TOO_HIGH",
+            "TEMP_RISING_FAST", "TEMP_FALLING_FAST", "SENSOR_OFFLINE"
+        };
+        for (size_t i = 0; i < m.alerts.size(); ++i) {
+            m.alerts[i] = &registry.counter("thermal_bridge_alerts_total", "Thermal alerts raised, by type",
+                                            metrics::label("type", alert_types[i]));
+        }
+        return m;
+    }();
+    return instance;
+}
+
+// Text frame body for viewers of alerts/{sensor_id}
+std::string format_alert_json(const thermal_monitoring::Alert& alert) {
+    std::stringstream alert_msg;
+    alert_msg << "{"
+              << "\"sensor_id\":\"" << alert.sensor_id << "\","
+              << "\"alert_type\":" << static_cast<int>(alert.alert_type) << ","
+              << "\"message\":\"" << alert.message << "\","
+              << "\"location\":\"" << alert.location << "\","
+              << "\"temperature\":" << alert.temperature << ","
+              << "\"humidity\":" << alert.humidity << ","
+              << "\"temp_rate\":" << alert.temp_rate << ","
+              << "\"timestamp\":" << std::chrono::duration_cast<std::chrono::seconds>(
+                     alert.timestamp.time_since_epoch()).count()
+              << "}";
+    return alert_msg.str();
+}
+
+// Topics the ingestion client covers ("sensors/" for "sensors/#"); empty
+// when ingestion is off or its filter is not a whole subtree
+std::string ingested_prefix(const BridgeConfig& config) {
+    const std::string& filter = config.sensor_topic_filter;
+    if (!config.thermal_monitoring_enabled || filter.size() < 2 ||
+        filter.compare(filter.size() - 2, 2, "/#") != 0) {
+        return "";
+    }
+    return filter.substr(0, filter.size() - 1);
+}
+
+} // namespace
+
 //=============================================================================
 // MessageBuffer Implementation
 //=============================================================================
@@ -33,68 +114,156 @@ void MessageBuffer::resize(size_t new_size) {
 bool MessageBuffer::parse_websocket_message(std::string& topic, std::vector<uint8_t>& payload) {
     if (size_ == 0) return false;
     
-    // Convert message to string for parsing (UTF-8)
-    std::string message_str(buffer_.begin(), buffer_.begin() + size_);
-    
-    std::cout << "🔍 [C++] Parsing message: '" << message_str << "'" << std::endl;
+    // Split in place; topic and payload are assigned into the caller's
+    // buffers, which keep their capacity across messages
+    std::string_view message(reinterpret_cast<const char*>(buffer_.data()), size_);
+    THERMAL_LOG_DEBUG << "🔍 [C++] Parsing message: '" << message << "'";
     
     // Find the topic separator '|'
-    size_t pipe_pos = message_str.find('|');
-    if (pipe_pos == std::string::npos) {
-        std::cout << "❌ [C++] Invalid message format - no topic separator found" << std::endl;
+    size_t pipe_pos = message.find('|');
+    if (pipe_pos == std::string_view::npos) {
+        THERMAL_LOG_ERROR << "❌ [C++] Invalid message format - no topic separator found";
         return false;
     }
     
-    // Extract topic and payload
-    topic = message_str.substr(0, pipe_pos);
-    std::string payload_str = message_str.substr(pipe_pos + 1);
+    topic.assign(message.data(), pipe_pos);
+    payload.assign(buffer_.data() + pipe_pos + 1, buffer_.data() + size_);
     
-    // Convert payload string to bytes
-    payload.assign(payload_str.begin(), payload_str.end());
-    
-    std::cout << "✅ [C++] Parsed topic: '" << topic << "', payload: '" << payload_str << "'" << std::endl;
+    THERMAL_LOG_DEBUG << "✅ [C++] Parsed topic: '" << topic << "', payload: '" << message.substr(pipe_pos + 1) << "'";
     return !topic.empty();
 }
 
 void MessageBuffer::format_mqtt_message(const std::string& topic, const std::vector<uint8_t>& payload) {
-    // Format: "topic|payload" in UTF-8
-    std::string payload_str(payload.begin(), payload.end());
-    std::string message_str = topic + "|" + payload_str;
+    // Format: "topic|payload" in UTF-8, written straight into the buffer
+    resize(topic.size() + 1 + payload.size());
+    std::memcpy(buffer_.data(), topic.data(), topic.size());
+    buffer_[topic.size()] = '|';
+    if (!payload.empty()) {
+        std::memcpy(buffer_.data() + topic.size() + 1, payload.data(), payload.size());
+    }
     
-    std::cout << "📝 [C++] Formatting message: '" << message_str << "'" << std::endl;
+    THERMAL_LOG_DEBUG << "📝 [C++] Formatting message: '" 
+                      << std::string_view(reinterpret_cast<const char*>(buffer_.data()), size_) << "'";
+}
+
+//=============================================================================
+// OutboundFrame Implementation
+//=============================================================================
+
+OutboundFrame::OutboundFrame(const std::string& topic, const uint8_t* payload, size_t len)
+    : storage_(MAX_HEADER_SIZE + topic.size() + 1 + len), topic_len_(topic.size()),
+      binary_(thermal_monitoring::wire::is_binary_topic(topic)),
+      created_(std::chrono::steady_clock::now()) {
+    // Format: "topic|payload" in UTF-8
+    uint8_t* out = storage_.data() + MAX_HEADER_SIZE;
+    std::memcpy(out, topic.data(), topic.size());
+    out[topic.size()] = '|';
+    if (len > 0) {
+        std::memcpy(out + topic.size() + 1, payload, len);
+    }
     
-    resize(message_str.size());
-    std::memcpy(buffer_.data(), message_str.data(), message_str.size());
+    // RFC 6455 header directly in front of the payload: FIN plus opcode,
+    // then a 7-bit, 16-bit or 64-bit big-endian length; servers never mask
+    size_t payload_len = size();
+    uint8_t header[MAX_HEADER_SIZE];
+    size_t header_len = 0;
+    header[header_len++] = 0x80 | (binary_ ? 0x2 : 0x1);
+    if (payload_len < 126) {
+        header[header_len++] = static_cast<uint8_t>(payload_len);
+    } else if (payload_len <= 0xFFFF) {
+        header[header_len++] = 126;
+        for (int shift = 8; shift >= 0; shift -= 8) {
+            header[header_len++] = static_cast<uint8_t>(payload_len >> shift);
+        }
+    } else {
+        header[header_len++] = 127;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            header[header_len++] = static_cast<uint8_t>(static_cast<uint64_t>(payload_len) >> shift);
+        }
+    }
+    header_offset_ = MAX_HEADER_SIZE - header_len;
+    std::memcpy(storage_.data() + header_offset_, header, header_len);
+}
+
+FramePtr OutboundFrame::create(const std::string& topic, const uint8_t* payload, size_t len) {
+    return std::make_shared<const OutboundFrame>(topic, payload, len);
+}
+
+FramePtr OutboundFrame::create(const std::string& topic, const std::string& payload) {
+    return create(topic, reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+}
+
+//=============================================================================
+// PendingWrites Implementation
+//=============================================================================
+
+void PendingWrites::push(struct lws* wsi) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wsis_.push_back(wsi);
+}
+
+void PendingWrites::take(std::vector<struct lws*>& out) {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    wsis_.swap(out);
 }
 
 //=============================================================================
 // WebSocketConnection Implementation
 //=============================================================================
 
-WebSocketConnection::WebSocketConnection(struct lws* wsi, const std::string& topic)
-    : wsi_(wsi), topic_(topic), active_(false) {
+WebSocketConnection::WebSocketConnection(struct lws* wsi, const std::string& topic,
+                                         struct lws_context* service_context)
+    : wsi_(wsi), topic_(topic), max_filters_(1), subscriptions_(nullptr), active_(false),
+      send_head_(0), send_count_(0), send_budget_bytes_(0),
+      overflow_policy_(OverflowPolicy::DROP_OLDEST), overflowed_(false), pending_writes_(nullptr),
+      service_context_(service_context) {
 }
 
 WebSocketConnection::~WebSocketConnection() {
-    std::cout << "🔍 DEBUG: WebSocketConnection destructor called" << std::endl;
-    std::cout.flush();
+    THERMAL_LOG_DEBUG << "🔍 WebSocketConnection destructor called";
     
     cleanup();
     
-    std::cout << "🔍 DEBUG: WebSocketConnection destructor completed" << std::endl;
-    std::cout.flush();
+    THERMAL_LOG_DEBUG << "🔍 WebSocketConnection destructor completed";
 }
 
-bool WebSocketConnection::initialize(const BridgeConfig& config) {
+bool WebSocketConnection::initialize(const BridgeConfig& config, SubscriptionManager* subscriptions,
+                                     PendingWrites* pending_writes) {
     buffer_ = std::make_unique<MessageBuffer>(config.message_buffer_size);
+    pending_writes_ = pending_writes;
+    
+    // Send queue: byte budget from the buffer size, with ring slots for
+    // frames averaging 64 bytes (sensor readings are well under that)
+    send_budget_bytes_ = static_cast<size_t>(std::max(1, config.message_buffer_size));
+    send_ring_.assign(std::max<size_t>(16, send_budget_bytes_ / 64), nullptr);
+    overflow_policy_ = config.send_overflow_policy;
+    max_filters_ = static_cast<size_t>(std::max(1, config.max_subscriptions_per_connection));
+    
+    // Shared upstream clients: register with the bridge-wide multiplexer.
+    // An empty URL topic leaves the connection to subscribe by control message
+    if (subscriptions) {
+        subscriptions_ = subscriptions;
+        active_ = true;
+        if (!topic_.empty() && !subscribe(topic_)) {
+            active_ = false;
+            subscriptions_ = nullptr;
+            return false;
+        }
+        
+        THERMAL_LOG_INFO << "✅ [C++] Subscribed to topic: " << topic_ << " (shared)";
+        return true;
+    }
     
-    // Create MQTT client for this connection
+    // Create MQTT client for this connection; sensor topics are left to the
+    // bridge, which frames each reading once for every matching connection
+    ingested_prefix_ = ingested_prefix(config);
     std::string client_id = "ws_client_" + std::to_string(reinterpret_cast<uintptr_t>(wsi_));
     mqtt_client_ = std::make_unique<MqttClient>(client_id, config.mqtt_host, config.mqtt_port);
     
     // Set up the callback to handle incoming MQTT messages
     mqtt_client_->set_message_callback([this](const std::string& topic, const std::vector<uint8_t>& payload) {
-        std::cout << "📩 [C++] Received MQTT message on topic '" << topic << "': " << std::string(payload.begin(), payload.end()) << std::endl;
+        THERMAL_LOG_DEBUG << "📩 [C++] Received MQTT message on topic '" << topic << "': " << std::string_view(reinterpret_cast<const char*>(payload.data()), payload.size());
         this->handle_mqtt_message(topic, payload);
     });
     
@@ -103,106 +272,290 @@ bool WebSocketConnection::initialize(const BridgeConfig& config) {
     }
     
     // Subscribe to the topic
-    if (!mqtt_client_->subscribe(topic_)) {
+    if (!topic_.empty() && !subscribe(topic_)) {
         return false;
     }
     
-    std::cout << "✅ [C++] Subscribed to topic: " << topic_ << std::endl;
+    THERMAL_LOG_INFO << "✅ [C++] Subscribed to topic: " << topic_;
     active_ = true;
     return true;
 }
 
 void WebSocketConnection::cleanup() {
-    std::cout << "🔍 DEBUG: WebSocketConnection::cleanup() called" << std::endl;
-    std::cout.flush();
+    THERMAL_LOG_DEBUG << "🔍 WebSocketConnection::cleanup() called";
+    
+    active_ = false;
+    
+    if (subscriptions_) {
+        std::vector<std::string> filters;
+        {
+            std::lock_guard<std::mutex> lock(filters_mutex_);
+            filters.swap(filters_);
+        }
+        for (const auto& filter : filters) {
+            subscriptions_->unsubscribe(filter, this);
+        }
+        subscriptions_ = nullptr;
+    }
     
     if (mqtt_client_) {
-        std::cout << "🔍 DEBUG: Calling mqtt_client_->disconnect()" << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 Calling mqtt_client_->disconnect()";
         
         mqtt_client_->disconnect();
         
-        std::cout << "🔍 DEBUG: Resetting mqtt_client_" << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 Resetting mqtt_client_";
         
         mqtt_client_.reset();
         
-        std::cout << "🔍 DEBUG: mqtt_client_ reset completed" << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 mqtt_client_ reset completed";
     }
     
-    active_ = false;
-    
-    std::cout << "🔍 DEBUG: WebSocketConnection::cleanup() completed" << std::endl;
-    std::cout.flush();
+    THERMAL_LOG_DEBUG << "🔍 WebSocketConnection::cleanup() completed";
 }
 
 void WebSocketConnection::handle_websocket_message(const uint8_t* data, size_t len) {
     if (!active_ || !buffer_) return;
     
-    // Copy data to buffer for processing
+    // Copy data to buffer for processing; the buffer only ever grows
     buffer_->resize(len);
     std::memcpy(buffer_->data(), data, len);
     
-    std::string topic;
-    std::vector<uint8_t> payload;
+    // Receives run on this connection's service thread only
+    std::string& topic = rx_topic_;
+    std::vector<uint8_t>& payload = rx_payload_;
     
     if (buffer_->parse_websocket_message(topic, payload)) {
+        // Control messages use '$' topics, which MQTT clients cannot publish to
+        if (topic == "$subscribe" || topic == "$unsubscribe") {
+            std::string filter(payload.begin(), payload.end());
+            bool ok = topic == "$subscribe" ? subscribe(filter) : unsubscribe(filter);
+            send_control_reply(ok ? (topic == "$subscribe" ? "$subscribed" : "$unsubscribed") : "$error", filter);
+            return;
+        }
+        
         // Forward to MQTT
-        if (mqtt_client_) {
-            std::string payload_str(payload.begin(), payload.end());
-            std::cout << "📤 [C++] Publishing to MQTT topic '" << topic << "': '" << payload_str << "'" << std::endl;
+        if (subscriptions_ || mqtt_client_) {
+            THERMAL_LOG_DEBUG << "📤 [C++] Publishing to MQTT topic '" << topic << "': '"
+                              << std::string_view(reinterpret_cast<const char*>(payload.data()), payload.size()) << "'";
             
-            if (mqtt_client_->publish(topic, payload)) {
-                std::cout << "✅ [C++] Successfully published to MQTT" << std::endl;
+            bool published = subscriptions_ ? subscriptions_->publish(topic, payload)
+                                            : mqtt_client_->publish(topic, payload);
+            if (published) {
+                THERMAL_LOG_DEBUG << "✅ [C++] Successfully published to MQTT";
             } else {
-                std::cout << "❌ [C++] Failed to publish to MQTT" << std::endl;
+                THERMAL_LOG_ERROR << "❌ [C++] Failed to publish to MQTT";
             }
         }
     }
 }
 
-void WebSocketConnection::handle_mqtt_message(const std::string& topic, const std::vector<uint8_t>& payload) {
-    if (!active_ || !buffer_) return;
+bool WebSocketConnection::subscribe(const std::string& filter) {
+    if (!thermal_monitoring::valid_topic_filter(filter)) {
+        THERMAL_LOG_WARN << "⚠️  [C++] Invalid topic filter: '" << filter << "'";
+        return false;
+    }
     
-    // Check if this is a sensor message that should be processed by thermal monitoring
-    std::string payload_str(payload.begin(), payload.end());
-    if (topic.find("sensors/") == 0 && g_bridge_instance) {
-        // Process sensor message through thermal monitoring
-        g_bridge_instance->process_sensor_message(topic, payload_str);
+    std::lock_guard<std::mutex> lock(filters_mutex_);
+    if (std::find(filters_.begin(), filters_.end(), filter) != filters_.end()) {
+        return true;
+    }
+    if (filters_.size() >= max_filters_) {
+        THERMAL_LOG_WARN << "⚠️  [C++] Subscription limit (" << max_filters_ << ") reached, rejecting: " << filter;
+        return false;
     }
     
-    // Format message for WebSocket
-    buffer_->format_mqtt_message(topic, payload);
+    bool subscribed = subscriptions_ ? subscriptions_->subscribe(filter, shared_from_this())
+                                     : mqtt_client_ && (is_ingested(filter) || mqtt_client_->subscribe(filter));
+    if (!subscribed) {
+        return false;
+    }
+    filters_.push_back(filter);
+    THERMAL_LOG_DEBUG << "🔔 [C++] Subscribed to filter: " << filter << " (" << filters_.size() << " active)";
+    return true;
+}
+
+bool WebSocketConnection::unsubscribe(const std::string& filter) {
+    std::lock_guard<std::mutex> lock(filters_mutex_);
+    auto it = std::find(filters_.begin(), filters_.end(), filter);
+    if (it == filters_.end()) {
+        return false;
+    }
+    filters_.erase(it);
     
-    // Send to WebSocket client  
-    send_to_websocket(std::vector<uint8_t>(buffer_->data(), buffer_->data() + buffer_->size()));
+    if (subscriptions_) {
+        subscriptions_->unsubscribe(filter, this);
+    } else if (mqtt_client_ && !is_ingested(filter)) {
+        mqtt_client_->unsubscribe(filter);
+    }
+    THERMAL_LOG_DEBUG << "🔕 [C++] Unsubscribed from filter: " << filter;
+    return true;
+}
+
+std::vector<std::string> WebSocketConnection::get_filters() const {
+    std::lock_guard<std::mutex> lock(filters_mutex_);
+    return filters_;
+}
+
+bool WebSocketConnection::matches(const std::string& topic) const {
+    std::lock_guard<std::mutex> lock(filters_mutex_);
+    return std::any_of(filters_.begin(), filters_.end(), [&](const std::string& filter) {
+        return thermal_monitoring::topic_matches(filter, topic);
+    });
+}
+
+bool WebSocketConnection::is_ingested(const std::string& topic) const {
+    return !ingested_prefix_.empty() && topic.compare(0, ingested_prefix_.size(), ingested_prefix_) == 0;
+}
+
+void WebSocketConnection::send_control_reply(const std::string& topic, const std::string& filter) {
+    // "$subscribed|filter", "$unsubscribed|filter" or "$error|filter"
+    if (send_frame(OutboundFrame::create(topic, filter))) {
+        wake_service();
+    }
 }
 
-bool WebSocketConnection::send_to_websocket(const std::vector<uint8_t>& data) {
-    if (!wsi_ || data.empty()) return false;
+void WebSocketConnection::handle_mqtt_message(const std::string& topic, const std::vector<uint8_t>& payload) {
+    // Sensor topics reach this connection through deliver_ingested(); a
+    // wildcard filter ("#") still pulls them through its own client
+    if (!active_ || is_ingested(topic)) return;
     
-    std::cout << "📤 [C++] Sending to WebSocket client (" << data.size() << " bytes)" << std::endl;
+    if (send_frame(OutboundFrame::create(topic, payload.data(), payload.size()))) {
+        wake_service();
+    }
+}
+
+bool WebSocketConnection::send_frame(const FramePtr& frame) {
+    if (!wsi_ || !active_ || !frame) return false;
     
-    // Allocate buffer with LWS_PRE bytes padding for libwebsockets
-    size_t total_size = LWS_PRE + data.size();
-    std::vector<uint8_t> send_buffer(total_size);
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (overflowed_ || send_ring_.empty()) return false;
     
-    // Copy data after the LWS_PRE padding
-    std::memcpy(send_buffer.data() + LWS_PRE, data.data(), data.size());
+    // A non-empty ring already has a writable callback requested or this
+    // connection on the pending list; only the first frame registers it
+    if (send_count_ == 0 && pending_writes_) {
+        pending_writes_->push(wsi_);
+    }
     
-    // Send the data using libwebsockets as text (not binary)
-    int result = lws_write(wsi_, send_buffer.data() + LWS_PRE, data.size(), LWS_WRITE_TEXT);
+    // Either way the service thread still has work: the replacement frame
+    // to send or the overflowed connection to close
+    if (!make_room(frame)) {
+        return true;
+    }
     
-    if (result < 0) {
-        std::cout << "❌ [C++] Failed to send WebSocket message" << std::endl;
-        return false;
+    send_ring_[(send_head_ + send_count_) % send_ring_.size()] = frame;
+    send_count_++;
+    send_stats_.queued_frames = send_count_;
+    send_stats_.queued_bytes += frame->size();
+    return true;
+}
+
+void WebSocketConnection::pop_front_frame() {
+    send_stats_.queued_bytes -= send_ring_[send_head_]->size();
+    send_ring_[send_head_].reset();
+    send_head_ = (send_head_ + 1) % send_ring_.size();
+    send_count_--;
+    send_stats_.queued_frames = send_count_;
+}
+
+bool WebSocketConnection::make_room(const FramePtr& frame) {
+    // Caller holds send_mutex_. Returns false when the frame must not be
+    // appended: it replaced a queued frame or the connection overflowed
+    auto full = [&]() {
+        return send_count_ == send_ring_.size() ||
+               (send_count_ > 0 && send_stats_.queued_bytes + frame->size() > send_budget_bytes_);
+    };
+    if (!full()) return true;
+    
+    switch (overflow_policy_) {
+        case OverflowPolicy::COALESCE_LATEST: {
+            // Keep the queue position, swap in the latest value for the topic
+            for (size_t i = 0; i < send_count_; ++i) {
+                FramePtr& queued = send_ring_[(send_head_ + i) % send_ring_.size()];
+                if (queued->topic() == frame->topic()) {
+                    send_stats_.queued_bytes = send_stats_.queued_bytes - queued->size() + frame->size();
+                    queued = frame;
+                    send_stats_.coalesced_frames++;
+                    return false;
+                }
+            }
+            break;
+        }
+        
+        case OverflowPolicy::DISCONNECT: {
+            // Drop the backlog; the next writable callback closes the socket
+            while (send_count_ > 0) {
+                pop_front_frame();
+                send_stats_.dropped_frames++;
+            }
+            send_stats_.dropped_frames++;
+            send_stats_.overflow_disconnects++;
+            overflowed_ = true;
+            active_ = false;
+            THERMAL_LOG_WARN << "⚠️  [C++] Send queue overflow, disconnecting slow client on " << topic_;
+            return false;
+        }
+        
+        case OverflowPolicy::DROP_OLDEST:
+            break;
     }
     
-    std::cout << "✅ [C++] Successfully sent " << result << " bytes to WebSocket client" << std::endl;
+    while (full()) {
+        pop_front_frame();
+        send_stats_.dropped_frames++;
+    }
     return true;
 }
 
+void WebSocketConnection::wake_service() const {
+    // lws_callback_on_writable() is only safe on the service thread, so the
+    // service loops are woken and request writes in EVENT_WAIT_CANCELLED.
+    // Never through wsi_: a service thread may already have closed and freed it
+    if (service_context_) {
+        lws_cancel_service(service_context_);
+    }
+}
+
+SendQueueStats WebSocketConnection::get_send_stats() const {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    return send_stats_;
+}
+
+int WebSocketConnection::write_pending_frame() {
+    FramePtr frame;
+    bool more = false;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (overflowed_) {
+            lws_close_reason(wsi_, LWS_CLOSE_STATUS_POLICY_VIOLATION, nullptr, 0);
+            return -1;
+        }
+        if (send_count_ == 0) return 0;
+        frame = send_ring_[send_head_];
+        pop_front_frame();
+        more = send_count_ > 0;
+    }
+    
+    // The frame carries its own header, so the shared buffer goes out
+    // as is; lws_write() only reads it for LWS_WRITE_RAW
+    int result = lws_write(wsi_, const_cast<unsigned char*>(frame->wire_data()), frame->wire_size(),
+                           LWS_WRITE_RAW);
+    if (result < static_cast<int>(frame->wire_size())) {
+        THERMAL_LOG_ERROR << "❌ [C++] Failed to send WebSocket message";
+        return -1;
+    }
+    
+    BridgeMetrics& m = bridge_metrics();
+    m.frames_sent.inc();
+    m.bytes_sent.inc(frame->size());
+    m.fanout_latency_seconds.observe_duration(std::chrono::steady_clock::now() - frame->created());
+    
+    // One frame per writable callback; ask for the next one if needed
+    if (more) {
+        lws_callback_on_writable(wsi_);
+    }
+    return 0;
+}
+
 void WebSocketConnection::close_connection() {
     active_ = false;
     if (wsi_) {
@@ -234,15 +587,15 @@ MqttClient::~MqttClient() {
 
 bool MqttClient::connect() {
     if (!mosq_) {
-        std::cout << "❌ [C++] MQTT client not initialized" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [C++] MQTT client not initialized";
         return false;
     }
     
-    std::cout << "🔗 [C++] Connecting to MQTT broker " << host_ << ":" << port_ << std::endl;
+    THERMAL_LOG_INFO << "🔗 [C++] Connecting to MQTT broker " << host_ << ":" << port_;
     
     int rc = mosquitto_connect(mosq_, host_.c_str(), port_, 60);
     if (rc != MOSQ_ERR_SUCCESS) {
-        std::cout << "❌ [C++] Failed to connect to MQTT broker, error: " << rc << std::endl;
+        THERMAL_LOG_ERROR << "❌ [C++] Failed to connect to MQTT broker, error: " << rc;
         return false;
     }
     
@@ -256,57 +609,52 @@ bool MqttClient::connect() {
     }
     
     if (connected_) {
-        std::cout << "✅ [C++] Connected to MQTT broker" << std::endl;
+        THERMAL_LOG_INFO << "✅ [C++] Connected to MQTT broker";
         return true;
     } else {
-        std::cout << "❌ [C++] Connection to MQTT broker timed out" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [C++] Connection to MQTT broker timed out";
         return false;
     }
 }
 
 void MqttClient::disconnect() {
-    std::cout << "🔍 DEBUG: MqttClient::disconnect() called" << std::endl;
-    std::cout.flush();
+    THERMAL_LOG_DEBUG << "🔍 MqttClient::disconnect() called";
     
     if (mosq_ && connected_) {
-        std::cout << "🔍 DEBUG: Stopping MQTT loop" << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 Stopping MQTT loop";
         
         // Force stop the loop to avoid hanging
         mosquitto_loop_stop(mosq_, true);
         
-        std::cout << "🔍 DEBUG: Disconnecting from MQTT broker" << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 Disconnecting from MQTT broker";
         
         mosquitto_disconnect(mosq_);
         
-        std::cout << "🔍 DEBUG: MQTT disconnect completed" << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 MQTT disconnect completed";
     }
     
     connected_ = false;
     
-    std::cout << "🔍 DEBUG: MqttClient::disconnect() completed" << std::endl;
-    std::cout.flush();
+    THERMAL_LOG_DEBUG << "🔍 MqttClient::disconnect() completed";
 }
 
 bool MqttClient::subscribe(const std::string& topic) {
     if (!mosq_) {
-        std::cout << "❌ [C++] MQTT client not initialized for subscription" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [C++] MQTT client not initialized for subscription";
         return false;
     }
     if (!connected_) {
-        std::cout << "❌ [C++] MQTT client not connected for subscription" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [C++] MQTT client not connected for subscription";
         return false;
     }
     
-    std::cout << "📝 [C++] Subscribing to MQTT topic: " << topic << std::endl;
+    THERMAL_LOG_INFO << "📝 [C++] Subscribing to MQTT topic: " << topic;
     int rc = mosquitto_subscribe(mosq_, nullptr, topic.c_str(), 0);
     if (rc == MOSQ_ERR_SUCCESS) {
-        std::cout << "✅ [C++] Successfully subscribed to topic: " << topic << std::endl;
+        THERMAL_LOG_INFO << "✅ [C++] Successfully subscribed to topic: " << topic;
         return true;
     } else {
-        std::cout << "❌ [C++] Failed to subscribe to topic, error: " << rc << std::endl;
+        THERMAL_LOG_ERROR << "❌ [C++] Failed to subscribe to topic, error: " << rc;
         return false;
     }
 }
@@ -326,23 +674,34 @@ void MqttClient::set_message_callback(std::function<void(const std::string&, con
     message_callback_ = callback;
 }
 
+void MqttClient::set_connect_callback(std::function<void()> callback) {
+    connect_callback_ = callback;
+}
+
 // Static callbacks for mosquitto
 void MqttClient::on_connect_callback(struct mosquitto*, void* userdata, int rc) {
     MqttClient* client = static_cast<MqttClient*>(userdata);
     if (rc == 0) {
         client->connected_ = true;
-        std::cout << "✅ [C++] MQTT connection established successfully" << std::endl;
+        THERMAL_LOG_INFO << "✅ [C++] MQTT connection established successfully";
+        if (client->connect_callback_) {
+            client->connect_callback_();
+        }
     } else {
-        std::cout << "❌ [C++] MQTT connection failed with code: " << rc << std::endl;
+        THERMAL_LOG_ERROR << "❌ [C++] MQTT connection failed with code: " << rc;
     }
 }
 
 void MqttClient::on_message_callback(struct mosquitto*, void* userdata, const struct mosquitto_message* message) {
     MqttClient* client = static_cast<MqttClient*>(userdata);
     if (client->message_callback_) {
-        std::vector<uint8_t> payload(static_cast<uint8_t*>(message->payload), 
-                                   static_cast<uint8_t*>(message->payload) + message->payloadlen);
-        client->message_callback_(std::string(message->topic), payload);
+        // One set of buffers per mosquitto loop thread, refilled for every message
+        thread_local std::string topic;
+        thread_local std::vector<uint8_t> payload;
+        topic.assign(message->topic);
+        payload.assign(static_cast<const uint8_t*>(message->payload), 
+                       static_cast<const uint8_t*>(message->payload) + message->payloadlen);
+        client->message_callback_(topic, payload);
     }
 }
 
@@ -351,32 +710,269 @@ void MqttClient::on_disconnect_callback(struct mosquitto*, void* userdata, int)
     client->connected_ = false;
 }
 
+//=============================================================================
+// SubscriptionManager Implementation
+//=============================================================================
+
+SubscriptionManager::SubscriptionManager(const BridgeConfig& config, struct lws_context* service_context)
+    : config_(config), service_context_(service_context) {
+    size_t pool_size = static_cast<size_t>(std::max(1, config_.mqtt_pool_size));
+    
+    for (size_t i = 0; i < pool_size; ++i) {
+        std::string client_id = "ws_bridge_pool_" + std::to_string(getpid()) + "_" + std::to_string(i);
+        auto client = std::make_unique<MqttClient>(client_id, config_.mqtt_host, config_.mqtt_port);
+        
+        client->set_message_callback([this, i](const std::string& topic, const std::vector<uint8_t>& payload) {
+            this->dispatch(i, topic, payload);
+        });
+        
+        // Clean sessions drop broker-side subscriptions, so restore them on reconnect
+        client->set_connect_callback([this, i]() {
+            this->resubscribe_client(i);
+        });
+        
+        clients_.push_back(std::move(client));
+    }
+}
+
+SubscriptionManager::~SubscriptionManager() {
+    stop();
+}
+
+bool SubscriptionManager::start() {
+    size_t connected = 0;
+    for (auto& client : clients_) {
+        if (client->is_connected() || client->connect()) {
+            connected++;
+        }
+    }
+    
+    THERMAL_LOG_INFO << "🔀 [C++] Subscription manager: " << connected << "/" << clients_.size() 
+                     << " upstream MQTT clients connected";
+    return connected > 0;
+}
+
+void SubscriptionManager::stop() {
+    for (auto& client : clients_) {
+        client->disconnect();
+    }
+    
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    topics_.clear();
+    routes_.clear();
+}
+
+size_t SubscriptionManager::select_client(const std::string& topic) const {
+    // Stable topic -> client mapping keeps per-topic message ordering;
+    // fall back to any connected client if the preferred one is down
+    size_t preferred = std::hash<std::string>{}(topic) % clients_.size();
+    for (size_t i = 0; i < clients_.size(); ++i) {
+        size_t index = (preferred + i) % clients_.size();
+        if (clients_[index]->is_connected()) {
+            return index;
+        }
+    }
+    return preferred;
+}
+
+bool SubscriptionManager::is_ingested(const std::string& topic) const {
+    return !ingested_prefix_.empty() && topic.compare(0, ingested_prefix_.size(), ingested_prefix_) == 0;
+}
+
+void SubscriptionManager::set_ingested_prefix(const std::string& prefix) {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    ingested_prefix_ = prefix;
+}
+
+bool SubscriptionManager::subscribe(const std::string& topic, const std::shared_ptr<WebSocketConnection>& subscriber) {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    
+    if (const auto* routes = routes_.values(topic)) {
+        for (const Route& route : *routes) {
+            if (route.key == subscriber.get()) {
+                return true;
+            }
+        }
+    }
+    
+    auto it = topics_.find(topic);
+    if (it == topics_.end()) {
+        // First subscriber for this topic: subscribe upstream once, unless
+        // the ingestion stage already receives everything it can match
+        size_t client_index = select_client(topic);
+        if (!is_ingested(topic) && !clients_[client_index]->subscribe(topic)) {
+            return false;
+        }
+        it = topics_.emplace(topic, TopicSubscription{client_index}).first;
+        THERMAL_LOG_INFO << "🔀 [C++] Upstream subscription added: " << topic 
+                         << " (client " << client_index << ", " << topics_.size() << " topics)";
+    }
+    
+    routes_.insert(topic, Route{it->second.client_index, subscriber.get(), subscriber});
+    return true;
+}
+
+void SubscriptionManager::unsubscribe(const std::string& topic, const WebSocketConnection* subscriber) {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    
+    auto it = topics_.find(topic);
+    if (it == topics_.end()) {
+        return;
+    }
+    
+    // Drop this subscriber along with any that expired without unsubscribing
+    size_t remaining = routes_.erase_if(topic, [subscriber](const Route& route) {
+        return route.key == subscriber || route.connection.expired();
+    });
+    
+    if (remaining == 0) {
+        // Last subscriber gone: release the upstream subscription
+        if (!is_ingested(topic)) {
+            clients_[it->second.client_index]->unsubscribe(topic);
+        }
+        topics_.erase(it);
+        THERMAL_LOG_INFO << "🔀 [C++] Upstream subscription released: " << topic 
+                         << " (" << topics_.size() << " topics)";
+    }
+}
+
+bool SubscriptionManager::publish(const std::string& topic, const std::vector<uint8_t>& payload, int qos) {
+    return clients_[select_client(topic)]->publish(topic, payload, qos);
+}
+
+void SubscriptionManager::resubscribe_client(size_t client_index) {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    
+    for (const auto& entry : topics_) {
+        if (entry.second.client_index == client_index && !is_ingested(entry.first)) {
+            clients_[client_index]->subscribe(entry.first);
+        }
+    }
+}
+
+void SubscriptionManager::collect(const std::string& topic, size_t client_index,
+                                  std::vector<std::shared_ptr<WebSocketConnection>>& targets) const {
+    // Caller holds topics_mutex_
+    routes_.match(topic, [&](const Route& route) {
+        if (client_index != ANY_CLIENT && route.client_index != client_index) {
+            return;
+        }
+        if (auto connection = route.connection.lock()) {
+            targets.push_back(std::move(connection));
+        }
+    });
+    
+    // Overlapping filters ("alerts/#" and "alerts/+") still deliver once
+    if (targets.size() > 1) {
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    }
+}
+
+void SubscriptionManager::dispatch(size_t client_index, const std::string& topic, const std::vector<uint8_t>& payload) {
+    std::vector<std::shared_ptr<WebSocketConnection>> targets;
+    
+    // Collect targets under the lock, deliver outside it so connection
+    // handling (and thermal alerts) never runs with topics_mutex_ held
+    {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        
+        // Wildcard subscriptions can pull ingested topics through the pool
+        // as well; those already arrive once via deliver()
+        if (is_ingested(topic)) {
+            return;
+        }
+        
+        // Only filters held by this client, or a message matching filters
+        // on two clients would be delivered twice
+        collect(topic, client_index, targets);
+    }
+    
+    fan_out(targets, topic, payload);
+}
+
+void SubscriptionManager::deliver(const std::string& topic, const std::vector<uint8_t>& payload) {
+    std::vector<std::shared_ptr<WebSocketConnection>> targets;
+    
+    {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        
+        // Outside the prefix the pool clients deliver themselves
+        if (!is_ingested(topic)) {
+            return;
+        }
+        
+        collect(topic, ANY_CLIENT, targets);
+    }
+    
+    fan_out(targets, topic, payload);
+}
+
+std::vector<std::shared_ptr<WebSocketConnection>> SubscriptionManager::route(const std::string& topic) const {
+    std::vector<std::shared_ptr<WebSocketConnection>> targets;
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    collect(topic, ANY_CLIENT, targets);
+    return targets;
+}
+
+void SubscriptionManager::fan_out(const std::vector<std::shared_ptr<WebSocketConnection>>& targets,
+                                  const std::string& topic, const std::vector<uint8_t>& payload) {
+    if (targets.empty()) return;
+    
+    // Serialise once and queue the same frame on every subscriber
+    FramePtr frame = OutboundFrame::create(topic, payload.data(), payload.size());
+    size_t queued = 0;
+    for (const auto& connection : targets) {
+        if (connection->send_frame(frame)) {
+            queued++;
+        }
+    }
+    
+    // A single wake-up reaches every service thread
+    if (queued > 0 && service_context_) {
+        lws_cancel_service(service_context_);
+    }
+}
+
+size_t SubscriptionManager::get_topic_count() const {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    return topics_.size();
+}
+
+size_t SubscriptionManager::get_subscriber_count() const {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    return routes_.size();
+}
+
 //=============================================================================
 // MqttWebSocketBridge Implementation
 //=============================================================================
 
 MqttWebSocketBridge::MqttWebSocketBridge(const BridgeConfig& config)
-    : config_(config), lws_context_(nullptr), connection_count_(0), 
-      running_(false), epoll_fd_(-1), events_(nullptr), ssl_ctx_(nullptr) {
+    : config_(config), lws_context_(nullptr), connection_count_(0),
+      closed_dropped_frames_(0), closed_coalesced_frames_(0), closed_overflow_disconnects_(0),
+      service_thread_count_(1), running_(false), ssl_ctx_(nullptr) {
     
     g_bridge_instance = this;
     
     // Initialize mosquitto library
     mosquitto_lib_init();
     
-    std::cout << "🔧 Initializing MQTT-WebSocket Bridge..." << std::endl;
-    std::cout << "   MQTT Broker: " << config_.mqtt_host << ":" << config_.mqtt_port << std::endl;
-    std::cout << "   WebSocket Port: " << config_.websocket_port << std::endl;
-    std::cout << "   Worker Threads: " << config_.worker_threads << std::endl;
+    THERMAL_LOG_INFO << "🔧 Initializing MQTT-WebSocket Bridge...";
+    THERMAL_LOG_INFO << "   MQTT Broker: " << config_.mqtt_host << ":" << config_.mqtt_port;
+    THERMAL_LOG_INFO << "   WebSocket Port: " << config_.websocket_port;
+    THERMAL_LOG_INFO << "   Worker Threads: " << config_.worker_threads;
     
     // Initialize thermal monitoring if enabled
     if (config_.thermal_monitoring_enabled) {
         thermal_tracker_ = std::make_unique<thermal_monitoring::ThermalIsolationTracker>(config_.thermal_config);
-        std::cout << "🌡️  Thermal monitoring initialized" << std::endl;
+        THERMAL_LOG_INFO << "🌡️  Thermal monitoring initialized";
     }
 }
 
 MqttWebSocketBridge::~MqttWebSocketBridge() {
+    // A scrape in flight finishes before the state it reads goes away
+    metrics_callbacks_.reset();
     stop();
     cleanup_resources();
     mosquitto_lib_cleanup();
@@ -384,61 +980,81 @@ MqttWebSocketBridge::~MqttWebSocketBridge() {
 }
 
 bool MqttWebSocketBridge::initialize() {
-    std::cout << "🚀 Initializing bridge components..." << std::endl;
+    THERMAL_LOG_INFO << "🚀 Initializing bridge components...";
     
     // Setup SSL if certificates are provided
     if (!config_.ssl_cert_path.empty() && !config_.ssl_key_path.empty()) {
         if (!setup_ssl_context()) {
-            std::cerr << "❌ Failed to setup SSL context" << std::endl;
+            THERMAL_LOG_ERROR << "❌ Failed to setup SSL context";
             return false;
         }
-        std::cout << "✅ SSL context initialized" << std::endl;
+        THERMAL_LOG_INFO << "✅ SSL context initialized";
     }
     
     // Setup libwebsockets
     if (!setup_libwebsockets()) {
-        std::cerr << "❌ Failed to setup libwebsockets" << std::endl;
+        THERMAL_LOG_ERROR << "❌ Failed to setup libwebsockets";
         return false;
     }
-    std::cout << "✅ WebSocket server initialized" << std::endl;
+    THERMAL_LOG_INFO << "✅ WebSocket server initialized";
     
-    // Setup epoll for I/O (Linux optimization)
-    if (config_.use_epoll && !setup_epoll()) {
-        std::cerr << "❌ Failed to setup epoll" << std::endl;
+    // Setup shared upstream MQTT clients
+    if (config_.connection_pooling && !setup_subscription_manager()) {
+        THERMAL_LOG_ERROR << "❌ Failed to setup MQTT subscription manager";
         return false;
     }
     
     // Setup thermal monitoring
     if (config_.thermal_monitoring_enabled && !setup_thermal_monitoring()) {
-        std::cerr << "❌ Failed to setup thermal monitoring" << std::endl;
+        THERMAL_LOG_ERROR << "❌ Failed to setup thermal monitoring";
+        return false;
+    }
+    
+    // Setup bridge-level sensor ingestion
+    if (config_.thermal_monitoring_enabled && !setup_sensor_ingestion()) {
+        THERMAL_LOG_ERROR << "❌ Failed to setup sensor ingestion";
         return false;
     }
     
-    std::cout << "✅ Bridge initialization complete" << std::endl;
+    if (config_.metrics_enabled) {
+        setup_metrics();
+        THERMAL_LOG_INFO << "📈 Metrics served at http://" << config_.websocket_host << ":"
+                         << config_.websocket_port << config_.metrics_path;
+    }
+    
+    THERMAL_LOG_INFO << "✅ Bridge initialization complete";
     return true;
 }
 
 bool MqttWebSocketBridge::start() {
     if (running_.load()) {
-        std::cout << "⚠️  Bridge is already running" << std::endl;
+        THERMAL_LOG_WARN << "⚠️  Bridge is already running";
         return true;
     }
     
     running_ = true;
     
-    std::cout << "🌐 Starting WebSocket server on port " << config_.websocket_port << std::endl;
+    THERMAL_LOG_INFO << "🌐 Starting WebSocket server on port " << config_.websocket_port;
+    
+    // First snapshot before any scrape can arrive; refreshed off the service threads
+    if (config_.metrics_enabled) {
+        metrics_snapshot_ = std::make_shared<const std::string>(metrics::Registry::global().render_prometheus());
+        metrics_thread_ = std::thread(&MqttWebSocketBridge::metrics_render_loop, this);
+    }
     
-    // Start single worker thread for libwebsockets (thread-safe approach)
-    worker_threads_.emplace_back(&MqttWebSocketBridge::worker_thread_loop, this);
+    // One service thread per libwebsockets thread slot; each owns its shard
+    for (int tsi = 0; tsi < service_thread_count_; ++tsi) {
+        worker_threads_.emplace_back(&MqttWebSocketBridge::worker_thread_loop, this, tsi);
+    }
     
     // Start thermal monitoring if enabled
     if (config_.thermal_monitoring_enabled && thermal_tracker_) {
         thermal_tracker_->start();
-        std::cout << "🌡️  Thermal monitoring started" << std::endl;
+        THERMAL_LOG_INFO << "🌡️  Thermal monitoring started";
     }
     
-    std::cout << "✅ Bridge started successfully!" << std::endl;
-    std::cout << "📊 Monitoring connections..." << std::endl;
+    THERMAL_LOG_INFO << "✅ Bridge started successfully!";
+    THERMAL_LOG_INFO << "📊 Monitoring connections...";
     
     return true;
 }
@@ -446,13 +1062,18 @@ bool MqttWebSocketBridge::start() {
 void MqttWebSocketBridge::stop() {
     if (!running_.load()) return;
     
-    std::cout << "\n🛑 Stopping bridge..." << std::endl;
+    THERMAL_LOG_INFO << "\n🛑 Stopping bridge...";
     running_ = false;
     
+    // Stop sensor ingestion before the tracker it feeds
+    if (ingest_client_) {
+        ingest_client_->disconnect();
+    }
+    
     // Stop thermal monitoring if running
     if (thermal_tracker_) {
         thermal_tracker_->stop();
-        std::cout << "🌡️  Thermal monitoring stopped" << std::endl;
+        THERMAL_LOG_INFO << "🌡️  Thermal monitoring stopped";
     }
     
     // Wait for worker threads to finish
@@ -463,8 +1084,22 @@ void MqttWebSocketBridge::stop() {
     }
     worker_threads_.clear();
     
+    // Taking the lock orders running_ before the render loop's wait
+    {
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+    }
+    metrics_cv_.notify_all();
+    if (metrics_thread_.joinable()) {
+        metrics_thread_.join();
+    }
+    
     cleanup_connections();
-    std::cout << "✅ Bridge stopped gracefully" << std::endl;
+    
+    if (subscription_manager_) {
+        subscription_manager_->stop();
+    }
+    
+    THERMAL_LOG_INFO << "✅ Bridge stopped gracefully";
 }
 
 //=============================================================================
@@ -493,12 +1128,23 @@ bool MqttWebSocketBridge::setup_libwebsockets() {
         {
             "mqtt-ws-protocol",                     // name
             websocket_callback,                     // callback
-            0,                                      // per_session_data_size
+            sizeof(HttpSession),                    // per_session_data_size
             1024,                                  // rx_buffer_size
         },
         { NULL, NULL, 0, 0 } // terminator
     };
     
+    // Service threads are capped by what libwebsockets was built for
+    service_thread_count_ = std::max(1, config_.worker_threads);
+#ifdef LWS_MAX_SMP
+    service_thread_count_ = std::min(service_thread_count_, LWS_MAX_SMP);
+#endif
+    
+    connection_shards_.clear();
+    for (int i = 0; i < service_thread_count_; ++i) {
+        connection_shards_.push_back(std::make_unique<ConnectionShard>());
+    }
+    
     // Initialize libwebsockets context info
     memset(&lws_info_, 0, sizeof(lws_info_));
     lws_info_.port = config_.websocket_port;
@@ -506,6 +1152,7 @@ bool MqttWebSocketBridge::setup_libwebsockets() {
     lws_info_.protocols = protocols;
     lws_info_.gid = -1;
     lws_info_.uid = -1;
+    lws_info_.count_threads = service_thread_count_;
     
     // SSL configuration
     if (ssl_ctx_) {
@@ -519,23 +1166,74 @@ bool MqttWebSocketBridge::setup_libwebsockets() {
     return lws_context_ != nullptr;
 }
 
-bool MqttWebSocketBridge::setup_epoll() {
-    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
-    if (epoll_fd_ == -1) return false;
+bool MqttWebSocketBridge::setup_subscription_manager() {
+    subscription_manager_ = std::make_unique<SubscriptionManager>(config_, lws_context_);
+    if (!subscription_manager_->start()) {
+        subscription_manager_.reset();
+        return false;
+    }
     
-    events_ = new struct epoll_event[config_.max_connections];
+    THERMAL_LOG_INFO << "✅ MQTT connection pool ready (" << config_.mqtt_pool_size << " clients)";
     return true;
 }
 
-void MqttWebSocketBridge::worker_thread_loop() {
-    std::cout << "🔄 Main worker thread started (ID: " << std::this_thread::get_id() << ")" << std::endl;
+void MqttWebSocketBridge::setup_metrics() {
+    metrics::Registry& registry = metrics::Registry::global();
+    metrics_callbacks_.reset();
+    metrics_callbacks_ = metrics::CallbackHandle(&registry, {});
+    
+    metrics_callbacks_.add(registry.add_callback(
+        "thermal_bridge_connections", "Open WebSocket connections", metrics::MetricType::GAUGE,
+        [this] { return static_cast<double>(connection_count_.load()); }));
+    
+    // Each scrape walks the shards once per series; cheap next to the scrape itself
+    metrics_callbacks_.add(registry.add_callback(
+        "thermal_bridge_send_queue_frames", "Frames queued for WebSocket clients", metrics::MetricType::GAUGE,
+        [this] { return static_cast<double>(get_send_queue_stats().queued_frames); }));
+    metrics_callbacks_.add(registry.add_callback(
+        "thermal_bridge_send_queue_bytes", "Bytes queued for WebSocket clients", metrics::MetricType::GAUGE,
+        [this] { return static_cast<double>(get_send_queue_stats().queued_bytes); }));
+    metrics_callbacks_.add(registry.add_callback(
+        "thermal_bridge_dropped_frames_total", "Frames dropped from full send queues", metrics::MetricType::COUNTER,
+        [this] { return static_cast<double>(get_send_queue_stats().dropped_frames); }));
+    metrics_callbacks_.add(registry.add_callback(
+        "thermal_bridge_coalesced_frames_total", "Queued frames replaced by a newer frame on the same topic",
+        metrics::MetricType::COUNTER,
+        [this] { return static_cast<double>(get_send_queue_stats().coalesced_frames); }));
+    metrics_callbacks_.add(registry.add_callback(
+        "thermal_bridge_overflow_disconnects_total", "Clients disconnected for falling behind",
+        metrics::MetricType::COUNTER,
+        [this] { return static_cast<double>(get_send_queue_stats().overflow_disconnects); }));
+    
+    if (subscription_manager_) {
+        metrics_callbacks_.add(registry.add_callback(
+            "thermal_bridge_mqtt_topics", "Topics subscribed on the shared MQTT pool", metrics::MetricType::GAUGE,
+            [this] { return static_cast<double>(subscription_manager_->get_topic_count()); }));
+        metrics_callbacks_.add(registry.add_callback(
+            "thermal_bridge_mqtt_subscribers", "Connection subscriptions on the shared MQTT pool",
+            metrics::MetricType::GAUGE,
+            [this] { return static_cast<double>(subscription_manager_->get_subscriber_count()); }));
+    }
+    
+    if (thermal_tracker_) {
+        metrics_callbacks_.add(registry.add_callback(
+            "thermal_bridge_active_sensors", "Sensors reporting within the offline timeout",
+            metrics::MetricType::GAUGE,
+            [this] { return static_cast<double>(thermal_tracker_->get_totals().active_sensors); }));
+    }
+    
+    // Touch the hot-path instruments so they are exported before first use
+    bridge_metrics();
+}
+
+void MqttWebSocketBridge::worker_thread_loop(int tsi) {
+    THERMAL_LOG_INFO << "🔄 Service thread " << tsi << " started (ID: " << std::this_thread::get_id() << ")";
     
     while (running_.load()) {
         if (lws_context_) {
-            // Service libwebsockets with longer timeout for stability
-            int n = lws_service(lws_context_, 1000); // 1 second timeout
+            int n = lws_service_tsi(lws_context_, 1000, tsi); // 1 second timeout
             if (n < 0) {
-                std::cerr << "⚠️  lws_service returned error: " << n << std::endl;
+                THERMAL_LOG_ERROR << "⚠️  lws_service_tsi(" << tsi << ") returned error: " << n;
                 break;
             }
         } else {
@@ -543,16 +1241,28 @@ void MqttWebSocketBridge::worker_thread_loop() {
         }
     }
     
-    std::cout << "🏁 Main worker thread finished (ID: " << std::this_thread::get_id() << ")" << std::endl;
+    THERMAL_LOG_INFO << "🏁 Service thread " << tsi << " finished (ID: " << std::this_thread::get_id() << ")";
+}
+
+MqttWebSocketBridge::ConnectionShard& MqttWebSocketBridge::shard_for(struct lws* wsi) {
+    // libwebsockets pins each wsi to one service thread for its lifetime
+    size_t tsi = static_cast<size_t>(std::max(0, lws_get_tsi(wsi)));
+    return *connection_shards_[tsi % connection_shards_.size()];
 }
 
 void MqttWebSocketBridge::cleanup_connections() {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    connections_.clear();
+    for (auto& shard : connection_shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->connections.clear();
+    }
     connection_count_ = 0;
 }
 
 void MqttWebSocketBridge::cleanup_resources() {
+    // Must go before mosquitto_lib_cleanup() in the destructor
+    ingest_client_.reset();
+    subscription_manager_.reset();
+    
     if (lws_context_) {
         lws_context_destroy(lws_context_);
         lws_context_ = nullptr;
@@ -562,75 +1272,128 @@ void MqttWebSocketBridge::cleanup_resources() {
         SSL_CTX_free(ssl_ctx_);
         ssl_ctx_ = nullptr;
     }
-    
-    if (epoll_fd_ != -1) {
-        close(epoll_fd_);
-        epoll_fd_ = -1;
-    }
-    
-    if (events_) {
-        delete[] events_;
-        events_ = nullptr;
-    }
 }
 
-void MqttWebSocketBridge::handle_new_connection(struct lws* wsi, const std::string& topic) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    
-    auto connection = std::make_unique<WebSocketConnection>(wsi, topic);
-    if (connection->initialize(config_)) {
-        connections_[wsi] = std::move(connection);
+void MqttWebSocketBridge::handle_new_connection(struct lws* wsi, const std::string& topic,
+                                                const std::vector<std::string>& extra_filters) {
+    ConnectionShard& shard = shard_for(wsi);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    
+    auto connection = std::make_shared<WebSocketConnection>(wsi, topic, lws_context_);
+    if (connection->initialize(config_, subscription_manager_.get(), &shard.pending_writes)) {
+        for (const auto& filter : extra_filters) {
+            if (!connection->subscribe(filter)) {
+                THERMAL_LOG_WARN << "⚠️  Ignoring URL subscription: " << filter;
+            }
+        }
+        shard.connections[wsi] = std::move(connection);
         connection_count_++;
-        std::cout << "✅ New connection initialized for topic: " << topic << " (Total: " << connection_count_ << ")" << std::endl;
+        
+        // Frames queued while subscribing may have been taken off the
+        // pending list before the wsi was in the map
+        lws_callback_on_writable(wsi);
+        THERMAL_LOG_INFO << "✅ New connection initialized for topic: " << topic 
+                         << (extra_filters.empty() ? "" : " (+" + std::to_string(extra_filters.size()) + " filters)")
+                         << " (Total: " << connection_count_ << ")";
     } else {
-        std::cout << "❌ Failed to initialize connection for topic: " << topic << std::endl;
+        THERMAL_LOG_ERROR << "❌ Failed to initialize connection for topic: " << topic;
     }
 }
 
 void MqttWebSocketBridge::handle_connection_close(struct lws* wsi) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
+    ConnectionShard& shard = shard_for(wsi);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     
-    std::cout << "🔍 DEBUG: handle_connection_close called for wsi=" << wsi << std::endl;
-    std::cout.flush();
+    THERMAL_LOG_DEBUG << "🔍 handle_connection_close called for wsi=" << wsi;
     
-    auto it = connections_.find(wsi);
-    if (it != connections_.end()) {
+    auto it = shard.connections.find(wsi);
+    if (it != shard.connections.end()) {
         std::string topic = it->second->get_topic();
-        std::cout << "🔍 DEBUG: Found connection in map for topic: " << topic << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 Found connection in map for topic: " << topic;
         
-        std::cout << "🗑️  Removing connection for topic: " << topic << std::endl;
-        std::cout.flush(); // Ensure first message is shown
+        THERMAL_LOG_INFO << "🗑️  Removing connection for topic: " << topic;
         
-        std::cout << "🔍 DEBUG: About to erase connection from map" << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 About to erase connection from map";
         
-        connections_.erase(it);
+        // A fan-out in flight may still hold a reference; deactivate now
+        it->second->cleanup();
+        
+        SendQueueStats stats = it->second->get_send_stats();
+        closed_dropped_frames_ += stats.dropped_frames;
+        closed_coalesced_frames_ += stats.coalesced_frames;
+        closed_overflow_disconnects_ += stats.overflow_disconnects;
+        
+        shard.connections.erase(it);
         connection_count_--;
         
-        std::cout << "🔍 DEBUG: Connection erased, new count: " << connection_count_ << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 Connection erased, new count: " << connection_count_;
         
-        std::cout << "✅ Connection removed (Total: " << connection_count_ << ")" << std::endl;
-        std::cout.flush(); // Ensure second message is shown
+        THERMAL_LOG_INFO << "✅ Connection removed (Total: " << connection_count_ << ")";
         
-        std::cout << "🔍 DEBUG: handle_connection_close completed successfully" << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_DEBUG << "🔍 handle_connection_close completed successfully";
     } else {
-        std::cout << "⚠️  Attempted to remove unknown connection (wsi=" << wsi << ")" << std::endl;
-        std::cout.flush();
+        THERMAL_LOG_WARN << "⚠️  Attempted to remove unknown connection (wsi=" << wsi << ")";
     }
 }
 
 void MqttWebSocketBridge::process_websocket_message(struct lws* wsi, const uint8_t* data, size_t len) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
+    ConnectionShard& shard = shard_for(wsi);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     
-    auto it = connections_.find(wsi);
-    if (it != connections_.end()) {
+    auto it = shard.connections.find(wsi);
+    if (it != shard.connections.end()) {
         it->second->handle_websocket_message(data, len);
     }
 }
 
+SendQueueStats MqttWebSocketBridge::get_send_queue_stats() {
+    SendQueueStats total;
+    total.dropped_frames = closed_dropped_frames_.load();
+    total.coalesced_frames = closed_coalesced_frames_.load();
+    total.overflow_disconnects = closed_overflow_disconnects_.load();
+    
+    for (auto& shard : connection_shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& connection_pair : shard->connections) {
+            SendQueueStats stats = connection_pair.second->get_send_stats();
+            total.queued_frames += stats.queued_frames;
+            total.queued_bytes += stats.queued_bytes;
+            total.dropped_frames += stats.dropped_frames;
+            total.coalesced_frames += stats.coalesced_frames;
+            total.overflow_disconnects += stats.overflow_disconnects;
+        }
+    }
+    return total;
+}
+
+void MqttWebSocketBridge::request_pending_writes(struct lws* wsi) {
+    // Runs on the service thread that owns this shard; only connections
+    // that queued a first frame since the previous wake-up are visited
+    ConnectionShard& shard = shard_for(wsi);
+    shard.pending_writes.take(shard.writes_to_request);
+    if (shard.writes_to_request.empty()) return;
+    
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (struct lws* pending : shard.writes_to_request) {
+        // Skip connections closed since they queued: their wsi is gone.
+        // A new connection reusing the address just gets a spare callback
+        if (shard.connections.count(pending) > 0) {
+            lws_callback_on_writable(pending);
+        }
+    }
+}
+
+int MqttWebSocketBridge::write_pending_frame(struct lws* wsi) {
+    ConnectionShard& shard = shard_for(wsi);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    
+    auto it = shard.connections.find(wsi);
+    if (it == shard.connections.end()) {
+        return 0;
+    }
+    return it->second->write_pending_frame();
+}
+
 // Static callback for libwebsockets
 int MqttWebSocketBridge::websocket_callback(struct lws* wsi, enum lws_callback_reasons reason,
                                            void* user, void* in, size_t len) {
@@ -641,38 +1404,53 @@ int MqttWebSocketBridge::websocket_callback(struct lws* wsi, enum lws_callback_r
     switch (reason) {
         case LWS_CALLBACK_FILTER_NETWORK_CONNECTION: {
             // Allow all connections for now
-            std::cout << "🌐 Network connection filter" << std::endl;
+            THERMAL_LOG_DEBUG << "🌐 Network connection filter";
             return 0;
         }
         
         case LWS_CALLBACK_FILTER_HTTP_CONNECTION: {
             // Allow HTTP connections for WebSocket upgrade
-            std::cout << "🔗 HTTP connection filter" << std::endl;
+            THERMAL_LOG_DEBUG << "🔗 HTTP connection filter";
             return 0;
         }
         
         case LWS_CALLBACK_ESTABLISHED: {
             // New WebSocket connection
-            std::cout << "📱 New WebSocket connection established" << std::endl;
+            THERMAL_LOG_INFO << "📱 New WebSocket connection established";
             
-            // Extract topic from URL path (simplified)
-            std::string topic = "test/topic"; // In real implementation, parse from URL
-            bridge->handle_new_connection(wsi, topic);
+            // ws://host:port/<topic>?subscribe=<filter>&subscribe=<filter>, URL-encoded
+            char uri[1024];
+            int uri_len = lws_hdr_copy(wsi, uri, sizeof(uri), WSI_TOKEN_GET_URI);
+            std::string topic = uri_len > 0 ? bridge->extract_topic_from_url(std::string(uri, uri_len)) : "";
+            bridge->handle_new_connection(wsi, topic, bridge->extract_filters_from_args(wsi));
             break;
         }
         
         case LWS_CALLBACK_RECEIVE: {
             // Message received from WebSocket client
-            std::cout << "📨 Message received (" << len << " bytes)" << std::endl;
+            THERMAL_LOG_DEBUG << "📨 Message received (" << len << " bytes)";
             if (in && len > 0) {
                 bridge->process_websocket_message(wsi, static_cast<const uint8_t*>(in), len);
             }
             break;
         }
         
+        case LWS_CALLBACK_SERVER_WRITEABLE: {
+            // Drain one queued frame; a failed write closes the connection
+            return bridge->write_pending_frame(wsi);
+        }
+        
+        case LWS_CALLBACK_EVENT_WAIT_CANCELLED: {
+            // Woken by lws_cancel_service(): frames were queued from another thread
+            if (wsi) {
+                bridge->request_pending_writes(wsi);
+            }
+            break;
+        }
+        
         case LWS_CALLBACK_CLOSED: {
             // Connection closed
-            std::cout << "🔌 WebSocket connection closed" << std::endl;
+            THERMAL_LOG_INFO << "🔌 WebSocket connection closed";
             bridge->handle_connection_close(wsi);
             break;
         }
@@ -681,29 +1459,115 @@ int MqttWebSocketBridge::websocket_callback(struct lws* wsi, enum lws_callback_r
             // HTTP request - check if it's a WebSocket upgrade request
             const char *requested_uri = (char *)in;
             
-            std::cout << "📡 HTTP request for: " << (requested_uri ? requested_uri : "null") << std::endl;
+            THERMAL_LOG_DEBUG << "📡 HTTP request for: " << (requested_uri ? requested_uri : "null");
             
             // For WebSocket upgrade requests, allow the upgrade
             if (lws_hdr_total_length(wsi, WSI_TOKEN_UPGRADE) > 0) {
-                std::cout << "🔄 WebSocket upgrade request detected" << std::endl;
+                THERMAL_LOG_DEBUG << "🔄 WebSocket upgrade request detected";
                 return 0; // Allow upgrade
             }
             
-            // For regular HTTP requests, return simple 404
+            if (bridge->config_.metrics_enabled && requested_uri && user &&
+                bridge->config_.metrics_path == requested_uri) {
+                return bridge->begin_metrics_response(wsi, static_cast<HttpSession*>(user));
+            }
+            
+            // For other HTTP requests, return simple 404
             lws_return_http_status(wsi, HTTP_STATUS_NOT_FOUND, "WebSocket endpoint only");
             return -1;
         }
         
+        case LWS_CALLBACK_HTTP_WRITEABLE: {
+            if (!user) return -1;
+            return bridge->write_metrics_body(wsi, static_cast<HttpSession*>(user));
+        }
+        
+        case LWS_CALLBACK_CLOSED_HTTP: {
+            // Scrape client went away mid-response
+            if (user) {
+                HttpSession* session = static_cast<HttpSession*>(user);
+                delete session->body;
+                session->body = nullptr;
+            }
+            break;
+        }
+        
         default:
             break;
     }
     
-    // Suppress unused parameter warnings
-    (void)user;
+    return 0;
+}
+
+int MqttWebSocketBridge::begin_metrics_response(struct lws* wsi, HttpSession* session) {
+    // Copied from the latest snapshot; the body is streamed from writable callbacks
+    std::shared_ptr<const std::string> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        snapshot = metrics_snapshot_;
+    }
+    delete session->body;
+    session->body = new std::string(snapshot ? *snapshot : std::string());
+    session->offset = 0;
+    
+    unsigned char headers[LWS_PRE + 512];
+    unsigned char* start = headers + LWS_PRE;
+    unsigned char* p = start;
+    unsigned char* end = headers + sizeof(headers) - 1;
+    if (lws_add_http_common_headers(wsi, HTTP_STATUS_OK, "text/plain; version=0.0.4; charset=utf-8",
+                                    static_cast<long long>(session->body->size()), &p, end) ||
+        lws_finalize_write_http_header(wsi, start, &p, end)) {
+        delete session->body;
+        session->body = nullptr;
+        return 1;
+    }
     
+    lws_callback_on_writable(wsi);
     return 0;
 }
 
+void MqttWebSocketBridge::metrics_render_loop() {
+    const auto refresh = std::chrono::milliseconds(std::max(1, config_.metrics_refresh_ms));
+    std::unique_lock<std::mutex> lock(metrics_mutex_);
+    while (running_.load()) {
+        if (metrics_cv_.wait_for(lock, refresh, [this] { return !running_.load(); })) {
+            break;
+        }
+        
+        // Rendered unlocked: scrapes keep getting the previous snapshot meanwhile
+        lock.unlock();
+        auto body = std::make_shared<const std::string>(metrics::Registry::global().render_prometheus());
+        lock.lock();
+        metrics_snapshot_ = std::move(body);
+    }
+}
+
+int MqttWebSocketBridge::write_metrics_body(struct lws* wsi, HttpSession* session) {
+    if (!session->body) return 0;
+    
+    constexpr size_t CHUNK = 4096;
+    unsigned char buffer[LWS_PRE + CHUNK];
+    size_t remaining = session->body->size() - session->offset;
+    size_t chunk = std::min(remaining, CHUNK);
+    bool last = chunk == remaining;
+    
+    std::memcpy(buffer + LWS_PRE, session->body->data() + session->offset, chunk);
+    if (lws_write(wsi, buffer + LWS_PRE, chunk, last ? LWS_WRITE_HTTP_FINAL : LWS_WRITE_HTTP) <
+        static_cast<int>(chunk)) {
+        return -1;
+    }
+    session->offset += chunk;
+    
+    if (!last) {
+        lws_callback_on_writable(wsi);
+        return 0;
+    }
+    
+    delete session->body;
+    session->body = nullptr;
+    return lws_http_transaction_completed(wsi) ? -1 : 0;
+}
+
 //=============================================================================
 // Thermal Monitoring Integration
 //=============================================================================
@@ -713,24 +1577,112 @@ bool MqttWebSocketBridge::setup_thermal_monitoring() {
         return false;
     }
     
-    // Set up alert callback to handle thermal alerts
-    thermal_tracker_->set_alert_callback(
-        [this](const thermal_monitoring::Alert& alert) {
-            this->handle_thermal_alert(alert);
+    // Set up alert callback to handle thermal alerts; records arrive
+    // unrendered and are only turned into frames for connected viewers
+    thermal_tracker_->set_alert_record_callback(
+        [this](const thermal_monitoring::AlertRecord& record) {
+            this->handle_thermal_alert(record);
         }
     );
     
-    std::cout << "✅ Thermal monitoring setup complete" << std::endl;
+    THERMAL_LOG_INFO << "✅ Thermal monitoring setup complete";
     return true;
 }
 
+bool MqttWebSocketBridge::setup_sensor_ingestion() {
+    const std::string& filter = config_.sensor_topic_filter;
+    std::string client_id = "ws_bridge_ingest_" + std::to_string(getpid());
+    ingest_client_ = std::make_unique<MqttClient>(client_id, config_.mqtt_host, config_.mqtt_port);
+    
+    ingest_client_->set_message_callback([this](const std::string& topic, const std::vector<uint8_t>& payload) {
+        this->handle_ingested_message(topic, payload);
+    });
+    ingest_client_->set_connect_callback([this, filter]() {
+        ingest_client_->subscribe(filter);
+    });
+    
+    // The connect callback performs the initial subscription as well
+    if (!ingest_client_->connect()) {
+        ingest_client_.reset();
+        return false;
+    }
+    
+    // The shared pool no longer needs broker subscriptions for sensor topics
+    std::string prefix = ingested_prefix(config_);
+    if (subscription_manager_ && !prefix.empty()) {
+        subscription_manager_->set_ingested_prefix(prefix);
+    }
+    
+    THERMAL_LOG_INFO << "✅ Sensor ingestion subscribed to " << filter;
+    return true;
+}
+
+void MqttWebSocketBridge::handle_ingested_message(const std::string& topic, const std::vector<uint8_t>& payload) {
+    bridge_metrics().ingested_messages.inc();
+    
+    // Each sensor reading is parsed and tracked exactly once, however many
+    // WebSocket viewers are subscribed to it
+    process_sensor_message(topic, payload.data(), payload.size());
+    
+    if (subscription_manager_) {
+        subscription_manager_->deliver(topic, payload);
+    } else {
+        deliver_ingested(topic, payload);
+    }
+}
+
+void MqttWebSocketBridge::deliver_ingested(const std::string& topic, const std::vector<uint8_t>& payload) {
+    // Without the shared multiplexer there is no filter index: resolve the
+    // matching connections first, then serialise once and queue the same
+    // frame on each of them
+    std::vector<std::shared_ptr<WebSocketConnection>> targets;
+    for (auto& shard : connection_shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& connection_pair : shard->connections) {
+            if (connection_pair.second->matches(topic)) {
+                targets.push_back(connection_pair.second);
+            }
+        }
+    }
+    if (targets.empty()) return;
+    
+    FramePtr frame = OutboundFrame::create(topic, payload.data(), payload.size());
+    size_t sent = 0;
+    for (const auto& connection : targets) {
+        if (connection->send_frame(frame)) {
+            sent++;
+        }
+    }
+    
+    // A single wake-up reaches every service thread
+    if (sent > 0 && lws_context_) {
+        lws_cancel_service(lws_context_);
+    }
+}
+
 void MqttWebSocketBridge::process_sensor_message(const std::string& topic, const std::string& payload) {
+    process_sensor_message(topic, reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+}
+
+void MqttWebSocketBridge::process_sensor_message(const std::string& topic, const uint8_t* payload, size_t len) {
     if (!thermal_tracker_) return;
     
-    // Parse sensor message using the thermal monitoring utilities
-    auto sensor_reading = thermal_monitoring::parse_sensor_message(topic, payload);
-    if (sensor_reading) {
+    BridgeMetrics& m = bridge_metrics();
+    
+    // Parse straight from the MQTT payload bytes
+    std::optional<thermal_monitoring::SensorReading> sensor_reading;
+    {
+        metrics::ScopedTimer timer(m.parse_seconds);
+        sensor_reading = thermal_monitoring::parse_sensor_message(topic, payload, len);
+    }
+    if (!sensor_reading) {
+        m.parse_errors.inc();
+        return;
+    }
+    
+    {
         // Process the sensor data through the thermal tracker
+        metrics::ScopedTimer timer(m.tracker_update_seconds);
         thermal_tracker_->process_sensor_data(
             sensor_reading->sensor_id,
             sensor_reading->temperature,
@@ -740,38 +1692,117 @@ void MqttWebSocketBridge::process_sensor_message(const std::string& topic, const
     }
 }
 
-void MqttWebSocketBridge::handle_thermal_alert(const thermal_monitoring::Alert& alert) {
+void MqttWebSocketBridge::handle_thermal_alert(const thermal_monitoring::AlertRecord& record) {
+    size_t type_index = static_cast<size_t>(record.alert_type);
+    if (type_index < bridge_metrics().alerts.size()) {
+        bridge_metrics().alerts[type_index]->inc();
+    }
+    
     // Create MQTT topic for alerts
-    std::string alert_topic = "alerts/" + alert.sensor_id;
+    std::string alert_topic = "alerts/" + std::string(thermal_tracker_->name_of(record.sensor));
+    
+    // Alerts go to connections with a filter matching alerts/{id} ("alerts/#");
+    // without the shared multiplexer there is no index, so each connection's
+    // filters are checked as in deliver_ingested()
+    std::vector<std::shared_ptr<WebSocketConnection>> targets;
+    if (subscription_manager_) {
+        targets = subscription_manager_->route(alert_topic);
+    } else {
+        for (auto& shard : connection_shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            for (const auto& connection_pair : shard->connections) {
+                if (connection_pair.second && connection_pair.second->matches(alert_topic)) {
+                    targets.push_back(connection_pair.second);
+                }
+            }
+        }
+    }
     
-    // Create alert message
-    std::stringstream alert_msg;
-    alert_msg << "{"
-              << "\"sensor_id\":\"" << alert.sensor_id << "\","
-              << "\"alert_type\":" << static_cast<int>(alert.alert_type) << ","
-              << "\"message\":\"" << alert.message << "\","
-              << "\"location\":\"" << alert.location << "\","
-              << "\"temperature\":" << alert.temperature << ","
-              << "\"humidity\":" << alert.humidity << ","
-              << "\"temp_rate\":" << alert.temp_rate << ","
-              << "\"timestamp\":" << std::chrono::duration_cast<std::chrono::seconds>(
-                     alert.timestamp.time_since_epoch()).count()
-              << "}";
+    // Rendered on first use: with no viewers an alert costs only the counter.
+    // Serialised once per encoding; every connection queues the same frame
+    std::optional<thermal_monitoring::Alert> alert;
+    FramePtr frame;
+    FramePtr binary_frame;
+    size_t sent = 0;
+    for (const auto& connection : targets) {
+        bool binary = connection->wants_binary();
+        if (!alert) {
+            alert = thermal_tracker_->materialize(record);
+        }
+        if (binary && !binary_frame) {
+            // Binary viewers get "alerts/{id}/bin|<packed alert>"
+            std::vector<uint8_t> packed;
+            thermal_monitoring::wire::encode_alert(*alert, packed);
+            binary_frame = OutboundFrame::create(alert_topic + std::string(thermal_monitoring::wire::BINARY_TOPIC_SUFFIX),
+                                                 packed.data(), packed.size());
+        } else if (!binary && !frame) {
+            frame = OutboundFrame::create(alert_topic, format_alert_json(*alert));
+        }
+        if (connection->send_frame(binary ? binary_frame : frame)) {
+            sent++;
+        }
+    }
     
-    std::string alert_json = alert_msg.str();
+    if (sent > 0 && lws_context_) {
+        lws_cancel_service(lws_context_);
+    }
     
-    // Send alert to all connected WebSocket clients
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    for (const auto& connection_pair : connections_) {
-        if (connection_pair.second && connection_pair.second->is_active()) {
-            // Format alert for WebSocket transmission
-            std::string ws_message = alert_topic + "|" + alert_json;
-            std::vector<uint8_t> ws_data(ws_message.begin(), ws_message.end());
-            connection_pair.second->send_to_websocket(ws_data);
+    THERMAL_LOG_DEBUG << "🚨 Alert sent to " << sent << " WebSocket clients";
+}
+
+//=============================================================================
+// Utility Functions
+//=============================================================================
+
+std::string MqttWebSocketBridge::extract_topic_from_url(const std::string& url) {
+    // "/sensors/%2B/temperature?..." -> "sensors/+/temperature"
+    std::string path = url.substr(0, url.find('?'));
+    size_t start = path.find_first_not_of('/');
+    return start == std::string::npos ? "" : utils::url_decode(path.substr(start));
+}
+
+std::vector<std::string> MqttWebSocketBridge::extract_filters_from_args(struct lws* wsi) {
+    constexpr std::string_view key = "subscribe=";
+    std::vector<std::string> filters;
+    char arg[512];
+    
+    // One fragment per '&'-separated query argument
+    for (int index = 0; index < config_.max_subscriptions_per_connection; ++index) {
+        int len = lws_hdr_copy_fragment(wsi, arg, sizeof(arg), WSI_TOKEN_HTTP_URI_ARGS, index);
+        if (len < 0) {
+            break;
+        }
+        std::string_view text(arg, static_cast<size_t>(len));
+        if (text.substr(0, key.size()) == key && text.size() > key.size()) {
+            filters.push_back(utils::url_decode(std::string(text.substr(key.size()))));
         }
     }
-    
-    std::cout << "🚨 Alert sent to " << connections_.size() << " WebSocket clients" << std::endl;
+    return filters;
+}
+
+namespace utils {
+
+std::string url_decode(const std::string& encoded) {
+    // Percent-escapes only: '+' is the MQTT single-level wildcard, not a space
+    std::string decoded;
+    decoded.reserve(encoded.size());
+    auto hex = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        if (encoded[i] == '%' && i + 2 < encoded.size() && hex(encoded[i + 1]) >= 0 && hex(encoded[i + 2]) >= 0) {
+            decoded.push_back(static_cast<char>(hex(encoded[i + 1]) * 16 + hex(encoded[i + 2])));
+            i += 2;
+        } else {
+            decoded.push_back(encoded[i]);
+        }
+    }
+    return decoded;
 }
 
+} // namespace utils
+
 } // namespace mqtt_ws
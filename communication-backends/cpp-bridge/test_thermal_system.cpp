@@ -1,12 +1,23 @@
 #include "../../thermal-monitoring/ThermalIsolationTracker.h"
+#include "../../thermal-monitoring/SensorWireFormat.h"
+#include "../../thermal-monitoring/Log.h"
+#include "../../thermal-monitoring/Metrics.h"
+#include "../../thermal-monitoring/TopicTrie.h"
 #include <iostream>
+#include <iomanip>
 #include <chrono>
 #include <thread>
 #include <random>
+#include <numeric>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
 
 using namespace thermal_monitoring;
 
 void print_separator(const std::string& title) {
+    // Keep asynchronous tracker output inside the section that produced it
+    Log::flush();
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "  " << title << std::endl;
     std::cout << std::string(60, '=') << std::endl;
@@ -72,6 +83,15 @@ void simulate_sensor_data(ThermalIsolationTracker& tracker) {
 void test_message_parsing() {
     print_separator("Testing Message Parsing");
     
+    // Packed binary reading as published on sensors/{id}/bin
+    wire::SensorRecord record;
+    record.sensor_id = "sensor_006";
+    record.location = "room2";
+    record.temperature = 21.25f;
+    record.humidity = 48.5f;
+    std::vector<uint8_t> packed;
+    wire::encode_sensor_record(record, packed);
+    
     // Test different message formats
     std::vector<std::pair<std::string, std::string>> test_messages = {
         {"sensors/sensor_001/data", "{\"temperature\": 25.5, \"humidity\": 60.2, \"location\": \"room1\"}"},
@@ -79,11 +99,15 @@ void test_message_parsing() {
         {"sensors/sensor_003/humidity", "58.5"},
         {"sensors/sensor_004/data", "{\"temperature\": 19.2, \"humidity\": 45.8}"},
         {"invalid/topic", "should not parse"},
-        {"sensors/sensor_005/data", "invalid json format"}
+        {"sensors/sensor_005/data", "invalid json format"},
+        {"sensors/sensor_006/bin", std::string(packed.begin(), packed.end())},
+        {"sensors/sensor_007/bin", std::string(packed.begin(), packed.begin() + 10)}
     };
     
     for (const auto& test : test_messages) {
-        std::cout << "\nTesting: " << test.first << " -> " << test.second << std::endl;
+        std::string shown = wire::is_binary_topic(test.first)
+            ? "<" + std::to_string(test.second.size()) + " bytes packed>" : test.second;
+        std::cout << "\nTesting: " << test.first << " -> " << shown << std::endl;
         
         auto result = parse_sensor_message(test.first, test.second);
         if (result) {
@@ -146,9 +170,447 @@ void test_threshold_alerts() {
     
     std::cout << "Total alerts generated: " << alert_count << std::endl;
     
+    // A reading's own location wins; one without falls back to the configured room
+    tracker.process_sensor_data("test_sensor_1", 22.0f, 45.0f, "Hallway");
+    std::string reported = tracker.get_sensor_stats("test_sensor_1").location;
+    tracker.process_sensor_data("test_sensor_1", 22.0f, 45.0f);
+    std::string configured = tracker.get_sensor_stats("test_sensor_1").location;
+    if (reported != "Hallway" || configured != "Test Room 1") {
+        std::cerr << "❌ Sensor location: reported '" << reported << "', then '" << configured << "'" << std::endl;
+    } else {
+        std::cout << "✅ Readings without a location fell back to the configured room" << std::endl;
+    }
+    
     tracker.stop();
 }
 
+void test_minimal_history() {
+    print_separator("Testing Minimal History");
+    
+    // history_size = 0 still keeps the latest sample, like the snapshot path
+    ThermalConfig config;
+    config.history_size = 0;
+    ThermalIsolationTracker tracker(config);
+    tracker.start();
+    for (int i = 0; i < 5; ++i) {
+        tracker.process_sensor_data("tiny_history", 20.0f + i, 50.0f);
+    }
+    SensorStats stats = tracker.get_sensor_stats("tiny_history");
+    tracker.stop();
+    
+    if (stats.current_temp != 24.0f || stats.avg_temp != 24.0f || stats.min_temp != 24.0f ||
+        stats.max_temp != 24.0f) {
+        std::cerr << "❌ history_size = 0: avg " << stats.avg_temp << ", min " << stats.min_temp
+                  << ", max " << stats.max_temp << std::endl;
+    } else {
+        std::cout << "✅ history_size = 0 kept only the latest reading" << std::endl;
+    }
+}
+
+void test_virtual_clock() {
+    print_separator("Testing Virtual Clock");
+    
+    ThermalConfig config;
+    config.temp_rate_limit = 2.0f;
+    config.sensor_timeout_minutes = 10;
+    
+    // No monitoring thread: time only moves when the test advances it
+    auto clock = std::make_shared<VirtualClock>();
+    ThermalIsolationTracker tracker(config, clock);
+    
+    int rising_alerts = 0;
+    int offline_alerts = 0;
+    tracker.set_alert_callback([&](const Alert& alert) {
+        rising_alerts += alert.alert_type == AlertType::TEMP_RISING_FAST;
+        offline_alerts += alert.alert_type == AlertType::SENSOR_OFFLINE;
+    });
+    
+    // Three minutes of a 3°C/min rise, then silence past the offline timeout
+    for (int minute = 0; minute < 3; ++minute) {
+        tracker.process_sensor_data("virtual_sensor", 20.0f + 3.0f * minute, 45.0f, "Replay Room");
+        clock->advance(std::chrono::minutes(1));
+    }
+    clock->advance(std::chrono::minutes(config.sensor_timeout_minutes + 1));
+    tracker.run_maintenance();
+    
+    std::cout << "Rising-fast alerts: " << rising_alerts << ", offline alerts: " << offline_alerts << std::endl;
+    if (rising_alerts != 1 || offline_alerts != 1) {
+        std::cerr << "❌ Virtual clock did not drive rate and timeout checks" << std::endl;
+    } else {
+        std::cout << "✅ 14 virtual minutes checked without waiting" << std::endl;
+    }
+}
+
+void test_offline_deadlines() {
+    print_separator("Testing Offline Deadlines");
+    
+    ThermalConfig config;
+    config.sensor_timeout_minutes = 10;
+    config.sensor_shards = 4;
+    
+    auto clock = std::make_shared<VirtualClock>();
+    ThermalIsolationTracker tracker(config, clock);
+    
+    int offline_alerts = 0;
+    tracker.set_alert_callback([&](const Alert& alert) {
+        offline_alerts += alert.alert_type == AlertType::SENSOR_OFFLINE;
+    });
+    
+    // 1000 sensors report once; the even ones keep reporting every minute
+    const int sensors = 1000;
+    for (int i = 0; i < sensors; ++i) {
+        tracker.process_sensor_data("deadline_" + std::to_string(i), 20.0f + i % 2, 45.0f, "Deadline Room");
+    }
+    for (int minute = 0; minute < 15; ++minute) {
+        clock->advance(std::chrono::minutes(1));
+        for (int i = 0; i < sensors; i += 2) {
+            tracker.process_sensor_data("deadline_" + std::to_string(i), 20.0f, 45.0f, "Deadline Room");
+        }
+        tracker.run_maintenance();
+    }
+    
+    TrackerTotals totals = tracker.get_totals();
+    auto snapshot = tracker.get_snapshot();
+    std::cout << "Offline alerts: " << offline_alerts << ", active: " << totals.active_sensors
+              << "/" << totals.sensors << ", avg temp: " << totals.avg_temperature << "°C" << std::endl;
+    
+    // A silent sensor comes back
+    tracker.process_sensor_data("deadline_1", 21.0f, 45.0f, "Deadline Room");
+    TrackerTotals revived = tracker.get_totals();
+    
+    if (offline_alerts != sensors / 2 || totals.active_sensors != static_cast<size_t>(sensors / 2) ||
+        totals.active_sensors != snapshot->active_sensors || totals.avg_temperature != 20.0f ||
+        revived.active_sensors != totals.active_sensors + 1) {
+        std::cerr << "❌ Deadline tracking disagrees with a full scan" << std::endl;
+    } else {
+        std::cout << "✅ Only the " << sensors / 2 << " silent sensors timed out; totals kept incrementally" << std::endl;
+    }
+}
+
+void test_batch_ingestion() {
+    print_separator("Testing Batch Ingestion");
+    
+    ThermalConfig config;
+    config.sensor_shards = 4;
+    config.alert_throttle_minutes = 2;
+    
+    // Same readings, batched and one at a time, on identical virtual clocks
+    auto batch_clock = std::make_shared<VirtualClock>();
+    auto single_clock = std::make_shared<VirtualClock>();
+    ThermalIsolationTracker batched(config, batch_clock);
+    ThermalIsolationTracker single(config, single_clock);
+    
+    std::vector<int> batch_alerts(ALERT_TYPE_COUNT), single_alerts(ALERT_TYPE_COUNT);
+    batched.set_alert_callback([&](const Alert& alert) { batch_alerts[static_cast<size_t>(alert.alert_type)]++; });
+    single.set_alert_callback([&](const Alert& alert) { single_alerts[static_cast<size_t>(alert.alert_type)]++; });
+    
+    // 200 sensors; a few run hot, cold, humid or swing fast, and the last
+    // reading of each minute repeats sensor 0 within the same batch
+    const int sensors = 200;
+    std::vector<SensorReading> readings;
+    size_t first_batch_alerts = 0;
+    for (int minute = 0; minute < 6; ++minute) {
+        readings.clear();
+        for (int i = 0; i < sensors; ++i) {
+            float temperature = 22.0f;
+            float humidity = 45.0f;
+            if (i % 50 == 1) temperature = 30.0f;
+            if (i % 50 == 2) temperature = 15.0f;
+            if (i % 50 == 3) humidity = 75.0f;
+            if (i % 50 == 4) temperature = minute % 2 ? 26.0f : 20.0f;
+            readings.push_back({"batch_" + std::to_string(i), temperature, humidity, "Batch Room"});
+        }
+        readings.push_back({"batch_0", 16.0f, 45.0f, "Batch Room"});
+        
+        size_t before = std::accumulate(batch_alerts.begin(), batch_alerts.end(), size_t(0));
+        batched.process_sensor_batch(readings);
+        for (const SensorReading& reading : readings) {
+            single.process_sensor_data(reading.sensor_id, reading.temperature, reading.humidity, reading.location);
+        }
+        if (minute == 0) {
+            first_batch_alerts = std::accumulate(batch_alerts.begin(), batch_alerts.end(), size_t(0)) - before;
+        }
+        batch_clock->advance(std::chrono::minutes(1));
+        single_clock->advance(std::chrono::minutes(1));
+    }
+    
+    // A batch in which nothing trips raises nothing
+    readings.assign(1, {"batch_quiet", 22.0f, 45.0f, ""});
+    size_t before_quiet = std::accumulate(batch_alerts.begin(), batch_alerts.end(), size_t(0));
+    batched.process_sensor_batch(readings);
+    size_t after_quiet = std::accumulate(batch_alerts.begin(), batch_alerts.end(), size_t(0));
+    single.process_sensor_data("batch_quiet", 22.0f, 45.0f);
+    
+    TrackerTotals batch_totals = batched.get_totals();
+    TrackerTotals single_totals = single.get_totals();
+    std::cout << "Alerts per type (batch/single):";
+    for (size_t type = 0; type < ALERT_TYPE_COUNT; ++type) {
+        std::cout << " " << batch_alerts[type] << "/" << single_alerts[type];
+    }
+    std::cout << ", first minute: " << first_batch_alerts << ", sensors: " << batch_totals.sensors << std::endl;
+    
+    SensorStats batch_stats = batched.get_sensor_stats("batch_0");
+    SensorStats single_stats = single.get_sensor_stats("batch_0");
+    if (batch_alerts != single_alerts || batch_totals.sensors != single_totals.sensors ||
+        batch_totals.active_sensors != single_totals.active_sensors ||
+        batch_totals.avg_temperature != single_totals.avg_temperature ||
+        batch_stats.current_temp != single_stats.current_temp || batch_stats.avg_temp != single_stats.avg_temp ||
+        after_quiet != before_quiet) {
+        std::cerr << "❌ Batched ingestion disagrees with per-reading ingestion" << std::endl;
+    } else {
+        std::cout << "✅ Batches match per-reading ingestion alert for alert" << std::endl;
+    }
+}
+
+void test_alert_journal() {
+    print_separator("Testing Alert Journal");
+    
+    ThermalConfig config;
+    config.max_alerts_history = 100;
+    auto clock = std::make_shared<VirtualClock>();
+    ThermalIsolationTracker tracker(config, clock);
+    
+    // A failed HVAC zone: 1000 sensors all read too hot at once
+    size_t records = 0;
+    std::string last_message;
+    tracker.set_alert_record_callback([&](const AlertRecord&) { records++; });
+    tracker.set_alert_callback([&](const Alert& alert) { last_message = alert.message; });
+    
+    std::vector<SensorReading> readings;
+    for (int i = 0; i < 1000; ++i) {
+        readings.push_back({"storm_" + std::to_string(i), 35.0f, 45.0f, "Zone B"});
+    }
+    tracker.process_sensor_batch(readings);
+    
+    // The ring keeps only the newest max_alerts_history, oldest first
+    auto recent = tracker.get_recent_alerts(1000);
+    auto last_two = tracker.get_recent_alerts(2);
+    std::cout << "Records dispatched: " << records << ", journaled: " << recent.size() << std::endl;
+    if (!recent.empty()) {
+        std::cout << "Newest: [" << recent.back().sensor_id << "] " << recent.back().message << std::endl;
+    }
+    
+    if (records != 1000 || recent.size() != config.max_alerts_history || last_two.size() != 2 ||
+        recent.back().sensor_id != last_two.back().sensor_id || recent.back().message != last_message ||
+        last_message != "Temperature too high: 35°C (max: 28°C) in Zone B" ||
+        recent.back().location != "Zone B") {
+        std::cerr << "❌ Alert journal lost or misrendered alerts" << std::endl;
+    } else {
+        std::cout << "✅ Storm journaled as compact records, rendered on request" << std::endl;
+    }
+}
+
+void test_topic_routing() {
+    print_separator("Testing Topic Routing");
+    
+    // 10 floors with 100 dashboards each, a few alert consoles, one firehose
+    TopicTrie<int> routes;
+    int viewer = 0;
+    for (int floor = 0; floor < 10; ++floor) {
+        for (int i = 0; i < 100; ++i) {
+            routes.insert("building/floor" + std::to_string(floor) + "/+/temperature", viewer++);
+        }
+    }
+    for (int i = 0; i < 5; ++i) {
+        routes.insert("alerts/#", viewer++);
+    }
+    routes.insert("#", viewer++);
+    
+    auto matches = [&](const std::string& topic) {
+        size_t count = 0;
+        routes.match(topic, [&](int) { count++; });
+        return count;
+    };
+    size_t floor3 = matches("building/floor3/room7/temperature");
+    size_t humidity = matches("building/floor3/room7/humidity");
+    size_t alerts = matches("alerts/sensor_001");
+    size_t system = matches("$SYS/broker/uptime");
+    std::cout << "Filters: " << routes.filter_count() << ", floor3 temperature: " << floor3
+              << ", humidity: " << humidity << ", alerts: " << alerts << ", $SYS: " << system << std::endl;
+    
+    bool filters_checked = valid_topic_filter("sensors/+/temperature") && valid_topic_filter("alerts/#") &&
+                           !valid_topic_filter("alerts/#/x") && !valid_topic_filter("sensors/a+") &&
+                           !valid_topic_filter("");
+    bool single_checked = topic_matches("building/+/+/temperature", "building/floor3/room7/temperature") &&
+                          topic_matches("alerts/#", "alerts") && topic_matches("a/+", "a/") &&
+                          !topic_matches("a/+", "a") && !topic_matches("#", "$SYS/broker/uptime") &&
+                          !topic_matches("building/floor3", "building/floor3/room7");
+    
+    // Floor 3 goes dark: its dashboards unsubscribe and the branch is pruned
+    size_t remaining = routes.erase_if("building/floor3/+/temperature", [](int) { return true; });
+    size_t after = matches("building/floor3/room7/temperature");
+    
+    if (floor3 != 101 || humidity != 1 || alerts != 6 || system != 0 || !filters_checked || !single_checked ||
+        remaining != 0 || after != 1 || routes.filter_count() != 11 || routes.size() != 906) {
+        std::cerr << "❌ Topic trie routed to the wrong subscribers" << std::endl;
+    } else {
+        std::cout << "✅ Each topic reached only its floor's viewers (plus wildcards)" << std::endl;
+    }
+}
+
+void test_warm_restart() {
+    print_separator("Testing Warm Restart");
+    
+    const std::string path = "/tmp/thermal_tracker_state_" + std::to_string(getpid()) + ".snap";
+    std::remove(path.c_str());
+    
+    ThermalConfig config;
+    config.sensor_shards = 4;
+    config.history_size = 20;
+    config.alert_throttle_minutes = 20;
+    config.state_snapshot_path = path;
+    
+    // First run: 30 minutes of 200 sensors; sensor 0 runs hot, odd sensors go quiet after minute 24
+    const int sensors = 200;
+    SensorStats before;
+    TrackerTotals before_totals;
+    {
+        auto clock = std::make_shared<VirtualClock>();
+        ThermalIsolationTracker tracker(config, clock);
+        for (int minute = 0; minute < 30; ++minute) {
+            for (int i = 0; i < sensors; ++i) {
+                if (minute >= 25 && i % 2) continue;
+                float temperature = i == 0 ? 30.0f : 20.0f + 0.1f * (minute % 5) + i % 3;
+                tracker.process_sensor_data("warm_" + std::to_string(i), temperature, 45.0f, "Warm Room");
+            }
+            clock->advance(std::chrono::minutes(1));
+        }
+        before = tracker.get_sensor_stats("warm_2");
+        before_totals = tracker.get_totals();
+    }   // Destructor writes the last changes
+    
+    // Second run on a fresh clock, restored by the constructor
+    auto clock = std::make_shared<VirtualClock>();
+    auto started = std::chrono::steady_clock::now();
+    ThermalIsolationTracker tracker(config, clock);
+    double restore_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    
+    std::vector<int> alerts(ALERT_TYPE_COUNT);
+    tracker.set_alert_callback([&](const Alert& alert) { alerts[static_cast<size_t>(alert.alert_type)]++; });
+    SensorStats after = tracker.get_sensor_stats("warm_2");
+    TrackerTotals after_totals = tracker.get_totals();
+    
+    // Sensor 0 alerted 10 minutes ago, so it is still throttled; sensor 2's
+    // rate is computed against its last reading, two minutes back in the first run
+    tracker.process_sensor_data("warm_0", 30.0f, 45.0f);
+    clock->advance(std::chrono::minutes(1));
+    tracker.process_sensor_data("warm_2", before.current_temp + 5.0f, 45.0f);
+    
+    // The quiet sensors' offline deadlines carried over too
+    clock->advance(std::chrono::minutes(5));
+    tracker.run_maintenance();
+    
+    std::cout << "Restored " << after_totals.sensors << " sensors in " << std::setprecision(2) << restore_ms
+              << " ms; alerts after restart: too high " << alerts[static_cast<size_t>(AlertType::TEMP_TOO_HIGH)]
+              << ", rising " << alerts[static_cast<size_t>(AlertType::TEMP_RISING_FAST)]
+              << ", offline " << alerts[static_cast<size_t>(AlertType::SENSOR_OFFLINE)] << std::setprecision(1) << std::endl;
+    std::remove(path.c_str());
+    
+    if (after_totals.sensors != before_totals.sensors || after_totals.active_sensors != before_totals.active_sensors ||
+        after.current_temp != before.current_temp || std::fabs(after.avg_temp - before.avg_temp) > 1e-4f ||
+        std::fabs(after.temp_trend - before.temp_trend) > 1e-4f || after.max_temp != before.max_temp ||
+        alerts[static_cast<size_t>(AlertType::TEMP_TOO_HIGH)] != 0 ||
+        alerts[static_cast<size_t>(AlertType::TEMP_RISING_FAST)] != 1 ||
+        alerts[static_cast<size_t>(AlertType::SENSOR_OFFLINE)] != sensors / 2 || restore_ms >= 1000.0) {
+        std::cerr << "❌ Restarted tracker lost history, throttles or deadlines" << std::endl;
+    } else {
+        std::cout << "✅ History, throttles and offline deadlines survived the restart" << std::endl;
+    }
+}
+
+void test_async_logging() {
+    print_separator("Testing Async Logging");
+    
+    // Disabled levels must not evaluate their arguments
+    int evaluations = 0;
+    auto expensive = [&]() { return ++evaluations; };
+    THERMAL_LOG_TRACE << "never formatted " << expensive();
+    
+    LogStats before = Log::get_stats();
+    const int threads = 4;
+    const int records_per_thread = 25;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([t]() {
+            for (int i = 0; i < records_per_thread; ++i) {
+                THERMAL_LOG_DEBUG << "🧵 writer " << t << " record " << i;
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    Log::flush();
+    LogStats after = Log::get_stats();
+    
+    uint64_t written = after.records_written - before.records_written;
+    std::cout << "Records written: " << written << ", dropped: " 
+              << (after.records_dropped - before.records_dropped) << ", trace evaluations: " << evaluations << std::endl;
+    if (evaluations != 0 || written < static_cast<uint64_t>(threads * records_per_thread) ||
+        after.records_dropped != before.records_dropped) {
+        std::cerr << "❌ Async logging lost records or formatted a disabled level" << std::endl;
+    } else {
+        std::cout << "✅ All records drained from " << threads << " thread buffers" << std::endl;
+    }
+}
+
+void test_metrics() {
+    print_separator("Testing Metrics Registry");
+    
+    // A private registry keeps the checks independent of process metrics
+    metrics::Registry registry;
+    auto& counter = registry.counter("test_events_total", "Events", metrics::label("kind", "a\"b"));
+    auto& histogram = registry.histogram("test_latency_seconds", "Latency", {0.001, 0.01, 0.1});
+    
+    const int threads = 4;
+    const int events_per_thread = 10000;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&]() {
+            for (int i = 0; i < events_per_thread; ++i) {
+                counter.inc();
+                histogram.observe(i % 2 ? 0.005 : 0.5);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    
+    int depth = 7;
+    uint64_t callback = registry.add_callback("test_queue_depth", "Depth", metrics::MetricType::GAUGE,
+                                              [&depth]() { return static_cast<double>(depth); });
+    std::string text = registry.render_prometheus();
+    registry.remove_callback(callback);
+    std::string after_removal = registry.render_prometheus();
+    
+    const uint64_t total = static_cast<uint64_t>(threads) * events_per_thread;
+    const std::string expected[] = {
+        "# TYPE test_events_total counter",
+        "test_events_total{kind=\"a\\\"b\"} " + std::to_string(total),
+        "test_latency_seconds_bucket{le=\"0.001\"} 0",
+        "test_latency_seconds_bucket{le=\"0.01\"} " + std::to_string(total / 2),
+        "test_latency_seconds_bucket{le=\"+Inf\"} " + std::to_string(total),
+        "test_latency_seconds_count " + std::to_string(total),
+        "test_queue_depth 7"
+    };
+    bool ok = true;
+    for (const auto& line : expected) {
+        if (text.find(line + "\n") == std::string::npos) {
+            std::cerr << "❌ Exposition is missing: " << line << std::endl;
+            ok = false;
+        }
+    }
+    if (after_removal.find("test_queue_depth") != std::string::npos) {
+        std::cerr << "❌ Removed callback is still exported" << std::endl;
+        ok = false;
+    }
+    if (ok) {
+        std::cout << "✅ " << total << " striped updates from " << threads
+                  << " threads exported in Prometheus text format" << std::endl;
+    }
+}
+
 void print_system_stats(const ThermalIsolationTracker& tracker) {
     print_separator("System Statistics");
     
@@ -162,7 +624,7 @@ void print_system_stats(const ThermalIsolationTracker& tracker) {
         std::cout << "   Humidity: " << sensor.humidity << "%" << std::endl;
         std::cout << "   Rate: " << sensor.temp_rate << "°C/min" << std::endl;
         std::cout << "   Active: " << (sensor.is_active ? "Yes" : "No") << std::endl;
-        std::cout << "   History: " << sensor.temperature_history.size() << " readings" << std::endl;
+        std::cout << "   History: " << sensor.history.size() << " readings" << std::endl;
     }
     
     auto alerts = tracker.get_recent_alerts(5);
@@ -173,6 +635,10 @@ void print_system_stats(const ThermalIsolationTracker& tracker) {
 }
 
 int main() {
+    // Show every processed reading, not just INFO and above
+    Log::set_level(LogLevel::DEBUG);
+    std::cout << std::fixed << std::setprecision(1);
+    
     std::cout << "🌡️  Thermal Isolation Tracker Test Program" << std::endl;
     std::cout << "=============================================" << std::endl;
     
@@ -183,6 +649,33 @@ int main() {
         // Test 2: Threshold alerts
         test_threshold_alerts();
         
+        // Test 2a: Degenerate history size
+        test_minimal_history();
+        
+        // Test 2b: Virtual time
+        test_virtual_clock();
+        
+        // Test 2c: Logging
+        test_async_logging();
+        
+        // Test 2d: Metrics
+        test_metrics();
+        
+        // Test 2e: Offline deadlines
+        test_offline_deadlines();
+        
+        // Test 2f: Batch ingestion
+        test_batch_ingestion();
+        
+        // Test 2g: Alert journal
+        test_alert_journal();
+        
+        // Test 2h: Topic routing
+        test_topic_routing();
+        
+        // Test 2i: Warm restart
+        test_warm_restart();
+        
         // Test 3: Full system simulation
         print_separator("Full System Simulation");
         
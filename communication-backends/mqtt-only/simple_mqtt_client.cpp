@@ -229,10 +229,10 @@ private:
         std::cout << "Throughput: " << std::fixed << std::setprecision(2) << (messages_sent_ / duration_sec) << " msg/sec" << std::endl;
         
         // Get thermal monitoring stats
-        auto sensors = thermal_tracker_->get_all_sensors();
+        auto totals = thermal_tracker_->get_totals();
         auto alerts = thermal_tracker_->get_recent_alerts(10);
         
-        std::cout << "Active sensors: " << sensors.size() << std::endl;
+        std::cout << "Active sensors: " << totals.active_sensors << std::endl;
         std::cout << "Recent alerts: " << alerts.size() << std::endl;
     }
     
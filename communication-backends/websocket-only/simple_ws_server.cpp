@@ -265,30 +265,14 @@ private:
         }
     }
     
-    void HandleClientMessage(struct lws* /* wsi */, const std::string& message) {
+    void HandleClientMessage(struct lws* /* wsi */, std::string_view message) {
         messages_received_++;
         
-        try {
-            Json::Value data;
-            Json::CharReaderBuilder reader_builder;
-            std::string errors;
-            std::stringstream ss(message);
-            
-            if (Json::parseFromStream(reader_builder, ss, &data, &errors)) {
-                std::string type = data.get("type", "").asString();
-                
-                if (type == "sensor_data") {
-                    // Handle incoming sensor data from client
-                    std::string sensor_id = data.get("sensor_id", "").asString();
-                    double temperature = data.get("temperature", 0.0).asDouble();
-                    double humidity = data.get("humidity", 0.0).asDouble();
-                    std::string location = data.get("location", "").asString();
-                    
-                    thermal_tracker_->process_sensor_data(sensor_id, temperature, humidity, location);
-                }
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "❌ Error processing client message: " << e.what() << std::endl;
+        // Handle incoming sensor data from client
+        auto reading = parse_client_sensor_message(message);
+        if (reading) {
+            thermal_tracker_->process_sensor_data(reading->sensor_id, reading->temperature,
+                                                  reading->humidity, reading->location);
         }
     }
     
@@ -313,10 +297,10 @@ private:
         std::cout << "Throughput: " << std::fixed << std::setprecision(2) << (messages_sent_ / duration_sec) << " msg/sec" << std::endl;
         
         // Get thermal monitoring stats
-        auto sensors = thermal_tracker_->get_all_sensors();
+        auto totals = thermal_tracker_->get_totals();
         auto alerts = thermal_tracker_->get_recent_alerts(10);
         
-        std::cout << "Active sensors: " << sensors.size() << std::endl;
+        std::cout << "Active sensors: " << totals.active_sensors << std::endl;
         std::cout << "Recent alerts: " << alerts.size() << std::endl;
     }
     
@@ -336,8 +320,7 @@ private:
                 
             case LWS_CALLBACK_RECEIVE:
                 if (in && len > 0) {
-                    std::string message(static_cast<char*>(in), len);
-                    server->HandleClientMessage(wsi, message);
+                    server->HandleClientMessage(wsi, std::string_view(static_cast<const char*>(in), len));
                 }
                 break;
                 
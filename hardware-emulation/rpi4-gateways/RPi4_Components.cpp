@@ -1,9 +1,19 @@
 #include "RPi4_Gateway.h"
-#include <iostream>
+#include "../../thermal-monitoring/Log.h"
 #include <sstream>
 #include <iomanip>
 #include <filesystem>
 #include <fstream>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
 #include <sys/sysinfo.h>
 #include <sys/statvfs.h>
 
@@ -16,117 +26,140 @@ namespace rpi4_gateway {
 StorageManager::StorageManager(const RPi4GatewayConfig& config) : config_(config) {
     data_path_ = config_.data_directory;
     log_path_ = config_.log_directory;
-    std::cout << "💾 [StorageManager] Created" << std::endl;
+    THERMAL_LOG_INFO << "💾 [StorageManager] Created";
 }
 
 StorageManager::~StorageManager() {
-    std::cout << "💾 [StorageManager] Destroyed" << std::endl;
+    if (segment_store_) {
+        segment_store_->close();
+    }
+    THERMAL_LOG_INFO << "💾 [StorageManager] Destroyed";
 }
 
 bool StorageManager::initialize() {
     try {
         std::filesystem::create_directories(data_path_);
         std::filesystem::create_directories(log_path_);
-        std::cout << "✅ [StorageManager] Initialized" << std::endl;
+        
+        segment_store_ = std::make_unique<SegmentStore>(data_path_ + "/segments", config_);
+        if (!segment_store_->open()) {
+            segment_store_.reset();
+            return false;
+        }
+        
+        THERMAL_LOG_INFO << "✅ [StorageManager] Initialized";
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "❌ [StorageManager] Init failed: " << e.what() << std::endl;
+        THERMAL_LOG_ERROR << "❌ [StorageManager] Init failed: " << e.what();
         return false;
     }
 }
 
+namespace {
+int64_t wall_clock_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+}
+
+// Appends are buffered by the segment store; no file I/O on the caller's thread
 bool StorageManager::store_sensor_data(const SensorDataPacket& packet) {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
-    
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto tm = *std::localtime(&time_t);
-    
-    std::stringstream filename;
-    filename << data_path_ << "/" << packet.sensor_id << "_" 
-             << std::put_time(&tm, "%Y%m%d") << ".csv";
-    
-    std::ofstream file(filename.str(), std::ios::app);
-    if (file.is_open()) {
-        file << std::chrono::duration_cast<std::chrono::seconds>(
-                    packet.timestamp.time_since_epoch()).count() << ","
-             << packet.sensor_id << ","
-             << packet.temperature_celsius << ","
-             << packet.humidity_percent << std::endl;
-        return true;
-    }
-    return false;
+    return segment_store_ && segment_store_->append_reading(packet, wall_clock_ms());
 }
 
 void StorageManager::cleanup() {
-    std::cout << "🧹 [StorageManager] Cleanup completed" << std::endl;
+    if (segment_store_) {
+        segment_store_->flush();
+    }
+    THERMAL_LOG_INFO << "🧹 [StorageManager] Cleanup completed";
 }
 
 bool StorageManager::store_statistics(const SensorStatistics& stats) {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
-    
-    std::stringstream filename;
-    filename << data_path_ << "/statistics_" 
-             << std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() 
-             << ".csv";
-    
-    std::ofstream file(filename.str(), std::ios::app);
-    if (file.is_open()) {
-        file << stats.sensor_id << ","
-             << stats.total_packets << ","
-             << stats.valid_packets << ","
-             << stats.packet_loss_rate << ","
-             << stats.avg_temperature << ","
-             << stats.avg_humidity << std::endl;
-        return true;
-    }
-    return false;
+    return segment_store_ && segment_store_->append_statistics(stats, wall_clock_ms());
 }
 
 bool StorageManager::store_edge_result(const EdgeProcessingResult& result) {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
+    return segment_store_ && segment_store_->append_edge_result(result, wall_clock_ms());
+}
+
+bool StorageManager::export_csv(const std::string& output_path) {
+    if (!segment_store_) {
+        return false;
+    }
+    segment_store_->flush();
     
-    std::stringstream filename;
-    filename << data_path_ << "/edge_results_" 
-             << std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count() 
-             << ".csv";
+    std::ofstream file(output_path, std::ios::trunc);
+    if (!file.is_open()) {
+        THERMAL_LOG_ERROR << "❌ [StorageManager] Cannot write " << output_path;
+        return false;
+    }
     
-    std::ofstream file(filename.str(), std::ios::app);
-    if (file.is_open()) {
-        file << result.sensor_id << ","
-             << result.analysis_type << ","
-             << result.confidence_score << std::endl;
-        return true;
+    file << "timestamp_ms,sensor_id,temperature,humidity,pressure,supply_voltage\n";
+    size_t rows = 0;
+    SensorDataPacket packet = {};
+    for (const auto& segment : segment_store_->list_segments()) {
+        SegmentStore::scan_segment(segment, [&](SegmentStore::RecordType type, int64_t timestamp_ms,
+                                                const uint8_t* payload, size_t length) {
+            if (type == SegmentStore::RecordType::SENSOR_READING &&
+                SegmentStore::decode_reading(payload, length, packet)) {
+                file << timestamp_ms << "," << packet.sensor_id << ","
+                     << packet.temperature_celsius << "," << packet.humidity_percent << ","
+                     << packet.pressure_hpa << "," << packet.supply_voltage << "\n";
+                rows++;
+            }
+            return true;
+        });
     }
-    return false;
+    
+    THERMAL_LOG_INFO << "📤 [StorageManager] Exported " << rows << " readings to " << output_path;
+    return file.good();
+}
+
+SegmentStore::Stats StorageManager::get_segment_stats() const {
+    return segment_store_ ? segment_store_->get_stats() : SegmentStore::Stats{};
 }
 
+// Time-indexed range query; sealed days are served from mmapped segment indexes
 std::vector<SensorDataPacket> StorageManager::retrieve_sensor_data(
     const std::string& sensor_id, 
     const std::chrono::system_clock::time_point& start,
     const std::chrono::system_clock::time_point& end) {
-    std::lock_guard<std::mutex> lock(storage_mutex_);
+    if (!segment_store_) {
+        return {};
+    }
+    segment_store_->flush();
     
-    // Simplified implementation - in real scenario would parse CSV files
-    std::vector<SensorDataPacket> results;
-    std::cout << "📊 [StorageManager] Retrieved data for " << sensor_id 
-              << " (mock implementation)" << std::endl;
-    return results;
+    auto to_ms = [](const std::chrono::system_clock::time_point& point) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(point.time_since_epoch()).count();
+    };
+    std::lock_guard<std::mutex> lock(storage_mutex_);
+    return segment_store_->query_readings(sensor_id, to_ms(start), to_ms(end));
 }
 
+// Sealed (past-day) segments are rewritten sensor-major and indexed
 void StorageManager::rotate_logs() {
-    std::cout << "🔄 [StorageManager] Log rotation completed" << std::endl;
+    if (!segment_store_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(storage_mutex_);
+    size_t compacted = segment_store_->compact_sealed_segments();
+    THERMAL_LOG_INFO << "🔄 [StorageManager] Log rotation completed (" << compacted 
+                     << " segments indexed)";
 }
 
+// Drops the oldest whole segments until the store fits max_storage_mb
 void StorageManager::cleanup_old_data() {
-    std::cout << "🧹 [StorageManager] Old data cleanup completed" << std::endl;
+    if (!segment_store_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(storage_mutex_);
+    size_t removed = segment_store_->enforce_retention(config_.max_storage_mb * 1024 * 1024);
+    THERMAL_LOG_INFO << "🧹 [StorageManager] Old data cleanup completed (" << removed 
+                     << " segments removed)";
 }
 
 uint64_t StorageManager::get_storage_usage() const {
-    // Simplified implementation
-    return 1024 * 1024; // 1MB mock usage
+    return segment_store_ ? segment_store_->disk_usage() : 0;
 }
 
 //=============================================================================
@@ -134,12 +167,12 @@ uint64_t StorageManager::get_storage_usage() const {
 //=============================================================================
 
 SystemMonitor::SystemMonitor() : running_(false) {
-    std::cout << "📊 [SystemMonitor] Created" << std::endl;
+    THERMAL_LOG_INFO << "📊 [SystemMonitor] Created";
 }
 
 SystemMonitor::~SystemMonitor() {
     stop();
-    std::cout << "📊 [SystemMonitor] Destroyed" << std::endl;
+    THERMAL_LOG_INFO << "📊 [SystemMonitor] Destroyed";
 }
 
 bool SystemMonitor::start() {
@@ -147,7 +180,7 @@ bool SystemMonitor::start() {
     
     running_ = true;
     monitor_thread_ = std::thread(&SystemMonitor::monitor_loop, this);
-    std::cout << "🚀 [SystemMonitor] Started" << std::endl;
+    THERMAL_LOG_INFO << "🚀 [SystemMonitor] Started";
     return true;
 }
 
@@ -158,7 +191,7 @@ void SystemMonitor::stop() {
     if (monitor_thread_.joinable()) {
         monitor_thread_.join();
     }
-    std::cout << "✅ [SystemMonitor] Stopped" << std::endl;
+    THERMAL_LOG_INFO << "✅ [SystemMonitor] Stopped";
 }
 
 void SystemMonitor::monitor_loop() {
@@ -214,24 +247,330 @@ GatewayStatus SystemMonitor::get_system_status() const {
     return current_status_;
 }
 
+//=============================================================================
+// MetricsEndpoint Implementation
+//=============================================================================
+
+namespace {
+constexpr size_t MAX_METRICS_REQUEST_BYTES = 8192;
+}
+
+MetricsEndpoint::MetricsEndpoint(const std::string& host, int port)
+    : host_(host), port_(port), listen_fd_(-1), listen_source_(-1), next_serial_(0),
+      render_stop_(false), done_fd_(-1), done_source_(-1) {
+}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    stop();
+}
+
+bool MetricsEndpoint::start() {
+    if (listen_fd_ >= 0) return true;
+    
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port_));
+    if (inet_pton(AF_INET, host_.c_str(), &address.sin_addr) != 1) {
+        THERMAL_LOG_ERROR << "❌ [Metrics] Invalid listen address: " << host_;
+        return false;
+    }
+    
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        THERMAL_LOG_ERROR << "❌ [Metrics] Failed to create socket: " << strerror(errno);
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0 || listen(fd, 16) < 0) {
+        THERMAL_LOG_ERROR << "❌ [Metrics] Failed to listen on " << host_ << ":" << port_ << ": " << strerror(errno);
+        close(fd);
+        return false;
+    }
+    
+    done_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    reactor_ = CommReactor::shared();
+    if (reactor_ && done_fd_ >= 0) {
+        done_source_ = reactor_->add_fd(done_fd_, EPOLLIN, [this](uint32_t) { on_rendered(); });
+        listen_source_ = reactor_->add_fd(fd, EPOLLIN, [this](uint32_t) { on_accept(); });
+    }
+    if (listen_source_ < 0 || done_source_ < 0) {
+        THERMAL_LOG_ERROR << "❌ [Metrics] Failed to register with reactor";
+        if (reactor_) {
+            reactor_->remove(listen_source_);
+            reactor_->remove(done_source_);
+        }
+        listen_source_ = -1;
+        done_source_ = -1;
+        if (done_fd_ >= 0) {
+            close(done_fd_);
+            done_fd_ = -1;
+        }
+        close(fd);
+        reactor_.reset();
+        return false;
+    }
+    
+    render_stop_ = false;
+    render_thread_ = std::thread(&MetricsEndpoint::render_loop, this);
+    listen_fd_ = fd;
+    THERMAL_LOG_INFO << "📈 [Metrics] Serving http://" << host_ << ":" << port_ << "/metrics";
+    return true;
+}
+
+void MetricsEndpoint::stop() {
+    if (listen_fd_ < 0) return;
+    
+    reactor_->remove(listen_source_);
+    listen_source_ = -1;
+    close(listen_fd_);
+    listen_fd_ = -1;
+    
+    // Renders still queued or in flight are dropped with their clients
+    {
+        std::lock_guard<std::mutex> lock(render_mutex_);
+        render_stop_ = true;
+        render_queue_.clear();
+    }
+    render_cv_.notify_all();
+    if (render_thread_.joinable()) {
+        render_thread_.join();
+    }
+    reactor_->remove(done_source_);
+    done_source_ = -1;
+    close(done_fd_);
+    done_fd_ = -1;
+    rendered_.clear();
+    
+    // No new clients can appear now; a handler still running for one of
+    // these finishes before remove() returns
+    std::unordered_map<int, std::unique_ptr<Client>> clients;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        clients.swap(clients_);
+    }
+    for (auto& pair : clients) {
+        reactor_->remove(pair.second->source_id);
+        close(pair.second->fd);
+    }
+    
+    reactor_.reset();
+    THERMAL_LOG_INFO << "✅ [Metrics] Stopped";
+}
+
+void MetricsEndpoint::on_accept() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                THERMAL_LOG_WARN << "⚠️ [Metrics] accept failed: " << strerror(errno);
+            }
+            return;
+        }
+        
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        client->serial = ++next_serial_;
+        client->rendering = false;
+        client->sent = 0;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            client->source_id = reactor_->add_fd(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+                                                 [this, fd](uint32_t events) { on_client(fd, events); });
+            if (client->source_id < 0) {
+                close(fd);
+                continue;
+            }
+            clients_[fd] = std::move(client);
+        }
+    }
+}
+
+void MetricsEndpoint::on_client(int fd, uint32_t events) {
+    Client* client = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        auto it = clients_.find(fd);
+        if (it == clients_.end()) return;
+        client = it->second.get();
+    }
+    
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        close_client(fd);
+        return;
+    }
+    
+    // The response is on its way from the render thread
+    if (client->rendering) return;
+    
+    // Edge-triggered: drain the request until the kernel has nothing more
+    if (client->response.empty()) {
+        char buffer[1024];
+        bool peer_closed = false;
+        while (true) {
+            ssize_t bytes_read = read(fd, buffer, sizeof(buffer));
+            if (bytes_read > 0) {
+                client->request.append(buffer, static_cast<size_t>(bytes_read));
+                if (client->request.size() > MAX_METRICS_REQUEST_BYTES) {
+                    close_client(fd);
+                    return;
+                }
+            } else if (bytes_read == 0) {
+                peer_closed = true;  // A half-closed scraper still gets its response
+                break;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else if (errno != EINTR) {
+                close_client(fd);
+                return;
+            }
+        }
+        if (client->request.find("\r\n\r\n") == std::string::npos) {
+            if (peer_closed) {
+                close_client(fd);
+            }
+            return; // Headers still incomplete
+        }
+        
+        // Rendering the registry takes far longer than any socket call;
+        // on_rendered() picks the response up on this thread again
+        client->rendering = true;
+        {
+            std::lock_guard<std::mutex> lock(render_mutex_);
+            render_queue_.push_back({fd, client->serial, std::move(client->request)});
+        }
+        render_cv_.notify_one();
+        return;
+    }
+    
+    send_response(fd, client);
+}
+
+void MetricsEndpoint::on_rendered() {
+    uint64_t signals;
+    while (read(done_fd_, &signals, sizeof(signals)) > 0) {}
+    
+    std::vector<RenderJob> rendered;
+    {
+        std::lock_guard<std::mutex> lock(render_mutex_);
+        rendered.swap(rendered_);
+    }
+    
+    for (RenderJob& job : rendered) {
+        Client* client = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            auto it = clients_.find(job.fd);
+            if (it == clients_.end() || it->second->serial != job.serial) {
+                continue;  // Scraper hung up while its response was rendered
+            }
+            client = it->second.get();
+        }
+        client->rendering = false;
+        client->response = std::move(job.text);
+        send_response(job.fd, client);
+    }
+}
+
+void MetricsEndpoint::send_response(int fd, Client* client) {
+    while (client->sent < client->response.size()) {
+        ssize_t written = send(fd, client->response.data() + client->sent,
+                               client->response.size() - client->sent, MSG_NOSIGNAL);
+        if (written > 0) {
+            client->sent += static_cast<size_t>(written);
+        } else if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return; // Resumed on the next EPOLLOUT edge
+        } else {
+            break;
+        }
+    }
+    close_client(fd);
+}
+
+void MetricsEndpoint::render_loop() {
+    while (true) {
+        RenderJob job;
+        {
+            std::unique_lock<std::mutex> lock(render_mutex_);
+            render_cv_.wait(lock, [this] { return render_stop_ || !render_queue_.empty(); });
+            if (render_stop_) return;
+            job = std::move(render_queue_.front());
+            render_queue_.pop_front();
+        }
+        
+        job.text = build_response(job.text);
+        
+        {
+            std::lock_guard<std::mutex> lock(render_mutex_);
+            if (render_stop_) return;
+            rendered_.push_back(std::move(job));
+        }
+        uint64_t signal = 1;
+        if (write(done_fd_, &signal, sizeof(signal)) < 0 && errno != EAGAIN) {
+            THERMAL_LOG_WARN << "⚠️ [Metrics] Failed to signal rendered response: " << strerror(errno);
+        }
+    }
+}
+
+void MetricsEndpoint::close_client(int fd) {
+    std::unique_ptr<Client> client;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        auto it = clients_.find(fd);
+        if (it == clients_.end()) return;  // Already taken by stop()
+        client = std::move(it->second);
+        clients_.erase(it);
+    }
+    reactor_->remove(client->source_id);
+    close(client->fd);
+}
+
+std::string MetricsEndpoint::build_response(const std::string& request) {
+    // Request line: METHOD SP PATH[?QUERY] SP VERSION
+    size_t method_end = request.find(' ');
+    size_t path_end = method_end == std::string::npos ? std::string::npos : request.find_first_of(" ?", method_end + 1);
+    std::string method = request.substr(0, method_end);
+    std::string path = path_end == std::string::npos ? "" : request.substr(method_end + 1, path_end - method_end - 1);
+    
+    std::string status = "404 Not Found";
+    std::string content_type = "text/plain";
+    std::string body = "Not found\n";
+    if (method == "GET" && path == "/metrics") {
+        status = "200 OK";
+        content_type = "text/plain; version=0.0.4; charset=utf-8";
+        body = thermal_monitoring::metrics::Registry::global().render_prometheus();
+    }
+    
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: " << content_type << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    return response.str();
+}
+
 //=============================================================================
 // RPi4_Gateway Main Implementation
 //=============================================================================
 
 RPi4_Gateway::RPi4_Gateway(const RPi4GatewayConfig& config)
     : config_(config), running_(false), initialized_(false) {
-    std::cout << "🏠 [RPi4_Gateway] Created: " << config_.gateway_id << std::endl;
+    THERMAL_LOG_INFO << "🏠 [RPi4_Gateway] Created: " << config_.gateway_id;
 }
 
 RPi4_Gateway::~RPi4_Gateway() {
     stop();
-    std::cout << "🏠 [RPi4_Gateway] Destroyed" << std::endl;
+    metrics_callbacks_.reset();
+    THERMAL_LOG_INFO << "🏠 [RPi4_Gateway] Destroyed";
 }
 
 bool RPi4_Gateway::initialize() {
     if (initialized_.load()) return true;
     
-    std::cout << "🚀 [RPi4_Gateway] Initializing..." << std::endl;
+    THERMAL_LOG_INFO << "🚀 [RPi4_Gateway] Initializing...";
     
     // Initialize components
     data_processor_ = std::make_unique<DataProcessor>(config_);
@@ -264,14 +603,28 @@ bool RPi4_Gateway::initialize() {
             this->handle_websocket_message(message);
         });
     
+    // Mesh traffic shares the gateway's MQTT path
+    if (config_.mesh_enabled) {
+        mesh_ = std::make_unique<GatewayMesh>(config_, *data_processor_,
+            [this](const std::string& topic, const std::string& payload) {
+                this->handle_mqtt_message(topic, payload);
+            });
+        mesh_->set_reading_callback(
+            [this](SensorDataPacket&& packet) {
+                this->handle_sensor_data(std::move(packet));
+            });
+    }
+    
+    setup_metrics();
+    
     initialized_ = true;
-    std::cout << "✅ [RPi4_Gateway] Initialized" << std::endl;
+    THERMAL_LOG_INFO << "✅ [RPi4_Gateway] Initialized";
     return true;
 }
 
 bool RPi4_Gateway::start() {
     if (!initialized_.load()) {
-        std::cerr << "❌ [RPi4_Gateway] Not initialized" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [RPi4_Gateway] Not initialized";
         return false;
     }
     
@@ -285,6 +638,13 @@ bool RPi4_Gateway::start() {
         return false;
     }
     
+    // Join the mesh before the first reading so ownership is known
+    if (mesh_ && !mesh_->start()) {
+        data_processor_->stop();
+        running_ = false;
+        return false;
+    }
+    
     // Start communication interfaces
     for (auto& interface : comm_interfaces_) {
         interface->start();
@@ -293,16 +653,30 @@ bool RPi4_Gateway::start() {
     // Start main loop
     main_loop_thread_ = std::thread(&RPi4_Gateway::main_loop, this);
     
-    std::cout << "🚀 [RPi4_Gateway] Started with " << comm_interfaces_.size() << " interfaces" << std::endl;
+    // A metrics port that cannot be bound is reported but not fatal
+    if (config_.metrics_port > 0) {
+        metrics_endpoint_ = std::make_unique<MetricsEndpoint>(config_.metrics_host, config_.metrics_port);
+        if (!metrics_endpoint_->start()) {
+            THERMAL_LOG_WARN << "⚠️ [RPi4_Gateway] Metrics endpoint unavailable";
+            metrics_endpoint_.reset();
+        }
+    }
+    
+    THERMAL_LOG_INFO << "🚀 [RPi4_Gateway] Started with " << comm_interfaces_.size() << " interfaces";
     return true;
 }
 
 void RPi4_Gateway::stop() {
     if (!running_.load()) return;
     
-    std::cout << "🛑 [RPi4_Gateway] Stopping..." << std::endl;
+    THERMAL_LOG_INFO << "🛑 [RPi4_Gateway] Stopping...";
     running_ = false;
     
+    if (metrics_endpoint_) {
+        metrics_endpoint_->stop();
+        metrics_endpoint_.reset();
+    }
+    
     // Stop interfaces
     for (auto& interface : comm_interfaces_) {
         interface->stop();
@@ -313,58 +687,144 @@ void RPi4_Gateway::stop() {
         data_processor_->stop();
     }
     
+    // Hand the final state of this gateway's sensors to their next owners
+    if (mesh_) {
+        mesh_->stop();
+    }
+    
     // Stop main loop
     if (main_loop_thread_.joinable()) {
         main_loop_thread_.join();
     }
     
-    std::cout << "✅ [RPi4_Gateway] Stopped" << std::endl;
+    THERMAL_LOG_INFO << "✅ [RPi4_Gateway] Stopped";
+}
+
+void RPi4_Gateway::setup_metrics() {
+    using thermal_monitoring::metrics::MetricType;
+    auto& registry = thermal_monitoring::metrics::Registry::global();
+    const std::string labels = thermal_monitoring::metrics::label("gateway", config_.gateway_id);
+    DataProcessor* processor = data_processor_.get();
+    
+    metrics_callbacks_.reset();
+    metrics_callbacks_ = thermal_monitoring::metrics::CallbackHandle(&registry, {});
+    auto add = [&](const char* name, const char* help, MetricType type, std::function<double()> read) {
+        metrics_callbacks_.add(registry.add_callback(name, help, type, std::move(read), labels));
+    };
+    
+    add("thermal_gateway_ingest_queue_capacity", "Packets the ingest queues can hold", MetricType::GAUGE,
+        [processor] { return static_cast<double>(processor->get_queue_stats().capacity); });
+    add("thermal_gateway_ingest_queue_depth", "Packets waiting in the ingest queues", MetricType::GAUGE,
+        [processor] { return static_cast<double>(processor->get_queue_stats().depth); });
+    add("thermal_gateway_ingest_queue_high_water", "Deepest any ingest partition has been", MetricType::GAUGE,
+        [processor] { return static_cast<double>(processor->get_queue_stats().high_water_mark); });
+    add("thermal_gateway_enqueued_packets_total", "Packets accepted into the ingest queues", MetricType::COUNTER,
+        [processor] { return static_cast<double>(processor->get_queue_stats().enqueued_packets); });
+    add("thermal_gateway_dropped_packets_total", "Packets dropped because an ingest queue was full",
+        MetricType::COUNTER,
+        [processor] { return static_cast<double>(processor->get_queue_stats().dropped_packets); });
+    add("thermal_gateway_sensors", "Sensors known to the gateway", MetricType::GAUGE,
+        [processor] { return static_cast<double>(processor->get_sensor_registry()->size()); });
+    
+    add("thermal_gateway_messages_published_total", "MQTT messages published", MetricType::COUNTER,
+        [processor] { return static_cast<double>(processor->get_publish_stats().messages_published); });
+    add("thermal_gateway_readings_batched_total", "Readings carried inside batch payloads", MetricType::COUNTER,
+        [processor] { return static_cast<double>(processor->get_publish_stats().readings_batched); });
+    add("thermal_gateway_readings_suppressed_total", "Readings held back by the deadband filter",
+        MetricType::COUNTER,
+        [processor] { return static_cast<double>(processor->get_publish_stats().readings_suppressed); });
+    add("thermal_gateway_alerts_forwarded_total", "Alerting readings published immediately", MetricType::COUNTER,
+        [processor] { return static_cast<double>(processor->get_publish_stats().alerts_forwarded); });
+    
+    if (GatewayMesh* mesh = mesh_.get()) {
+        add("thermal_gateway_mesh_members", "Gateways in this gateway's view of the mesh", MetricType::GAUGE,
+            [mesh] { return static_cast<double>(mesh->get_stats().members); });
+        add("thermal_gateway_mesh_membership_changes_total", "Ring rebuilds after joins, leaves and failures",
+            MetricType::COUNTER,
+            [mesh] { return static_cast<double>(mesh->get_stats().membership_changes); });
+        add("thermal_gateway_mesh_readings_forwarded_total", "Readings sent to the gateway that owns the sensor",
+            MetricType::COUNTER,
+            [mesh] { return static_cast<double>(mesh->get_stats().readings_forwarded); });
+        add("thermal_gateway_mesh_readings_replicated_total", "Readings mirrored to the sensor's replica gateway",
+            MetricType::COUNTER,
+            [mesh] { return static_cast<double>(mesh->get_stats().readings_replicated); });
+        add("thermal_gateway_mesh_states_sent_total", "Sensor histories handed to another gateway",
+            MetricType::COUNTER,
+            [mesh] { return static_cast<double>(mesh->get_stats().states_sent); });
+    }
+    
+    if (!config_.state_snapshot_path.empty()) {
+        add("thermal_gateway_state_snapshot_records", "Sensors held in the warm restart file", MetricType::GAUGE,
+            [processor] { return static_cast<double>(processor->get_state_snapshot_stats().records); });
+        add("thermal_gateway_state_snapshot_writes_total", "Sensor states written to the warm restart file",
+            MetricType::COUNTER,
+            [processor] { return static_cast<double>(processor->get_state_snapshot_stats().writes); });
+    }
+    
+    if (StorageManager* storage = storage_manager_.get()) {
+        add("thermal_gateway_storage_records_appended_total", "Records appended to local segments",
+            MetricType::COUNTER,
+            [storage] { return static_cast<double>(storage->get_segment_stats().appended_records); });
+        add("thermal_gateway_storage_records_dropped_total", "Records dropped because the flusher fell behind",
+            MetricType::COUNTER,
+            [storage] { return static_cast<double>(storage->get_segment_stats().dropped_records); });
+        add("thermal_gateway_storage_commits_total", "Group commits written to segment files",
+            MetricType::COUNTER,
+            [storage] { return static_cast<double>(storage->get_segment_stats().commits); });
+        add("thermal_gateway_storage_syncs_total", "fdatasync calls on segment files", MetricType::COUNTER,
+            [storage] { return static_cast<double>(storage->get_segment_stats().syncs); });
+        add("thermal_gateway_storage_bytes_written_total", "Bytes written to segment files", MetricType::COUNTER,
+            [storage] { return static_cast<double>(storage->get_segment_stats().bytes_written); });
+    }
 }
 
 void RPi4_Gateway::setup_communication_interfaces() {
-    std::cout << "🔌 [RPi4_Gateway] Setting up interfaces..." << std::endl;
+    THERMAL_LOG_INFO << "🔌 [RPi4_Gateway] Setting up interfaces...";
     
     // Create UART interface
     auto uart_interface = std::make_unique<UARTInterface>(config_.uart_device, config_.uart_baudrate);
+    uart_interface->set_sensor_registry(data_processor_->get_sensor_registry());
     uart_interface->set_data_callback(
-        [this](const SensorDataPacket& packet) {
-            this->handle_sensor_data(packet);
+        [this](SensorDataPacket&& packet) {
+            this->handle_sensor_data(std::move(packet));
         });
     
     if (uart_interface->initialize()) {
         comm_interfaces_.push_back(std::move(uart_interface));
-        std::cout << "✅ [RPi4_Gateway] UART interface ready" << std::endl;
+        THERMAL_LOG_INFO << "✅ [RPi4_Gateway] UART interface ready";
     }
     
     // Create SPI interface
     auto spi_interface = std::make_unique<SPIInterface>(config_.spi_device, config_.spi_speed);
+    spi_interface->set_sensor_registry(data_processor_->get_sensor_registry());
     spi_interface->set_data_callback(
-        [this](const SensorDataPacket& packet) {
-            this->handle_sensor_data(packet);
+        [this](SensorDataPacket&& packet) {
+            this->handle_sensor_data(std::move(packet));
         });
     
     if (spi_interface->initialize()) {
         comm_interfaces_.push_back(std::move(spi_interface));
-        std::cout << "✅ [RPi4_Gateway] SPI interface ready" << std::endl;
+        THERMAL_LOG_INFO << "✅ [RPi4_Gateway] SPI interface ready";
     }
     
     // Create I2C interface
     if (!config_.i2c_addresses.empty()) {
         auto i2c_interface = std::make_unique<I2CInterface>(config_.i2c_bus, config_.i2c_addresses);
+        i2c_interface->set_sensor_registry(data_processor_->get_sensor_registry());
         i2c_interface->set_data_callback(
-            [this](const SensorDataPacket& packet) {
-                this->handle_sensor_data(packet);
+            [this](SensorDataPacket&& packet) {
+                this->handle_sensor_data(std::move(packet));
             });
         
         if (i2c_interface->initialize()) {
             comm_interfaces_.push_back(std::move(i2c_interface));
-            std::cout << "✅ [RPi4_Gateway] I2C interface ready" << std::endl;
+            THERMAL_LOG_INFO << "✅ [RPi4_Gateway] I2C interface ready";
         }
     }
 }
 
 void RPi4_Gateway::main_loop() {
-    std::cout << "🔄 [RPi4_Gateway] Main loop started" << std::endl;
+    THERMAL_LOG_INFO << "🔄 [RPi4_Gateway] Main loop started";
     
     while (running_.load()) {
         // Periodic status logging
@@ -374,10 +834,10 @@ void RPi4_Gateway::main_loop() {
         if (now - last_status >= std::chrono::minutes(5)) {
             if (system_monitor_) {
                 auto status = system_monitor_->get_system_status();
-                std::cout << "📊 [RPi4_Gateway] Status - CPU: " 
-                          << std::fixed << std::setprecision(1) << status.cpu_usage_percent 
-                          << "%, Memory: " << (status.memory_usage_bytes / 1024 / 1024) 
-                          << "MB, Disk: " << status.disk_usage_percent << "%" << std::endl;
+                THERMAL_LOG_INFO << "📊 [RPi4_Gateway] Status - CPU: " 
+                                 << std::fixed << std::setprecision(1) << status.cpu_usage_percent 
+                                 << "%, Memory: " << (status.memory_usage_bytes / 1024 / 1024) 
+                                 << "MB, Disk: " << status.disk_usage_percent << "%";
             }
             last_status = now;
         }
@@ -385,16 +845,16 @@ void RPi4_Gateway::main_loop() {
         std::this_thread::sleep_for(std::chrono::seconds(10));
     }
     
-    std::cout << "🏁 [RPi4_Gateway] Main loop finished" << std::endl;
+    THERMAL_LOG_INFO << "🏁 [RPi4_Gateway] Main loop finished";
 }
 
-void RPi4_Gateway::handle_sensor_data(const SensorDataPacket& packet) {
-    std::cout << "📨 [RPi4_Gateway] Data from " << packet.sensor_id << ": " 
-              << packet.temperature_celsius << "°C, " << packet.humidity_percent << "%" << std::endl;
+void RPi4_Gateway::handle_sensor_data(SensorDataPacket&& packet) {
+    THERMAL_LOG_DEBUG << "📨 [RPi4_Gateway] Data from " << packet.sensor_id << ": " 
+                      << packet.temperature_celsius << "°C, " << packet.humidity_percent << "%";
     
-    // Process through data processor
-    if (data_processor_) {
-        data_processor_->process_packet(packet);
+    // In a mesh, sensors owned by another gateway are forwarded to it instead
+    if (mesh_ && !mesh_->route_reading(packet)) {
+        return;
     }
     
     // Store locally if enabled
@@ -406,17 +866,28 @@ void RPi4_Gateway::handle_sensor_data(const SensorDataPacket& packet) {
     if (thermal_callback_ && packet.is_valid) {
         thermal_callback_(packet.sensor_id, packet.temperature_celsius, packet.humidity_percent);
     }
+    
+    // Hand the packet to the data processor last: it takes the contents
+    if (data_processor_) {
+        data_processor_->process_packet(std::move(packet));
+    }
 }
 
 void RPi4_Gateway::handle_mqtt_message(const std::string& topic, const std::string& message) {
-    std::cout << "📤 [RPi4_Gateway] MQTT: " << topic << std::endl;
+    THERMAL_LOG_DEBUG << "📤 [RPi4_Gateway] MQTT: " << topic;
     if (external_mqtt_callback_) {
         external_mqtt_callback_(topic, message);
     }
 }
 
+void RPi4_Gateway::handle_mesh_message(const std::string& topic, const std::string& payload) {
+    if (mesh_) {
+        mesh_->handle_message(topic, payload);
+    }
+}
+
 void RPi4_Gateway::handle_websocket_message(const std::string& message) {
-    std::cout << "📤 [RPi4_Gateway] WebSocket message" << std::endl;
+    THERMAL_LOG_DEBUG << "📤 [RPi4_Gateway] WebSocket message";
     if (external_websocket_callback_) {
         external_websocket_callback_(message);
     }
@@ -460,10 +931,18 @@ void RPi4_Gateway::set_thermal_monitoring_callback(std::function<void(const std:
 }
 
 std::vector<SensorStatistics> RPi4_Gateway::get_sensor_statistics() const {
-    if (data_processor_) {
-        return data_processor_->get_all_statistics();
+    if (!data_processor_) {
+        return {};
     }
-    return {};
+    
+    // Replicas held for failover are reported by their owners
+    auto stats = data_processor_->get_all_statistics();
+    if (mesh_) {
+        stats.erase(std::remove_if(stats.begin(), stats.end(),
+                                   [this](const SensorStatistics& s) { return !mesh_->owns(s.sensor_id); }),
+                    stats.end());
+    }
+    return stats;
 }
 
 std::vector<EdgeProcessingResult> RPi4_Gateway::get_edge_results() const {
@@ -475,19 +954,19 @@ std::vector<EdgeProcessingResult> RPi4_Gateway::get_edge_results() const {
 
 void RPi4_Gateway::update_config(const RPi4GatewayConfig& new_config) {
     config_ = new_config;
-    std::cout << "🔧 [RPi4_Gateway] Configuration updated" << std::endl;
+    THERMAL_LOG_INFO << "🔧 [RPi4_Gateway] Configuration updated";
 }
 
 void RPi4_Gateway::trigger_data_sync() {
-    std::cout << "🔄 [RPi4_Gateway] Manual data sync triggered" << std::endl;
+    THERMAL_LOG_INFO << "🔄 [RPi4_Gateway] Manual data sync triggered";
     if (data_processor_) {
         // Trigger immediate aggregation
-        std::cout << "📊 [RPi4_Gateway] Forcing data aggregation..." << std::endl;
+        THERMAL_LOG_INFO << "📊 [RPi4_Gateway] Forcing data aggregation...";
     }
 }
 
 void RPi4_Gateway::perform_system_cleanup() {
-    std::cout << "🧹 [RPi4_Gateway] Performing system cleanup..." << std::endl;
+    THERMAL_LOG_INFO << "🧹 [RPi4_Gateway] Performing system cleanup...";
     if (storage_manager_) {
         storage_manager_->cleanup_old_data();
         storage_manager_->rotate_logs();
@@ -496,10 +975,10 @@ void RPi4_Gateway::perform_system_cleanup() {
 
 void RPi4_Gateway::switch_mode(GatewayMode new_mode) {
     config_.mode = new_mode;
-    std::cout << "🔄 [RPi4_Gateway] Switched to mode: " 
-              << (new_mode == GatewayMode::COLLECTOR_ONLY ? "Collector Only" :
+    THERMAL_LOG_INFO << "🔄 [RPi4_Gateway] Switched to mode: " 
+                     << (new_mode == GatewayMode::COLLECTOR_ONLY ? "Collector Only" :
                   new_mode == GatewayMode::EDGE_PROCESSOR ? "Edge Processor" :
-                  new_mode == GatewayMode::HYBRID_BRIDGE ? "Hybrid Bridge" : "Failsafe") << std::endl;
+                  new_mode == GatewayMode::HYBRID_BRIDGE ? "Hybrid Bridge" : "Failsafe");
 }
 
 //=============================================================================
@@ -1,44 +1,239 @@
 #include "RPi4_Gateway.h"
-#include <iostream>
+#include "../../thermal-monitoring/SensorWireFormat.h"
+#include "../../thermal-monitoring/Log.h"
 #include <sstream>
 #include <iomanip>
 #include <cmath>
 #include <algorithm>
 #include <numeric>
 #include <fstream>
+#include <charconv>
+#include <cstdio>
 
 namespace rpi4_gateway {
 
+namespace {
+
+// Per-thread buffers for outbound messages: the string handed to a callback
+// is overwritten by the thread's next message, so after warm-up formatting
+// a reading allocates nothing
+struct OutboundScratch {
+    std::string message;
+    std::string batch_element;
+    std::string batch_full;
+    std::vector<uint8_t> encoded;
+    thermal_monitoring::wire::SensorRecord record;
+};
+
+OutboundScratch& outbound_scratch() {
+    thread_local OutboundScratch scratch;
+    return scratch;
+}
+
+// Per-thread buffers for state snapshot passes
+struct StateScratch {
+    std::string sensor_id;
+    std::string record;
+};
+
+StateScratch& state_scratch() {
+    thread_local StateScratch scratch;
+    return scratch;
+}
+
+// Same text as std::fixed << std::setprecision(2), without a stream
+void append_fixed(std::string& out, float value) {
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), "%.2f", value);
+    out.append(buffer, static_cast<size_t>(std::max(0, length)));
+}
+
+void append_int(std::string& out, long long value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+const char* interface_name(CommInterface interface) {
+    switch (interface) {
+        case CommInterface::UART_INTERFACE: return "UART";
+        case CommInterface::SPI_INTERFACE: return "SPI";
+        case CommInterface::I2C_INTERFACE: return "I2C";
+        default: return "UNKNOWN";
+    }
+}
+
+template <typename Duration>
+long long ticks_since_epoch(std::chrono::steady_clock::time_point time) {
+    return static_cast<long long>(std::chrono::duration_cast<Duration>(time.time_since_epoch()).count());
+}
+
+}
+
+//=============================================================================
+// SensorRegistry Implementation
+//=============================================================================
+
+SensorRegistry::SensorRegistry(const std::string& base_topic)
+    : base_topic_(base_topic), count_(0) {
+    for (auto& chunk : chunks_) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+SensorRegistry::~SensorRegistry() {
+    for (auto& chunk : chunks_) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+SensorHandle SensorRegistry::intern(const std::string& sensor_id) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = by_id_.find(sensor_id);
+        if (it != by_id_.end()) {
+            return it->second;
+        }
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_id_.find(sensor_id);
+    if (it != by_id_.end()) {
+        return it->second;
+    }
+    return add_locked(sensor_id, std::string());
+}
+
+SensorHandle SensorRegistry::intern_node(CommInterface interface, uint32_t node_number,
+                                         const char* id_prefix, const std::string& location) {
+    uint64_t key = (static_cast<uint64_t>(interface) << 32) | node_number;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = by_node_.find(key);
+        if (it != by_node_.end()) {
+            return it->second;
+        }
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_node_.find(key);
+    if (it != by_node_.end()) {
+        return it->second;
+    }
+    
+    std::string sensor_id = id_prefix + std::to_string(node_number);
+    auto existing = by_id_.find(sensor_id);
+    SensorHandle handle = existing != by_id_.end() ? existing->second : add_locked(sensor_id, location);
+    if (handle != INVALID_SENSOR_HANDLE) {
+        by_node_[key] = handle;
+    }
+    return handle;
+}
+
+SensorHandle SensorRegistry::find(const std::string& sensor_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_id_.find(sensor_id);
+    return it != by_id_.end() ? it->second : INVALID_SENSOR_HANDLE;
+}
+
+SensorHandle SensorRegistry::add_locked(const std::string& sensor_id, const std::string& location) {
+    size_t index = count_.load(std::memory_order_relaxed);
+    if (index >= CHUNK_SIZE * MAX_CHUNKS) {
+        THERMAL_LOG_ERROR << "❌ [SensorRegistry] Sensor limit reached, rejecting " << sensor_id;
+        return INVALID_SENSOR_HANDLE;
+    }
+    
+    auto& chunk = chunks_[index / CHUNK_SIZE];
+    if (!chunk.load(std::memory_order_relaxed)) {
+        chunk.store(new SensorInfo[CHUNK_SIZE], std::memory_order_release);
+    }
+    
+    SensorHandle handle = static_cast<SensorHandle>(index);
+    SensorInfo& info = chunk.load(std::memory_order_relaxed)[index % CHUNK_SIZE];
+    std::string prefix = base_topic_ + "/sensors/" + sensor_id;
+    info.handle = handle;
+    info.sensor_id = sensor_id;
+    info.location = location;
+    info.data_topic = prefix + "/data";
+    info.binary_topic = prefix + "/bin";
+    info.aggregated_topic = prefix + "/aggregated";
+    
+    by_id_[sensor_id] = handle;
+    count_.store(index + 1, std::memory_order_release);
+    return handle;
+}
+
 //=============================================================================
 // DataProcessor Implementation
 //=============================================================================
 
 DataProcessor::DataProcessor(const RPi4GatewayConfig& config)
-    : config_(config), running_(false), edge_analytics_enabled_(config.enable_edge_analytics) {
-    std::cout << "🧠 [DataProcessor] Created with " << config_.worker_thread_count 
-              << " worker threads" << std::endl;
+    : config_(config), clock_(thermal_monitoring::Clock::steady()), running_(false),
+      registry_(std::make_shared<SensorRegistry>(config.mqtt_base_topic)),
+      edge_analytics_enabled_(config.enable_edge_analytics),
+      processing_seconds_(thermal_monitoring::metrics::Registry::global().histogram(
+          "thermal_gateway_packet_processing_seconds", "Worker time to process one sensor packet",
+          thermal_monitoring::metrics::latency_buckets_seconds(),
+          thermal_monitoring::metrics::label("gateway", config.gateway_id))),
+      alerts_raised_(thermal_monitoring::metrics::Registry::global().counter(
+          "thermal_gateway_alerts_total", "Sensor alerts raised by the data processor",
+          thermal_monitoring::metrics::label("gateway", config.gateway_id))) {
+    // max_queue_size bounds the total across partitions
+    size_t partition_count = config_.partition_workers_by_sensor ?
+        static_cast<size_t>(std::max(1, config_.worker_thread_count)) : 1;
+    size_t total_capacity = static_cast<size_t>(std::max(1, config_.max_queue_size));
+    size_t partition_capacity = std::max<size_t>(1, total_capacity / partition_count);
+    for (size_t i = 0; i < partition_count; ++i) {
+        partitions_.push_back(std::make_unique<SensorPartition>(i, partition_capacity));
+    }
+    batch_topic_ = config_.mqtt_base_topic + "/batch";
+    batch_payload_.reserve(config_.batch_max_bytes);
+    edge_journal_.resize(EDGE_RESULTS_HISTORY);
+    
+    THERMAL_LOG_INFO << "🧠 [DataProcessor] Created with " << config_.worker_thread_count 
+                     << " worker threads";
 }
 
 DataProcessor::~DataProcessor() {
     stop();
-    std::cout << "🧠 [DataProcessor] Destroyed" << std::endl;
+    THERMAL_LOG_INFO << "🧠 [DataProcessor] Destroyed";
 }
 
 bool DataProcessor::initialize() {
-    std::cout << "🚀 [DataProcessor] Initializing..." << std::endl;
+    THERMAL_LOG_INFO << "🚀 [DataProcessor] Initializing...";
     
     // Initialize data structures
-    sensor_history_.clear();
-    sensor_stats_.clear();
-    edge_results_.clear();
+    for (auto& partition : partitions_) {
+        std::lock_guard<std::mutex> lock(partition->mutex);
+        partition->sensor_history.clear();
+        partition->sensor_stats.clear();
+        partition->state_dirty.clear();
+        partition->last_aggregation = clock_->now();
+        partition->last_state_snapshot = clock_->now();
+    }
+    {
+        std::lock_guard<std::mutex> lock(edge_results_mutex_);
+        edge_results_journaled_ = 0;
+    }
     
-    std::cout << "✅ [DataProcessor] Initialized successfully" << std::endl;
+    if (!config_.state_snapshot_path.empty() && !state_store_) {
+        size_t history_capacity = static_cast<size_t>(std::max(1, config_.max_sensor_history));
+        state_store_ = std::make_unique<thermal_monitoring::StateSnapshotFile>(
+            config_.state_snapshot_path, sensor_state::FORMAT_VERSION, sensor_state::max_encoded_size(history_capacity));
+        if (state_store_->open()) {
+            restore_state_snapshot();
+        } else {
+            state_store_.reset();
+        }
+    }
+    
+    THERMAL_LOG_INFO << "✅ [DataProcessor] Initialized successfully";
     return true;
 }
 
 bool DataProcessor::start() {
     if (running_.load()) {
-        std::cout << "⚠️ [DataProcessor] Already running" << std::endl;
+        THERMAL_LOG_WARN << "⚠️ [DataProcessor] Already running";
         return true;
     }
     
@@ -47,11 +242,12 @@ bool DataProcessor::start() {
     // Start worker threads
     worker_threads_.clear();
     for (int i = 0; i < config_.worker_thread_count; ++i) {
-        worker_threads_.emplace_back(&DataProcessor::worker_loop, this);
+        worker_threads_.emplace_back(&DataProcessor::worker_loop, this, 
+                                     static_cast<size_t>(i) % partitions_.size());
     }
     
-    std::cout << "🚀 [DataProcessor] Started with " << config_.worker_thread_count 
-              << " worker threads" << std::endl;
+    THERMAL_LOG_INFO << "🚀 [DataProcessor] Started with " << config_.worker_thread_count 
+                     << " worker threads over " << partitions_.size() << " partition(s)";
     return true;
 }
 
@@ -60,11 +256,14 @@ void DataProcessor::stop() {
         return;
     }
     
-    std::cout << "🛑 [DataProcessor] Stopping..." << std::endl;
+    THERMAL_LOG_INFO << "🛑 [DataProcessor] Stopping...";
     running_ = false;
     
     // Wake up all worker threads
-    queue_cv_.notify_all();
+    for (auto& partition : partitions_) {
+        std::lock_guard<std::mutex> lock(partition->idle_mutex);
+        partition->idle_cv.notify_all();
+    }
     
     // Wait for all threads to finish
     for (auto& thread : worker_threads_) {
@@ -74,35 +273,98 @@ void DataProcessor::stop() {
     }
     worker_threads_.clear();
     
-    std::cout << "✅ [DataProcessor] Stopped" << std::endl;
+    // Nothing buffered for the broker is left behind
+    flush_batch(true);
+    save_state_snapshot();
+    
+    THERMAL_LOG_INFO << "✅ [DataProcessor] Stopped";
 }
 
 void DataProcessor::process_packet(const SensorDataPacket& packet) {
+    process_packet(SensorDataPacket(packet));
+}
+
+void DataProcessor::process_packet(SensorDataPacket&& packet) {
     if (!running_.load()) {
         return;
     }
     
-    // Add packet to processing queue
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        if (processing_queue_.size() >= static_cast<size_t>(config_.max_queue_size)) {
-            std::cout << "⚠️ [DataProcessor] Queue full, dropping packet from " 
-                      << packet.sensor_id << std::endl;
+    // One string lookup at ingest; everything downstream indexes by handle
+    if (packet.sensor_handle == INVALID_SENSOR_HANDLE) {
+        packet.sensor_handle = registry_->intern(packet.sensor_id);
+        if (packet.sensor_handle == INVALID_SENSOR_HANDLE) {
+            dropped_packets_.fetch_add(1, std::memory_order_relaxed);
             return;
         }
-        processing_queue_.push(packet);
     }
     
-    // Notify worker threads
-    queue_cv_.notify_one();
+    SensorPartition& partition = partition_for(packet.sensor_handle);
+    
+    // Shed the newest packet when full; the bound is enforced by the queue itself.
+    // On success the caller's packet comes back holding a spent one to refill
+    if (!partition.queue.try_push(std::move(packet))) {
+        uint64_t dropped = dropped_packets_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (dropped == 1 || dropped % 1000 == 0) {
+            THERMAL_LOG_WARN << "⚠️ [DataProcessor] Ingest queue full, " << dropped 
+                             << " packets dropped so far";
+        }
+        return;
+    }
+    enqueued_packets_.fetch_add(1, std::memory_order_relaxed);
+    
+    size_t depth = partition.queue.size();
+    size_t high_water = queue_high_water_.load(std::memory_order_relaxed);
+    while (depth > high_water &&
+           !queue_high_water_.compare_exchange_weak(high_water, depth, std::memory_order_relaxed)) {
+    }
+    
+    wake_idle_worker(partition);
+}
+
+DataProcessor::SensorPartition& DataProcessor::partition_for(SensorHandle handle) const {
+    return *partitions_[handle % partitions_.size()];
+}
+
+void DataProcessor::wake_idle_worker(SensorPartition& partition) {
+    if (partition.idle_workers.load() > 0) {
+        std::lock_guard<std::mutex> lock(partition.idle_mutex);
+        partition.idle_cv.notify_one();
+    }
+}
+
+IngestQueueStats DataProcessor::get_queue_stats() const {
+    IngestQueueStats stats;
+    stats.capacity = 0;
+    stats.depth = 0;
+    for (const auto& partition : partitions_) {
+        stats.capacity += partition->queue.capacity();
+        stats.depth += partition->queue.size();
+    }
+    stats.high_water_mark = queue_high_water_.load(std::memory_order_relaxed);
+    stats.enqueued_packets = enqueued_packets_.load(std::memory_order_relaxed);
+    stats.dropped_packets = dropped_packets_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+PublishStats DataProcessor::get_publish_stats() const {
+    PublishStats stats;
+    stats.messages_published = messages_published_.load(std::memory_order_relaxed);
+    stats.readings_batched = readings_batched_.load(std::memory_order_relaxed);
+    stats.readings_suppressed = readings_suppressed_.load(std::memory_order_relaxed);
+    stats.alerts_forwarded = alerts_forwarded_.load(std::memory_order_relaxed);
+    return stats;
 }
 
 SensorStatistics DataProcessor::get_sensor_statistics(const std::string& sensor_id) const {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    auto it = sensor_stats_.find(sensor_id);
-    if (it != sensor_stats_.end()) {
-        return it->second;
+    SensorHandle handle = registry_->find(sensor_id);
+    if (handle != INVALID_SENSOR_HANDLE) {
+        const SensorPartition& partition = partition_for(handle);
+        size_t slot = slot_for(handle);
+        
+        std::lock_guard<std::mutex> lock(partition.mutex);
+        if (slot < partition.sensor_stats.size() && !partition.sensor_stats[slot].sensor_id.empty()) {
+            return partition.sensor_stats[slot];
+        }
     }
     
     // Return empty statistics if sensor not found
@@ -112,24 +374,37 @@ SensorStatistics DataProcessor::get_sensor_statistics(const std::string& sensor_
 }
 
 std::vector<SensorStatistics> DataProcessor::get_all_statistics() const {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
+    // Merge the partitions one at a time so workers are held up only briefly
     std::vector<SensorStatistics> stats;
-    for (const auto& pair : sensor_stats_) {
-        stats.push_back(pair.second);
+    for (const auto& partition : partitions_) {
+        std::lock_guard<std::mutex> lock(partition->mutex);
+        for (const auto& sensor_stats : partition->sensor_stats) {
+            if (!sensor_stats.sensor_id.empty()) {
+                stats.push_back(sensor_stats);
+            }
+        }
     }
     
     return stats;
 }
 
 std::vector<EdgeProcessingResult> DataProcessor::get_recent_edge_results(int count) const {
-    std::lock_guard<std::mutex> lock(edge_results_mutex_);
+    // Copy the records out, then render them without holding the journal
+    std::vector<EdgeRecord> records;
+    {
+        std::lock_guard<std::mutex> lock(edge_results_mutex_);
+        uint64_t stored = std::min<uint64_t>(edge_results_journaled_, edge_journal_.size());
+        uint64_t wanted = std::min<uint64_t>(stored, static_cast<uint64_t>(std::max(0, count)));
+        records.reserve(wanted);
+        for (uint64_t i = edge_results_journaled_ - wanted; i < edge_results_journaled_; ++i) {
+            records.push_back(edge_journal_[i % edge_journal_.size()]);
+        }
+    }
     
     std::vector<EdgeProcessingResult> results;
-    int start_index = std::max(0, static_cast<int>(edge_results_.size()) - count);
-    
-    for (int i = start_index; i < static_cast<int>(edge_results_.size()); ++i) {
-        results.push_back(edge_results_[i]);
+    results.reserve(records.size());
+    for (const EdgeRecord& record : records) {
+        results.push_back(render_edge_result(record));
     }
     
     return results;
@@ -147,92 +422,296 @@ void DataProcessor::set_alert_callback(std::function<void(const std::string&, co
     alert_callback_ = callback;
 }
 
-void DataProcessor::worker_loop() {
-    std::cout << "🏃 [DataProcessor] Worker thread started" << std::endl;
+void DataProcessor::set_clock(std::shared_ptr<thermal_monitoring::Clock> clock) {
+    clock_ = clock ? std::move(clock) : thermal_monitoring::Clock::steady();
+}
+
+bool DataProcessor::export_sensor_state(const std::string& sensor_id, std::string& out) const {
+    SensorHandle handle = registry_->find(sensor_id);
+    if (handle == INVALID_SENSOR_HANDLE) {
+        return false;
+    }
     
-    while (running_.load()) {
-        SensorDataPacket packet;
-        bool has_packet = false;
-        
-        // Get packet from queue
+    const SensorPartition& partition = partition_for(handle);
+    size_t slot = slot_for(handle);
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    if (slot >= partition.sensor_stats.size() || partition.sensor_stats[slot].sensor_id.empty()) {
+        return false;
+    }
+    sensor_state::encode(partition.sensor_stats[slot], partition.sensor_history[slot], clock_->now(), out);
+    return true;
+}
+
+bool DataProcessor::import_sensor_state(const uint8_t* data, size_t length) {
+    // Decode outside the partition lock; only the swap happens under it
+    SensorStatistics stats = {};
+    SensorHistory history;
+    if (!sensor_state::decode(data, length, clock_->now(),
+                              static_cast<size_t>(std::max(1, config_.max_sensor_history)), stats, history)) {
+        THERMAL_LOG_WARN << "⚠️ [DataProcessor] Rejected malformed sensor state (" << length << " bytes)";
+        return false;
+    }
+    
+    SensorHandle handle = registry_->intern(stats.sensor_id);
+    if (handle == INVALID_SENSOR_HANDLE) {
+        return false;
+    }
+    
+    SensorPartition& partition = partition_for(handle);
+    size_t slot = slot_for(handle);
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    resize_slots(partition, slot);
+    
+    SensorStatistics& current = partition.sensor_stats[slot];
+    if (!current.sensor_id.empty() && current.total_packets > stats.total_packets) {
+        return false;
+    }
+    current = std::move(stats);
+    partition.sensor_history[slot] = std::move(history);
+    partition.state_dirty[slot] = 1;
+    return true;
+}
+
+void DataProcessor::forget_sensor(const std::string& sensor_id) {
+    SensorHandle handle = registry_->find(sensor_id);
+    if (handle == INVALID_SENSOR_HANDLE) {
+        return;
+    }
+    
+    SensorPartition& partition = partition_for(handle);
+    size_t slot = slot_for(handle);
+    {
+        std::lock_guard<std::mutex> lock(partition.mutex);
+        if (slot < partition.sensor_stats.size()) {
+            partition.sensor_stats[slot] = SensorStatistics();
+            partition.sensor_history[slot] = SensorHistory();
+            partition.state_dirty[slot] = 0;
+        }
+    }
+    if (state_store_) {
+        state_store_->erase(sensor_id);
+    }
+}
+
+void DataProcessor::record_replica(SensorDataPacket&& packet) {
+    if (!packet.is_valid) {
+        return;
+    }
+    if (packet.sensor_handle == INVALID_SENSOR_HANDLE) {
+        packet.sensor_handle = registry_->intern(packet.sensor_id);
+        if (packet.sensor_handle == INVALID_SENSOR_HANDLE) {
+            return;
+        }
+    }
+    
+    SensorPartition& partition = partition_for(packet.sensor_handle);
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    record_reading(partition, packet);
+}
+
+void DataProcessor::save_state_snapshot() {
+    if (!state_store_) {
+        return;
+    }
+    for (auto& partition : partitions_) {
+        save_partition_state(*partition, true);
+    }
+    state_store_->sync(true);
+}
+
+thermal_monitoring::StateSnapshotFile::Stats DataProcessor::get_state_snapshot_stats() const {
+    return state_store_ ? state_store_->get_stats() : thermal_monitoring::StateSnapshotFile::Stats();
+}
+
+void DataProcessor::restore_state_snapshot() {
+    // Same path as a mesh handoff, so the rebasing and sizing rules match
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::string> unreadable;
+    size_t restored = state_store_->load([&](std::string_view sensor_id, const uint8_t* record, size_t length) {
+        if (!import_sensor_state(record, length)) {
+            unreadable.emplace_back(sensor_id);
+        }
+    });
+    for (const std::string& sensor_id : unreadable) {
+        state_store_->erase(sensor_id);
+    }
+    
+    // Restored sensors are already on disk as they are
+    for (auto& partition : partitions_) {
+        std::lock_guard<std::mutex> lock(partition->mutex);
+        std::fill(partition->state_dirty.begin(), partition->state_dirty.end(), 0);
+    }
+    
+    restored -= unreadable.size();
+    if (restored > 0 || !unreadable.empty()) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+        THERMAL_LOG_INFO << "♻️ [DataProcessor] Restored " << restored << " sensors from " << state_store_->path()
+                         << " in " << std::fixed << std::setprecision(1) << elapsed.count() / 1000.0 << " ms";
+    }
+}
+
+// Writes the partition's changed sensors once state_snapshot_interval_ms has
+// passed since its last pass (or always with force)
+void DataProcessor::save_partition_state(SensorPartition& partition, bool force) {
+    if (!state_store_) {
+        return;
+    }
+    
+    // Workers sharing a partition skip a pass another one is running
+    std::unique_lock<std::mutex> pass(partition.state_snapshot_mutex, std::defer_lock);
+    if (force) {
+        pass.lock();
+    } else if (!pass.try_lock()) {
+        return;
+    }
+    auto now = clock_->now();
+    if (!force && now - partition.last_state_snapshot < std::chrono::milliseconds(config_.state_snapshot_interval_ms)) {
+        return;
+    }
+    partition.last_state_snapshot = now;
+    
+    // One sensor per lock hold: encode under the lock, copy into the mapping outside it
+    StateScratch& scratch = state_scratch();
+    size_t saved = 0;
+    for (size_t slot = 0;; ++slot) {
         {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            queue_cv_.wait(lock, [this] { return !processing_queue_.empty() || !running_.load(); });
-            
-            if (!running_.load()) {
+            std::lock_guard<std::mutex> lock(partition.mutex);
+            const size_t slots = partition.state_dirty.size();
+            while (slot < slots && !(partition.state_dirty[slot] && !partition.sensor_stats[slot].sensor_id.empty())) {
+                partition.state_dirty[slot] = 0;
+                ++slot;
+            }
+            if (slot == slots) {
                 break;
             }
-            
-            if (!processing_queue_.empty()) {
-                packet = processing_queue_.front();
-                processing_queue_.pop();
-                has_packet = true;
+            partition.state_dirty[slot] = 0;
+            scratch.sensor_id.assign(partition.sensor_stats[slot].sensor_id);
+            sensor_state::encode(partition.sensor_stats[slot], partition.sensor_history[slot], now, scratch.record);
+        }
+        saved += state_store_->put(scratch.sensor_id, scratch.record);
+    }
+    
+    if (saved > 0) {
+        state_store_->sync();
+        THERMAL_LOG_DEBUG << "💾 [DataProcessor] Saved state of " << saved << " sensors from partition "
+                          << partition.index;
+    }
+}
+
+void DataProcessor::worker_loop(size_t partition_index) {
+    SensorPartition& partition = *partitions_[partition_index];
+    THERMAL_LOG_INFO << "🏃 [DataProcessor] Worker thread started";
+    
+    // Slots are swapped with queue cells and never destroyed, so the packets'
+    // strings keep circulating between producers, the queue and this worker
+    const size_t batch_size = static_cast<size_t>(std::max(1, config_.ingest_batch_size));
+    std::vector<SensorDataPacket> batch(batch_size);
+    
+    while (running_.load()) {
+        size_t taken = partition.queue.try_pop_batch(batch.data(), batch_size);
+        if (taken == 0) {
+            // Park until a producer sees us idle; the timeout covers a push
+            // that raced with the idle count going up
+            partition.idle_workers.fetch_add(1);
+            {
+                std::unique_lock<std::mutex> lock(partition.idle_mutex);
+                partition.idle_cv.wait_for(lock, std::chrono::milliseconds(50), [this, &partition] {
+                    return !partition.queue.empty() || !running_.load();
+                });
             }
+            partition.idle_workers.fetch_sub(1);
+            flush_batch(false); // Honours the batch latency budget while idle
+            save_partition_state(partition, false);
+            continue;
         }
         
-        if (has_packet) {
-            process_packet_internal(packet);
+        for (size_t i = 0; i < taken; ++i) {
+            thermal_monitoring::metrics::ScopedTimer timer(processing_seconds_);
+            process_packet_internal(partition, batch[i]);
+        }
+        flush_batch(false);
+        save_partition_state(partition, false);
+        
+        // More work than one batch: let another idle worker share it
+        if (taken == batch_size) {
+            wake_idle_worker(partition);
         }
     }
     
-    std::cout << "🏁 [DataProcessor] Worker thread finished" << std::endl;
+    THERMAL_LOG_INFO << "🏁 [DataProcessor] Worker thread finished";
 }
 
-void DataProcessor::process_packet_internal(const SensorDataPacket& packet) {
+void DataProcessor::process_packet_internal(SensorPartition& partition, const SensorDataPacket& packet) {
     if (!packet.is_valid) {
-        std::cout << "⚠️ [DataProcessor] Ignoring invalid packet from " << packet.sensor_id << std::endl;
+        THERMAL_LOG_WARN << "⚠️ [DataProcessor] Ignoring invalid packet from " << packet.sensor_id;
         return;
     }
     
-    // Update statistics
-    update_statistics(packet);
-    
-    // Store in history
+    // Update statistics and store in history
     {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        auto& history = sensor_history_[packet.sensor_id];
-        history.push_back(packet);
-        
-        // Limit history size
-        if (history.size() > static_cast<size_t>(config_.max_sensor_history)) {
-            history.erase(history.begin());
-        }
+        std::lock_guard<std::mutex> lock(partition.mutex);
+        record_reading(partition, packet);
     }
     
     // Check for alerts
-    check_alerts(packet);
+    bool alerted = check_alerts(packet);
     
     // Perform edge analytics
     if (edge_analytics_enabled_.load()) {
-        perform_edge_analytics(packet);
+        perform_edge_analytics(partition, packet);
     }
     
-    // Forward to MQTT
-    if (mqtt_callback_) {
-        std::string topic = config_.mqtt_base_topic + "/sensors/" + packet.sensor_id + "/data";
-        std::string message = format_mqtt_message(packet);
-        mqtt_callback_(topic, message);
-    }
+    // Forward to MQTT according to the processing strategy
+    forward_packet(partition, packet, alerted);
     
     // Forward to WebSocket
     if (websocket_callback_) {
-        std::string message = format_websocket_message(packet);
+        std::string& message = outbound_scratch().message;
+        format_websocket_message(packet, message);
         websocket_callback_(message);
     }
     
-    // Periodic aggregation
-    static auto last_aggregation = std::chrono::steady_clock::now();
-    auto now = std::chrono::steady_clock::now();
-    if (now - last_aggregation >= std::chrono::seconds(config_.aggregation_window_seconds)) {
-        aggregate_and_forward();
-        last_aggregation = now;
+    // Periodic aggregation, per partition
+    aggregate_and_forward(partition);
+}
+
+// Caller holds partition.mutex
+void DataProcessor::resize_slots(SensorPartition& partition, size_t slot) {
+    if (slot >= partition.sensor_history.size()) {
+        partition.sensor_history.resize(slot + 1);
+        partition.sensor_stats.resize(slot + 1);
+        partition.state_dirty.resize(slot + 1);
     }
 }
 
-void DataProcessor::update_statistics(const SensorDataPacket& packet) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
+// Caller holds partition.mutex
+void DataProcessor::record_reading(SensorPartition& partition, const SensorDataPacket& packet) {
+    size_t slot = slot_for(packet.sensor_handle);
+    resize_slots(partition, slot);
+    partition.state_dirty[slot] = 1;
     
-    auto& stats = sensor_stats_[packet.sensor_id];
+    update_statistics(partition, packet);
+    
+    auto& history = partition.sensor_history[slot];
+    if (history.samples.capacity() == 0) {
+        history.samples.reset(static_cast<size_t>(std::max(1, config_.max_sensor_history)));
+        history.temperature_window.reset(history.samples.capacity());
+    }
+    
+    // Fixed capacity: the oldest sample is overwritten once full
+    history.location = packet.location;
+    if (history.samples.full()) {
+        history.temperature_window.remove_oldest(history.samples.value<SensorHistory::TEMPERATURE>(0));
+    }
+    history.temperature_window.add(packet.temperature_celsius);
+    history.samples.push(packet.timestamp, packet.temperature_celsius, packet.humidity_percent,
+                         packet.pressure_hpa, static_cast<uint8_t>(packet.is_valid));
+}
+
+// Caller holds partition.mutex and has sized the slot arrays
+void DataProcessor::update_statistics(SensorPartition& partition, const SensorDataPacket& packet) {
+    size_t slot = slot_for(packet.sensor_handle);
+    auto& stats = partition.sensor_stats[slot];
     
     // Initialize if first packet
     if (stats.sensor_id.empty()) {
@@ -262,21 +741,20 @@ void DataProcessor::update_statistics(const SensorDataPacket& packet) {
         stats.min_temperature = std::min(stats.min_temperature, packet.temperature_celsius);
         stats.max_temperature = std::max(stats.max_temperature, packet.temperature_celsius);
         
-        // Calculate running average (simplified)
-        stats.avg_temperature = (stats.avg_temperature * (stats.valid_packets - 1) + 
-                                packet.temperature_celsius) / stats.valid_packets;
-        stats.avg_humidity = (stats.avg_humidity * (stats.valid_packets - 1) + 
-                             packet.humidity_percent) / stats.valid_packets;
+        // Welford running statistics over all valid packets
+        auto& history = partition.sensor_history[slot];
+        history.temperature_lifetime.add(packet.temperature_celsius);
+        history.humidity_lifetime.add(packet.humidity_percent);
         
-        // Calculate standard deviation (simplified)
-        // In a real implementation, you'd use a more sophisticated approach
-        stats.temperature_stddev = std::abs(packet.temperature_celsius - stats.avg_temperature);
+        stats.avg_temperature = static_cast<float>(history.temperature_lifetime.mean());
+        stats.avg_humidity = static_cast<float>(history.humidity_lifetime.mean());
+        stats.temperature_stddev = static_cast<float>(history.temperature_lifetime.stddev());
     }
     
     stats.last_update = packet.timestamp;
 }
 
-void DataProcessor::check_alerts(const SensorDataPacket& packet) {
+bool DataProcessor::check_alerts(const SensorDataPacket& packet) {
     std::vector<std::string> alerts;
     
     // Temperature alerts
@@ -306,68 +784,221 @@ void DataProcessor::check_alerts(const SensorDataPacket& packet) {
     }
     
     // Send alerts
+    if (!alerts.empty()) {
+        alerts_raised_.inc(alerts.size());
+    }
     for (const auto& alert : alerts) {
         if (alert_callback_) {
             alert_callback_("SENSOR_ALERT", packet.sensor_id + ": " + alert);
         }
-        std::cout << "🚨 [DataProcessor] ALERT - " << packet.sensor_id << ": " << alert << std::endl;
+        THERMAL_LOG_INFO << "🚨 [DataProcessor] ALERT - " << packet.sensor_id << ": " << alert;
     }
+    return !alerts.empty();
 }
 
-void DataProcessor::perform_edge_analytics(const SensorDataPacket& packet) {
-    // Get sensor history for analysis
-    std::vector<SensorDataPacket> history;
-    {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        auto it = sensor_history_.find(packet.sensor_id);
-        if (it != sensor_history_.end()) {
-            history = it->second;
-        }
+//-----------------------------------------------------------------------------
+// Outbound strategy
+//-----------------------------------------------------------------------------
+
+void DataProcessor::forward_packet(SensorPartition& partition, const SensorDataPacket& packet, bool alerted) {
+    if (!mqtt_callback_) {
+        return;
     }
     
-    if (history.size() < 5) {
-        return; // Need at least 5 data points for meaningful analysis
+    switch (config_.processing_strategy) {
+        case ProcessingStrategy::AGGREGATE_BATCH:
+            // Alerting readings skip the batch so they are not delayed
+            if (alerted) {
+                alerts_forwarded_.fetch_add(1, std::memory_order_relaxed);
+                publish_packet(packet);
+            } else {
+                append_to_batch(packet);
+            }
+            break;
+            
+        case ProcessingStrategy::SMART_FILTER:
+            if (passes_deadband(partition, packet, alerted)) {
+                if (alerted) {
+                    alerts_forwarded_.fetch_add(1, std::memory_order_relaxed);
+                }
+                publish_packet(packet);
+            } else {
+                readings_suppressed_.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+            
+        default:
+            publish_packet(packet);
+            break;
+    }
+}
+
+// One message per reading on the topics cached at registration
+void DataProcessor::publish_packet(const SensorDataPacket& packet) {
+    const SensorInfo& info = registry_->info(packet.sensor_handle);
+    std::string& message = outbound_scratch().message;
+    if (config_.mqtt_binary_payloads) {
+        format_binary_mqtt_message(packet, message);
+        mqtt_callback_(info.binary_topic, message);
+    } else {
+        format_mqtt_message(packet, message);
+        mqtt_callback_(info.data_topic, message);
     }
+    messages_published_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool DataProcessor::passes_deadband(SensorPartition& partition, const SensorDataPacket& packet, bool alerted) {
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    SensorHistory& history = partition.sensor_history[slot_for(packet.sensor_handle)];
     
-    EdgeProcessingResult result;
-    result.sensor_id = packet.sensor_id;
-    result.analysis_type = "trend_analysis";
-    result.processed_at = std::chrono::steady_clock::now();
+    bool publish = alerted || !history.has_published ||
+        std::abs(packet.temperature_celsius - history.published_temperature) >= config_.deadband_temperature_c ||
+        std::abs(packet.humidity_percent - history.published_humidity) >= config_.deadband_humidity_percent ||
+        packet.timestamp - history.published_at >= std::chrono::seconds(config_.deadband_max_silence_seconds);
     
-    // Calculate temperature trend
-    std::vector<float> temperatures;
-    for (const auto& h : history) {
-        temperatures.push_back(h.temperature_celsius);
+    if (publish) {
+        history.has_published = true;
+        history.published_temperature = packet.temperature_celsius;
+        history.published_humidity = packet.humidity_percent;
+        history.published_at = packet.timestamp;
+        partition.state_dirty[slot_for(packet.sensor_handle)] = 1;
     }
+    return publish;
+}
+
+void DataProcessor::append_to_batch(const SensorDataPacket& packet) {
+    OutboundScratch& scratch = outbound_scratch();
+    std::string& element = scratch.batch_element;
+    element.assign("{\"sensor_id\":\"").append(packet.sensor_id);
+    element.append("\",\"location\":\"").append(packet.location);
+    element.append("\",\"timestamp\":");
+    append_int(element, ticks_since_epoch<std::chrono::milliseconds>(packet.timestamp));
+    element.append(",\"temperature\":");
+    append_fixed(element, packet.temperature_celsius);
+    element.append(",\"humidity\":");
+    append_fixed(element, packet.humidity_percent);
+    element.append(",\"pressure\":");
+    append_fixed(element, packet.pressure_hpa);
+    element.append(",\"supply_voltage\":");
+    append_fixed(element, packet.supply_voltage);
+    element.append(",\"sensor_status\":");
+    append_int(element, packet.sensor_status);
+    element.push_back('}');
     
-    // Simple linear regression for trend
-    float n = static_cast<float>(temperatures.size());
-    float sum_x = n * (n - 1) / 2.0f;
-    float sum_y = std::accumulate(temperatures.begin(), temperatures.end(), 0.0f);
-    float sum_xy = 0.0f;
-    float sum_x2 = 0.0f;
+    // A full batch is swapped into this thread's spare buffer, whose old
+    // capacity becomes the next batch's
+    std::string& full_payload = scratch.batch_full;
+    size_t full_readings = 0;
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex_);
+        
+        // Hand off what is pending if this reading would overrun the size budget
+        if (batch_readings_ > 0 && batch_payload_.size() + element.size() + 16 > config_.batch_max_bytes) {
+            full_readings = batch_readings_;
+            full_payload.swap(batch_payload_);
+            batch_readings_ = 0;
+        }
+        
+        if (batch_readings_ == 0) {
+            batch_started_ = clock_->now();
+            batch_payload_.assign("{\"gateway_id\":\"").append(config_.gateway_id).append("\",\"readings\":[");
+        } else {
+            batch_payload_ += ',';
+        }
+        batch_payload_ += element;
+        batch_readings_++;
+    }
     
-    for (size_t i = 0; i < temperatures.size(); ++i) {
-        float x = static_cast<float>(i);
-        float y = temperatures[i];
-        sum_xy += x * y;
-        sum_x2 += x * x;
+    if (full_readings > 0) {
+        publish_batch(full_payload, full_readings);
+    }
+}
+
+void DataProcessor::flush_batch(bool force) {
+    if (!mqtt_callback_) {
+        return;
     }
     
-    float slope = (n * sum_xy - sum_x * sum_y) / (n * sum_x2 - sum_x * sum_x);
-    float intercept = (sum_y - slope * sum_x) / n;
+    std::string& payload = outbound_scratch().batch_full;
+    size_t readings = 0;
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex_);
+        if (batch_readings_ == 0 ||
+            (!force && batch_payload_.size() < config_.batch_max_bytes &&
+             clock_->now() - batch_started_ < 
+                 std::chrono::milliseconds(config_.batch_max_latency_ms))) {
+            return;
+        }
+        readings = batch_readings_;
+        payload.swap(batch_payload_);
+        batch_readings_ = 0;
+    }
+    publish_batch(payload, readings);
+}
+
+void DataProcessor::publish_batch(std::string& payload, size_t readings) {
+    payload.append("],\"count\":");
+    append_int(payload, static_cast<long long>(readings));
+    payload.push_back('}');
+    mqtt_callback_(batch_topic_, payload);
+    messages_published_.fetch_add(1, std::memory_order_relaxed);
+    readings_batched_.fetch_add(readings, std::memory_order_relaxed);
+}
+
+void DataProcessor::perform_edge_analytics(SensorPartition& partition, const SensorDataPacket& packet) {
+    EdgeRecord record;
+    record.sensor = packet.sensor_handle;
+    record.temperature = packet.temperature_celsius;
+    record.humidity = packet.humidity_percent;
+    record.processed_at = clock_->now();
     
-    result.metrics["temperature_trend_slope"] = slope;
-    result.metrics["temperature_trend_intercept"] = intercept;
-    result.metrics["temperature_current"] = packet.temperature_celsius;
-    result.metrics["humidity_current"] = packet.humidity_percent;
+    // Linear regression for trend, maintained incrementally per packet
+    size_t history_size = 0;
+    {
+        std::lock_guard<std::mutex> lock(partition.mutex);
+        size_t slot = slot_for(packet.sensor_handle);
+        if (slot < partition.sensor_history.size()) {
+            history_size = partition.sensor_history[slot].samples.size();
+        }
+        
+        if (history_size < 5) {
+            return; // Need at least 5 data points for meaningful analysis
+        }
+        
+        const SensorHistory& history = partition.sensor_history[slot];
+        record.slope = static_cast<float>(history.temperature_window.slope());
+        record.intercept = static_cast<float>(history.temperature_window.intercept());
+    }
     
     // Calculate confidence based on data quality
-    result.confidence_score = std::min(1.0f, packet.data_confidence * (history.size() / 10.0f));
+    record.confidence = std::min(1.0f, packet.data_confidence * (history_size / 10.0f));
+    
+    // Journal the numbers; names, alerts and recommendations are rendered on request
+    {
+        std::lock_guard<std::mutex> lock(edge_results_mutex_);
+        edge_journal_[edge_results_journaled_ % edge_journal_.size()] = record;
+        edge_results_journaled_++;
+    }
+    
+    THERMAL_LOG_DEBUG << "🤖 [DataProcessor] Edge analysis completed for " << packet.sensor_id 
+                      << " (trend slope: " << record.slope << ")";
+}
+
+EdgeProcessingResult DataProcessor::render_edge_result(const EdgeRecord& record) const {
+    EdgeProcessingResult result;
+    result.sensor_id = registry_->info(record.sensor).sensor_id;
+    result.analysis_type = "trend_analysis";
+    result.processed_at = record.processed_at;
+    result.confidence_score = record.confidence;
+    
+    result.metrics["temperature_trend_slope"] = record.slope;
+    result.metrics["temperature_trend_intercept"] = record.intercept;
+    result.metrics["temperature_current"] = record.temperature;
+    result.metrics["humidity_current"] = record.humidity;
     
     // Generate alerts and recommendations
-    if (std::abs(slope) > 0.5f) {
-        if (slope > 0) {
+    if (std::abs(record.slope) > 0.5f) {
+        if (record.slope > 0) {
             result.alerts.push_back("Rising temperature trend detected");
             result.recommendations.push_back("Monitor for overheating");
         } else {
@@ -376,136 +1007,152 @@ void DataProcessor::perform_edge_analytics(const SensorDataPacket& packet) {
         }
     }
     
-    if (packet.humidity_percent > 70.0f) {
+    if (record.humidity > 70.0f) {
         result.alerts.push_back("High humidity detected");
         result.recommendations.push_back("Improve ventilation");
     }
     
-    // Store result
-    {
-        std::lock_guard<std::mutex> lock(edge_results_mutex_);
-        edge_results_.push_back(result);
-        
-        // Limit results history
-        if (edge_results_.size() > 100) {
-            edge_results_.erase(edge_results_.begin());
-        }
-    }
-    
-    std::cout << "🤖 [DataProcessor] Edge analysis completed for " << packet.sensor_id 
-              << " (trend slope: " << slope << ")" << std::endl;
+    return result;
 }
 
-void DataProcessor::aggregate_and_forward() {
-    std::cout << "📊 [DataProcessor] Performing data aggregation..." << std::endl;
-    
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    // Aggregate data for each sensor
-    for (const auto& pair : sensor_history_) {
-        const std::string& sensor_id = pair.first;
-        const std::vector<SensorDataPacket>& history = pair.second;
+void DataProcessor::aggregate_and_forward(SensorPartition& partition) {
+    // (topic, message) per sensor: formatted under the partition lock,
+    // published after it is released so a slow callback never holds up
+    // the partition's other workers or its producers
+    std::vector<std::pair<std::string, std::string>> aggregates;
+    {
+        std::lock_guard<std::mutex> lock(partition.mutex);
         
-        if (history.empty()) {
-            continue;
+        auto now = clock_->now();
+        if (now - partition.last_aggregation < std::chrono::seconds(config_.aggregation_window_seconds)) {
+            return;
         }
+        partition.last_aggregation = now;
         
-        // Get recent data (last aggregation window)
-        auto cutoff_time = std::chrono::steady_clock::now() - 
-                          std::chrono::seconds(config_.aggregation_window_seconds);
+        THERMAL_LOG_INFO << "📊 [DataProcessor] Performing data aggregation...";
         
-        std::vector<SensorDataPacket> recent_data;
-        for (const auto& packet : history) {
-            if (packet.timestamp >= cutoff_time) {
-                recent_data.push_back(packet);
+        // Aggregate data for each sensor in this partition
+        for (size_t slot = 0; slot < partition.sensor_history.size(); ++slot) {
+            const SensorHistory& history = partition.sensor_history[slot];
+            if (history.samples.empty()) {
+                continue;
             }
+            
+            // Get recent data (last aggregation window)
+            auto cutoff_time = now - 
+                              std::chrono::seconds(config_.aggregation_window_seconds);
+            size_t from = history.samples.first_index_since(cutoff_time);
+            
+            if (from == history.samples.size()) {
+                continue;
+            }
+            
+            SensorHandle handle = static_cast<SensorHandle>(slot * partitions_.size() + partition.index);
+            const SensorInfo& info = registry_->info(handle);
+            aggregates.emplace_back(info.aggregated_topic, format_aggregated_data(info.sensor_id, history, from));
         }
-        
-        if (recent_data.empty()) {
-            continue;
-        }
-        
-        // Create aggregated message
-        std::string aggregated_message = format_aggregated_data(recent_data);
-        
+    }
+    
+    for (const auto& aggregate : aggregates) {
         // Send to MQTT
         if (mqtt_callback_) {
-            std::string topic = config_.mqtt_base_topic + "/sensors/" + sensor_id + "/aggregated";
-            mqtt_callback_(topic, aggregated_message);
+            mqtt_callback_(aggregate.first, aggregate.second);
         }
         
         // Send to WebSocket
         if (websocket_callback_) {
-            websocket_callback_(aggregated_message);
+            websocket_callback_(aggregate.second);
         }
     }
     
-    std::cout << "📊 [DataProcessor] Aggregation completed for " 
-              << sensor_history_.size() << " sensors" << std::endl;
+    THERMAL_LOG_INFO << "📊 [DataProcessor] Aggregation completed for " 
+                     << aggregates.size() << " sensors";
 }
 
-std::string DataProcessor::format_mqtt_message(const SensorDataPacket& packet) {
-    std::stringstream ss;
-    ss << "{"
-       << "\"sensor_id\":\"" << packet.sensor_id << "\","
-       << "\"location\":\"" << packet.location << "\","
-       << "\"timestamp\":" << std::chrono::duration_cast<std::chrono::seconds>(
-              packet.timestamp.time_since_epoch()).count() << ","
-       << "\"temperature\":" << std::fixed << std::setprecision(2) << packet.temperature_celsius << ","
-       << "\"humidity\":" << packet.humidity_percent << ","
-       << "\"pressure\":" << packet.pressure_hpa << ","
-       << "\"supply_voltage\":" << packet.supply_voltage << ","
-       << "\"sensor_status\":" << static_cast<int>(packet.sensor_status) << ","
-       << "\"interface\":\"" << (packet.interface_used == CommInterface::UART_INTERFACE ? "UART" :
-                                packet.interface_used == CommInterface::SPI_INTERFACE ? "SPI" :
-                                packet.interface_used == CommInterface::I2C_INTERFACE ? "I2C" : "UNKNOWN") << "\","
-       << "\"signal_strength\":" << packet.signal_strength << ","
-       << "\"data_confidence\":" << packet.data_confidence << ","
-       << "\"gateway_id\":\"" << config_.gateway_id << "\""
-       << "}";
-    
-    return ss.str();
+void DataProcessor::format_mqtt_message(const SensorDataPacket& packet, std::string& out) {
+    out.assign("{\"sensor_id\":\"").append(packet.sensor_id);
+    out.append("\",\"location\":\"").append(packet.location);
+    out.append("\",\"timestamp\":");
+    append_int(out, ticks_since_epoch<std::chrono::seconds>(packet.timestamp));
+    out.append(",\"temperature\":");
+    append_fixed(out, packet.temperature_celsius);
+    out.append(",\"humidity\":");
+    append_fixed(out, packet.humidity_percent);
+    out.append(",\"pressure\":");
+    append_fixed(out, packet.pressure_hpa);
+    out.append(",\"supply_voltage\":");
+    append_fixed(out, packet.supply_voltage);
+    out.append(",\"sensor_status\":");
+    append_int(out, packet.sensor_status);
+    out.append(",\"interface\":\"").append(interface_name(packet.interface_used));
+    out.append("\",\"signal_strength\":");
+    append_fixed(out, packet.signal_strength);
+    out.append(",\"data_confidence\":");
+    append_fixed(out, packet.data_confidence);
+    out.append(",\"gateway_id\":\"").append(config_.gateway_id).append("\"}");
 }
 
-std::string DataProcessor::format_websocket_message(const SensorDataPacket& packet) {
-    std::stringstream ss;
-    ss << "{"
-       << "\"type\":\"sensor_data\","
-       << "\"sensor_id\":\"" << packet.sensor_id << "\","
-       << "\"location\":\"" << packet.location << "\","
-       << "\"timestamp\":" << std::chrono::duration_cast<std::chrono::milliseconds>(
-              packet.timestamp.time_since_epoch()).count() << ","
-       << "\"temperature\":" << std::fixed << std::setprecision(2) << packet.temperature_celsius << ","
-       << "\"humidity\":" << packet.humidity_percent << ","
-       << "\"pressure\":" << packet.pressure_hpa << ","
-       << "\"supply_voltage\":" << packet.supply_voltage << ","
-       << "\"gateway_id\":\"" << config_.gateway_id << "\","
-       << "\"interface\":\"" << (packet.interface_used == CommInterface::UART_INTERFACE ? "UART" :
-                                packet.interface_used == CommInterface::SPI_INTERFACE ? "SPI" :
-                                packet.interface_used == CommInterface::I2C_INTERFACE ? "I2C" : "UNKNOWN") << "\""
-       << "}";
+void DataProcessor::format_binary_mqtt_message(const SensorDataPacket& packet, std::string& out) {
+    // The record and encode buffer are per thread too, so their strings are reused
+    OutboundScratch& scratch = outbound_scratch();
+    thermal_monitoring::wire::SensorRecord& record = scratch.record;
+    record.sensor_id = packet.sensor_id;
+    record.location = packet.location;
+    record.gateway_id = config_.gateway_id;
+    record.timestamp_ms = ticks_since_epoch<std::chrono::milliseconds>(packet.timestamp);
+    record.temperature = packet.temperature_celsius;
+    record.humidity = packet.humidity_percent;
+    record.pressure = packet.pressure_hpa;
+    record.supply_voltage = packet.supply_voltage;
+    record.signal_strength = packet.signal_strength;
+    record.data_confidence = packet.data_confidence;
+    record.sequence = packet.packet_sequence;
+    record.status = packet.sensor_status;
+    record.interface = static_cast<uint8_t>(packet.interface_used);
     
-    return ss.str();
+    scratch.encoded.clear();
+    thermal_monitoring::wire::encode_sensor_record(record, scratch.encoded);
+    out.assign(reinterpret_cast<const char*>(scratch.encoded.data()), scratch.encoded.size());
+}
+
+void DataProcessor::format_websocket_message(const SensorDataPacket& packet, std::string& out) {
+    out.assign("{\"type\":\"sensor_data\",\"sensor_id\":\"").append(packet.sensor_id);
+    out.append("\",\"location\":\"").append(packet.location);
+    out.append("\",\"timestamp\":");
+    append_int(out, ticks_since_epoch<std::chrono::milliseconds>(packet.timestamp));
+    out.append(",\"temperature\":");
+    append_fixed(out, packet.temperature_celsius);
+    out.append(",\"humidity\":");
+    append_fixed(out, packet.humidity_percent);
+    out.append(",\"pressure\":");
+    append_fixed(out, packet.pressure_hpa);
+    out.append(",\"supply_voltage\":");
+    append_fixed(out, packet.supply_voltage);
+    out.append(",\"gateway_id\":\"").append(config_.gateway_id);
+    out.append("\",\"interface\":\"").append(interface_name(packet.interface_used)).append("\"}");
 }
 
-std::string DataProcessor::format_aggregated_data(const std::vector<SensorDataPacket>& packets) {
-    if (packets.empty()) {
+std::string DataProcessor::format_aggregated_data(const std::string& sensor_id, const SensorHistory& history, size_t from) {
+    const auto& samples = history.samples;
+    if (from >= samples.size()) {
         return "{}";
     }
     
     // Calculate aggregated statistics
     float sum_temp = 0.0f, sum_hum = 0.0f, sum_press = 0.0f;
-    float min_temp = packets[0].temperature_celsius;
-    float max_temp = packets[0].temperature_celsius;
+    float min_temp = samples.value<SensorHistory::TEMPERATURE>(from);
+    float max_temp = min_temp;
     int valid_count = 0;
+    size_t sample_count = samples.size() - from;
     
-    for (const auto& packet : packets) {
-        if (packet.is_valid) {
-            sum_temp += packet.temperature_celsius;
-            sum_hum += packet.humidity_percent;
-            sum_press += packet.pressure_hpa;
-            min_temp = std::min(min_temp, packet.temperature_celsius);
-            max_temp = std::max(max_temp, packet.temperature_celsius);
+    for (size_t i = from; i < samples.size(); ++i) {
+        if (samples.value<SensorHistory::VALID>(i)) {
+            float temp = samples.value<SensorHistory::TEMPERATURE>(i);
+            sum_temp += temp;
+            sum_hum += samples.value<SensorHistory::HUMIDITY>(i);
+            sum_press += samples.value<SensorHistory::PRESSURE>(i);
+            min_temp = std::min(min_temp, temp);
+            max_temp = std::max(max_temp, temp);
             valid_count++;
         }
     }
@@ -521,12 +1168,12 @@ std::string DataProcessor::format_aggregated_data(const std::vector<SensorDataPa
     std::stringstream ss;
     ss << "{"
        << "\"type\":\"aggregated_data\","
-       << "\"sensor_id\":\"" << packets[0].sensor_id << "\","
-       << "\"location\":\"" << packets[0].location << "\","
+       << "\"sensor_id\":\"" << sensor_id << "\","
+       << "\"location\":\"" << history.location << "\","
        << "\"timestamp\":" << std::chrono::duration_cast<std::chrono::seconds>(
-              std::chrono::steady_clock::now().time_since_epoch()).count() << ","
+              clock_->now().time_since_epoch()).count() << ","
        << "\"window_seconds\":" << config_.aggregation_window_seconds << ","
-       << "\"sample_count\":" << packets.size() << ","
+       << "\"sample_count\":" << sample_count << ","
        << "\"valid_count\":" << valid_count << ","
        << "\"temperature\":{"
        << "\"avg\":" << std::fixed << std::setprecision(2) << avg_temp << ","
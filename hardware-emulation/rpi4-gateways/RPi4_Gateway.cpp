@@ -1,5 +1,5 @@
 #include "RPi4_Gateway.h"
-#include <iostream>
+#include "../../thermal-monitoring/Log.h"
 #include <sstream>
 #include <iomanip>
 #include <cstring>
@@ -12,6 +12,9 @@
 #include <unistd.h>
 #include <termios.h>
 #include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <linux/spi/spidev.h>
 #include <linux/i2c-dev.h>
 #include <sys/stat.h>
@@ -19,14 +22,245 @@
 
 namespace rpi4_gateway {
 
+//=============================================================================
+// Communication Reactor Implementation
+//=============================================================================
+
+namespace {
+constexpr uint64_t WAKE_SOURCE_ID = ~0ULL;
+constexpr int MAX_REACTOR_EVENTS = 16;
+
+// Stamp the packet's identity; with a registry the id and location strings
+// are built once per node rather than once per frame
+void assign_sensor_identity(SensorDataPacket& packet, SensorRegistry* registry, CommInterface interface,
+                            uint32_t node_number, const char* id_prefix, const std::string& location) {
+    if (registry) {
+        SensorHandle handle = registry->intern_node(interface, node_number, id_prefix, location);
+        if (handle != INVALID_SENSOR_HANDLE) {
+            const SensorInfo& info = registry->info(handle);
+            packet.sensor_handle = handle;
+            packet.sensor_id = info.sensor_id;
+            packet.location = info.location;
+            return;
+        }
+    }
+    packet.sensor_id.assign(id_prefix);
+    packet.sensor_id += std::to_string(node_number);
+    packet.location = location;
+}
+
+// Zero every field of a reused packet but keep its strings' capacity
+void reset_packet(SensorDataPacket& packet) {
+    std::string sensor_id;
+    std::string location;
+    sensor_id.swap(packet.sensor_id);
+    location.swap(packet.location);
+    packet = SensorDataPacket{};
+    sensor_id.clear();
+    location.clear();
+    packet.sensor_id.swap(sensor_id);
+    packet.location.swap(location);
+}
+}
+
+CommReactor::CommReactor()
+    : epoll_fd_(-1), wake_fd_(-1), running_(false), next_source_id_(0) {
+}
+
+CommReactor::~CommReactor() {
+    stop();
+}
+
+bool CommReactor::start() {
+    if (running_.load()) {
+        return true;
+    }
+    
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        THERMAL_LOG_ERROR << "❌ [Reactor] Failed to create epoll/eventfd: " << strerror(errno);
+        stop();
+        return false;
+    }
+    
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_SOURCE_ID;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) < 0) {
+        THERMAL_LOG_ERROR << "❌ [Reactor] Failed to register wake descriptor";
+        stop();
+        return false;
+    }
+    
+    running_ = true;
+    reactor_thread_ = std::thread(&CommReactor::reactor_loop, this);
+    
+    THERMAL_LOG_INFO << "🚀 [Reactor] Started";
+    return true;
+}
+
+void CommReactor::stop() {
+    if (running_.exchange(false)) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+        if (reactor_thread_.joinable()) {
+            reactor_thread_.join();
+        }
+        THERMAL_LOG_INFO << "✅ [Reactor] Stopped";
+    }
+    
+    std::lock_guard<std::recursive_mutex> lock(dispatch_mutex_);
+    for (auto& pair : sources_) {
+        if (pair.second.is_timer) {
+            close(pair.second.fd);
+        }
+    }
+    sources_.clear();
+    
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+}
+
+int CommReactor::add_fd(int fd, uint32_t events, EventHandler handler) {
+    return add_source(fd, events, false, std::move(handler));
+}
+
+int CommReactor::add_source(int fd, uint32_t events, bool is_timer, EventHandler handler) {
+    if (!running_.load() || fd < 0) {
+        return -1;
+    }
+    
+    std::lock_guard<std::recursive_mutex> lock(dispatch_mutex_);
+    int source_id = next_source_id_++;
+    
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.u64 = static_cast<uint64_t>(source_id);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        THERMAL_LOG_ERROR << "❌ [Reactor] Failed to register descriptor: " << strerror(errno);
+        return -1;
+    }
+    
+    sources_[source_id] = {fd, is_timer, std::make_shared<EventHandler>(std::move(handler))};
+    return source_id;
+}
+
+int CommReactor::add_timer(std::chrono::milliseconds period, std::function<void()> handler) {
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        THERMAL_LOG_ERROR << "❌ [Reactor] Failed to create timer: " << strerror(errno);
+        return -1;
+    }
+    
+    struct itimerspec spec = {};
+    spec.it_interval.tv_sec = period.count() / 1000;
+    spec.it_interval.tv_nsec = (period.count() % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+        spec.it_value.tv_nsec = 1; // Zero would disarm the timer
+    }
+    timerfd_settime(timer_fd, 0, &spec, nullptr);
+    
+    int source_id = add_source(timer_fd, EPOLLIN, true, [handler](uint32_t) { handler(); });
+    if (source_id < 0) {
+        close(timer_fd);
+    }
+    return source_id;
+}
+
+void CommReactor::remove(int source_id) {
+    // Blocks while the reactor thread is inside a handler; re-entrant when
+    // a handler removes itself
+    std::lock_guard<std::recursive_mutex> lock(dispatch_mutex_);
+    auto it = sources_.find(source_id);
+    if (it == sources_.end()) {
+        return;
+    }
+    
+    if (epoll_fd_ >= 0) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    }
+    if (it->second.is_timer) {
+        close(it->second.fd);
+    }
+    sources_.erase(it);
+}
+
+std::shared_ptr<CommReactor> CommReactor::shared() {
+    static std::mutex shared_mutex;
+    static std::weak_ptr<CommReactor> shared_reactor;
+    
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    auto reactor = shared_reactor.lock();
+    if (!reactor) {
+        reactor = std::make_shared<CommReactor>();
+        if (!reactor->start()) {
+            return nullptr;
+        }
+        shared_reactor = reactor;
+    }
+    return reactor;
+}
+
+void CommReactor::reactor_loop() {
+    THERMAL_LOG_INFO << "🔄 [Reactor] Event loop started";
+    
+    struct epoll_event events[MAX_REACTOR_EVENTS];
+    while (running_.load()) {
+        int count = epoll_wait(epoll_fd_, events, MAX_REACTOR_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            THERMAL_LOG_ERROR << "❌ [Reactor] epoll_wait failed: " << strerror(errno);
+            break;
+        }
+        
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.u64 == WAKE_SOURCE_ID) {
+                uint64_t value;
+                ssize_t ignored = read(wake_fd_, &value, sizeof(value));
+                (void)ignored;
+                continue;
+            }
+            
+            std::lock_guard<std::recursive_mutex> lock(dispatch_mutex_);
+            auto it = sources_.find(static_cast<int>(events[i].data.u64));
+            if (it == sources_.end()) {
+                continue; // Removed after this batch was collected
+            }
+            
+            if (it->second.is_timer) {
+                uint64_t expirations;
+                ssize_t ignored = read(it->second.fd, &expirations, sizeof(expirations));
+                (void)ignored;
+            }
+            
+            // Hold a reference: the handler may remove its own source
+            std::shared_ptr<EventHandler> handler = it->second.handler;
+            (*handler)(events[i].events);
+        }
+    }
+    
+    THERMAL_LOG_INFO << "🏁 [Reactor] Event loop finished";
+}
+
 //=============================================================================
 // UART Interface Implementation
 //=============================================================================
 
 UARTInterface::UARTInterface(const std::string& device, int baudrate)
-    : device_(device), baudrate_(baudrate), fd_(-1), active_(false) {
-    std::cout << "🔌 [UART] Interface created for device: " << device_ 
-              << " @ " << baudrate_ << " baud" << std::endl;
+    : device_(device), baudrate_(baudrate), fd_(-1), active_(false), reactor_source_(-1) {
+    THERMAL_LOG_INFO << "🔌 [UART] Interface created for device: " << device_ 
+                     << " @ " << baudrate_ << " baud";
 }
 
 UARTInterface::~UARTInterface() {
@@ -34,23 +268,23 @@ UARTInterface::~UARTInterface() {
     if (fd_ >= 0) {
         close(fd_);
     }
-    std::cout << "🔌 [UART] Interface destroyed" << std::endl;
+    THERMAL_LOG_INFO << "🔌 [UART] Interface destroyed";
 }
 
 bool UARTInterface::initialize() {
-    std::cout << "🚀 [UART] Initializing interface..." << std::endl;
+    THERMAL_LOG_INFO << "🚀 [UART] Initializing interface...";
     
     // Open UART device
-    fd_ = open(device_.c_str(), O_RDWR | O_NOCTTY | O_SYNC);
+    fd_ = open(device_.c_str(), O_RDWR | O_NOCTTY | O_SYNC | O_NONBLOCK);
     if (fd_ < 0) {
-        std::cerr << "❌ [UART] Failed to open device: " << device_ << std::endl;
+        THERMAL_LOG_ERROR << "❌ [UART] Failed to open device: " << device_;
         return false;
     }
     
     // Configure UART
     struct termios tty;
     if (tcgetattr(fd_, &tty) != 0) {
-        std::cerr << "❌ [UART] Failed to get device attributes" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [UART] Failed to get device attributes";
         close(fd_);
         fd_ = -1;
         return false;
@@ -81,41 +315,57 @@ bool UARTInterface::initialize() {
     
     // Configure input modes
     tty.c_iflag &= ~(IXON | IXOFF | IXANY); // No software flow control
-    tty.c_iflag &= ~(ICANON | ECHO | ECHOE | ISIG); // Raw input
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL); // No byte translation
+    
+    // Configure local modes: non-canonical, so VMIN/VTIME below apply
+    tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ECHONL | ISIG | IEXTEN); // Raw input
     
     // Configure output modes
     tty.c_oflag &= ~OPOST; // Raw output
     
-    // Set timeouts
-    tty.c_cc[VMIN] = 0;   // Non-blocking read
-    tty.c_cc[VTIME] = 10; // 1 second timeout
+    // Readable as soon as any byte arrives; on_readable() drains everything
+    // buffered. VMIN = FRAME_SIZE would cut wakeups, but a frame split across
+    // a read would then wait for the next frame before becoming readable.
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
     
     if (tcsetattr(fd_, TCSANOW, &tty) != 0) {
-        std::cerr << "❌ [UART] Failed to set device attributes" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [UART] Failed to set device attributes";
         close(fd_);
         fd_ = -1;
         return false;
     }
     
-    std::cout << "✅ [UART] Interface initialized successfully" << std::endl;
+    THERMAL_LOG_INFO << "✅ [UART] Interface initialized successfully";
     return true;
 }
 
 bool UARTInterface::start() {
     if (fd_ < 0) {
-        std::cerr << "❌ [UART] Interface not initialized" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [UART] Interface not initialized";
         return false;
     }
     
     if (active_.load()) {
-        std::cout << "⚠️ [UART] Interface already running" << std::endl;
+        THERMAL_LOG_WARN << "⚠️ [UART] Interface already running";
         return true;
     }
     
+    rx_ring_.clear();
     active_ = true;
-    reader_thread_ = std::thread(&UARTInterface::reader_loop, this);
     
-    std::cout << "🚀 [UART] Interface started" << std::endl;
+    reactor_ = CommReactor::shared();
+    if (reactor_) {
+        reactor_source_ = reactor_->add_fd(fd_, EPOLLIN, [this](uint32_t) { on_readable(); });
+    }
+    if (reactor_source_ < 0) {
+        THERMAL_LOG_ERROR << "❌ [UART] Failed to register with reactor";
+        active_ = false;
+        reactor_.reset();
+        return false;
+    }
+    
+    THERMAL_LOG_INFO << "🚀 [UART] Interface started";
     return true;
 }
 
@@ -124,105 +374,96 @@ void UARTInterface::stop() {
         return;
     }
     
-    std::cout << "🛑 [UART] Stopping interface..." << std::endl;
+    THERMAL_LOG_INFO << "🛑 [UART] Stopping interface...";
     active_ = false;
     
-    if (reader_thread_.joinable()) {
-        reader_thread_.join();
-    }
+    reactor_->remove(reactor_source_);
+    reactor_source_ = -1;
+    reactor_.reset();
     
-    std::cout << "✅ [UART] Interface stopped" << std::endl;
+    THERMAL_LOG_INFO << "✅ [UART] Interface stopped";
 }
 
-void UARTInterface::set_data_callback(std::function<void(const SensorDataPacket&)> callback) {
+void UARTInterface::set_data_callback(std::function<void(SensorDataPacket&&)> callback) {
     data_callback_ = callback;
 }
 
-void UARTInterface::reader_loop() {
-    std::cout << "🔄 [UART] Reader thread started" << std::endl;
-    
-    std::vector<uint8_t> buffer;
-    buffer.reserve(1024);
-    
+void UARTInterface::on_readable() {
+    // Drain the descriptor straight into the ring, parsing as we go so the
+    // ring never holds more than one partial frame
     while (active_.load()) {
-        uint8_t temp_buffer[256];
-        ssize_t bytes_read = read(fd_, temp_buffer, sizeof(temp_buffer));
+        size_t space = 0;
+        uint8_t* region = rx_ring_.write_region(space);
+        if (space == 0) {
+            rx_ring_.clear(); // Unreachable while parse_frames keeps up; resync
+            continue;
+        }
         
+        ssize_t bytes_read = read(fd_, region, space);
         if (bytes_read > 0) {
-            // Add to buffer
-            buffer.insert(buffer.end(), temp_buffer, temp_buffer + bytes_read);
-            
-            // Look for complete packets (simple framing: 0xAA 0xBB ... checksum)
-            while (buffer.size() >= 14) { // Minimum packet size
-                // Find start of packet
-                auto it = std::find(buffer.begin(), buffer.end(), 0xAA);
-                if (it == buffer.end()) {
-                    buffer.clear();
-                    break;
-                }
-                
-                // Check if we have the second header byte
-                if (std::distance(it, buffer.end()) < 2 || *(it + 1) != 0xBB) {
-                    buffer.erase(buffer.begin(), it + 1);
-                    continue;
-                }
-                
-                // Check if we have a complete packet
-                if (std::distance(it, buffer.end()) >= 14) {
-                    std::vector<uint8_t> packet_data(it, it + 14);
-                    
-                    // Verify checksum
-                    uint8_t checksum = 0;
-                    for (size_t i = 2; i < 13; ++i) {
-                        checksum ^= packet_data[i];
-                    }
-                    
-                    if (checksum == packet_data[13]) {
-                        // Valid packet
-                        SensorDataPacket packet = parse_uart_packet(packet_data);
-                        if (data_callback_ && packet.is_valid) {
-                            data_callback_(packet);
-                        }
-                        
-                        std::cout << "📨 [UART] Received valid packet from sensor: " 
-                                  << packet.sensor_id << std::endl;
-                    } else {
-                        std::cout << "⚠️ [UART] Invalid checksum, packet discarded" << std::endl;
-                    }
-                    
-                    buffer.erase(buffer.begin(), it + 14);
-                } else {
-                    break; // Wait for more data
-                }
+            rx_ring_.commit(static_cast<size_t>(bytes_read));
+            parse_frames();
+        } else {
+            if (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                THERMAL_LOG_ERROR << "❌ [UART] Read error: " << strerror(errno);
             }
-        } else if (bytes_read < 0) {
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                std::cerr << "❌ [UART] Read error: " << strerror(errno) << std::endl;
+            break;
+        }
+    }
+}
+
+void UARTInterface::parse_frames() {
+    // Look for complete packets (simple framing: 0xAA 0xBB ... checksum)
+    while (rx_ring_.size() >= FRAME_SIZE) {
+        if (rx_ring_[0] != 0xAA || rx_ring_[1] != 0xBB) {
+            rx_ring_.consume(1);
+            continue;
+        }
+        
+        // Parse in place unless the frame wraps around the end of the ring
+        std::array<uint8_t, FRAME_SIZE> wrapped;
+        const uint8_t* frame = rx_ring_.contiguous(0, FRAME_SIZE);
+        if (!frame) {
+            rx_ring_.copy_out(0, wrapped.data(), FRAME_SIZE);
+            frame = wrapped.data();
+        }
+        
+        // Verify checksum
+        uint8_t checksum = 0;
+        for (size_t i = 2; i < FRAME_SIZE - 1; ++i) {
+            checksum ^= frame[i];
+        }
+        
+        if (checksum == frame[FRAME_SIZE - 1]) {
+            // Valid packet
+            parse_uart_packet(frame, rx_packet_);
+            THERMAL_LOG_DEBUG << "📨 [UART] Received valid packet from sensor: " 
+                              << rx_packet_.sensor_id;
+            if (data_callback_ && rx_packet_.is_valid) {
+                data_callback_(std::move(rx_packet_));
             }
+        } else {
+            THERMAL_LOG_WARN << "⚠️ [UART] Invalid checksum, packet discarded";
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        rx_ring_.consume(FRAME_SIZE);
     }
-    
-    std::cout << "🏁 [UART] Reader thread finished" << std::endl;
 }
 
-SensorDataPacket UARTInterface::parse_uart_packet(const std::vector<uint8_t>& data) {
-    SensorDataPacket packet = {};
+// 'data' points at a checksummed FRAME_SIZE-byte frame
+void UARTInterface::parse_uart_packet(const uint8_t* data, SensorDataPacket& packet) {
+    reset_packet(packet);
     packet.timestamp = std::chrono::steady_clock::now();
     packet.interface_used = CommInterface::UART_INTERFACE;
     packet.is_valid = false;
     
-    if (data.size() < 14) {
-        return packet;
-    }
-    
     // Parse packet: [0xAA][0xBB][NodeID(4)][Temp(2)][Humidity(2)][Voltage(2)][Status(1)][Checksum(1)]
     
     // Extract node ID (simplified hash)
     uint32_t node_hash = (data[2] << 24) | (data[3] << 16) | (data[4] << 8) | data[5];
-    packet.sensor_id = "sensor_" + std::to_string(node_hash % 10000);
-    packet.location = "Unknown";
+    static const std::string location = "Unknown";
+    assign_sensor_identity(packet, registry_.get(), CommInterface::UART_INTERFACE,
+                           node_hash % 10000, "sensor_", location);
     
     // Extract temperature (int16 * 100)
     int16_t temp_raw = (data[6] << 8) | data[7];
@@ -253,8 +494,6 @@ SensorDataPacket UARTInterface::parse_uart_packet(const std::vector<uint8_t>& da
         packet.supply_voltage >= 2.0f && packet.supply_voltage <= 5.0f) {
         packet.is_valid = true;
     }
-    
-    return packet;
 }
 
 //=============================================================================
@@ -262,9 +501,9 @@ SensorDataPacket UARTInterface::parse_uart_packet(const std::vector<uint8_t>& da
 //=============================================================================
 
 SPIInterface::SPIInterface(const std::string& device, int speed)
-    : device_(device), speed_(speed), fd_(-1), active_(false) {
-    std::cout << "🔌 [SPI] Interface created for device: " << device_ 
-              << " @ " << speed_ << " Hz" << std::endl;
+    : device_(device), speed_(speed), fd_(-1), active_(false), reactor_source_(-1) {
+    THERMAL_LOG_INFO << "🔌 [SPI] Interface created for device: " << device_ 
+                     << " @ " << speed_ << " Hz";
 }
 
 SPIInterface::~SPIInterface() {
@@ -272,23 +511,23 @@ SPIInterface::~SPIInterface() {
     if (fd_ >= 0) {
         close(fd_);
     }
-    std::cout << "🔌 [SPI] Interface destroyed" << std::endl;
+    THERMAL_LOG_INFO << "🔌 [SPI] Interface destroyed";
 }
 
 bool SPIInterface::initialize() {
-    std::cout << "🚀 [SPI] Initializing interface..." << std::endl;
+    THERMAL_LOG_INFO << "🚀 [SPI] Initializing interface...";
     
     // Open SPI device
     fd_ = open(device_.c_str(), O_RDWR);
     if (fd_ < 0) {
-        std::cerr << "❌ [SPI] Failed to open device: " << device_ << std::endl;
+        THERMAL_LOG_ERROR << "❌ [SPI] Failed to open device: " << device_;
         return false;
     }
     
     // Configure SPI mode
     uint8_t mode = SPI_MODE_0;
     if (ioctl(fd_, SPI_IOC_WR_MODE, &mode) < 0) {
-        std::cerr << "❌ [SPI] Failed to set SPI mode" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [SPI] Failed to set SPI mode";
         close(fd_);
         fd_ = -1;
         return false;
@@ -297,7 +536,7 @@ bool SPIInterface::initialize() {
     // Configure bits per word
     uint8_t bits = 8;
     if (ioctl(fd_, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) {
-        std::cerr << "❌ [SPI] Failed to set bits per word" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [SPI] Failed to set bits per word";
         close(fd_);
         fd_ = -1;
         return false;
@@ -305,31 +544,42 @@ bool SPIInterface::initialize() {
     
     // Configure speed
     if (ioctl(fd_, SPI_IOC_WR_MAX_SPEED_HZ, &speed_) < 0) {
-        std::cerr << "❌ [SPI] Failed to set speed" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [SPI] Failed to set speed";
         close(fd_);
         fd_ = -1;
         return false;
     }
     
-    std::cout << "✅ [SPI] Interface initialized successfully" << std::endl;
+    THERMAL_LOG_INFO << "✅ [SPI] Interface initialized successfully";
     return true;
 }
 
 bool SPIInterface::start() {
     if (fd_ < 0) {
-        std::cerr << "❌ [SPI] Interface not initialized" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [SPI] Interface not initialized";
         return false;
     }
     
     if (active_.load()) {
-        std::cout << "⚠️ [SPI] Interface already running" << std::endl;
+        THERMAL_LOG_WARN << "⚠️ [SPI] Interface already running";
         return true;
     }
     
+    // Poll every 500ms to avoid overwhelming the SPI bus; SPI is master
+    // driven, so the reactor's timer stands in for a readiness event
+    reactor_ = CommReactor::shared();
+    if (reactor_) {
+        reactor_source_ = reactor_->add_timer(std::chrono::milliseconds(500), [this] { poll_once(); });
+    }
+    if (reactor_source_ < 0) {
+        THERMAL_LOG_ERROR << "❌ [SPI] Failed to register with reactor";
+        reactor_.reset();
+        return false;
+    }
+    
     active_ = true;
-    polling_thread_ = std::thread(&SPIInterface::polling_loop, this);
     
-    std::cout << "🚀 [SPI] Interface started" << std::endl;
+    THERMAL_LOG_INFO << "🚀 [SPI] Interface started";
     return true;
 }
 
@@ -338,64 +588,59 @@ void SPIInterface::stop() {
         return;
     }
     
-    std::cout << "🛑 [SPI] Stopping interface..." << std::endl;
+    THERMAL_LOG_INFO << "🛑 [SPI] Stopping interface...";
     active_ = false;
     
-    if (polling_thread_.joinable()) {
-        polling_thread_.join();
-    }
+    reactor_->remove(reactor_source_);
+    reactor_source_ = -1;
+    reactor_.reset();
     
-    std::cout << "✅ [SPI] Interface stopped" << std::endl;
+    THERMAL_LOG_INFO << "✅ [SPI] Interface stopped";
 }
 
-void SPIInterface::set_data_callback(std::function<void(const SensorDataPacket&)> callback) {
+void SPIInterface::set_data_callback(std::function<void(SensorDataPacket&&)> callback) {
     data_callback_ = callback;
 }
 
-void SPIInterface::polling_loop() {
-    std::cout << "🔄 [SPI] Polling thread started" << std::endl;
+void SPIInterface::poll_once() {
+    if (!active_.load()) {
+        return;
+    }
     
-    while (active_.load()) {
-        // SPI is typically request-response, so we poll for data
-        std::vector<uint8_t> tx_buffer(14, 0x00); // Send zeros to request data
-        std::vector<uint8_t> rx_buffer(14, 0x00);
-        
-        struct spi_ioc_transfer transfer = {};
-        transfer.tx_buf = reinterpret_cast<uintptr_t>(tx_buffer.data());
-        transfer.rx_buf = reinterpret_cast<uintptr_t>(rx_buffer.data());
-        transfer.len = 14;
-        transfer.speed_hz = speed_;
-        transfer.bits_per_word = 8;
-        
-        if (ioctl(fd_, SPI_IOC_MESSAGE(1), &transfer) >= 0) {
-            // Check if we received valid data (starts with 0xAA 0xBB)
-            if (rx_buffer[0] == 0xAA && rx_buffer[1] == 0xBB) {
-                SensorDataPacket packet = parse_spi_packet(rx_buffer);
-                if (data_callback_ && packet.is_valid) {
-                    data_callback_(packet);
-                    std::cout << "📨 [SPI] Received valid packet from sensor: " 
-                              << packet.sensor_id << std::endl;
-                }
+    // SPI is typically request-response, so we poll for data
+    std::array<uint8_t, 14> tx_buffer{}; // Send zeros to request data
+    std::array<uint8_t, 14> rx_buffer{};
+    
+    struct spi_ioc_transfer transfer = {};
+    transfer.tx_buf = reinterpret_cast<uintptr_t>(tx_buffer.data());
+    transfer.rx_buf = reinterpret_cast<uintptr_t>(rx_buffer.data());
+    transfer.len = 14;
+    transfer.speed_hz = speed_;
+    transfer.bits_per_word = 8;
+    
+    if (ioctl(fd_, SPI_IOC_MESSAGE(1), &transfer) >= 0) {
+        // Check if we received valid data (starts with 0xAA 0xBB)
+        if (rx_buffer[0] == 0xAA && rx_buffer[1] == 0xBB) {
+            parse_spi_packet(rx_buffer.data(), rx_buffer.size(), rx_packet_);
+            if (data_callback_ && rx_packet_.is_valid) {
+                THERMAL_LOG_DEBUG << "📨 [SPI] Received valid packet from sensor: " 
+                                  << rx_packet_.sensor_id;
+                data_callback_(std::move(rx_packet_));
             }
-        } else {
-            std::cerr << "❌ [SPI] Transfer failed: " << strerror(errno) << std::endl;
         }
-        
-        // Poll every 500ms to avoid overwhelming the SPI bus
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    } else {
+        THERMAL_LOG_ERROR << "❌ [SPI] Transfer failed: " << strerror(errno);
     }
-    
-    std::cout << "🏁 [SPI] Polling thread finished" << std::endl;
 }
 
-SensorDataPacket SPIInterface::parse_spi_packet(const std::vector<uint8_t>& data) {
-    SensorDataPacket packet = {};
+void SPIInterface::parse_spi_packet(const uint8_t* data, size_t length, SensorDataPacket& packet) {
+    reset_packet(packet);
     packet.timestamp = std::chrono::steady_clock::now();
     packet.interface_used = CommInterface::SPI_INTERFACE;
     packet.is_valid = false;
     
-    if (data.size() < 14) {
-        return packet;
+    if (length < 14) {
+        return;
     }
     
     // Verify checksum
@@ -405,13 +650,14 @@ SensorDataPacket SPIInterface::parse_spi_packet(const std::vector<uint8_t>& data
     }
     
     if (checksum != data[13]) {
-        return packet; // Invalid checksum
+        return; // Invalid checksum
     }
     
     // Parse packet (same format as UART)
     uint32_t node_hash = (data[2] << 24) | (data[3] << 16) | (data[4] << 8) | data[5];
-    packet.sensor_id = "spi_sensor_" + std::to_string(node_hash % 10000);
-    packet.location = "SPI_Bus";
+    static const std::string location = "SPI_Bus";
+    assign_sensor_identity(packet, registry_.get(), CommInterface::SPI_INTERFACE,
+                           node_hash % 10000, "spi_sensor_", location);
     
     int16_t temp_raw = (data[6] << 8) | data[7];
     packet.temperature_celsius = temp_raw / 100.0f;
@@ -436,8 +682,6 @@ SensorDataPacket SPIInterface::parse_spi_packet(const std::vector<uint8_t>& data
         packet.supply_voltage >= 2.0f && packet.supply_voltage <= 5.0f) {
         packet.is_valid = true;
     }
-    
-    return packet;
 }
 
 //=============================================================================
@@ -445,9 +689,10 @@ SensorDataPacket SPIInterface::parse_spi_packet(const std::vector<uint8_t>& data
 //=============================================================================
 
 I2CInterface::I2CInterface(int bus, const std::vector<int>& addresses)
-    : bus_(bus), addresses_(addresses), fd_(-1), active_(false) {
-    std::cout << "🔌 [I2C] Interface created for bus: " << bus_ 
-              << " with " << addresses_.size() << " sensor addresses" << std::endl;
+    : bus_(bus), addresses_(addresses), fd_(-1), active_(false), reactor_source_(-1),
+      bus_location_("I2C_Bus_" + std::to_string(bus)) {
+    THERMAL_LOG_INFO << "🔌 [I2C] Interface created for bus: " << bus_ 
+                     << " with " << addresses_.size() << " sensor addresses";
 }
 
 I2CInterface::~I2CInterface() {
@@ -455,39 +700,49 @@ I2CInterface::~I2CInterface() {
     if (fd_ >= 0) {
         close(fd_);
     }
-    std::cout << "🔌 [I2C] Interface destroyed" << std::endl;
+    THERMAL_LOG_INFO << "🔌 [I2C] Interface destroyed";
 }
 
 bool I2CInterface::initialize() {
-    std::cout << "🚀 [I2C] Initializing interface..." << std::endl;
+    THERMAL_LOG_INFO << "🚀 [I2C] Initializing interface...";
     
     // Open I2C device
     std::string device = "/dev/i2c-" + std::to_string(bus_);
     fd_ = open(device.c_str(), O_RDWR);
     if (fd_ < 0) {
-        std::cerr << "❌ [I2C] Failed to open device: " << device << std::endl;
+        THERMAL_LOG_ERROR << "❌ [I2C] Failed to open device: " << device;
         return false;
     }
     
-    std::cout << "✅ [I2C] Interface initialized successfully" << std::endl;
+    THERMAL_LOG_INFO << "✅ [I2C] Interface initialized successfully";
     return true;
 }
 
 bool I2CInterface::start() {
     if (fd_ < 0) {
-        std::cerr << "❌ [I2C] Interface not initialized" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [I2C] Interface not initialized";
         return false;
     }
     
     if (active_.load()) {
-        std::cout << "⚠️ [I2C] Interface already running" << std::endl;
+        THERMAL_LOG_WARN << "⚠️ [I2C] Interface already running";
         return true;
     }
     
+    // Poll every 1 second on the shared reactor thread
+    reactor_ = CommReactor::shared();
+    if (reactor_) {
+        reactor_source_ = reactor_->add_timer(std::chrono::seconds(1), [this] { poll_once(); });
+    }
+    if (reactor_source_ < 0) {
+        THERMAL_LOG_ERROR << "❌ [I2C] Failed to register with reactor";
+        reactor_.reset();
+        return false;
+    }
+    
     active_ = true;
-    polling_thread_ = std::thread(&I2CInterface::polling_loop, this);
     
-    std::cout << "🚀 [I2C] Interface started" << std::endl;
+    THERMAL_LOG_INFO << "🚀 [I2C] Interface started";
     return true;
 }
 
@@ -496,42 +751,36 @@ void I2CInterface::stop() {
         return;
     }
     
-    std::cout << "🛑 [I2C] Stopping interface..." << std::endl;
+    THERMAL_LOG_INFO << "🛑 [I2C] Stopping interface...";
     active_ = false;
     
-    if (polling_thread_.joinable()) {
-        polling_thread_.join();
-    }
+    reactor_->remove(reactor_source_);
+    reactor_source_ = -1;
+    reactor_.reset();
     
-    std::cout << "✅ [I2C] Interface stopped" << std::endl;
+    THERMAL_LOG_INFO << "✅ [I2C] Interface stopped";
 }
 
-void I2CInterface::set_data_callback(std::function<void(const SensorDataPacket&)> callback) {
+void I2CInterface::set_data_callback(std::function<void(SensorDataPacket&&)> callback) {
     data_callback_ = callback;
 }
 
-void I2CInterface::polling_loop() {
-    std::cout << "🔄 [I2C] Polling thread started" << std::endl;
+void I2CInterface::poll_once() {
+    if (!active_.load()) {
+        return;
+    }
     
-    while (active_.load()) {
-        // Poll each I2C address
-        for (int address : addresses_) {
-            std::vector<uint8_t> data;
-            if (read_i2c_sensor(address, data)) {
-                SensorDataPacket packet = parse_i2c_packet(address, data);
-                if (data_callback_ && packet.is_valid) {
-                    data_callback_(packet);
-                    std::cout << "📨 [I2C] Received valid packet from address: 0x" 
-                              << std::hex << address << std::dec << std::endl;
-                }
+    // Poll each I2C address
+    for (int address : addresses_) {
+        if (read_i2c_sensor(address, rx_data_)) {
+            parse_i2c_packet(address, rx_data_, rx_packet_);
+            if (data_callback_ && rx_packet_.is_valid) {
+                data_callback_(std::move(rx_packet_));
+                THERMAL_LOG_DEBUG << "📨 [I2C] Received valid packet from address: 0x" 
+                                  << std::hex << address << std::dec;
             }
         }
-        
-        // Poll every 1 second
-        std::this_thread::sleep_for(std::chrono::seconds(1));
     }
-    
-    std::cout << "🏁 [I2C] Polling thread finished" << std::endl;
 }
 
 bool I2CInterface::read_i2c_sensor(int address, std::vector<uint8_t>& data) {
@@ -575,13 +824,13 @@ bool I2CInterface::read_i2c_sensor(int address, std::vector<uint8_t>& data) {
     return false; // Unknown sensor type
 }
 
-SensorDataPacket I2CInterface::parse_i2c_packet(int address, const std::vector<uint8_t>& data) {
-    SensorDataPacket packet = {};
+void I2CInterface::parse_i2c_packet(int address, const std::vector<uint8_t>& data, SensorDataPacket& packet) {
+    reset_packet(packet);
     packet.timestamp = std::chrono::steady_clock::now();
     packet.interface_used = CommInterface::I2C_INTERFACE;
     packet.is_valid = false;
-    packet.sensor_id = "i2c_" + std::to_string(address);
-    packet.location = "I2C_Bus_" + std::to_string(bus_);
+    assign_sensor_identity(packet, registry_.get(), CommInterface::I2C_INTERFACE,
+                           static_cast<uint32_t>(address), "i2c_", bus_location_);
     
     if (address == 0x76 || address == 0x77) {
         // BME280 parsing
@@ -628,8 +877,6 @@ SensorDataPacket I2CInterface::parse_i2c_packet(int address, const std::vector<u
             packet.is_valid = true;
         }
     }
-    
-    return packet;
 }
 
 } // namespace rpi4_gateway 
\ No newline at end of file
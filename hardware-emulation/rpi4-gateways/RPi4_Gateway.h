@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <queue>
+#include <deque>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -13,6 +14,15 @@
 #include <functional>
 #include <fstream>
 #include <unordered_map>
+#include <shared_mutex>
+#include <array>
+#include <string_view>
+#include "../../thermal-monitoring/RingHistory.h"
+#include "../../thermal-monitoring/RollingStats.h"
+#include "../../thermal-monitoring/BoundedMpmcQueue.h"
+#include "../../thermal-monitoring/Clock.h"
+#include "../../thermal-monitoring/Metrics.h"
+#include "../../thermal-monitoring/StateSnapshot.h"
 
 namespace rpi4_gateway {
 
@@ -42,16 +52,34 @@ enum class GatewayMode {
  */
 enum class ProcessingStrategy {
     RAW_FORWARD,        // Forward all data as-is
-    AGGREGATE_BATCH,    // Batch and aggregate data
-    SMART_FILTER,       // Intelligent filtering and prioritization
+    AGGREGATE_BATCH,    // All sensors' readings in size/latency-bounded batch payloads
+    SMART_FILTER,       // Per-sensor deadband filtering; alerts always pass
     PREDICTIVE_EDGE     // Edge AI/ML processing
 };
 
+/**
+ * When the segment store calls fdatasync on its segment files
+ */
+enum class StorageSyncPolicy {
+    NEVER,              // Leave write-back to the kernel
+    EVERY_COMMIT,       // After every group commit
+    PERIODIC            // At most once per storage_sync_interval_ms
+};
+
+// Dense per-gateway sensor index assigned by SensorRegistry
+using SensorHandle = uint32_t;
+constexpr SensorHandle INVALID_SENSOR_HANDLE = 0xFFFFFFFFu;
+
 /**
  * Sensor data packet from STM32 nodes
+ *
+ * Handed through the pipeline by move (interface -> gateway -> ingest
+ * queue -> worker); each stage keeps and refills its own packet object, so
+ * the two strings keep their capacity instead of being reallocated per frame.
  */
 struct SensorDataPacket {
     std::string sensor_id;
+    SensorHandle sensor_handle = INVALID_SENSOR_HANDLE;
     std::string location;
     float temperature_celsius;
     float humidity_percent;
@@ -70,6 +98,88 @@ struct SensorDataPacket {
     float data_confidence;      // AI-computed confidence score
 };
 
+/**
+ * Per-sensor packet history kept by the DataProcessor
+ * Fixed ring of the numeric fields used by analytics and aggregation,
+ * one contiguous array per field
+ */
+struct SensorHistory {
+    static constexpr size_t TEMPERATURE = 0;
+    static constexpr size_t HUMIDITY = 1;
+    static constexpr size_t PRESSURE = 2;
+    static constexpr size_t VALID = 3;
+    
+    std::string location;
+    thermal_monitoring::RingHistory<float, float, float, uint8_t> samples;
+    thermal_monitoring::WindowedStats temperature_window;     // Temperatures in samples
+    thermal_monitoring::RunningStats temperature_lifetime;    // Every valid packet
+    thermal_monitoring::RunningStats humidity_lifetime;
+    
+    // SMART_FILTER deadband reference: the last reading actually published
+    bool has_published = false;
+    float published_temperature = 0.0f;
+    float published_humidity = 0.0f;
+    std::chrono::steady_clock::time_point published_at;
+};
+
+/**
+ * Per-sensor strings built once at registration
+ */
+struct SensorInfo {
+    SensorHandle handle;
+    std::string sensor_id;
+    std::string location;           // Fixed bus location for node-registered sensors
+    std::string data_topic;         // {base}/sensors/{id}/data
+    std::string binary_topic;       // {base}/sensors/{id}/bin
+    std::string aggregated_topic;   // {base}/sensors/{id}/aggregated
+};
+
+/**
+ * Interns sensor ids into dense integer handles
+ *
+ * Handles index flat per-sensor arrays in the DataProcessor, so the hot
+ * path does one lookup at ingest instead of hashing the id string for
+ * every table. Interfaces that identify nodes numerically register by
+ * (interface, node number) and never build the id string after the first
+ * frame.
+ *
+ * Entries are stored in fixed-size chunks that never move, so info() is a
+ * lock-free read for any handle the caller obtained from this registry.
+ */
+class SensorRegistry {
+public:
+    static constexpr size_t CHUNK_SIZE = 256;
+    static constexpr size_t MAX_CHUNKS = 256;
+    
+    explicit SensorRegistry(const std::string& base_topic);
+    ~SensorRegistry();
+    
+    SensorRegistry(const SensorRegistry&) = delete;
+    SensorRegistry& operator=(const SensorRegistry&) = delete;
+    
+    // Returns INVALID_SENSOR_HANDLE once CHUNK_SIZE * MAX_CHUNKS sensors exist
+    SensorHandle intern(const std::string& sensor_id);
+    SensorHandle intern_node(CommInterface interface, uint32_t node_number,
+                             const char* id_prefix, const std::string& location);
+    SensorHandle find(const std::string& sensor_id) const;
+    
+    const SensorInfo& info(SensorHandle handle) const {
+        return chunks_[handle / CHUNK_SIZE].load(std::memory_order_acquire)[handle % CHUNK_SIZE];
+    }
+    size_t size() const { return count_.load(std::memory_order_acquire); }
+    
+private:
+    std::string base_topic_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, SensorHandle> by_id_;
+    std::unordered_map<uint64_t, SensorHandle> by_node_;
+    std::array<std::atomic<SensorInfo*>, MAX_CHUNKS> chunks_;
+    std::atomic<size_t> count_;
+    
+    // Caller holds mutex_ exclusively
+    SensorHandle add_locked(const std::string& sensor_id, const std::string& location);
+};
+
 /**
  * Aggregated sensor statistics
  */
@@ -88,6 +198,28 @@ struct SensorStatistics {
     std::chrono::steady_clock::time_point first_seen;
 };
 
+/**
+ * Ingest queue counters, summed over partitions; depth and high-water
+ * mark are in packets (high-water is the deepest any partition has been)
+ */
+struct IngestQueueStats {
+    size_t capacity;
+    size_t depth;
+    size_t high_water_mark;
+    uint64_t enqueued_packets;
+    uint64_t dropped_packets;
+};
+
+/**
+ * Outbound MQTT counters for the processing strategy in effect
+ */
+struct PublishStats {
+    uint64_t messages_published;    // Per-reading, batch and alert publishes
+    uint64_t readings_batched;      // Readings carried inside batch payloads
+    uint64_t readings_suppressed;   // Held back by the SMART_FILTER deadband
+    uint64_t alerts_forwarded;      // Readings published immediately because they alerted
+};
+
 /**
  * Gateway system status
  */
@@ -159,6 +291,7 @@ struct RPi4GatewayConfig {
     std::string mqtt_password;
     std::string mqtt_base_topic = "gateway";
     bool mqtt_ssl = false;
+    bool mqtt_binary_payloads = false;  // Packed wire format on .../bin topics instead of JSON
     
     // WebSocket settings
     std::string websocket_host = "localhost";
@@ -178,6 +311,12 @@ struct RPi4GatewayConfig {
     std::string log_directory = "/var/log/rpi4-gateway";
     int max_log_files = 10;
     uint64_t max_storage_mb = 1024;
+    size_t storage_commit_bytes = 64 * 1024;    // Group commit once this much is buffered...
+    int storage_commit_interval_ms = 1000;      // ...or this long has passed
+    StorageSyncPolicy storage_sync_policy = StorageSyncPolicy::PERIODIC;
+    int storage_sync_interval_ms = 10000;
+    std::string state_snapshot_path;            // Warm restart file for per-sensor state; empty disables
+    int state_snapshot_interval_ms = 5000;      // How often changed sensors are written to it
     
     // Alert thresholds
     float temp_alert_low = 10.0f;
@@ -189,6 +328,128 @@ struct RPi4GatewayConfig {
     int max_concurrent_sensors = 100;
     int max_queue_size = 10000;
     int worker_thread_count = 4;
+    int ingest_batch_size = 32;         // Packets a worker takes per wakeup
+    bool partition_workers_by_sensor = true;  // Pin each sensor to one worker
+    
+    // AGGREGATE_BATCH: one {base}/batch payload for all sensors, published
+    // when it reaches batch_max_bytes or its oldest reading is this old
+    size_t batch_max_bytes = 16 * 1024;
+    int batch_max_latency_ms = 1000;
+    
+    // SMART_FILTER: readings inside the deadband of the last published value
+    // are suppressed; a heartbeat still goes out after max silence
+    float deadband_temperature_c = 0.2f;
+    float deadband_humidity_percent = 1.0f;
+    int deadband_max_silence_seconds = 300;
+    
+    // Prometheus text exposition at http://metrics_host:metrics_port/metrics (0 disables)
+    int metrics_port = 0;
+    std::string metrics_host = "0.0.0.0";
+
+    // Multi-gateway mode: sensors are sharded by consistent hashing over
+    // every gateway heartbeating on mesh_topic (see GatewayMesh)
+    bool mesh_enabled = false;
+    std::string mesh_topic = "thermal/mesh";
+    int mesh_virtual_nodes = 64;
+    int mesh_heartbeat_interval_ms = 1000;
+    int mesh_peer_timeout_ms = 5000;        // Silent this long = gateway failed
+    bool mesh_replicate_readings = true;    // Mirror readings to each sensor's replica gateway
+};
+
+/**
+ * Single-threaded epoll reactor shared by the hardware interfaces
+ *
+ * One thread waits on every registered descriptor; handlers run on that
+ * thread as soon as the kernel reports readiness, so latency is bounded by
+ * the wire rather than a sleep interval. Master-driven buses (SPI, I2C)
+ * that have no readiness signal register a timerfd-backed periodic source
+ * on the same thread instead of owning a polling thread.
+ *
+ * remove() guarantees the handler is not running and will not run again
+ * once it returns, so interfaces can unregister from stop()/destructors.
+ */
+class CommReactor {
+public:
+    using EventHandler = std::function<void(uint32_t events)>;
+    
+    CommReactor();
+    ~CommReactor();
+    
+    bool start();
+    void stop();
+    bool is_running() const { return running_.load(); }
+    
+    // Returns a source id, or -1 on failure
+    int add_fd(int fd, uint32_t events, EventHandler handler);
+    int add_timer(std::chrono::milliseconds period, std::function<void()> handler);
+    void remove(int source_id);
+    
+    // Process-wide reactor, started on first use and shut down with its last user
+    static std::shared_ptr<CommReactor> shared();
+    
+private:
+    struct Source {
+        int fd;
+        bool is_timer;
+        std::shared_ptr<EventHandler> handler;
+    };
+    
+    int epoll_fd_;
+    int wake_fd_;
+    std::atomic<bool> running_;
+    std::thread reactor_thread_;
+    std::recursive_mutex dispatch_mutex_;  // Held while a handler runs
+    std::unordered_map<int, Source> sources_;
+    int next_source_id_;
+    
+    int add_source(int fd, uint32_t events, bool is_timer, EventHandler handler);
+    void reactor_loop();
+};
+
+/**
+ * Fixed-capacity byte ring for parsing serial frames in place
+ */
+template <size_t N>
+class ByteRing {
+public:
+    size_t size() const { return count_; }
+    void clear() { head_ = 0; count_ = 0; }
+    
+    uint8_t operator[](size_t index) const { return data_[(head_ + index) % N]; }
+    
+    // Largest contiguous free region, for read() straight into the ring
+    uint8_t* write_region(size_t& length) {
+        size_t tail = (head_ + count_) % N;
+        if (count_ == N) {
+            length = 0;
+        } else if (tail >= head_) {
+            length = N - tail;
+        } else {
+            length = head_ - tail;
+        }
+        return data_.data() + tail;
+    }
+    void commit(size_t length) { count_ += length; }
+    void consume(size_t length) {
+        head_ = (head_ + length) % N;
+        count_ -= length;
+    }
+    
+    // Pointer to 'length' bytes at 'offset' when they don't wrap, else nullptr
+    const uint8_t* contiguous(size_t offset, size_t length) const {
+        size_t start = (head_ + offset) % N;
+        return start + length <= N ? data_.data() + start : nullptr;
+    }
+    void copy_out(size_t offset, uint8_t* out, size_t length) const {
+        for (size_t i = 0; i < length; ++i) {
+            out[i] = (*this)[offset + i];
+        }
+    }
+    
+private:
+    std::array<uint8_t, N> data_{};
+    size_t head_ = 0;
+    size_t count_ = 0;
 };
 
 /**
@@ -202,7 +463,11 @@ public:
     virtual void stop() = 0;
     virtual bool is_active() const = 0;
     virtual std::string get_interface_name() const = 0;
-    virtual void set_data_callback(std::function<void(const SensorDataPacket&)> callback) = 0;
+    // The callback may take the packet's contents; the interface refills the object next frame
+    virtual void set_data_callback(std::function<void(SensorDataPacket&&)> callback) = 0;
+    
+    // Optional: lets the interface stamp packets with interned handles
+    virtual void set_sensor_registry(std::shared_ptr<SensorRegistry> registry) { (void)registry; }
 };
 
 /**
@@ -218,18 +483,27 @@ public:
     void stop() override;
     bool is_active() const override { return active_.load(); }
     std::string get_interface_name() const override { return "UART"; }
-    void set_data_callback(std::function<void(const SensorDataPacket&)> callback) override;
+    void set_data_callback(std::function<void(SensorDataPacket&&)> callback) override;
+    void set_sensor_registry(std::shared_ptr<SensorRegistry> registry) override { registry_ = registry; }
+    
+    // [0xAA][0xBB][NodeID(4)][Temp(2)][Humidity(2)][Voltage(2)][Status(1)][Checksum(1)]
+    static constexpr size_t FRAME_SIZE = 14;
     
 private:
     std::string device_;
     int baudrate_;
     int fd_;
     std::atomic<bool> active_;
-    std::thread reader_thread_;
-    std::function<void(const SensorDataPacket&)> data_callback_;
+    std::shared_ptr<CommReactor> reactor_;
+    int reactor_source_;
+    std::shared_ptr<SensorRegistry> registry_;
+    ByteRing<1024> rx_ring_;
+    SensorDataPacket rx_packet_;
+    std::function<void(SensorDataPacket&&)> data_callback_;
     
-    void reader_loop();
-    SensorDataPacket parse_uart_packet(const std::vector<uint8_t>& data);
+    void on_readable();
+    void parse_frames();
+    void parse_uart_packet(const uint8_t* frame, SensorDataPacket& packet);
 };
 
 /**
@@ -245,18 +519,22 @@ public:
     void stop() override;
     bool is_active() const override { return active_.load(); }
     std::string get_interface_name() const override { return "SPI"; }
-    void set_data_callback(std::function<void(const SensorDataPacket&)> callback) override;
+    void set_data_callback(std::function<void(SensorDataPacket&&)> callback) override;
+    void set_sensor_registry(std::shared_ptr<SensorRegistry> registry) override { registry_ = registry; }
     
 private:
     std::string device_;
     int speed_;
     int fd_;
     std::atomic<bool> active_;
-    std::thread polling_thread_;
-    std::function<void(const SensorDataPacket&)> data_callback_;
+    std::shared_ptr<CommReactor> reactor_;
+    int reactor_source_;
+    std::shared_ptr<SensorRegistry> registry_;
+    SensorDataPacket rx_packet_;
+    std::function<void(SensorDataPacket&&)> data_callback_;
     
-    void polling_loop();
-    SensorDataPacket parse_spi_packet(const std::vector<uint8_t>& data);
+    void poll_once();
+    void parse_spi_packet(const uint8_t* data, size_t length, SensorDataPacket& packet);
 };
 
 /**
@@ -272,19 +550,25 @@ public:
     void stop() override;
     bool is_active() const override { return active_.load(); }
     std::string get_interface_name() const override { return "I2C"; }
-    void set_data_callback(std::function<void(const SensorDataPacket&)> callback) override;
+    void set_data_callback(std::function<void(SensorDataPacket&&)> callback) override;
+    void set_sensor_registry(std::shared_ptr<SensorRegistry> registry) override { registry_ = registry; }
     
 private:
     int bus_;
     std::vector<int> addresses_;
     int fd_;
     std::atomic<bool> active_;
-    std::thread polling_thread_;
-    std::function<void(const SensorDataPacket&)> data_callback_;
+    std::shared_ptr<CommReactor> reactor_;
+    int reactor_source_;
+    std::shared_ptr<SensorRegistry> registry_;
+    std::string bus_location_;
+    std::vector<uint8_t> rx_data_;
+    SensorDataPacket rx_packet_;
+    std::function<void(SensorDataPacket&&)> data_callback_;
     
-    void polling_loop();
+    void poll_once();
     bool read_i2c_sensor(int address, std::vector<uint8_t>& data);
-    SensorDataPacket parse_i2c_packet(int address, const std::vector<uint8_t>& data);
+    void parse_i2c_packet(int address, const std::vector<uint8_t>& data, SensorDataPacket& packet);
 };
 
 /**
@@ -299,10 +583,15 @@ public:
     bool start();
     void stop();
     
-    // Data input
+    // Data input; the rvalue overload takes the packet's contents and leaves
+    // it holding a spent packet whose strings the caller can refill
     void process_packet(const SensorDataPacket& packet);
+    void process_packet(SensorDataPacket&& packet);
     
     // Statistics and monitoring
+    std::shared_ptr<SensorRegistry> get_sensor_registry() const { return registry_; }
+    IngestQueueStats get_queue_stats() const;
+    PublishStats get_publish_stats() const;
     SensorStatistics get_sensor_statistics(const std::string& sensor_id) const;
     std::vector<SensorStatistics> get_all_statistics() const;
     
@@ -315,24 +604,103 @@ public:
     void set_websocket_callback(std::function<void(const std::string&)> callback);
     void set_alert_callback(std::function<void(const std::string&, const std::string&)> callback);
     
+    // Time source for aggregation windows and batch latency; set before initialize()
+    void set_clock(std::shared_ptr<thermal_monitoring::Clock> clock);
+
+    // Multi-gateway handoff: a portable copy of one sensor's history and
+    // statistics (sensor_state format). Import keeps whichever copy has seen
+    // more packets, so a stale or freshly booted peer never erases a trend
+    bool export_sensor_state(const std::string& sensor_id, std::string& out) const;
+    bool import_sensor_state(const uint8_t* data, size_t length);
+    void forget_sensor(const std::string& sensor_id);
+
+    // Replica of a reading processed by another gateway: history and
+    // statistics only, nothing is published or alerted
+    void record_replica(SensorDataPacket&& packet);
+
+    // Warm restart: with config.state_snapshot_path set, initialize() maps
+    // the file back in and workers write the sensors changed since their
+    // last pass every state_snapshot_interval_ms (sensor_state format).
+    // save_state_snapshot() writes every partition now and waits for the disk
+    void save_state_snapshot();
+    thermal_monitoring::StateSnapshotFile::Stats get_state_snapshot_stats() const;
+
 private:
     RPi4GatewayConfig config_;
+    std::shared_ptr<thermal_monitoring::Clock> clock_;
     std::atomic<bool> running_;
     
+    /**
+     * Slice of the processor owned by one worker
+     *
+     * In partitioned mode every sensor handle maps to exactly one partition and
+     * each partition has exactly one worker, so a sensor's packets are
+     * processed in arrival order and workers never share state. The mutex
+     * only guards against monitoring readers (get_*_statistics). With
+     * partitioning off there is a single partition shared by all workers.
+     */
+    struct SensorPartition {
+        SensorPartition(size_t partition_index, size_t queue_capacity)
+            : index(partition_index), queue(queue_capacity),
+              last_aggregation(std::chrono::steady_clock::now()) {}
+        
+        const size_t index;
+        thermal_monitoring::BoundedMpmcQueue<SensorDataPacket> queue;
+        
+        // Indexed by handle / partition count; stats.sensor_id stays empty
+        // for slots whose sensor has not reported yet
+        std::vector<SensorHistory> sensor_history;
+        std::vector<SensorStatistics> sensor_stats;
+        std::vector<uint8_t> state_dirty;      // Changed since the last state snapshot pass
+        std::chrono::steady_clock::time_point last_aggregation;
+        mutable std::mutex mutex;
+        
+        // Held by the worker writing this partition's state snapshot
+        std::mutex state_snapshot_mutex;
+        std::chrono::steady_clock::time_point last_state_snapshot;
+        
+        // Idle workers park here; producers only touch it when someone is parked
+        std::atomic<int> idle_workers{0};
+        std::mutex idle_mutex;
+        std::condition_variable idle_cv;
+    };
+    
     // Threading
     std::vector<std::thread> worker_threads_;
-    std::queue<SensorDataPacket> processing_queue_;
-    mutable std::mutex queue_mutex_;
-    std::condition_variable queue_cv_;
+    std::vector<std::unique_ptr<SensorPartition>> partitions_;
+    std::shared_ptr<SensorRegistry> registry_;
+    std::atomic<size_t> queue_high_water_{0};
+    std::atomic<uint64_t> enqueued_packets_{0};
+    std::atomic<uint64_t> dropped_packets_{0};
     
-    // Data storage
-    std::unordered_map<std::string, std::vector<SensorDataPacket>> sensor_history_;
-    std::unordered_map<std::string, SensorStatistics> sensor_stats_;
-    mutable std::mutex data_mutex_;
+    // AGGREGATE_BATCH payload under construction, shared by all partitions
+    std::string batch_payload_;
+    size_t batch_readings_ = 0;
+    std::chrono::steady_clock::time_point batch_started_;
+    std::mutex batch_mutex_;
+    std::string batch_topic_;
+    
+    std::atomic<uint64_t> messages_published_{0};
+    std::atomic<uint64_t> readings_batched_{0};
+    std::atomic<uint64_t> readings_suppressed_{0};
+    std::atomic<uint64_t> alerts_forwarded_{0};
+    
+    // Edge processing: the last EDGE_RESULTS_HISTORY analyses as compact
+    // records in a fixed ring, rendered by get_recent_edge_results()
+    struct EdgeRecord {
+        SensorHandle sensor = INVALID_SENSOR_HANDLE;
+        float slope = 0.0f;
+        float intercept = 0.0f;
+        float temperature = 0.0f;
+        float humidity = 0.0f;
+        float confidence = 0.0f;
+        std::chrono::steady_clock::time_point processed_at;
+    };
+    static constexpr size_t EDGE_RESULTS_HISTORY = 100;
     
-    // Edge processing
     std::atomic<bool> edge_analytics_enabled_;
-    std::vector<EdgeProcessingResult> edge_results_;
+    std::vector<EdgeRecord> edge_journal_;
+    uint64_t edge_results_journaled_ = 0;
     mutable std::mutex edge_results_mutex_;
     
     // Callbacks
@@ -340,18 +708,162 @@ private:
     std::function<void(const std::string&)> websocket_callback_;
     std::function<void(const std::string&, const std::string&)> alert_callback_;
     
+    std::unique_ptr<thermal_monitoring::StateSnapshotFile> state_store_;
+    
+    // Instruments in the global metrics registry, labelled with the gateway id
+    thermal_monitoring::metrics::Histogram& processing_seconds_;
+    thermal_monitoring::metrics::Counter& alerts_raised_;
+    
     // Internal methods
-    void worker_loop();
-    void process_packet_internal(const SensorDataPacket& packet);
-    void update_statistics(const SensorDataPacket& packet);
-    void check_alerts(const SensorDataPacket& packet);
-    void perform_edge_analytics(const SensorDataPacket& packet);
-    void aggregate_and_forward();
-    
-    // Data formatting
-    std::string format_mqtt_message(const SensorDataPacket& packet);
-    std::string format_websocket_message(const SensorDataPacket& packet);
-    std::string format_aggregated_data(const std::vector<SensorDataPacket>& packets);
+    SensorPartition& partition_for(SensorHandle handle) const;
+    size_t slot_for(SensorHandle handle) const { return handle / partitions_.size(); }
+    void worker_loop(size_t partition_index);
+    void wake_idle_worker(SensorPartition& partition);
+    void process_packet_internal(SensorPartition& partition, const SensorDataPacket& packet);
+    void record_reading(SensorPartition& partition, const SensorDataPacket& packet);
+    void resize_slots(SensorPartition& partition, size_t slot);
+    void restore_state_snapshot();
+    void save_partition_state(SensorPartition& partition, bool force);
+    void update_statistics(SensorPartition& partition, const SensorDataPacket& packet);
+    bool check_alerts(const SensorDataPacket& packet);
+    
+    // Outbound strategy
+    void forward_packet(SensorPartition& partition, const SensorDataPacket& packet, bool alerted);
+    void publish_packet(const SensorDataPacket& packet);
+    bool passes_deadband(SensorPartition& partition, const SensorDataPacket& packet, bool alerted);
+    void append_to_batch(const SensorDataPacket& packet);
+    void flush_batch(bool force);
+    void publish_batch(std::string& payload, size_t readings);
+    void perform_edge_analytics(SensorPartition& partition, const SensorDataPacket& packet);
+    EdgeProcessingResult render_edge_result(const EdgeRecord& record) const;
+    void aggregate_and_forward(SensorPartition& partition);
+    
+    // Data formatting; per-reading messages overwrite 'out' so callers can
+    // keep one buffer per thread
+    void format_mqtt_message(const SensorDataPacket& packet, std::string& out);
+    void format_binary_mqtt_message(const SensorDataPacket& packet, std::string& out);
+    void format_websocket_message(const SensorDataPacket& packet, std::string& out);
+    std::string format_aggregated_data(const std::string& sensor_id, const SensorHistory& history, size_t from);
+};
+
+/**
+ * Append-only binary segment files with background group commit
+ *
+ * Records go into a preallocated in-memory buffer under a short lock (a
+ * memcpy, no I/O). A flusher thread swaps the buffer out and writes it to
+ * the always-open segment file for the record's local day once
+ * storage_commit_bytes are pending or storage_commit_interval_ms elapses,
+ * then applies the configured fdatasync policy. If the flusher falls
+ * behind by more than eight commits' worth (at least 1 MiB), new records
+ * are dropped and counted rather than blocking the caller.
+ *
+ * Segment file: 8-byte file header "RP4SEG" | u8 version | u8 0, followed
+ * by records, little-endian:
+ *   u8 type | u8 version | u16 payload length | i64 wall-clock ms | payload
+ * A torn record left by a crash is truncated away when the segment is
+ * reopened. Every payload starts with the u8-length-prefixed sensor id.
+ *
+ * Sealed (past-day) segments are compacted into sensor-major order and
+ * get a sparse ".idx" sidecar: file header "RP4IDX" | u8 version | u8 0 |
+ * u64 segment size | u64 entry count, then 24-byte entries
+ *   u32 sensor id hash | u32 0 | i64 timestamp_ms | u64 record offset
+ * sorted by (hash, time), one every INDEX_STRIDE records of a sensor.
+ * A range query mmaps both files, binary-searches the index and parses
+ * only that sensor's run. Today's segment is scanned linearly.
+ */
+class SegmentStore {
+public:
+    enum class RecordType : uint8_t {
+        SENSOR_READING = 1,
+        STATISTICS = 2,
+        EDGE_RESULT = 3
+    };
+    
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr size_t FILE_HEADER_SIZE = 8;
+    static constexpr size_t RECORD_HEADER_SIZE = 12;
+    static constexpr size_t INDEX_HEADER_SIZE = 24;
+    static constexpr size_t INDEX_ENTRY_SIZE = 24;
+    static constexpr size_t INDEX_STRIDE = 128;
+    
+    struct Stats {
+        uint64_t appended_records;
+        uint64_t dropped_records;
+        uint64_t commits;
+        uint64_t syncs;
+        uint64_t bytes_written;
+    };
+    
+    // Returns false to stop the scan
+    using RecordVisitor = std::function<bool(RecordType type, int64_t timestamp_ms, 
+                                             const uint8_t* payload, size_t length)>;
+    
+    SegmentStore(const std::string& directory, const RPi4GatewayConfig& config);
+    ~SegmentStore();
+    
+    bool open();
+    void close();
+    
+    bool append_reading(const SensorDataPacket& packet, int64_t timestamp_ms);
+    bool append_statistics(const SensorStatistics& stats, int64_t timestamp_ms);
+    bool append_edge_result(const EdgeProcessingResult& result, int64_t timestamp_ms);
+    
+    // Commit everything appended so far and wait until it is written
+    void flush();
+    
+    Stats get_stats() const;
+    std::vector<std::string> list_segments() const;
+    
+    // Readings of one sensor with wall-clock time in [start_ms, end_ms], oldest first
+    std::vector<SensorDataPacket> query_readings(const std::string& sensor_id, 
+                                                 int64_t start_ms, int64_t end_ms) const;
+    
+    // Maintenance: index sealed segments; delete the oldest whole segments
+    // until the store fits max_bytes (today's segment is never deleted)
+    size_t compact_sealed_segments();
+    size_t enforce_retention(uint64_t max_bytes);
+    uint64_t disk_usage() const;
+    
+    // Sequential scan of one segment file; returns the offset just past the
+    // last complete record (0 if the file is not a segment)
+    static uint64_t scan_segment(const std::string& path, const RecordVisitor& visitor);
+    static bool decode_reading(const uint8_t* payload, size_t length, SensorDataPacket& packet);
+    
+private:
+    std::string directory_;
+    size_t commit_bytes_;
+    size_t max_buffer_bytes_;
+    std::chrono::milliseconds commit_interval_;
+    StorageSyncPolicy sync_policy_;
+    std::chrono::milliseconds sync_interval_;
+    
+    // Producer side
+    mutable std::mutex buffer_mutex_;
+    std::condition_variable flush_cv_;
+    std::condition_variable committed_cv_;
+    std::vector<uint8_t> active_buffer_;
+    uint64_t appended_seq_;
+    uint64_t committed_seq_;
+    bool flush_requested_;
+    bool running_;
+    Stats stats_;
+    std::string active_segment_path_;
+    std::thread flusher_thread_;
+    
+    // Flusher side only
+    std::vector<uint8_t> flushing_buffer_;
+    int segment_fd_;
+    int64_t segment_start_ms_;
+    int64_t segment_end_ms_;
+    std::chrono::steady_clock::time_point last_sync_;
+    
+    bool append(RecordType type, int64_t timestamp_ms, const uint8_t* payload, size_t length);
+    void flusher_loop();
+    void write_buffer(const std::vector<uint8_t>& buffer);
+    bool open_segment_for(int64_t timestamp_ms);
+    void close_segment();
+    bool is_sealed(const std::string& path) const;
+    bool compact_segment(const std::string& path);
 };
 
 /**
@@ -370,6 +882,10 @@ public:
     bool store_statistics(const SensorStatistics& stats);
     bool store_edge_result(const EdgeProcessingResult& result);
     
+    // CSV export of stored readings (the on-disk format is binary segments)
+    bool export_csv(const std::string& output_path);
+    SegmentStore::Stats get_segment_stats() const;
+    
     // Data retrieval
     std::vector<SensorDataPacket> retrieve_sensor_data(const std::string& sensor_id, 
                                                        const std::chrono::system_clock::time_point& start,
@@ -385,6 +901,7 @@ private:
     std::string data_path_;
     std::string log_path_;
     mutable std::mutex storage_mutex_;
+    std::unique_ptr<SegmentStore> segment_store_;
     
     bool ensure_directories();
     std::string get_data_filename(const std::string& sensor_id, const std::chrono::system_clock::time_point& timestamp);
@@ -418,6 +935,254 @@ private:
     void update_system_metrics();
 };
 
+/**
+ * Plain HTTP server for GET /metrics on the shared comm reactor
+ *
+ * Serves the global metrics registry in the Prometheus text format to any
+ * scraper; every other path gets a 404. One request per connection
+ * (Connection: close). Sockets are non-blocking and edge-triggered, so a
+ * slow scraper never blocks the reactor. The body is rendered on the
+ * endpoint's own thread and handed back through an eventfd; only socket
+ * reads and writes run on the reactor, so a scrape never delays UART
+ * handling.
+ */
+class MetricsEndpoint {
+public:
+    MetricsEndpoint(const std::string& host, int port);
+    ~MetricsEndpoint();
+    
+    bool start();
+    void stop();
+    bool is_running() const { return listen_fd_ >= 0; }
+    
+private:
+    struct Client {
+        int fd;
+        int source_id;
+        uint64_t serial;        // Tells a reused fd's new client from the one a render was for
+        bool rendering;
+        std::string request;
+        std::string response;
+        size_t sent;
+    };
+    
+    // One request on its way through the render thread
+    struct RenderJob {
+        int fd;
+        uint64_t serial;
+        std::string text;       // Request in, response out
+    };
+    
+    std::string host_;
+    int port_;
+    int listen_fd_;
+    int listen_source_;
+    std::shared_ptr<CommReactor> reactor_;
+    
+    // Handlers on the reactor thread add and drop clients; stop() takes them all
+    std::mutex clients_mutex_;
+    std::unordered_map<int, std::unique_ptr<Client>> clients_;
+    uint64_t next_serial_;
+    
+    // Requests to render and rendered responses, guarded by render_mutex_;
+    // the render thread signals done_fd_ on the reactor when it finishes one
+    std::thread render_thread_;
+    std::mutex render_mutex_;
+    std::condition_variable render_cv_;
+    std::deque<RenderJob> render_queue_;
+    std::vector<RenderJob> rendered_;
+    bool render_stop_;
+    int done_fd_;
+    int done_source_;
+    
+    void on_accept();
+    void on_client(int fd, uint32_t events);
+    void on_rendered();
+    void send_response(int fd, Client* client);
+    void close_client(int fd);
+    void render_loop();
+    static std::string build_response(const std::string& request);
+};
+
+/**
+ * Portable encoding of one sensor's DataProcessor state, for handoff
+ * between gateways
+ *
+ * Little-endian, version 1:
+ *   u8 version | i64 wall-clock ms at encode
+ *   u8 len + sensor_id | u8 len + location
+ *   u64 total | u64 valid | u64 error packets | f32 min | f32 max temperature
+ *   i64 first_seen age ns | i64 last_update age ns
+ *   2 x (u64 count | f64 mean | f64 variance | f64 min | f64 max)   lifetime temperature, humidity
+ *   u8 has_published | f32 temperature | f32 humidity | i64 age ns  deadband reference
+ *   u32 samples, then per sample oldest first:
+ *     i64 age ns | f32 temperature | f32 humidity | f32 pressure | u8 valid
+ *
+ * steady_clock time does not cross hosts, so time points travel as ages
+ * before the encoder's now and are rebased on the decoder's clock, less the
+ * wall-clock time the message spent in flight.
+ */
+namespace sensor_state {
+    constexpr uint8_t FORMAT_VERSION = 1;
+
+    void encode(const SensorStatistics& stats, const SensorHistory& history,
+                std::chrono::steady_clock::time_point now, std::string& out);
+    size_t max_encoded_size(size_t history_capacity);
+    // Keeps the newest history_capacity samples and rebuilds the windowed stats from them
+    bool decode(const uint8_t* data, size_t length, std::chrono::steady_clock::time_point now,
+                size_t history_capacity, SensorStatistics& stats, SensorHistory& history);
+}
+
+/**
+ * Consistent-hash ring over gateway ids
+ *
+ * Every gateway places virtual_nodes points on a 32-bit ring. A sensor
+ * belongs to the first point at or after the hash of its id, and its
+ * replica is the next point owned by a different gateway. Adding or
+ * removing one of N gateways moves only about 1/N of the sensors. The ring
+ * is immutable; membership changes build a new one.
+ */
+class ConsistentHashRing {
+public:
+    struct Assignment {
+        const std::string* owner = nullptr;     // Null only for an empty ring
+        const std::string* replica = nullptr;   // Null with fewer than two members
+    };
+
+    ConsistentHashRing(std::vector<std::string> members, int virtual_nodes);
+
+    Assignment assign(std::string_view key) const;
+    const std::vector<std::string>& members() const { return members_; }
+
+    // FNV-1a with a murmur3 finalizer, so ids differing only in a numeric
+    // suffix still spread over the whole ring
+    static uint32_t hash(std::string_view key);
+
+private:
+    struct Point {
+        uint32_t hash;
+        uint32_t member;
+    };
+
+    std::vector<std::string> members_;  // Sorted, unique
+    std::vector<Point> points_;         // Sorted by hash
+};
+
+/**
+ * Sensor sharding across the gateways of one site
+ *
+ * Gateways find each other through heartbeats on {mesh_topic}/heartbeat
+ * and hash every sensor onto the resulting ring. Readings of a sensor that
+ * another gateway owns are forwarded to {mesh_topic}/{owner}/reading; the
+ * owner processes them and mirrors each one to the sensor's replica on
+ * {mesh_topic}/{replica}/replica, which keeps the history and statistics
+ * warm without publishing anything.
+ *
+ * When membership changes (a heartbeat from a new gateway, a leave message,
+ * or mesh_peer_timeout_ms of silence) every gateway rebuilds the ring and
+ * sends {mesh_topic}/{target}/state for the sensors it owned that moved
+ * and for its sensors whose replica changed. A failed owner's sensors fall
+ * to their replicas, which already hold the history, so trends and edge
+ * regressions continue across the failover. A gateway that stops hands its
+ * sensors over the same way but keeps its own copies, so its warm restart
+ * snapshot (written by DataProcessor::stop() just before) stays intact.
+ *
+ * Messages go out through the publish function (the gateway's MQTT path)
+ * and come back in through handle_message(); the integrator subscribes to
+ * subscriptions() on the site broker. No lock is held while publishing.
+ */
+class GatewayMesh {
+public:
+    using PublishFn = std::function<void(const std::string& topic, const std::string& payload)>;
+    using ReadingFn = std::function<void(SensorDataPacket&& packet)>;
+
+    struct Stats {
+        size_t members;
+        uint64_t membership_changes;
+        uint64_t readings_forwarded;    // Sent to their owner
+        uint64_t readings_replicated;   // Mirrored to a replica
+        uint64_t readings_misrouted;    // Forwarded here but owned elsewhere; dropped
+        uint64_t states_sent;
+        uint64_t states_received;
+    };
+
+    GatewayMesh(const RPi4GatewayConfig& config, DataProcessor& processor, PublishFn publish);
+    ~GatewayMesh();
+
+    GatewayMesh(const GatewayMesh&) = delete;
+    GatewayMesh& operator=(const GatewayMesh&) = delete;
+
+    // Readings forwarded by peers; the gateway runs them through its own ingest
+    void set_reading_callback(ReadingFn callback);
+    // Time source for heartbeat ages; set before start()
+    void set_clock(std::shared_ptr<thermal_monitoring::Clock> clock);
+
+    // Heartbeats run on the shared comm reactor. stop() hands this gateway's
+    // sensors to their next owners and announces the leave
+    bool start();
+    void stop();
+
+    // Heartbeat and failure detection; start() runs it every mesh_heartbeat_interval_ms
+    void tick();
+
+    // Ingest path: true if this gateway owns the sensor (the replica copy has
+    // been sent), false if the reading went to its owner instead
+    bool route_reading(const SensorDataPacket& packet);
+    void handle_message(const std::string& topic, const std::string& payload);
+
+    // Topic filters to subscribe to and feed into handle_message()
+    std::vector<std::string> subscriptions() const;
+
+    const std::string& gateway_id() const { return gateway_id_; }
+    std::string owner_of(const std::string& sensor_id) const;
+    bool owns(const std::string& sensor_id) const;
+    std::vector<std::string> members() const;
+    Stats get_stats() const;
+
+private:
+    using Outbox = std::vector<std::pair<std::string, std::string>>;
+
+    const std::string gateway_id_;
+    const int virtual_nodes_;
+    const std::chrono::milliseconds heartbeat_interval_;
+    const std::chrono::milliseconds peer_timeout_;
+    const bool replicate_readings_;
+    const std::string heartbeat_topic_;   // {mesh_topic}/heartbeat
+    const std::string leave_topic_;       // {mesh_topic}/leave
+    const std::string topic_prefix_;      // {mesh_topic}/
+    const std::string inbox_prefix_;      // {mesh_topic}/{gateway_id}/
+
+    DataProcessor& processor_;
+    PublishFn publish_;
+    ReadingFn reading_callback_;
+    std::shared_ptr<thermal_monitoring::Clock> clock_;
+    std::shared_ptr<CommReactor> reactor_;
+    int timer_source_;
+    std::atomic<bool> running_;
+
+    // Last heartbeat per peer; changes rebuild the ring and run the handoffs
+    // under membership_mutex_. Readers take the ring snapshot under ring_mutex_
+    std::mutex membership_mutex_;
+    std::map<std::string, std::chrono::steady_clock::time_point> peers_;
+    bool left_ = false;                 // After stop() the ring no longer includes this gateway
+    mutable std::shared_mutex ring_mutex_;
+    std::shared_ptr<const ConsistentHashRing> ring_;
+
+    std::atomic<uint64_t> membership_changes_{0};
+    std::atomic<uint64_t> readings_forwarded_{0};
+    std::atomic<uint64_t> readings_replicated_{0};
+    std::atomic<uint64_t> readings_misrouted_{0};
+    std::atomic<uint64_t> states_sent_{0};
+    std::atomic<uint64_t> states_received_{0};
+
+    std::shared_ptr<const ConsistentHashRing> current_ring() const;
+    // Caller holds membership_mutex_
+    void rebuild_ring(Outbox& outbox);
+    void rebalance(const ConsistentHashRing& before, const ConsistentHashRing& after, Outbox& outbox);
+    void send_reading(const std::string& target, const char* kind, const SensorDataPacket& packet);
+    void flush(Outbox& outbox);
+};
+
 /**
  * Main RPi4 Gateway class
  */
@@ -451,6 +1216,11 @@ public:
     void set_external_websocket_callback(std::function<void(const std::string&)> callback);
     void set_thermal_monitoring_callback(std::function<void(const std::string&, float, float)> callback);
     
+    // Multi-gateway mode (mesh_enabled): feed messages on the mesh's
+    // subscriptions() here. get_mesh() is null in single-gateway mode
+    void handle_mesh_message(const std::string& topic, const std::string& payload);
+    const GatewayMesh* get_mesh() const { return mesh_.get(); }
+    
 private:
     RPi4GatewayConfig config_;
     std::atomic<bool> running_;
@@ -460,6 +1230,8 @@ private:
     std::unique_ptr<DataProcessor> data_processor_;
     std::unique_ptr<StorageManager> storage_manager_;
     std::unique_ptr<SystemMonitor> system_monitor_;
+    std::unique_ptr<MetricsEndpoint> metrics_endpoint_;
+    std::unique_ptr<GatewayMesh> mesh_;     // Holds a reference to data_processor_
     
     // Communication interfaces
     std::vector<std::unique_ptr<CommInterfaceBase>> comm_interfaces_;
@@ -473,10 +1245,14 @@ private:
     std::function<void(const std::string&)> external_websocket_callback_;
     std::function<void(const std::string&, float, float)> thermal_callback_;
     
+    // Scrape-time reads of the components above; declared last so they go first
+    thermal_monitoring::metrics::CallbackHandle metrics_callbacks_;
+    
     // Internal methods
     void main_loop();
+    void setup_metrics();
     void setup_communication_interfaces();
-    void handle_sensor_data(const SensorDataPacket& packet);
+    void handle_sensor_data(SensorDataPacket&& packet);
     void handle_mqtt_message(const std::string& topic, const std::string& message);
     void handle_websocket_message(const std::string& message);
     void handle_alert(const std::string& alert_type, const std::string& message);
@@ -0,0 +1,679 @@
+#include "RPi4_Gateway.h"
+#include "../../thermal-monitoring/SensorWireFormat.h"
+#include "../../thermal-monitoring/Log.h"
+#include <algorithm>
+#include <cstring>
+
+namespace rpi4_gateway {
+
+namespace {
+
+void put_u8(std::string& out, uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+void put_u32(std::string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>(value >> shift));
+    }
+}
+
+void put_u64(std::string& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<char>(value >> shift));
+    }
+}
+
+void put_f32(std::string& out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u32(out, bits);
+}
+
+void put_f64(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u64(out, bits);
+}
+
+void put_str8(std::string& out, const std::string& value) {
+    size_t len = std::min<size_t>(value.size(), 0xFF);
+    put_u8(out, static_cast<uint8_t>(len));
+    out.append(value.data(), len);
+}
+
+// Bounds-checked little-endian reads; a short buffer latches ok = false
+struct Reader {
+    const uint8_t* data;
+    size_t length;
+    size_t offset = 0;
+    bool ok = true;
+
+    bool need(size_t count) {
+        if (ok && length - offset < count) {
+            ok = false;
+        }
+        return ok;
+    }
+    uint8_t u8() {
+        return need(1) ? data[offset++] : 0;
+    }
+    uint32_t u32() {
+        uint32_t value = 0;
+        if (need(4)) {
+            for (int i = 0; i < 4; ++i) {
+                value |= static_cast<uint32_t>(data[offset++]) << (8 * i);
+            }
+        }
+        return value;
+    }
+    uint64_t u64() {
+        uint64_t value = 0;
+        if (need(8)) {
+            for (int i = 0; i < 8; ++i) {
+                value |= static_cast<uint64_t>(data[offset++]) << (8 * i);
+            }
+        }
+        return value;
+    }
+    int64_t i64() { return static_cast<int64_t>(u64()); }
+    float f32() {
+        uint32_t bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    double f64() {
+        uint64_t bits = u64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    std::string str8() {
+        size_t len = u8();
+        if (!need(len)) {
+            return std::string();
+        }
+        std::string value(reinterpret_cast<const char*>(data + offset), len);
+        offset += len;
+        return value;
+    }
+};
+
+int64_t wall_clock_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t age_ns(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now - time).count();
+}
+
+void put_running_stats(std::string& out, const thermal_monitoring::RunningStats& stats) {
+    put_u64(out, stats.count());
+    put_f64(out, stats.mean());
+    put_f64(out, stats.variance());
+    put_f64(out, stats.min());
+    put_f64(out, stats.max());
+}
+
+thermal_monitoring::RunningStats get_running_stats(Reader& in) {
+    uint64_t count = in.u64();
+    double mean = in.f64();
+    double variance = in.f64();
+    double min = in.f64();
+    double max = in.f64();
+    return thermal_monitoring::RunningStats::restore(static_cast<size_t>(count), mean, variance, min, max);
+}
+
+// Per-thread buffers for forwarded and mirrored readings
+struct MeshScratch {
+    std::string topic;
+    std::string payload;
+    std::vector<uint8_t> encoded;
+    thermal_monitoring::wire::SensorRecord record;
+};
+
+MeshScratch& mesh_scratch() {
+    thread_local MeshScratch scratch;
+    return scratch;
+}
+
+}
+
+//=============================================================================
+// Sensor State Encoding
+//=============================================================================
+
+namespace sensor_state {
+
+constexpr size_t SAMPLE_SIZE = 21;
+
+size_t max_encoded_size(size_t history_capacity) {
+    // Header and names, counters and lifetime stats, deadband state, samples
+    return 9 + 2 * 256 + 48 + 2 * 40 + 17 + 4 + history_capacity * SAMPLE_SIZE;
+}
+
+void encode(const SensorStatistics& stats, const SensorHistory& history,
+            std::chrono::steady_clock::time_point now, std::string& out) {
+    out.clear();
+    out.reserve(256 + history.samples.size() * SAMPLE_SIZE);
+
+    put_u8(out, FORMAT_VERSION);
+    put_u64(out, static_cast<uint64_t>(wall_clock_ms()));
+    put_str8(out, stats.sensor_id);
+    put_str8(out, history.location);
+
+    put_u64(out, stats.total_packets);
+    put_u64(out, stats.valid_packets);
+    put_u64(out, stats.error_packets);
+    put_f32(out, stats.min_temperature);
+    put_f32(out, stats.max_temperature);
+    put_u64(out, static_cast<uint64_t>(age_ns(now, stats.first_seen)));
+    put_u64(out, static_cast<uint64_t>(age_ns(now, stats.last_update)));
+    put_running_stats(out, history.temperature_lifetime);
+    put_running_stats(out, history.humidity_lifetime);
+
+    put_u8(out, history.has_published ? 1 : 0);
+    put_f32(out, history.published_temperature);
+    put_f32(out, history.published_humidity);
+    put_u64(out, static_cast<uint64_t>(age_ns(now, history.published_at)));
+
+    const auto& samples = history.samples;
+    put_u32(out, static_cast<uint32_t>(samples.size()));
+    for (size_t i = 0; i < samples.size(); ++i) {
+        put_u64(out, static_cast<uint64_t>(age_ns(now, samples.timestamp(i))));
+        put_f32(out, samples.value<SensorHistory::TEMPERATURE>(i));
+        put_f32(out, samples.value<SensorHistory::HUMIDITY>(i));
+        put_f32(out, samples.value<SensorHistory::PRESSURE>(i));
+        put_u8(out, samples.value<SensorHistory::VALID>(i));
+    }
+}
+
+bool decode(const uint8_t* data, size_t length, std::chrono::steady_clock::time_point now,
+            size_t history_capacity, SensorStatistics& stats, SensorHistory& history) {
+    Reader in{data, length};
+    if (in.u8() != FORMAT_VERSION) {
+        return false;
+    }
+
+    // Rebase ages on this clock, also counting the time spent in flight
+    int64_t in_flight_ms = std::max<int64_t>(0, wall_clock_ms() - in.i64());
+    auto rebase = [now, in_flight_ms](int64_t age) {
+        return now - std::chrono::milliseconds(in_flight_ms) -
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(age));
+    };
+
+    stats.sensor_id = in.str8();
+    history.location = in.str8();
+    stats.total_packets = static_cast<size_t>(in.u64());
+    stats.valid_packets = static_cast<size_t>(in.u64());
+    stats.error_packets = static_cast<size_t>(in.u64());
+    stats.min_temperature = in.f32();
+    stats.max_temperature = in.f32();
+    stats.first_seen = rebase(in.i64());
+    stats.last_update = rebase(in.i64());
+    history.temperature_lifetime = get_running_stats(in);
+    history.humidity_lifetime = get_running_stats(in);
+
+    history.has_published = in.u8() != 0;
+    history.published_temperature = in.f32();
+    history.published_humidity = in.f32();
+    history.published_at = rebase(in.i64());
+
+    uint32_t count = in.u32();
+    if (!in.ok || stats.sensor_id.empty()) {
+        return false;
+    }
+
+    // Only the newest samples that fit are kept; the window mirrors them
+    history.samples.reset(history_capacity);
+    history.temperature_window.reset(history_capacity);
+    size_t skip = count > history_capacity ? count - history_capacity : 0;
+    for (uint32_t i = 0; i < count && in.ok; ++i) {
+        int64_t age = in.i64();
+        float temperature = in.f32();
+        float humidity = in.f32();
+        float pressure = in.f32();
+        uint8_t valid = in.u8();
+        if (i < skip || !in.ok) {
+            continue;
+        }
+        history.temperature_window.add(temperature);
+        history.samples.push(rebase(age), temperature, humidity, pressure, valid);
+    }
+    if (!in.ok) {
+        return false;
+    }
+
+    stats.packet_loss_rate = stats.total_packets > 0 ?
+        static_cast<float>(stats.error_packets) / stats.total_packets : 0.0f;
+    stats.avg_temperature = static_cast<float>(history.temperature_lifetime.mean());
+    stats.avg_humidity = static_cast<float>(history.humidity_lifetime.mean());
+    stats.temperature_stddev = static_cast<float>(history.temperature_lifetime.stddev());
+    return true;
+}
+
+} // namespace sensor_state
+
+//=============================================================================
+// ConsistentHashRing Implementation
+//=============================================================================
+
+ConsistentHashRing::ConsistentHashRing(std::vector<std::string> members, int virtual_nodes)
+    : members_(std::move(members)) {
+    std::sort(members_.begin(), members_.end());
+    members_.erase(std::unique(members_.begin(), members_.end()), members_.end());
+
+    size_t per_member = static_cast<size_t>(std::max(1, virtual_nodes));
+    points_.reserve(members_.size() * per_member);
+    std::string key;
+    for (size_t member = 0; member < members_.size(); ++member) {
+        for (size_t v = 0; v < per_member; ++v) {
+            key.assign(members_[member]).append("#").append(std::to_string(v));
+            points_.push_back({hash(key), static_cast<uint32_t>(member)});
+        }
+    }
+
+    // Ties (vanishingly rare) break by member so every gateway builds the same ring
+    std::sort(points_.begin(), points_.end(), [](const Point& a, const Point& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.member < b.member;
+    });
+}
+
+ConsistentHashRing::Assignment ConsistentHashRing::assign(std::string_view key) const {
+    Assignment assignment;
+    if (points_.empty()) {
+        return assignment;
+    }
+
+    uint32_t target = hash(key);
+    auto it = std::lower_bound(points_.begin(), points_.end(), target,
+                               [](const Point& point, uint32_t value) { return point.hash < value; });
+    size_t index = it == points_.end() ? 0 : static_cast<size_t>(it - points_.begin());
+    uint32_t owner = points_[index].member;
+    assignment.owner = &members_[owner];
+
+    // Walk clockwise to the next point of another gateway
+    for (size_t step = 1; step < points_.size(); ++step) {
+        uint32_t member = points_[(index + step) % points_.size()].member;
+        if (member != owner) {
+            assignment.replica = &members_[member];
+            break;
+        }
+    }
+    return assignment;
+}
+
+uint32_t ConsistentHashRing::hash(std::string_view key) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+//=============================================================================
+// GatewayMesh Implementation
+//=============================================================================
+
+GatewayMesh::GatewayMesh(const RPi4GatewayConfig& config, DataProcessor& processor, PublishFn publish)
+    : gateway_id_(config.gateway_id),
+      virtual_nodes_(std::max(1, config.mesh_virtual_nodes)),
+      heartbeat_interval_(std::max(1, config.mesh_heartbeat_interval_ms)),
+      peer_timeout_(std::max(1, config.mesh_peer_timeout_ms)),
+      replicate_readings_(config.mesh_replicate_readings),
+      heartbeat_topic_(config.mesh_topic + "/heartbeat"),
+      leave_topic_(config.mesh_topic + "/leave"),
+      topic_prefix_(config.mesh_topic + "/"),
+      inbox_prefix_(config.mesh_topic + "/" + config.gateway_id + "/"),
+      processor_(processor), publish_(std::move(publish)),
+      clock_(thermal_monitoring::Clock::steady()), timer_source_(-1), running_(false),
+      ring_(std::make_shared<const ConsistentHashRing>(std::vector<std::string>{config.gateway_id},
+                                                       config.mesh_virtual_nodes)) {
+    THERMAL_LOG_INFO << "🕸️ [GatewayMesh] Created for " << gateway_id_ << " on " << config.mesh_topic;
+}
+
+GatewayMesh::~GatewayMesh() {
+    stop();
+}
+
+void GatewayMesh::set_reading_callback(ReadingFn callback) {
+    reading_callback_ = std::move(callback);
+}
+
+void GatewayMesh::set_clock(std::shared_ptr<thermal_monitoring::Clock> clock) {
+    clock_ = clock ? std::move(clock) : thermal_monitoring::Clock::steady();
+}
+
+bool GatewayMesh::start() {
+    if (running_.load()) {
+        return true;
+    }
+
+    reactor_ = CommReactor::shared();
+    if (reactor_) {
+        timer_source_ = reactor_->add_timer(heartbeat_interval_, [this] { tick(); });
+    }
+    if (timer_source_ < 0) {
+        THERMAL_LOG_ERROR << "❌ [GatewayMesh] Failed to register heartbeat timer";
+        reactor_.reset();
+        return false;
+    }
+
+    running_ = true;
+
+    // A restarted mesh rejoins with whatever peers it still remembers
+    Outbox outbox;
+    {
+        std::lock_guard<std::mutex> lock(membership_mutex_);
+        if (left_) {
+            left_ = false;
+            rebuild_ring(outbox);
+        }
+    }
+    flush(outbox);
+    tick();
+
+    THERMAL_LOG_INFO << "🚀 [GatewayMesh] " << gateway_id_ << " heartbeating every "
+                     << heartbeat_interval_.count() << "ms";
+    return true;
+}
+
+void GatewayMesh::stop() {
+    if (!running_.load()) {
+        return;
+    }
+    running_ = false;
+
+    reactor_->remove(timer_source_);
+    timer_source_ = -1;
+    reactor_.reset();
+
+    // Hand everything over on a ring without this gateway, then say so
+    Outbox outbox;
+    {
+        std::lock_guard<std::mutex> lock(membership_mutex_);
+        left_ = true;
+        rebuild_ring(outbox);
+    }
+    outbox.emplace_back(leave_topic_, gateway_id_);
+    flush(outbox);
+
+    THERMAL_LOG_INFO << "✅ [GatewayMesh] " << gateway_id_ << " left the mesh";
+}
+
+void GatewayMesh::tick() {
+    Outbox outbox;
+    outbox.emplace_back(heartbeat_topic_, gateway_id_);
+    {
+        std::lock_guard<std::mutex> lock(membership_mutex_);
+        auto now = clock_->now();
+        bool changed = false;
+        for (auto it = peers_.begin(); it != peers_.end();) {
+            if (now - it->second > peer_timeout_) {
+                THERMAL_LOG_WARN << "⚠️ [GatewayMesh] " << it->first << " missed heartbeats, taking over its sensors";
+                it = peers_.erase(it);
+                changed = true;
+            } else {
+                ++it;
+            }
+        }
+        if (changed) {
+            rebuild_ring(outbox);
+        }
+    }
+    flush(outbox);
+}
+
+bool GatewayMesh::route_reading(const SensorDataPacket& packet) {
+    auto ring = current_ring();
+    ConsistentHashRing::Assignment assignment = ring->assign(packet.sensor_id);
+
+    if (!assignment.owner || *assignment.owner == gateway_id_) {
+        if (replicate_readings_ && assignment.replica && packet.is_valid) {
+            send_reading(*assignment.replica, "/replica", packet);
+            readings_replicated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // The wire record has no validity flag; an invalid frame would only
+    // count as an error at the owner, so it is not worth the hop
+    if (packet.is_valid) {
+        send_reading(*assignment.owner, "/reading", packet);
+        readings_forwarded_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
+
+void GatewayMesh::handle_message(const std::string& topic, const std::string& payload) {
+    if (topic == heartbeat_topic_) {
+        if (payload.empty() || payload == gateway_id_) {
+            return;
+        }
+        Outbox outbox;
+        {
+            std::lock_guard<std::mutex> lock(membership_mutex_);
+            bool joined = peers_.insert_or_assign(payload, clock_->now()).second;
+            if (joined) {
+                THERMAL_LOG_INFO << "🤝 [GatewayMesh] " << payload << " joined";
+                // Answer at once so the newcomer does not wait a full interval for us
+                outbox.emplace_back(heartbeat_topic_, gateway_id_);
+                rebuild_ring(outbox);
+            }
+        }
+        flush(outbox);
+        return;
+    }
+
+    if (topic == leave_topic_) {
+        Outbox outbox;
+        {
+            std::lock_guard<std::mutex> lock(membership_mutex_);
+            if (peers_.erase(payload) > 0) {
+                THERMAL_LOG_INFO << "👋 [GatewayMesh] " << payload << " left";
+                rebuild_ring(outbox);
+            }
+        }
+        flush(outbox);
+        return;
+    }
+
+    if (topic.compare(0, inbox_prefix_.size(), inbox_prefix_) != 0) {
+        return;
+    }
+    std::string_view kind(topic);
+    kind.remove_prefix(inbox_prefix_.size());
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data());
+
+    if (kind == "state") {
+        states_received_.fetch_add(1, std::memory_order_relaxed);
+        processor_.import_sensor_state(data, payload.size());
+        return;
+    }
+
+    bool replica = kind == "replica";
+    if (!replica && kind != "reading") {
+        return;
+    }
+
+    auto record = thermal_monitoring::wire::decode_sensor_record(data, payload.size());
+    if (!record) {
+        THERMAL_LOG_WARN << "⚠️ [GatewayMesh] Malformed reading on " << topic;
+        return;
+    }
+
+    SensorDataPacket packet = {};
+    packet.sensor_id = std::move(record->sensor_id);
+    packet.location = std::move(record->location);
+    packet.temperature_celsius = record->temperature;
+    packet.humidity_percent = record->humidity;
+    packet.pressure_hpa = record->pressure;
+    packet.supply_voltage = record->supply_voltage;
+    packet.signal_strength = record->signal_strength;
+    packet.data_confidence = record->data_confidence;
+    packet.packet_sequence = record->sequence;
+    packet.sensor_status = record->status;
+    packet.interface_used = static_cast<CommInterface>(record->interface);
+    packet.is_valid = true;
+    // steady_clock time does not cross hosts; readings are re-stamped on arrival
+    packet.timestamp = clock_->now();
+
+    if (replica) {
+        processor_.record_replica(std::move(packet));
+        return;
+    }
+
+    // Rings disagree while membership settles; re-forwarding could loop
+    if (!owns(packet.sensor_id)) {
+        readings_misrouted_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (reading_callback_) {
+        reading_callback_(std::move(packet));
+    }
+}
+
+std::vector<std::string> GatewayMesh::subscriptions() const {
+    return {heartbeat_topic_, leave_topic_, inbox_prefix_ + "#"};
+}
+
+std::string GatewayMesh::owner_of(const std::string& sensor_id) const {
+    auto ring = current_ring();
+    ConsistentHashRing::Assignment assignment = ring->assign(sensor_id);
+    return assignment.owner ? *assignment.owner : std::string();
+}
+
+bool GatewayMesh::owns(const std::string& sensor_id) const {
+    auto ring = current_ring();
+    ConsistentHashRing::Assignment assignment = ring->assign(sensor_id);
+    return assignment.owner && *assignment.owner == gateway_id_;
+}
+
+std::vector<std::string> GatewayMesh::members() const {
+    return current_ring()->members();
+}
+
+GatewayMesh::Stats GatewayMesh::get_stats() const {
+    Stats stats;
+    stats.members = current_ring()->members().size();
+    stats.membership_changes = membership_changes_.load(std::memory_order_relaxed);
+    stats.readings_forwarded = readings_forwarded_.load(std::memory_order_relaxed);
+    stats.readings_replicated = readings_replicated_.load(std::memory_order_relaxed);
+    stats.readings_misrouted = readings_misrouted_.load(std::memory_order_relaxed);
+    stats.states_sent = states_sent_.load(std::memory_order_relaxed);
+    stats.states_received = states_received_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::shared_ptr<const ConsistentHashRing> GatewayMesh::current_ring() const {
+    std::shared_lock<std::shared_mutex> lock(ring_mutex_);
+    return ring_;
+}
+
+void GatewayMesh::rebuild_ring(Outbox& outbox) {
+    std::vector<std::string> members;
+    members.reserve(peers_.size() + 1);
+    if (!left_) {
+        members.push_back(gateway_id_);
+    }
+    for (const auto& peer : peers_) {
+        members.push_back(peer.first);
+    }
+
+    auto next = std::make_shared<const ConsistentHashRing>(std::move(members), virtual_nodes_);
+    std::shared_ptr<const ConsistentHashRing> previous;
+    {
+        std::unique_lock<std::shared_mutex> lock(ring_mutex_);
+        previous = std::move(ring_);
+        ring_ = next;
+    }
+    membership_changes_.fetch_add(1, std::memory_order_relaxed);
+
+    rebalance(*previous, *next, outbox);
+}
+
+void GatewayMesh::rebalance(const ConsistentHashRing& before, const ConsistentHashRing& after, Outbox& outbox) {
+    size_t handed_off = 0;
+    size_t seeded = 0;
+    size_t dropped = 0;
+
+    for (const SensorStatistics& stats : processor_.get_all_statistics()) {
+        ConsistentHashRing::Assignment was = before.assign(stats.sensor_id);
+        ConsistentHashRing::Assignment now = after.assign(stats.sensor_id);
+        bool owned = was.owner && *was.owner == gateway_id_;
+        bool owns_now = now.owner && *now.owner == gateway_id_;
+        bool replica_now = now.replica && *now.replica == gateway_id_;
+
+        // The new owner takes over from us; a new replica is seeded by the
+        // owner so it can take over in turn
+        const std::string* target = nullptr;
+        if (owned && !owns_now) {
+            target = now.owner;
+            handed_off++;
+        } else if (owns_now && now.replica && (!owned || !was.replica || *was.replica != *now.replica)) {
+            target = now.replica;
+            seeded++;
+        }
+
+        if (target) {
+            std::string payload;
+            if (processor_.export_sensor_state(stats.sensor_id, payload)) {
+                outbox.emplace_back(topic_prefix_ + *target + "/state", std::move(payload));
+                states_sent_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // On a graceful leave the processor has already written its warm
+        // restart snapshot; keep it so a restart without peers comes back
+        // warm. Rejoining peers' newer copies win on import
+        if (!owns_now && !replica_now && !left_) {
+            processor_.forget_sensor(stats.sensor_id);
+            dropped++;
+        }
+    }
+
+    THERMAL_LOG_INFO << "🕸️ [GatewayMesh] " << gateway_id_ << " sees " << after.members().size()
+                     << " gateway(s): " << handed_off << " sensors handed off, " << seeded
+                     << " replicas seeded, " << dropped << " released";
+}
+
+void GatewayMesh::send_reading(const std::string& target, const char* kind, const SensorDataPacket& packet) {
+    MeshScratch& scratch = mesh_scratch();
+    thermal_monitoring::wire::SensorRecord& record = scratch.record;
+    record.sensor_id = packet.sensor_id;
+    record.location = packet.location;
+    record.gateway_id = gateway_id_;
+    record.timestamp_ms = wall_clock_ms();
+    record.temperature = packet.temperature_celsius;
+    record.humidity = packet.humidity_percent;
+    record.pressure = packet.pressure_hpa;
+    record.supply_voltage = packet.supply_voltage;
+    record.signal_strength = packet.signal_strength;
+    record.data_confidence = packet.data_confidence;
+    record.sequence = packet.packet_sequence;
+    record.status = packet.sensor_status;
+    record.interface = static_cast<uint8_t>(packet.interface_used);
+
+    scratch.encoded.clear();
+    thermal_monitoring::wire::encode_sensor_record(record, scratch.encoded);
+    scratch.payload.assign(reinterpret_cast<const char*>(scratch.encoded.data()), scratch.encoded.size());
+    scratch.topic.assign(topic_prefix_).append(target).append(kind);
+    publish_(scratch.topic, scratch.payload);
+}
+
+void GatewayMesh::flush(Outbox& outbox) {
+    for (const auto& message : outbox) {
+        publish_(message.first, message.second);
+    }
+    outbox.clear();
+}
+
+} // namespace rpi4_gateway
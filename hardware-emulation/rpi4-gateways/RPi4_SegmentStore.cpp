@@ -0,0 +1,919 @@
+#include "RPi4_Gateway.h"
+#include "../../thermal-monitoring/Log.h"
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include <cctype>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace rpi4_gateway {
+
+//=============================================================================
+// SegmentStore Implementation
+//=============================================================================
+
+namespace {
+
+constexpr char FILE_MAGIC[6] = {'R', 'P', '4', 'S', 'E', 'G'};
+constexpr char INDEX_MAGIC[6] = {'R', 'P', '4', 'I', 'D', 'X'};
+constexpr const char* SEGMENT_EXTENSION = ".seg";
+constexpr const char* INDEX_EXTENSION = ".idx";
+
+// A past-day segment must also be this quiet before it is rewritten
+constexpr auto SEAL_QUIET_PERIOD = std::chrono::seconds(60);
+
+void put_u8(uint8_t*& out, uint8_t value) {
+    *out++ = value;
+}
+
+void put_u16(uint8_t*& out, uint16_t value) {
+    *out++ = static_cast<uint8_t>(value);
+    *out++ = static_cast<uint8_t>(value >> 8);
+}
+
+void put_u64(uint8_t*& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        *out++ = static_cast<uint8_t>(value >> shift);
+    }
+}
+
+void put_f32(uint8_t*& out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int shift = 0; shift < 32; shift += 8) {
+        *out++ = static_cast<uint8_t>(bits >> shift);
+    }
+}
+
+void put_u32(uint8_t*& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        *out++ = static_cast<uint8_t>(value >> shift);
+    }
+}
+
+void put_str8(uint8_t*& out, const std::string& value) {
+    size_t len = std::min<size_t>(value.size(), 0xFF);
+    *out++ = static_cast<uint8_t>(len);
+    std::memcpy(out, value.data(), len);
+    out += len;
+}
+
+uint16_t get_u16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t get_u32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+uint64_t get_u64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+float get_f32(const uint8_t* in) {
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; ++i) {
+        bits |= static_cast<uint32_t>(in[i]) << (8 * i);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool write_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Local-day bounds [start, end) in wall-clock ms; only called on rollover
+void local_day_bounds(int64_t timestamp_ms, int64_t& start_ms, int64_t& end_ms, std::string& day) {
+    time_t seconds = static_cast<time_t>(timestamp_ms / 1000);
+    struct tm local = {};
+    localtime_r(&seconds, &local);
+
+    char buffer[16];
+    strftime(buffer, sizeof(buffer), "%Y%m%d", &local);
+    day = buffer;
+
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    start_ms = static_cast<int64_t>(mktime(&local)) * 1000;
+    local.tm_mday += 1;
+    local.tm_isdst = -1;
+    end_ms = static_cast<int64_t>(mktime(&local)) * 1000;
+}
+
+std::string today_name() {
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t start_ms, end_ms;
+    std::string day;
+    local_day_bounds(now_ms, start_ms, end_ms, day);
+    return day;
+}
+
+// Bounds of the day a "YYYYMMDD.seg" file covers; false for foreign names
+bool segment_day_bounds(const std::string& path, int64_t& start_ms, int64_t& end_ms) {
+    std::string stem = std::filesystem::path(path).stem().string();
+    if (stem.size() != 8 || !std::all_of(stem.begin(), stem.end(), ::isdigit)) {
+        return false;
+    }
+    struct tm local = {};
+    local.tm_year = std::stoi(stem.substr(0, 4)) - 1900;
+    local.tm_mon = std::stoi(stem.substr(4, 2)) - 1;
+    local.tm_mday = std::stoi(stem.substr(6, 2));
+    local.tm_isdst = -1;
+    start_ms = static_cast<int64_t>(mktime(&local)) * 1000;
+    local.tm_mday += 1;
+    local.tm_isdst = -1;
+    end_ms = static_cast<int64_t>(mktime(&local)) * 1000;
+    return true;
+}
+
+std::string index_path_for(const std::string& segment_path) {
+    return std::filesystem::path(segment_path).replace_extension(INDEX_EXTENSION).string();
+}
+
+// FNV-1a; stable across runs so it can live in the index
+uint32_t hash_sensor_id(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Read-only mapping of a whole file, unmapped on destruction
+class MappedFile {
+public:
+    MappedFile() : data_(nullptr), size_(0) {}
+    ~MappedFile() {
+        if (data_) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+        }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(mapping);
+        size_ = static_cast<size_t>(info.st_size);
+        return true;
+    }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+};
+
+bool write_file(const std::string& path, const std::vector<uint8_t>& contents) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = write_all(fd, contents.data(), contents.size()) && fdatasync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+} // namespace
+
+SegmentStore::SegmentStore(const std::string& directory, const RPi4GatewayConfig& config)
+    : directory_(directory),
+      commit_bytes_(std::max<size_t>(1024, config.storage_commit_bytes)),
+      max_buffer_bytes_(std::max<size_t>(commit_bytes_ * 8, 1024 * 1024)),
+      commit_interval_(std::max(1, config.storage_commit_interval_ms)),
+      sync_policy_(config.storage_sync_policy),
+      sync_interval_(std::max(0, config.storage_sync_interval_ms)),
+      appended_seq_(0), committed_seq_(0), flush_requested_(false), running_(false),
+      stats_{}, segment_fd_(-1), segment_start_ms_(0), segment_end_ms_(0) {
+}
+
+SegmentStore::~SegmentStore() {
+    close();
+}
+
+bool SegmentStore::open() {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    if (running_) {
+        return true;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        THERMAL_LOG_ERROR << "❌ [SegmentStore] Cannot create " << directory_ << ": " << error.message();
+        return false;
+    }
+
+    // Both buffers are sized up front so appends never reallocate in steady state
+    active_buffer_.reserve(max_buffer_bytes_);
+    flushing_buffer_.reserve(max_buffer_bytes_);
+    last_sync_ = std::chrono::steady_clock::now();
+
+    running_ = true;
+    flusher_thread_ = std::thread(&SegmentStore::flusher_loop, this);
+
+    THERMAL_LOG_INFO << "✅ [SegmentStore] Opened " << directory_ << " (commit every "
+                     << commit_bytes_ / 1024 << " KiB or " << commit_interval_.count() << " ms)";
+    return true;
+}
+
+void SegmentStore::close() {
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    flush_cv_.notify_one();
+
+    // The flusher drains whatever is still buffered before exiting
+    if (flusher_thread_.joinable()) {
+        flusher_thread_.join();
+    }
+    close_segment();
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        active_segment_path_.clear();
+    }
+
+    THERMAL_LOG_INFO << "✅ [SegmentStore] Closed after " << stats_.commits << " commits, "
+                     << stats_.bytes_written << " bytes";
+}
+
+bool SegmentStore::append(RecordType type, int64_t timestamp_ms, const uint8_t* payload, size_t length) {
+    if (length > 0xFFFF) {
+        return false;
+    }
+
+    bool wake_flusher = false;
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        if (!running_) {
+            return false;
+        }
+        if (active_buffer_.size() + RECORD_HEADER_SIZE + length > max_buffer_bytes_) {
+            stats_.dropped_records++;
+            return false;
+        }
+
+        size_t offset = active_buffer_.size();
+        active_buffer_.resize(offset + RECORD_HEADER_SIZE + length);
+        uint8_t* out = active_buffer_.data() + offset;
+        put_u8(out, static_cast<uint8_t>(type));
+        put_u8(out, FORMAT_VERSION);
+        put_u16(out, static_cast<uint16_t>(length));
+        put_u64(out, static_cast<uint64_t>(timestamp_ms));
+        std::memcpy(out, payload, length);
+
+        appended_seq_++;
+        stats_.appended_records++;
+        wake_flusher = active_buffer_.size() >= commit_bytes_;
+    }
+
+    if (wake_flusher) {
+        flush_cv_.notify_one();
+    }
+    return true;
+}
+
+bool SegmentStore::append_reading(const SensorDataPacket& packet, int64_t timestamp_ms) {
+    // sensor_id | f32 temperature | f32 humidity | f32 pressure | f32 voltage
+    // | u8 status | u8 interface | u8 valid
+    uint8_t payload[1 + 255 + 16 + 3];
+    uint8_t* out = payload;
+    put_str8(out, packet.sensor_id);
+    put_f32(out, packet.temperature_celsius);
+    put_f32(out, packet.humidity_percent);
+    put_f32(out, packet.pressure_hpa);
+    put_f32(out, packet.supply_voltage);
+    put_u8(out, packet.sensor_status);
+    put_u8(out, static_cast<uint8_t>(packet.interface_used));
+    put_u8(out, packet.is_valid ? 1 : 0);
+    return append(RecordType::SENSOR_READING, timestamp_ms, payload, static_cast<size_t>(out - payload));
+}
+
+bool SegmentStore::append_statistics(const SensorStatistics& stats, int64_t timestamp_ms) {
+    // sensor_id | u64 total | u64 valid | f32 loss | f32 avg_temp | f32 avg_hum | f32 stddev
+    uint8_t payload[1 + 255 + 16 + 16];
+    uint8_t* out = payload;
+    put_str8(out, stats.sensor_id);
+    put_u64(out, stats.total_packets);
+    put_u64(out, stats.valid_packets);
+    put_f32(out, stats.packet_loss_rate);
+    put_f32(out, stats.avg_temperature);
+    put_f32(out, stats.avg_humidity);
+    put_f32(out, stats.temperature_stddev);
+    return append(RecordType::STATISTICS, timestamp_ms, payload, static_cast<size_t>(out - payload));
+}
+
+bool SegmentStore::append_edge_result(const EdgeProcessingResult& result, int64_t timestamp_ms) {
+    // sensor_id | analysis_type | f32 confidence
+    uint8_t payload[1 + 255 + 1 + 255 + 4];
+    uint8_t* out = payload;
+    put_str8(out, result.sensor_id);
+    put_str8(out, result.analysis_type);
+    put_f32(out, result.confidence_score);
+    return append(RecordType::EDGE_RESULT, timestamp_ms, payload, static_cast<size_t>(out - payload));
+}
+
+bool SegmentStore::decode_reading(const uint8_t* payload, size_t length, SensorDataPacket& packet) {
+    if (length < 1 || length < 1u + payload[0] + 19u) {
+        return false;
+    }
+
+    size_t id_length = payload[0];
+    const uint8_t* in = payload + 1;
+    packet.sensor_id.assign(reinterpret_cast<const char*>(in), id_length);
+    in += id_length;
+    packet.temperature_celsius = get_f32(in);
+    packet.humidity_percent = get_f32(in + 4);
+    packet.pressure_hpa = get_f32(in + 8);
+    packet.supply_voltage = get_f32(in + 12);
+    packet.sensor_status = in[16];
+    packet.interface_used = static_cast<CommInterface>(in[17]);
+    packet.is_valid = in[18] != 0;
+    return true;
+}
+
+void SegmentStore::flush() {
+    std::unique_lock<std::mutex> lock(buffer_mutex_);
+    if (!running_) {
+        return;
+    }
+
+    uint64_t target = appended_seq_;
+    flush_requested_ = true;
+    flush_cv_.notify_one();
+    committed_cv_.wait(lock, [this, target] { return committed_seq_ >= target || !running_; });
+}
+
+SegmentStore::Stats SegmentStore::get_stats() const {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    return stats_;
+}
+
+std::vector<std::string> SegmentStore::list_segments() const {
+    std::vector<std::string> segments;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+        if (entry.is_regular_file() && entry.path().extension() == SEGMENT_EXTENSION) {
+            segments.push_back(entry.path().string());
+        }
+    }
+
+    // YYYYMMDD names sort chronologically
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+void SegmentStore::flusher_loop() {
+    std::unique_lock<std::mutex> lock(buffer_mutex_);
+
+    for (;;) {
+        flush_cv_.wait_for(lock, commit_interval_, [this] {
+            return !running_ || flush_requested_ || active_buffer_.size() >= commit_bytes_;
+        });
+        flush_requested_ = false;
+
+        uint64_t batch_seq = appended_seq_;
+        if (!active_buffer_.empty()) {
+            // Group commit: hand the whole buffer to I/O and let producers
+            // keep appending into the (already reserved) spare
+            active_buffer_.swap(flushing_buffer_);
+            lock.unlock();
+
+            write_buffer(flushing_buffer_);
+            size_t written = flushing_buffer_.size();
+            flushing_buffer_.clear();
+
+            bool synced = false;
+            auto now = std::chrono::steady_clock::now();
+            if (segment_fd_ >= 0 &&
+                (sync_policy_ == StorageSyncPolicy::EVERY_COMMIT ||
+                 (sync_policy_ == StorageSyncPolicy::PERIODIC && now - last_sync_ >= sync_interval_))) {
+                fdatasync(segment_fd_);
+                last_sync_ = now;
+                synced = true;
+            }
+
+            lock.lock();
+            stats_.commits++;
+            stats_.bytes_written += written;
+            if (synced) {
+                stats_.syncs++;
+            }
+        }
+
+        committed_seq_ = batch_seq;
+        committed_cv_.notify_all();
+
+        if (!running_ && active_buffer_.empty()) {
+            break;
+        }
+    }
+}
+
+void SegmentStore::write_buffer(const std::vector<uint8_t>& buffer) {
+    // Write runs of consecutive records that fall in the same local day
+    size_t run_start = 0;
+    size_t offset = 0;
+    while (offset + RECORD_HEADER_SIZE <= buffer.size()) {
+        const uint8_t* header = buffer.data() + offset;
+        size_t record_size = RECORD_HEADER_SIZE + get_u16(header + 2);
+        int64_t timestamp_ms = static_cast<int64_t>(get_u64(header + 4));
+
+        if (segment_fd_ < 0 || timestamp_ms < segment_start_ms_ || timestamp_ms >= segment_end_ms_) {
+            if (segment_fd_ >= 0 && offset > run_start &&
+                !write_all(segment_fd_, buffer.data() + run_start, offset - run_start)) {
+                THERMAL_LOG_ERROR << "❌ [SegmentStore] Write failed: " << strerror(errno);
+            }
+            run_start = offset;
+            if (!open_segment_for(timestamp_ms)) {
+                run_start = offset + record_size; // Unwritable; skip this record
+            }
+        }
+        offset += record_size;
+    }
+
+    if (segment_fd_ >= 0 && offset > run_start &&
+        !write_all(segment_fd_, buffer.data() + run_start, offset - run_start)) {
+        THERMAL_LOG_ERROR << "❌ [SegmentStore] Write failed: " << strerror(errno);
+    }
+}
+
+bool SegmentStore::open_segment_for(int64_t timestamp_ms) {
+    close_segment();
+
+    std::string day;
+    local_day_bounds(timestamp_ms, segment_start_ms_, segment_end_ms_, day);
+    std::string path = directory_ + "/" + day + SEGMENT_EXTENSION;
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        active_segment_path_ = path;
+    }
+
+    // Drop a torn tail from an earlier crash so appends stay parseable
+    uint64_t valid_end = 0;
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0 && info.st_size > 0) {
+        valid_end = scan_segment(path, nullptr);
+        if (valid_end == 0) {
+            THERMAL_LOG_ERROR << "❌ [SegmentStore] " << path << " is not a segment file";
+            return false;
+        }
+        if (valid_end < static_cast<uint64_t>(info.st_size)) {
+            THERMAL_LOG_WARN << "⚠️ [SegmentStore] Truncating torn tail of " << path;
+            if (truncate(path.c_str(), static_cast<off_t>(valid_end)) != 0) {
+                return false;
+            }
+        }
+    }
+
+    segment_fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (segment_fd_ < 0) {
+        THERMAL_LOG_ERROR << "❌ [SegmentStore] Cannot open " << path << ": " << strerror(errno);
+        return false;
+    }
+
+    if (valid_end == 0) {
+        uint8_t header[FILE_HEADER_SIZE] = {};
+        std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header[6] = FORMAT_VERSION;
+        write_all(segment_fd_, header, sizeof(header));
+    }
+
+    THERMAL_LOG_INFO << "📂 [SegmentStore] Writing segment " << path;
+    return true;
+}
+
+void SegmentStore::close_segment() {
+    if (segment_fd_ >= 0) {
+        if (sync_policy_ != StorageSyncPolicy::NEVER) {
+            fdatasync(segment_fd_);
+        }
+        ::close(segment_fd_);
+        segment_fd_ = -1;
+    }
+}
+
+uint64_t SegmentStore::scan_segment(const std::string& path, const RecordVisitor& visitor) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+
+    uint8_t file_header[FILE_HEADER_SIZE];
+    if (read(fd, file_header, sizeof(file_header)) != static_cast<ssize_t>(sizeof(file_header)) ||
+        std::memcmp(file_header, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        ::close(fd);
+        return 0;
+    }
+
+    // Buffered sequential read; records never straddle more than one refill
+    std::vector<uint8_t> buffer(256 * 1024);
+    size_t begin = 0;
+    size_t end = 0;
+    uint64_t file_offset = FILE_HEADER_SIZE;
+    bool stop = false;
+
+    while (!stop) {
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        ssize_t bytes_read = read(fd, buffer.data() + end, buffer.size() - end);
+        if (bytes_read <= 0) {
+            break;
+        }
+        end += static_cast<size_t>(bytes_read);
+
+        while (end - begin >= RECORD_HEADER_SIZE) {
+            const uint8_t* header = buffer.data() + begin;
+            size_t length = get_u16(header + 2);
+            if (end - begin < RECORD_HEADER_SIZE + length) {
+                break;
+            }
+
+            if (visitor && !visitor(static_cast<RecordType>(header[0]),
+                                    static_cast<int64_t>(get_u64(header + 4)),
+                                    header + RECORD_HEADER_SIZE, length)) {
+                stop = true;
+            }
+            begin += RECORD_HEADER_SIZE + length;
+            file_offset += RECORD_HEADER_SIZE + length;
+            if (stop) {
+                break;
+            }
+        }
+    }
+
+    ::close(fd);
+    return file_offset;
+}
+
+//-----------------------------------------------------------------------------
+// Range queries, compaction and retention
+//-----------------------------------------------------------------------------
+
+std::vector<SensorDataPacket> SegmentStore::query_readings(const std::string& sensor_id,
+                                                           int64_t start_ms, int64_t end_ms) const {
+    std::vector<SensorDataPacket> results;
+    if (end_ms < start_ms) {
+        return results;
+    }
+
+    // Stored times are wall clock; packets carry steady-clock timestamps
+    auto steady_now = std::chrono::steady_clock::now();
+    int64_t wall_now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    const uint8_t* id_bytes = reinterpret_cast<const uint8_t*>(sensor_id.data());
+    size_t id_length = std::min<size_t>(sensor_id.size(), 0xFF);
+    uint32_t target_hash = hash_sensor_id(id_bytes, id_length);
+
+    auto emit = [&](int64_t timestamp_ms, const uint8_t* payload, size_t length) {
+        SensorDataPacket packet = {};
+        if (decode_reading(payload, length, packet)) {
+            packet.timestamp = steady_now - std::chrono::milliseconds(wall_now - timestamp_ms);
+            results.push_back(std::move(packet));
+        }
+    };
+    auto id_matches = [&](const uint8_t* payload, size_t length) {
+        return length >= 1 + id_length && payload[0] == id_length &&
+               std::memcmp(payload + 1, id_bytes, id_length) == 0;
+    };
+
+    for (const auto& segment : list_segments()) {
+        int64_t day_start, day_end;
+        if (segment_day_bounds(segment, day_start, day_end) &&
+            (day_end <= start_ms || day_start > end_ms)) {
+            continue;
+        }
+
+        MappedFile index;
+        MappedFile data;
+        bool indexed = index.open(index_path_for(segment)) && data.open(segment) &&
+                       index.size() >= INDEX_HEADER_SIZE &&
+                       std::memcmp(index.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+                       get_u64(index.data() + 8) == data.size() &&
+                       INDEX_HEADER_SIZE + get_u64(index.data() + 16) * INDEX_ENTRY_SIZE <= index.size();
+
+        if (!indexed) {
+            // Active or not yet compacted: sequential scan
+            scan_segment(segment, [&](RecordType type, int64_t timestamp_ms,
+                                      const uint8_t* payload, size_t length) {
+                if (type == RecordType::SENSOR_READING && timestamp_ms >= start_ms &&
+                    timestamp_ms <= end_ms && id_matches(payload, length)) {
+                    emit(timestamp_ms, payload, length);
+                }
+                return true;
+            });
+            continue;
+        }
+
+        // Entries are sorted by (hash, time): binary-search the sensor's run,
+        // then the last sample point at or before start_ms
+        const uint8_t* entries = index.data() + INDEX_HEADER_SIZE;
+        size_t count = static_cast<size_t>(get_u64(index.data() + 16));
+        auto entry_hash = [&](size_t i) { return get_u32(entries + i * INDEX_ENTRY_SIZE); };
+        auto entry_time = [&](size_t i) {
+            return static_cast<int64_t>(get_u64(entries + i * INDEX_ENTRY_SIZE + 8));
+        };
+
+        size_t low = 0, high = count;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (entry_hash(mid) < target_hash) low = mid + 1; else high = mid;
+        }
+        size_t run_begin = low;
+        high = count;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (entry_hash(mid) <= target_hash) low = mid + 1; else high = mid;
+        }
+        size_t run_end = low;
+        if (run_begin == run_end) {
+            continue;
+        }
+
+        // Colliding ids share a hash run; their times are not in one order,
+        // so fall back to the start of the run
+        size_t first = run_begin;
+        bool monotonic = true;
+        for (size_t i = run_begin + 1; i < run_end && monotonic; ++i) {
+            monotonic = entry_time(i - 1) <= entry_time(i);
+        }
+        if (monotonic) {
+            size_t lo = run_begin, hi = run_end;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (entry_time(mid) < start_ms) lo = mid + 1; else hi = mid;
+            }
+            first = lo > run_begin ? lo - 1 : run_begin;
+        }
+
+        size_t offset = static_cast<size_t>(get_u64(entries + first * INDEX_ENTRY_SIZE + 16));
+        while (offset + RECORD_HEADER_SIZE <= data.size()) {
+            const uint8_t* header = data.data() + offset;
+            size_t length = get_u16(header + 2);
+            if (offset + RECORD_HEADER_SIZE + length > data.size() || length < 1) {
+                break;
+            }
+            const uint8_t* payload = header + RECORD_HEADER_SIZE;
+            if (1u + payload[0] > length || hash_sensor_id(payload + 1, payload[0]) != target_hash) {
+                break; // Past this sensor's run
+            }
+
+            int64_t timestamp_ms = static_cast<int64_t>(get_u64(header + 4));
+            if (id_matches(payload, length)) {
+                if (timestamp_ms > end_ms) {
+                    break;
+                }
+                if (static_cast<RecordType>(header[0]) == RecordType::SENSOR_READING &&
+                    timestamp_ms >= start_ms) {
+                    emit(timestamp_ms, payload, length);
+                }
+            }
+            offset += RECORD_HEADER_SIZE + length;
+        }
+    }
+
+    return results;
+}
+
+bool SegmentStore::is_sealed(const std::string& path) const {
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        if (path == active_segment_path_) {
+            return false;
+        }
+    }
+    if (std::filesystem::path(path).stem().string() >= today_name()) {
+        return false;
+    }
+
+    std::error_code error;
+    auto modified = std::filesystem::last_write_time(path, error);
+    return !error && std::filesystem::file_time_type::clock::now() - modified >= SEAL_QUIET_PERIOD;
+}
+
+size_t SegmentStore::compact_sealed_segments() {
+    size_t compacted = 0;
+    for (const auto& segment : list_segments()) {
+        if (!is_sealed(segment)) {
+            continue;
+        }
+
+        // Skip segments whose index is already current
+        std::error_code error;
+        auto segment_size = std::filesystem::file_size(segment, error);
+        MappedFile index;
+        if (!error && index.open(index_path_for(segment)) && index.size() >= INDEX_HEADER_SIZE &&
+            std::memcmp(index.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+            get_u64(index.data() + 8) == segment_size) {
+            continue;
+        }
+
+        if (compact_segment(segment)) {
+            compacted++;
+        }
+    }
+    return compacted;
+}
+
+bool SegmentStore::compact_segment(const std::string& path) {
+    MappedFile data;
+    if (!data.open(path) || data.size() < FILE_HEADER_SIZE ||
+        std::memcmp(data.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return false;
+    }
+
+    struct Record {
+        uint32_t hash;
+        int64_t timestamp_ms;
+        size_t offset;
+        size_t size;
+    };
+    std::vector<Record> records;
+    size_t offset = FILE_HEADER_SIZE;
+    while (offset + RECORD_HEADER_SIZE <= data.size()) {
+        const uint8_t* header = data.data() + offset;
+        size_t length = get_u16(header + 2);
+        if (offset + RECORD_HEADER_SIZE + length > data.size()) {
+            break; // Torn tail is dropped by the rewrite
+        }
+        const uint8_t* payload = header + RECORD_HEADER_SIZE;
+        size_t id_length = length >= 1 ? std::min<size_t>(payload[0], length - 1) : 0;
+        records.push_back({hash_sensor_id(payload + 1, id_length),
+                           static_cast<int64_t>(get_u64(header + 4)),
+                           offset, RECORD_HEADER_SIZE + length});
+        offset += RECORD_HEADER_SIZE + length;
+    }
+
+    // Sensor-major order; ids that collide on the hash still stay contiguous
+    auto id_of = [&](const Record& record) {
+        const uint8_t* payload = data.data() + record.offset + RECORD_HEADER_SIZE;
+        size_t length = record.size - RECORD_HEADER_SIZE;
+        size_t id_length = length >= 1 ? std::min<size_t>(payload[0], length - 1) : 0;
+        return std::string_view(reinterpret_cast<const char*>(payload + 1), id_length);
+    };
+    std::stable_sort(records.begin(), records.end(), [&](const Record& a, const Record& b) {
+        if (a.hash != b.hash) return a.hash < b.hash;
+        std::string_view id_a = id_of(a), id_b = id_of(b);
+        if (id_a != id_b) return id_a < id_b;
+        return a.timestamp_ms < b.timestamp_ms;
+    });
+
+    std::vector<uint8_t> rewritten;
+    rewritten.reserve(offset);
+    rewritten.insert(rewritten.end(), data.data(), data.data() + FILE_HEADER_SIZE);
+
+    std::vector<uint8_t> entries;
+    size_t entry_count = 0;
+    size_t run_position = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& record = records[i];
+        bool new_run = i == 0 || record.hash != records[i - 1].hash || id_of(record) != id_of(records[i - 1]);
+        run_position = new_run ? 0 : run_position + 1;
+        if (run_position % INDEX_STRIDE == 0) {
+            uint8_t entry[INDEX_ENTRY_SIZE];
+            uint8_t* out = entry;
+            put_u32(out, record.hash);
+            put_u32(out, 0);
+            put_u64(out, static_cast<uint64_t>(record.timestamp_ms));
+            put_u64(out, rewritten.size());
+            entries.insert(entries.end(), entry, entry + sizeof(entry));
+            entry_count++;
+        }
+        rewritten.insert(rewritten.end(), data.data() + record.offset,
+                         data.data() + record.offset + record.size);
+    }
+
+    std::vector<uint8_t> index(INDEX_HEADER_SIZE);
+    uint8_t* out = index.data();
+    std::memcpy(out, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    out += sizeof(INDEX_MAGIC);
+    put_u8(out, FORMAT_VERSION);
+    put_u8(out, 0);
+    put_u64(out, rewritten.size());
+    put_u64(out, entry_count);
+    index.insert(index.end(), entries.begin(), entries.end());
+
+    // Segment first: a crash between the renames leaves an unindexed (but
+    // complete) segment that the next pass compacts again
+    std::string index_path = index_path_for(path);
+    if (!write_file(path + ".tmp", rewritten) || !write_file(index_path + ".tmp", index) ||
+        rename((path + ".tmp").c_str(), path.c_str()) != 0 ||
+        rename((index_path + ".tmp").c_str(), index_path.c_str()) != 0) {
+        THERMAL_LOG_ERROR << "❌ [SegmentStore] Compaction of " << path << " failed: " << strerror(errno);
+        unlink((path + ".tmp").c_str());
+        unlink((index_path + ".tmp").c_str());
+        return false;
+    }
+
+    THERMAL_LOG_INFO << "🗜️ [SegmentStore] Compacted " << path << " (" << records.size() << " records, "
+                     << entry_count << " index entries)";
+    return true;
+}
+
+uint64_t SegmentStore::disk_usage() const {
+    uint64_t total = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+        auto extension = entry.path().extension();
+        if (entry.is_regular_file() && (extension == SEGMENT_EXTENSION || extension == INDEX_EXTENSION)) {
+            total += entry.file_size(error);
+        }
+    }
+    return total;
+}
+
+size_t SegmentStore::enforce_retention(uint64_t max_bytes) {
+    uint64_t usage = disk_usage();
+    if (usage <= max_bytes) {
+        return 0;
+    }
+
+    std::string today = today_name();
+    size_t removed = 0;
+    for (const auto& segment : list_segments()) {
+        if (usage <= max_bytes) {
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex_);
+            if (segment == active_segment_path_) {
+                break;
+            }
+        }
+        if (std::filesystem::path(segment).stem().string() >= today) {
+            break;
+        }
+
+        // Whole segments only, oldest first
+        std::error_code error;
+        std::string index_path = index_path_for(segment);
+        uint64_t freed = std::filesystem::file_size(segment, error);
+        if (error) freed = 0;
+        uint64_t index_size = std::filesystem::file_size(index_path, error);
+        if (!error) freed += index_size;
+
+        if (std::filesystem::remove(segment, error)) {
+            std::filesystem::remove(index_path, error);
+            usage -= std::min(usage, freed);
+            removed++;
+            THERMAL_LOG_INFO << "🗑️ [SegmentStore] Retention removed " << segment;
+        }
+    }
+    return removed;
+}
+
+} // namespace rpi4_gateway
@@ -5,6 +5,13 @@
 #include <chrono>
 #include <random>
 #include <signal.h>
+#include <filesystem>
+#include <set>
+#include <deque>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace rpi4_gateway;
 
@@ -34,6 +41,10 @@ public:
         test_system_monitoring();
         test_full_gateway_integration();
         test_thermal_integration();
+        test_local_storage();
+        test_metrics_endpoint();
+        test_gateway_mesh();
+        test_warm_restart();
         
         std::cout << "\n" << std::string(80, '=') << std::endl;
         std::cout << "✅ ALL TESTS COMPLETED SUCCESSFULLY!" << std::endl;
@@ -169,10 +180,124 @@ private:
                       << ", Avg Humidity: " << stat.avg_humidity << "%" << std::endl;
         }
         
+        auto queue_stats = processor.get_queue_stats();
+        std::cout << "📥 Ingest queue: " << queue_stats.enqueued_packets << " enqueued, "
+                  << queue_stats.dropped_packets << " dropped, high-water "
+                  << queue_stats.high_water_mark << "/" << queue_stats.capacity << std::endl;
+        
         processor.stop();
+        
+        test_publish_strategies();
+        test_recycled_handoff();
         std::cout << "✅ Data processing test passed!" << std::endl;
     }
     
+    // Counts broker messages for a slowly drifting indoor signal
+    uint64_t run_publish_strategy(ProcessingStrategy strategy, int readings, PublishStats& publish_stats) {
+        auto config = gateway_factory::create_home_gateway_config("strategy_test");
+        config.processing_strategy = strategy;
+        config.worker_thread_count = 2;
+        config.enable_edge_analytics = false;
+        config.batch_max_latency_ms = 200;
+        
+        DataProcessor processor(config);
+        std::atomic<uint64_t> messages{0};
+        processor.set_mqtt_callback([&messages](const std::string&, const std::string&) { messages++; });
+        processor.initialize();
+        processor.start();
+        
+        for (int i = 0; i < readings; ++i) {
+            SensorDataPacket packet = generate_test_packet("strategy_sensor_" + std::to_string(i % 4));
+            packet.temperature_celsius = 22.0f + 0.01f * (i / 4);
+            packet.humidity_percent = 45.0f;
+            packet.supply_voltage = 3.7f;
+            packet.sensor_status = 0x00; // No fault bits, so nothing alerts
+            processor.process_packet(packet);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        processor.stop();
+        
+        publish_stats = processor.get_publish_stats();
+        return messages.load();
+    }
+    
+    void test_publish_strategies() {
+        std::cout << "📤 Comparing MQTT publish strategies..." << std::endl;
+        const int readings = 400;
+        PublishStats raw_stats, batch_stats, filter_stats;
+        
+        uint64_t raw = run_publish_strategy(ProcessingStrategy::RAW_FORWARD, readings, raw_stats);
+        uint64_t batched = run_publish_strategy(ProcessingStrategy::AGGREGATE_BATCH, readings, batch_stats);
+        uint64_t filtered = run_publish_strategy(ProcessingStrategy::SMART_FILTER, readings, filter_stats);
+        
+        std::cout << "   RAW_FORWARD: " << raw << " messages" << std::endl;
+        std::cout << "   AGGREGATE_BATCH: " << batched << " messages carrying "
+                  << batch_stats.readings_batched << " readings" << std::endl;
+        std::cout << "   SMART_FILTER: " << filtered << " messages, "
+                  << filter_stats.readings_suppressed << " readings inside the deadband" << std::endl;
+        
+        if (raw != static_cast<uint64_t>(readings) || batch_stats.readings_batched != static_cast<uint64_t>(readings) ||
+            batched * 10 > raw || filtered * 10 > raw) {
+            std::cerr << "❌ Publish strategies did not reduce the message rate" << std::endl;
+            return;
+        }
+        std::cout << "   ✓ Batching and deadband filtering cut broker messages by more than 10x" << std::endl;
+    }
+    
+    void test_recycled_handoff() {
+        std::cout << "♻️  Checking packet hand-off recycles string buffers..." << std::endl;
+        
+        // Ids past the small-string limit live on the heap; swapping through
+        // the queue must keep reusing the same few buffers
+        thermal_monitoring::BoundedMpmcQueue<SensorDataPacket> queue(4);
+        std::vector<SensorDataPacket> slots(2);
+        SensorDataPacket packet = generate_test_packet("recycled_sensor_with_a_long_id_0");
+        std::set<const char*> buffers;
+        for (int i = 0; i < 1000; ++i) {
+            packet.sensor_id.assign("recycled_sensor_with_a_long_id_").append(std::to_string(i % 10));
+            buffers.insert(packet.sensor_id.data());
+            queue.try_push(std::move(packet));
+            queue.try_pop_batch(slots.data(), slots.size());
+        }
+        
+        // Hand-built JSON must match what the stream formatter produced
+        auto config = gateway_factory::create_home_gateway_config("handoff_test");
+        config.enable_edge_analytics = false;
+        DataProcessor processor(config);
+        std::mutex mutex;
+        std::string message;
+        processor.set_mqtt_callback([&](const std::string&, const std::string& payload) {
+            std::lock_guard<std::mutex> lock(mutex);
+            message = payload;
+        });
+        processor.initialize();
+        processor.start();
+        SensorDataPacket reading = generate_test_packet("handoff_sensor");
+        reading.temperature_celsius = 21.5f;
+        reading.humidity_percent = 45.25f;
+        reading.pressure_hpa = 1013.25f;
+        reading.supply_voltage = 3.3f;
+        reading.sensor_status = 0x00;
+        reading.data_confidence = 0.95f;
+        long long seconds = std::chrono::duration_cast<std::chrono::seconds>(
+            reading.timestamp.time_since_epoch()).count();
+        processor.process_packet(std::move(reading));
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        processor.stop();
+        
+        std::string expected = "{\"sensor_id\":\"handoff_sensor\",\"location\":\"Test_Environment\",\"timestamp\":" +
+            std::to_string(seconds) + ",\"temperature\":21.50,\"humidity\":45.25,\"pressure\":1013.25,"
+            "\"supply_voltage\":3.30,\"sensor_status\":0,\"interface\":\"UART\",\"signal_strength\":1.00,"
+            "\"data_confidence\":0.95,\"gateway_id\":\"handoff_test\"}";
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (buffers.size() > queue.capacity() + slots.size() + 1 || message != expected) {
+            std::cerr << "❌ Hand-off allocated " << buffers.size() << " id buffers or formatted: " << message << std::endl;
+            return;
+        }
+        std::cout << "   ✓ 1000 hand-offs reused " << buffers.size() << " id buffers; JSON unchanged" << std::endl;
+    }
+    
     void test_edge_analytics() {
         std::cout << "\n🤖 TEST 4: Edge Analytics" << std::endl;
         std::cout << std::string(50, '-') << std::endl;
@@ -372,6 +497,505 @@ private:
         std::cout << "✅ Thermal integration test passed!" << std::endl;
     }
     
+    void test_local_storage() {
+        std::cout << "\n💾 TEST 8: Segment Storage" << std::endl;
+        std::cout << std::string(50, '-') << std::endl;
+        
+        std::string directory = "/tmp/rpi4_gateway_storage_test";
+        std::filesystem::remove_all(directory);
+        
+        auto config = gateway_factory::create_home_gateway_config("storage_test");
+        config.data_directory = directory + "/data";
+        config.log_directory = directory + "/log";
+        config.storage_commit_bytes = 4096;
+        config.storage_commit_interval_ms = 100;
+        
+        StorageManager storage(config);
+        if (!storage.initialize()) {
+            std::cerr << "❌ Failed to initialize storage" << std::endl;
+            return;
+        }
+        
+        const int reading_count = 500;
+        for (int i = 0; i < reading_count; ++i) {
+            storage.store_sensor_data(generate_test_packet("storage_sensor_" + std::to_string(i % 5)));
+        }
+        storage.cleanup(); // Flushes pending commits
+        
+        auto stats = storage.get_segment_stats();
+        std::cout << "📊 Segment store: " << stats.appended_records << " records, "
+                  << stats.commits << " commits, " << stats.bytes_written << " bytes, "
+                  << stats.dropped_records << " dropped" << std::endl;
+        
+        std::string csv_path = directory + "/export.csv";
+        storage.export_csv(csv_path);
+        
+        std::ifstream csv(csv_path);
+        size_t lines = 0;
+        for (std::string line; std::getline(csv, line);) {
+            lines++;
+        }
+        if (lines != static_cast<size_t>(reading_count) + 1) {
+            std::cerr << "❌ Expected " << reading_count << " exported readings, got "
+                      << (lines > 0 ? lines - 1 : 0) << std::endl;
+            return;
+        }
+        
+        std::cout << "   ✓ " << reading_count << " readings group-committed and exported" << std::endl;
+        
+        auto now = std::chrono::system_clock::now();
+        auto recent = storage.retrieve_sensor_data("storage_sensor_1", now - std::chrono::hours(1), now);
+        if (recent.size() != static_cast<size_t>(reading_count / 5)) {
+            std::cerr << "❌ Expected " << reading_count / 5 << " queried readings, got " << recent.size() << std::endl;
+            return;
+        }
+        std::cout << "   ✓ Range query over the active segment returned " << recent.size() << " readings" << std::endl;
+        
+        if (!test_indexed_history(directory + "/history", config)) {
+            return;
+        }
+        std::filesystem::remove_all(directory);
+        std::cout << "✅ Segment storage test passed!" << std::endl;
+    }
+    
+    void test_metrics_endpoint() {
+        std::cout << "\n📈 TEST 9: Metrics Endpoint" << std::endl;
+        std::cout << std::string(50, '-') << std::endl;
+        
+        auto config = gateway_factory::create_home_gateway_config("metrics_test");
+        config.enable_local_storage = false;
+        config.i2c_addresses.clear();
+        config.metrics_host = "127.0.0.1";
+        config.metrics_port = 19102;
+        
+        std::string response;
+        std::string missing;
+        {
+            RPi4_Gateway gateway(config);
+            if (!gateway.initialize() || !gateway.start()) {
+                std::cerr << "❌ Failed to start gateway" << std::endl;
+                return;
+            }
+            response = http_get(config.metrics_port, "/metrics");
+            missing = http_get(config.metrics_port, "/nothing");
+            gateway.stop();
+        }
+        
+        const char* expected[] = {
+            "HTTP/1.1 200 OK",
+            "Content-Type: text/plain; version=0.0.4",
+            "# TYPE thermal_gateway_ingest_queue_depth gauge",
+            "thermal_gateway_ingest_queue_capacity{gateway=\"metrics_test\"}",
+            "thermal_gateway_packet_processing_seconds_bucket{gateway=\"metrics_test\",le=\"+Inf\"}",
+            "process_cpu_seconds_total"
+        };
+        for (const char* line : expected) {
+            if (response.find(line) == std::string::npos) {
+                std::cerr << "❌ Scrape is missing \"" << line << "\"" << std::endl;
+                return;
+            }
+        }
+        std::cout << "   ✓ GET /metrics returned " << response.size() << " bytes of exposition" << std::endl;
+        
+        if (missing.find("HTTP/1.1 404") != 0) {
+            std::cerr << "❌ Expected 404 for an unknown path" << std::endl;
+            return;
+        }
+        std::cout << "   ✓ Unknown paths get 404" << std::endl;
+        
+        // Callbacks go with the destroyed gateway
+        if (thermal_monitoring::metrics::Registry::global().render_prometheus().find(
+                "thermal_gateway_ingest_queue_depth{gateway=\"metrics_test\"}") != std::string::npos) {
+            std::cerr << "❌ Gateway callbacks outlived the gateway" << std::endl;
+            return;
+        }
+        std::cout << "✅ Metrics endpoint test passed!" << std::endl;
+    }
+    
+    void test_gateway_mesh() {
+        std::cout << "\n🕸️ TEST 10: Gateway Mesh" << std::endl;
+        std::cout << std::string(50, '-') << std::endl;
+        
+        // Dropping one of four gateways moves only the sensors it owned
+        ConsistentHashRing four({"gw_a", "gw_b", "gw_c", "gw_d"}, 64);
+        ConsistentHashRing three({"gw_a", "gw_b", "gw_c"}, 64);
+        std::map<std::string, size_t> load;
+        size_t moved = 0;
+        for (int i = 0; i < 4000; ++i) {
+            std::string id = "ring_sensor_" + std::to_string(i);
+            const std::string& owner = *four.assign(id).owner;
+            load[owner]++;
+            if (*three.assign(id).owner != owner) {
+                moved++;
+            }
+        }
+        auto lightest = std::min_element(load.begin(), load.end(),
+                                         [](const auto& a, const auto& b) { return a.second < b.second; });
+        if (moved != load["gw_d"] || lightest->second < 600) {
+            std::cerr << "❌ Ring moved " << moved << " sensors for " << load["gw_d"] 
+                      << " owned; lightest gateway holds " << lightest->second << std::endl;
+            return;
+        }
+        std::cout << "   ✓ Lightest of 4 gateways owns " << lightest->second 
+                  << "/4000 sensors; removing gw_d moved only its " << moved << std::endl;
+        
+        // Gateways on an in-memory broker, driven by a virtual clock
+        auto clock = std::make_shared<thermal_monitoring::VirtualClock>();
+        std::mutex broker_mutex;
+        std::deque<std::pair<std::string, std::string>> broker;
+        std::set<std::string> offline;
+        struct Node {
+            std::unique_ptr<DataProcessor> processor;
+            std::unique_ptr<GatewayMesh> mesh;
+        };
+        std::map<std::string, Node> nodes;
+        
+        auto add_node = [&](const std::string& id) {
+            auto config = gateway_factory::create_home_gateway_config(id);
+            config.enable_edge_analytics = false;
+            config.worker_thread_count = 1;
+            config.mesh_enabled = true;
+            config.mesh_peer_timeout_ms = 3000;
+            Node& node = nodes[id];
+            node.processor = std::make_unique<DataProcessor>(config);
+            node.processor->set_clock(clock);
+            node.processor->initialize();
+            node.processor->start();
+            node.mesh = std::make_unique<GatewayMesh>(config, *node.processor,
+                [&, id](const std::string& topic, const std::string& payload) {
+                    std::lock_guard<std::mutex> lock(broker_mutex);
+                    if (!offline.count(id)) {
+                        broker.emplace_back(topic, payload);
+                    }
+                });
+            node.mesh->set_clock(clock);
+            DataProcessor* processor = node.processor.get();
+            GatewayMesh* mesh = node.mesh.get();
+            node.mesh->set_reading_callback([processor, mesh](SensorDataPacket&& packet) {
+                if (mesh->route_reading(packet)) {
+                    processor->process_packet(std::move(packet));
+                }
+            });
+        };
+        auto pump = [&] {
+            while (true) {
+                std::pair<std::string, std::string> message;
+                {
+                    std::lock_guard<std::mutex> lock(broker_mutex);
+                    if (broker.empty()) {
+                        break;
+                    }
+                    message = std::move(broker.front());
+                    broker.pop_front();
+                }
+                for (auto& entry : nodes) {
+                    if (!offline.count(entry.first)) {
+                        entry.second.mesh->handle_message(message.first, message.second);
+                    }
+                }
+            }
+        };
+        auto heartbeat_round = [&] {
+            clock->advance(std::chrono::seconds(1));
+            for (auto& entry : nodes) {
+                if (!offline.count(entry.first)) {
+                    entry.second.mesh->tick();
+                }
+            }
+            pump();
+        };
+        // Gateways holding a sensor's full 20 readings, as owner or replica
+        const int sensor_count = 24;
+        auto holders = [&](const std::string& sensor_id) {
+            std::vector<std::string> found;
+            for (auto& entry : nodes) {
+                if (!offline.count(entry.first) &&
+                    entry.second.processor->get_sensor_statistics(sensor_id).total_packets == 20) {
+                    found.push_back(entry.first);
+                }
+            }
+            return found;
+        };
+        auto check_placement = [&](const char* phase) {
+            GatewayMesh* view = nullptr;
+            for (auto& entry : nodes) {
+                if (!offline.count(entry.first)) {
+                    view = entry.second.mesh.get();
+                    break;
+                }
+            }
+            for (int s = 0; s < sensor_count; ++s) {
+                std::string id = "mesh_sensor_" + std::to_string(s);
+                std::string owner = view->owner_of(id);
+                auto found = holders(id);
+                if (found.size() != 2 || std::find(found.begin(), found.end(), owner) == found.end()) {
+                    std::cerr << "❌ " << phase << ": " << id << " owned by " << owner << " but complete on "
+                              << found.size() << " gateway(s)" << std::endl;
+                    return false;
+                }
+            }
+            return true;
+        };
+        
+        for (const char* id : {"gw_a", "gw_b", "gw_c"}) {
+            add_node(id);
+        }
+        heartbeat_round();
+        
+        // Every sensor is wired to gw_a; its owner processes, its replica mirrors
+        for (int round = 0; round < 20; ++round) {
+            for (int s = 0; s < sensor_count; ++s) {
+                SensorDataPacket packet = generate_test_packet("mesh_sensor_" + std::to_string(s));
+                if (nodes["gw_a"].mesh->route_reading(packet)) {
+                    nodes["gw_a"].processor->process_packet(std::move(packet));
+                }
+            }
+            pump();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        if (!check_placement("Three gateways")) {
+            return;
+        }
+        auto a_stats = nodes["gw_a"].mesh->get_stats();
+        std::cout << "   ✓ 3 gateways: every sensor complete on its owner and one replica ("
+                  << a_stats.readings_forwarded << " readings forwarded by gw_a)" << std::endl;
+        
+        // The owner of sensor 0 fails silently; its replicas take over
+        std::string failed = nodes["gw_a"].mesh->owner_of("mesh_sensor_0");
+        {
+            std::lock_guard<std::mutex> lock(broker_mutex);
+            offline.insert(failed);
+        }
+        for (int i = 0; i < 4; ++i) {
+            heartbeat_round();
+        }
+        std::string survivor = failed == "gw_a" ? "gw_b" : "gw_a";
+        if (nodes[survivor].mesh->members().size() != 2 || !check_placement("After failover")) {
+            return;
+        }
+        std::cout << "   ✓ " << failed << " failed: its sensors kept all 20 readings and were re-replicated" << std::endl;
+        
+        // A new gateway joins and receives the history of the sensors it takes over
+        add_node("gw_d");
+        heartbeat_round();
+        size_t taken_over = 0;
+        for (int s = 0; s < sensor_count; ++s) {
+            if (nodes["gw_d"].mesh->owner_of("mesh_sensor_" + std::to_string(s)) == "gw_d") {
+                taken_over++;
+            }
+        }
+        if (taken_over == 0 || nodes["gw_d"].mesh->members().size() != 3 || !check_placement("After join")) {
+            std::cerr << "❌ gw_d took over " << taken_over << " sensors" << std::endl;
+            return;
+        }
+        std::cout << "   ✓ gw_d joined and took over " << taken_over << " sensors with their history" << std::endl;
+        
+        nodes.clear();
+        std::cout << "✅ Gateway mesh test passed!" << std::endl;
+    }
+    
+    static std::string http_get(int port, const std::string& path) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        
+        std::string response;
+        if (fd >= 0 && connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0) {
+            std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+            if (send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size())) {
+                char buffer[4096];
+                ssize_t bytes_read;
+                while ((bytes_read = read(fd, buffer, sizeof(buffer))) > 0) {
+                    response.append(buffer, static_cast<size_t>(bytes_read));
+                }
+            }
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        return response;
+    }
+    
+    // A week of past-day segments: compacted, queried through the index, then aged out
+    bool test_indexed_history(const std::string& directory, const RPi4GatewayConfig& config) {
+        SegmentStore store(directory, config);
+        if (!store.open()) {
+            std::cerr << "❌ Failed to open history store" << std::endl;
+            return false;
+        }
+        
+        const int64_t day_ms = 24 * 3600 * 1000LL;
+        const int per_day = 3000;
+        int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        for (int day = 7; day >= 1; --day) {
+            for (int i = 0; i < per_day; ++i) {
+                store.append_reading(generate_test_packet("history_sensor_" + std::to_string(i % 3)),
+                                     now_ms - day * day_ms + i * 1000);
+            }
+            store.flush();
+        }
+        store.close();
+        
+        // Segments only become sealed once they have been quiet for a while
+        for (const auto& segment : store.list_segments()) {
+            std::filesystem::last_write_time(segment,
+                std::filesystem::file_time_type::clock::now() - std::chrono::minutes(5));
+        }
+        size_t compacted = store.compact_sealed_segments();
+        
+        auto start_time = std::chrono::high_resolution_clock::now();
+        auto week = store.query_readings("history_sensor_1", now_ms - 8 * day_ms, now_ms);
+        auto slice = store.query_readings("history_sensor_2", now_ms - 3 * day_ms + 100 * 1000,
+                                          now_ms - 3 * day_ms + 399 * 1000);
+        auto query_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start_time).count();
+        
+        if (compacted == 0 || week.size() != 7u * per_day / 3 || slice.size() != 100) {
+            std::cerr << "❌ Indexed query mismatch: " << compacted << " compacted, " << week.size()
+                      << " week readings, " << slice.size() << " slice readings" << std::endl;
+            return false;
+        }
+        std::cout << "   ✓ " << compacted << " segments indexed; week query returned " << week.size()
+                  << " readings (" << query_us << " μs for both queries)" << std::endl;
+        
+        uint64_t before = store.disk_usage();
+        size_t removed = store.enforce_retention(before / 2);
+        if (removed == 0 || store.disk_usage() > before / 2) {
+            std::cerr << "❌ Retention did not bring usage under budget" << std::endl;
+            return false;
+        }
+        std::cout << "   ✓ Retention removed " << removed << " oldest segments (" << before 
+                  << " -> " << store.disk_usage() << " bytes)" << std::endl;
+        return true;
+    }
+    
+    void test_warm_restart() {
+        std::cout << "\n♻️ TEST 11: Warm Restart" << std::endl;
+        std::cout << std::string(50, '-') << std::endl;
+        
+        std::string path = "/tmp/rpi4_gateway_state_test.snap";
+        std::filesystem::remove(path);
+        
+        auto config = gateway_factory::create_home_gateway_config("restart_test");
+        config.worker_thread_count = 2;
+        config.enable_edge_analytics = false;
+        config.max_sensor_history = 50;
+        config.state_snapshot_path = path;
+        
+        const int sensors = 20;
+        const uint64_t packets_per_sensor = 30;
+        auto wait_for_packets = [](DataProcessor& processor, uint64_t expected) {
+            for (int attempt = 0; attempt < 200; ++attempt) {
+                uint64_t processed = 0;
+                for (const auto& stats : processor.get_all_statistics()) {
+                    processed += stats.total_packets;
+                }
+                if (processed >= expected) {
+                    return true;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return false;
+        };
+        
+        // First run: history builds up, stop() writes it out
+        SensorStatistics before;
+        {
+            DataProcessor processor(config);
+            processor.initialize();
+            processor.start();
+            for (uint64_t i = 0; i < sensors * packets_per_sensor; ++i) {
+                SensorDataPacket packet = generate_test_packet("restart_sensor_" + std::to_string(i % sensors));
+                packet.sensor_status = 0;
+                processor.process_packet(std::move(packet));
+            }
+            if (!wait_for_packets(processor, sensors * packets_per_sensor)) {
+                std::cerr << "❌ First run did not process every packet" << std::endl;
+                return;
+            }
+            processor.stop();
+            before = processor.get_sensor_statistics("restart_sensor_3");
+        }
+        
+        // Second run: everything is back before a single packet arrives
+        auto started = std::chrono::steady_clock::now();
+        DataProcessor processor(config);
+        processor.initialize();
+        double restore_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        
+        SensorStatistics after = processor.get_sensor_statistics("restart_sensor_3");
+        auto restored = processor.get_all_statistics();
+        if (restored.size() != static_cast<size_t>(sensors) || after.total_packets != packets_per_sensor ||
+            after.avg_temperature != before.avg_temperature || after.max_temperature != before.max_temperature ||
+            after.temperature_stddev != before.temperature_stddev || restore_ms >= 1000.0) {
+            std::cerr << "❌ Restored " << restored.size() << " sensors, restart_sensor_3 has "
+                      << after.total_packets << " packets" << std::endl;
+            return;
+        }
+        std::cout << "   ✓ " << restored.size() << " sensors restored in " << std::fixed << std::setprecision(2)
+                  << restore_ms << " ms with identical statistics" << std::endl;
+        
+        // Only the sensor that reported since is rewritten
+        uint64_t writes_before = processor.get_state_snapshot_stats().writes;
+        processor.start();
+        SensorDataPacket packet = generate_test_packet("restart_sensor_3");
+        packet.sensor_status = 0;
+        processor.process_packet(std::move(packet));
+        if (!wait_for_packets(processor, sensors * packets_per_sensor + 1)) {
+            std::cerr << "❌ Packet after restart was not processed" << std::endl;
+            return;
+        }
+        processor.save_state_snapshot();
+        auto snapshot_stats = processor.get_state_snapshot_stats();
+        processor.stop();
+        std::filesystem::remove(path);
+        
+        if (snapshot_stats.writes - writes_before != 1 || snapshot_stats.records != static_cast<size_t>(sensors)) {
+            std::cerr << "❌ Snapshot pass wrote " << snapshot_stats.writes - writes_before << " records" << std::endl;
+            return;
+        }
+        std::cout << "   ✓ Incremental pass rewrote 1 of " << snapshot_stats.records << " records ("
+                  << snapshot_stats.file_bytes / 1024 << " KiB mapped)" << std::endl;
+
+        // A mesh gateway stops like RPi4_Gateway::stop(): processor first, then
+        // the leave; its records survive for a restart without peers
+        config.mesh_enabled = true;
+        {
+            DataProcessor mesh_processor(config);
+            mesh_processor.initialize();
+            mesh_processor.start();
+            GatewayMesh mesh(config, mesh_processor, [](const std::string&, const std::string&) {});
+            mesh.start();
+            for (uint64_t i = 0; i < sensors * packets_per_sensor; ++i) {
+                SensorDataPacket packet = generate_test_packet("restart_sensor_" + std::to_string(i % sensors));
+                packet.sensor_status = 0;
+                mesh_processor.process_packet(std::move(packet));
+            }
+            if (!wait_for_packets(mesh_processor, sensors * packets_per_sensor)) {
+                std::cerr << "❌ Mesh run did not process every packet" << std::endl;
+                return;
+            }
+            mesh_processor.stop();
+            mesh.stop();
+        }
+        config.mesh_enabled = false;
+        DataProcessor solo(config);
+        solo.initialize();
+        size_t solo_sensors = solo.get_all_statistics().size();
+        uint64_t solo_packets = solo.get_sensor_statistics("restart_sensor_3").total_packets;
+        std::filesystem::remove(path);
+
+        if (solo_sensors != static_cast<size_t>(sensors) || solo_packets != packets_per_sensor) {
+            std::cerr << "❌ Solo restart after a mesh leave restored " << solo_sensors << " sensors" << std::endl;
+            return;
+        }
+        std::cout << "   ✓ Graceful mesh leave kept all " << solo_sensors << " records for a solo restart" << std::endl;
+        std::cout << "✅ Warm restart test passed!" << std::endl;
+    }
+    
     SensorDataPacket generate_test_packet(const std::string& sensor_id) {
         SensorDataPacket packet = {};
         
@@ -494,6 +1118,10 @@ int main(int argc, char* argv[]) {
         std::cout << "✅ System Monitoring - PASSED" << std::endl;
         std::cout << "✅ Full Gateway Integration - PASSED" << std::endl;
         std::cout << "✅ Thermal Integration - PASSED" << std::endl;
+        std::cout << "✅ Segment Storage - PASSED" << std::endl;
+        std::cout << "✅ Metrics Endpoint - PASSED" << std::endl;
+        std::cout << "✅ Gateway Mesh - PASSED" << std::endl;
+        std::cout << "✅ Warm Restart - PASSED" << std::endl;
         
         std::cout << "\n🚀 To run interactive demo: " << argv[0] << " --demo" << std::endl;
     }
@@ -1,5 +1,6 @@
 #include "STM32_SensorNode.h"
-#include <iostream>
+#include "../../thermal-monitoring/SensorWireFormat.h"
+#include "../../thermal-monitoring/Log.h"
 #include <sstream>
 #include <iomanip>
 #include <cmath>
@@ -13,8 +14,8 @@ namespace stm32_simulation {
 //=============================================================================
 
 STM32_SensorNode::STM32_SensorNode(const SensorNodeConfig& config)
-    : config_(config), running_(false), initialized_(false),
-      random_generator_(std::random_device{}()),
+    : config_(config), clock_(thermal_monitoring::Clock::steady()), running_(false), initialized_(false),
+      random_generator_(config.random_seed != 0 ? config.random_seed : std::random_device{}()),
       temp_noise_(0.0f, config.noise_level),
       humidity_noise_(0.0f, config.noise_level * 2.0f),
       fault_dist_(0.0f, 1.0f),
@@ -25,16 +26,19 @@ STM32_SensorNode::STM32_SensorNode(const SensorNodeConfig& config)
       sensor_drift_(0.0f), supply_voltage_(3.3f),
       reading_count_(0), transmission_count_(0) {
     
-    reading_history_.reserve(MAX_HISTORY);
-    start_time_ = std::chrono::steady_clock::now();
+    start_time_ = clock_->now();
     
-    std::cout << "🔧 [" << config_.node_id << "] STM32 " << get_sensor_type_string() 
-              << " sensor node created at " << config_.location << std::endl;
+    if (config_.verbose_logging) {
+        THERMAL_LOG_INFO << "🔧 [" << config_.node_id << "] STM32 " << get_sensor_type_string() 
+                         << " sensor node created at " << config_.location;
+    }
 }
 
 STM32_SensorNode::~STM32_SensorNode() {
     stop();
-    std::cout << "🏁 [" << config_.node_id << "] STM32 sensor node destroyed" << std::endl;
+    if (config_.verbose_logging) {
+        THERMAL_LOG_INFO << "🏁 [" << config_.node_id << "] STM32 sensor node destroyed";
+    }
 }
 
 bool STM32_SensorNode::initialize() {
@@ -42,12 +46,14 @@ bool STM32_SensorNode::initialize() {
         return true;
     }
     
-    std::cout << "🚀 [" << config_.node_id << "] Initializing STM32 sensor node..." << std::endl;
-    std::cout << "   Sensor Type: " << get_sensor_type_string() << std::endl;
-    std::cout << "   Communication: " << get_comm_protocol_string() << std::endl;
-    std::cout << "   Environment: " << get_environment_pattern_string() << std::endl;
-    std::cout << "   Reading Interval: " << config_.reading_interval_ms << "ms" << std::endl;
-    std::cout << "   Transmission Interval: " << config_.transmission_interval_ms << "ms" << std::endl;
+    if (config_.verbose_logging) {
+        THERMAL_LOG_INFO << "🚀 [" << config_.node_id << "] Initializing STM32 sensor node...";
+        THERMAL_LOG_INFO << "   Sensor Type: " << get_sensor_type_string();
+        THERMAL_LOG_INFO << "   Communication: " << get_comm_protocol_string();
+        THERMAL_LOG_INFO << "   Environment: " << get_environment_pattern_string();
+        THERMAL_LOG_INFO << "   Reading Interval: " << config_.reading_interval_ms << "ms";
+        THERMAL_LOG_INFO << "   Transmission Interval: " << config_.transmission_interval_ms << "ms";
+    }
     
     // Simulate hardware initialization
     supply_voltage_ = simulate_supply_voltage();
@@ -58,30 +64,37 @@ bool STM32_SensorNode::initialize() {
     transmission_count_ = 0;
     
     initialized_ = true;
-    std::cout << "✅ [" << config_.node_id << "] STM32 sensor node initialized" << std::endl;
+    if (config_.verbose_logging) {
+        THERMAL_LOG_INFO << "✅ [" << config_.node_id << "] STM32 sensor node initialized";
+    }
     return true;
 }
 
-bool STM32_SensorNode::start() {
+bool STM32_SensorNode::start(NodeExecution execution) {
     if (!initialized_.load()) {
-        std::cerr << "❌ [" << config_.node_id << "] Cannot start: node not initialized" << std::endl;
+        THERMAL_LOG_ERROR << "❌ [" << config_.node_id << "] Cannot start: node not initialized";
         return false;
     }
     
     if (running_.load()) {
-        std::cout << "⚠️ [" << config_.node_id << "] Node already running" << std::endl;
+        THERMAL_LOG_WARN << "⚠️ [" << config_.node_id << "] Node already running";
         return true;
     }
     
     running_ = true;
     
-    // Start sensor reading thread
-    sensor_thread_ = std::thread(&STM32_SensorNode::sensor_reading_loop, this);
-    
-    // Start transmission thread
-    transmission_thread_ = std::thread(&STM32_SensorNode::transmission_loop, this);
+    // Scheduled nodes are stepped by the deployment's NodeScheduler
+    if (execution == NodeExecution::OWN_THREADS) {
+        // Start sensor reading thread
+        sensor_thread_ = std::thread(&STM32_SensorNode::sensor_reading_loop, this);
+        
+        // Start transmission thread
+        transmission_thread_ = std::thread(&STM32_SensorNode::transmission_loop, this);
+    }
     
-    std::cout << "🚀 [" << config_.node_id << "] STM32 sensor node started" << std::endl;
+    if (config_.verbose_logging) {
+        THERMAL_LOG_INFO << "🚀 [" << config_.node_id << "] STM32 sensor node started";
+    }
     return true;
 }
 
@@ -90,8 +103,11 @@ void STM32_SensorNode::stop() {
         return;
     }
     
-    std::cout << "🛑 [" << config_.node_id << "] Stopping STM32 sensor node..." << std::endl;
+    if (config_.verbose_logging) {
+        THERMAL_LOG_INFO << "🛑 [" << config_.node_id << "] Stopping STM32 sensor node...";
+    }
     running_ = false;
+    clock_->wake_sleepers();
     
     // Wait for threads to finish
     if (sensor_thread_.joinable()) {
@@ -101,7 +117,9 @@ void STM32_SensorNode::stop() {
         transmission_thread_.join();
     }
     
-    std::cout << "✅ [" << config_.node_id << "] STM32 sensor node stopped gracefully" << std::endl;
+    if (config_.verbose_logging) {
+        THERMAL_LOG_INFO << "✅ [" << config_.node_id << "] STM32 sensor node stopped gracefully";
+    }
 }
 
 std::string STM32_SensorNode::get_status() const {
@@ -127,15 +145,22 @@ std::vector<SensorReading> STM32_SensorNode::get_reading_history(int count) cons
     std::lock_guard<std::mutex> lock(data_mutex_);
     
     std::vector<SensorReading> result;
-    int start_index = std::max(0, static_cast<int>(reading_history_.size()) - count);
+    size_t size = reading_history_.size();
+    size_t start_index = count > 0 ? size - std::min(size, static_cast<size_t>(count)) : size;
+    result.reserve(size - start_index);
     
-    for (int i = start_index; i < static_cast<int>(reading_history_.size()); ++i) {
-        result.push_back(reading_history_[i]);
+    for (size_t i = start_index; i < size; ++i) {
+        result.push_back(reading_history_.value<0>(i));
     }
     
     return result;
 }
 
+void STM32_SensorNode::set_clock(std::shared_ptr<thermal_monitoring::Clock> clock) {
+    clock_ = clock ? std::move(clock) : thermal_monitoring::Clock::steady();
+    start_time_ = clock_->now();
+}
+
 void STM32_SensorNode::set_uart_callback(std::function<void(const std::string&, const std::vector<uint8_t>&)> callback) {
     uart_callback_ = callback;
 }
@@ -146,39 +171,29 @@ void STM32_SensorNode::set_mqtt_callback(std::function<void(const std::string&,
 
 void STM32_SensorNode::inject_fault() {
     sensor_fault_ = true;
-    std::cout << "🚨 [" << config_.node_id << "] Fault injected" << std::endl;
+    THERMAL_LOG_INFO << "🚨 [" << config_.node_id << "] Fault injected";
 }
 
 void STM32_SensorNode::simulate_power_loss(int duration_ms) {
-    std::cout << "⚡ [" << config_.node_id << "] Simulating power loss for " << duration_ms << "ms" << std::endl;
+    THERMAL_LOG_INFO << "⚡ [" << config_.node_id << "] Simulating power loss for " << duration_ms << "ms";
     
-    // Temporarily stop the node
-    bool was_running = running_.load();
-    if (was_running) {
-        running_ = false;
-        
-        // Wait for the specified duration
-        std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
-        
-        // Restart
-        running_ = true;
-        supply_voltage_ = simulate_supply_voltage(); // Voltage may change after power cycle
-    }
-    
-    std::cout << "🔋 [" << config_.node_id << "] Power restored" << std::endl;
+    // The read/transmit path sees the deadline; nothing sleeps here, so
+    // the node's driver (own threads or scheduler) keeps its timing
+    auto restore_at = clock_->now() + std::chrono::milliseconds(std::max(0, duration_ms));
+    power_restore_ns_ = std::max<int64_t>(1, restore_at.time_since_epoch().count());
 }
 
 void STM32_SensorNode::change_environment(EnvironmentPattern new_pattern) {
     config_.environment = new_pattern;
-    std::cout << "🌡️ [" << config_.node_id << "] Environment changed to: " 
-              << get_environment_pattern_string() << std::endl;
+    THERMAL_LOG_INFO << "🌡️ [" << config_.node_id << "] Environment changed to: " 
+                     << get_environment_pattern_string();
 }
 
 void STM32_SensorNode::update_base_conditions(float temp, float humidity) {
     current_base_temp_ = temp;
     current_base_humidity_ = humidity;
-    std::cout << "📊 [" << config_.node_id << "] Base conditions updated: " 
-              << temp << "°C, " << humidity << "%" << std::endl;
+    THERMAL_LOG_INFO << "📊 [" << config_.node_id << "] Base conditions updated: " 
+                     << temp << "°C, " << humidity << "%";
 }
 
 //=============================================================================
@@ -186,97 +201,129 @@ void STM32_SensorNode::update_base_conditions(float temp, float humidity) {
 //=============================================================================
 
 void STM32_SensorNode::sensor_reading_loop() {
-    std::cout << "🔄 [" << config_.node_id << "] Sensor reading loop started" << std::endl;
+    THERMAL_LOG_INFO << "🔄 [" << config_.node_id << "] Sensor reading loop started";
     
     while (running_.load()) {
-        // Read sensor
-        SensorReading reading = read_sensor();
-        
-        // Store reading
-        {
-            std::lock_guard<std::mutex> lock(data_mutex_);
-            last_reading_ = reading;
-            reading_history_.push_back(reading);
-            
-            // Limit history size
-            if (reading_history_.size() > MAX_HISTORY) {
-                reading_history_.erase(reading_history_.begin());
-            }
-        }
-        
-        reading_count_++;
-        
-        if (reading.is_valid) {
-            std::cout << "📊 [" << config_.node_id << "] T: " 
-                      << std::fixed << std::setprecision(1) << reading.temperature_celsius 
-                      << "°C, H: " << reading.humidity_percent 
-                      << "%, V: " << std::setprecision(2) << reading.supply_voltage << "V"
-                      << " (ADC: " << reading.raw_temp_adc << "/" << reading.raw_humidity_adc << ")"
-                      << std::endl;
-        } else {
-            std::cout << "❌ [" << config_.node_id << "] Invalid sensor reading" << std::endl;
-        }
+        perform_reading();
         
         // Sleep until next reading
-        std::this_thread::sleep_for(std::chrono::milliseconds(config_.reading_interval_ms));
+        clock_->sleep_for(std::chrono::milliseconds(config_.reading_interval_ms));
     }
     
-    std::cout << "🏁 [" << config_.node_id << "] Sensor reading loop finished" << std::endl;
+    THERMAL_LOG_INFO << "🏁 [" << config_.node_id << "] Sensor reading loop finished";
 }
 
 void STM32_SensorNode::transmission_loop() {
-    std::cout << "📡 [" << config_.node_id << "] Transmission loop started" << std::endl;
+    THERMAL_LOG_INFO << "📡 [" << config_.node_id << "] Transmission loop started";
     
     while (running_.load()) {
-        // Check if we have data to transmit
-        SensorReading reading;
-        {
-            std::lock_guard<std::mutex> lock(data_mutex_);
-            reading = last_reading_;
-        }
+        perform_transmission();
         
-        // Check connection status
-        if (check_connection_fault()) {
-            std::cout << "📶 [" << config_.node_id << "] Connection fault - transmission skipped" << std::endl;
-            std::this_thread::sleep_for(std::chrono::milliseconds(config_.transmission_interval_ms));
-            continue;
+        // Sleep until next transmission
+        clock_->sleep_for(std::chrono::milliseconds(config_.transmission_interval_ms));
+    }
+    
+    THERMAL_LOG_INFO << "🏁 [" << config_.node_id << "] Transmission loop finished";
+}
+
+bool STM32_SensorNode::perform_reading() {
+    // Dark until the restore time; the first reading after it powers back up
+    int64_t restore_ns = power_restore_ns_.load();
+    if (restore_ns != 0) {
+        if (clock_->now().time_since_epoch().count() < restore_ns) {
+            return false;
         }
-        
-        // Transmit based on communication protocol
-        if (reading.is_valid) {
-            switch (config_.comm_protocol) {
-                case CommProtocol::UART_TO_GATEWAY:
-                case CommProtocol::SPI_TO_GATEWAY:
-                case CommProtocol::I2C_TO_GATEWAY: {
-                    if (uart_callback_) {
-                        std::vector<uint8_t> packet = create_binary_packet(reading);
-                        uart_callback_(config_.node_id, packet);
-                        std::cout << "📤 [" << config_.node_id << "] Data sent via " 
-                                  << get_comm_protocol_string() << " (" << packet.size() << " bytes)" << std::endl;
-                    }
-                    break;
-                }
-                
-                case CommProtocol::MQTT_DIRECT: {
-                    if (mqtt_callback_) {
-                        std::string message = format_mqtt_message(reading);
-                        std::string topic = "sensors/" + config_.node_id + "/data";
-                        mqtt_callback_(topic, message);
-                        std::cout << "📤 [" << config_.node_id << "] Data sent via MQTT to topic: " 
-                                  << topic << std::endl;
-                    }
-                    break;
+        if (power_restore_ns_.compare_exchange_strong(restore_ns, 0)) {
+            supply_voltage_ = simulate_supply_voltage(); // Voltage may change after power cycle
+            THERMAL_LOG_INFO << "🔋 [" << config_.node_id << "] Power restored";
+        }
+    }
+    
+    // Read sensor
+    SensorReading reading = read_sensor();
+    
+    // Store reading
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        last_reading_ = reading;
+        reading_history_.push(reading.timestamp, reading);
+    }
+    
+    reading_count_++;
+    
+    if (!config_.verbose_logging) {
+        return true;
+    }
+    if (reading.is_valid) {
+        THERMAL_LOG_DEBUG << "📊 [" << config_.node_id << "] T: " 
+                          << std::fixed << std::setprecision(1) << reading.temperature_celsius 
+                          << "°C, H: " << reading.humidity_percent 
+                          << "%, V: " << std::setprecision(2) << reading.supply_voltage << "V"
+                          << " (ADC: " << reading.raw_temp_adc << "/" << reading.raw_humidity_adc << ")";
+    } else {
+        THERMAL_LOG_ERROR << "❌ [" << config_.node_id << "] Invalid sensor reading";
+    }
+    return true;
+}
+
+bool STM32_SensorNode::perform_transmission() {
+    int64_t restore_ns = power_restore_ns_.load();
+    if (restore_ns != 0 && clock_->now().time_since_epoch().count() < restore_ns) {
+        return false;
+    }
+    
+    // Check if we have data to transmit
+    SensorReading reading;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        reading = last_reading_;
+    }
+    
+    // Check connection status
+    if (check_connection_fault()) {
+        if (config_.verbose_logging) {
+            THERMAL_LOG_INFO << "📶 [" << config_.node_id << "] Connection fault - transmission skipped";
+        }
+        return true;
+    }
+    
+    // Transmit based on communication protocol
+    if (!reading.is_valid) {
+        return true;
+    }
+    switch (config_.comm_protocol) {
+        case CommProtocol::UART_TO_GATEWAY:
+        case CommProtocol::SPI_TO_GATEWAY:
+        case CommProtocol::I2C_TO_GATEWAY: {
+            if (uart_callback_) {
+                std::vector<uint8_t> packet = create_binary_packet(reading);
+                uart_callback_(config_.node_id, packet);
+                if (config_.verbose_logging) {
+                    THERMAL_LOG_DEBUG << "📤 [" << config_.node_id << "] Data sent via " 
+                                      << get_comm_protocol_string() << " (" << packet.size() << " bytes)";
                 }
             }
-            
-            transmission_count_++;
+            break;
         }
         
-        // Sleep until next transmission
-        std::this_thread::sleep_for(std::chrono::milliseconds(config_.transmission_interval_ms));
+        case CommProtocol::MQTT_DIRECT: {
+            if (mqtt_callback_) {
+                bool binary = config_.mqtt_binary_payloads;
+                std::string message = binary ? format_binary_mqtt_message(reading)
+                                             : format_mqtt_message(reading);
+                std::string topic = "sensors/" + config_.node_id + (binary ? "/bin" : "/data");
+                mqtt_callback_(topic, message);
+                if (config_.verbose_logging) {
+                    THERMAL_LOG_DEBUG << "📤 [" << config_.node_id << "] Data sent via MQTT to topic: " 
+                                      << topic;
+                }
+            }
+            break;
+        }
     }
     
-    std::cout << "🏁 [" << config_.node_id << "] Transmission loop finished" << std::endl;
+    transmission_count_++;
+    return true;
 }
 
 //=============================================================================
@@ -285,7 +332,7 @@ void STM32_SensorNode::transmission_loop() {
 
 SensorReading STM32_SensorNode::read_sensor() {
     SensorReading reading = {};
-    reading.timestamp = std::chrono::steady_clock::now();
+    reading.timestamp = clock_->now();
     reading.supply_voltage = simulate_supply_voltage();
     reading.sensor_status = get_sensor_status();
     
@@ -321,7 +368,7 @@ SensorReading STM32_SensorNode::read_sensor() {
 }
 
 float STM32_SensorNode::simulate_temperature() {
-    auto now = std::chrono::steady_clock::now();
+    auto now = clock_->now();
     auto elapsed = now - start_time_;
     float hours = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() / 3600000.0f;
     
@@ -358,7 +405,7 @@ float STM32_SensorNode::simulate_temperature() {
 }
 
 float STM32_SensorNode::simulate_humidity() {
-    auto now = std::chrono::steady_clock::now();
+    auto now = clock_->now();
     auto elapsed = now - start_time_;
     float hours = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() / 3600000.0f;
     
@@ -492,14 +539,18 @@ bool STM32_SensorNode::check_sensor_fault() {
         // Clear fault after some time
         if (fault_dist_(random_generator_) < 0.1f) {
             sensor_fault_ = false;
-            std::cout << "🔧 [" << config_.node_id << "] Sensor fault cleared" << std::endl;
+            if (config_.verbose_logging) {
+                THERMAL_LOG_INFO << "🔧 [" << config_.node_id << "] Sensor fault cleared";
+            }
         }
         return true;
     }
     
     // Random faults based on configuration
     if (fault_dist_(random_generator_) < config_.fault_probability) {
-        std::cout << "⚠️ [" << config_.node_id << "] Random sensor fault occurred" << std::endl;
+        if (config_.verbose_logging) {
+            THERMAL_LOG_WARN << "⚠️ [" << config_.node_id << "] Random sensor fault occurred";
+        }
         return true;
     }
     
@@ -517,7 +568,9 @@ bool STM32_SensorNode::check_connection_fault() {
         // Clear fault after some time
         if (fault_dist_(random_generator_) < 0.2f) {
             connection_fault_ = false;
-            std::cout << "📶 [" << config_.node_id << "] Connection restored" << std::endl;
+            if (config_.verbose_logging) {
+                THERMAL_LOG_INFO << "📶 [" << config_.node_id << "] Connection restored";
+            }
         }
         return true;
     }
@@ -525,7 +578,9 @@ bool STM32_SensorNode::check_connection_fault() {
     // Random connection issues
     if (fault_dist_(random_generator_) > config_.connection_stability) {
         connection_fault_ = true;
-        std::cout << "📶 [" << config_.node_id << "] Connection fault detected" << std::endl;
+        if (config_.verbose_logging) {
+            THERMAL_LOG_INFO << "📶 [" << config_.node_id << "] Connection fault detected";
+        }
         return true;
     }
     
@@ -562,6 +617,23 @@ std::string STM32_SensorNode::format_mqtt_message(const SensorReading& reading)
     return ss.str();
 }
 
+std::string STM32_SensorNode::format_binary_mqtt_message(const SensorReading& reading) {
+    thermal_monitoring::wire::SensorRecord record;
+    record.sensor_id = config_.node_id;
+    record.location = config_.location;
+    record.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        reading.timestamp.time_since_epoch()).count();
+    record.temperature = reading.temperature_celsius;
+    record.humidity = reading.humidity_percent;
+    record.pressure = reading.pressure_hpa;
+    record.supply_voltage = reading.supply_voltage;
+    record.status = reading.sensor_status;
+    
+    std::vector<uint8_t> encoded;
+    thermal_monitoring::wire::encode_sensor_record(record, encoded);
+    return std::string(encoded.begin(), encoded.end());
+}
+
 std::vector<uint8_t> STM32_SensorNode::create_binary_packet(const SensorReading& reading) {
     std::vector<uint8_t> packet;
     
@@ -686,6 +758,184 @@ std::string STM32_SensorNode::get_environment_pattern_string() const {
     }
 }
 
+//=============================================================================
+// NodeScheduler Implementation
+//=============================================================================
+
+NodeScheduler::NodeScheduler(size_t worker_count)
+    : worker_count_(std::max<size_t>(1, worker_count)), running_(false) {
+}
+
+NodeScheduler::~NodeScheduler() {
+    stop();
+}
+
+bool NodeScheduler::start(const std::vector<STM32_SensorNode*>& nodes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return true;
+        }
+        running_ = true;
+    }
+    
+    nodes_ = nodes;
+    workers_.clear();
+    for (size_t i = 0; i < worker_count_; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        schedule_initial(*workers_[i % worker_count_], i, now);
+    }
+    for (auto& worker : workers_) {
+        std::make_heap(worker->heap.begin(), worker->heap.end(), std::greater<Event>());
+        worker->thread = std::thread(&NodeScheduler::worker_loop, this, std::ref(*worker));
+    }
+    
+    THERMAL_LOG_INFO << "⏱️ [NodeScheduler] Driving " << nodes_.size() << " nodes with " 
+                     << worker_count_ << " worker threads";
+    return true;
+}
+
+bool NodeScheduler::start_virtual(const std::vector<STM32_SensorNode*>& nodes,
+                                  std::shared_ptr<thermal_monitoring::VirtualClock> clock) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_ || !clock) {
+            return running_;
+        }
+        running_ = true;
+    }
+    
+    // One heap, one thread (the caller's): event order is fully determined
+    virtual_clock_ = std::move(clock);
+    nodes_ = nodes;
+    workers_.clear();
+    workers_.push_back(std::make_unique<Worker>());
+    auto now = virtual_clock_->now();
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        schedule_initial(*workers_.front(), i, now);
+    }
+    std::make_heap(workers_.front()->heap.begin(), workers_.front()->heap.end(), std::greater<Event>());
+    
+    THERMAL_LOG_INFO << "⏱️ [NodeScheduler] Replaying " << nodes_.size() << " nodes on virtual time";
+    return true;
+}
+
+void NodeScheduler::run_until(std::chrono::steady_clock::time_point end) {
+    if (!virtual_clock_ || workers_.empty()) {
+        return;
+    }
+    
+    Worker& worker = *workers_.front();
+    while (!worker.heap.empty() && worker.heap.front().due <= end) {
+        virtual_clock_->advance_to(worker.heap.front().due);
+        run_due_events(worker, virtual_clock_->now());
+    }
+    virtual_clock_->advance_to(end);
+}
+
+void NodeScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    stop_cv_.notify_all();
+    
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    
+    auto stats = get_stats();
+    THERMAL_LOG_INFO << "⏱️ [NodeScheduler] Stopped after " << stats.readings << " readings, "
+                     << stats.transmissions << " transmissions, " << stats.overruns << " overruns";
+}
+
+NodeScheduler::Stats NodeScheduler::get_stats() const {
+    Stats stats = {};
+    for (const auto& worker : workers_) {
+        stats.readings += worker->readings.load(std::memory_order_relaxed);
+        stats.transmissions += worker->transmissions.load(std::memory_order_relaxed);
+        stats.overruns += worker->overruns.load(std::memory_order_relaxed);
+        stats.max_lateness_us = std::max(stats.max_lateness_us,
+                                         worker->max_lateness_us.load(std::memory_order_relaxed));
+    }
+    return stats;
+}
+
+// Spread first events across each interval so nodes do not fire in lockstep
+void NodeScheduler::schedule_initial(Worker& worker, size_t node_index, std::chrono::steady_clock::time_point now) {
+    auto reading_interval = std::max(1, nodes_[node_index]->get_reading_interval_ms());
+    auto transmission_interval = std::max(1, nodes_[node_index]->get_transmission_interval_ms());
+    auto phase = static_cast<int>((node_index * 7919) % 1000);
+    auto first_reading = now + std::chrono::milliseconds(reading_interval * phase / 1000);
+    
+    worker.heap.push_back({first_reading, static_cast<uint32_t>(node_index), EventKind::READING});
+    // Transmit after the first reading exists
+    worker.heap.push_back({first_reading + std::chrono::milliseconds(transmission_interval),
+                           static_cast<uint32_t>(node_index), EventKind::TRANSMISSION});
+}
+
+void NodeScheduler::worker_loop(Worker& worker) {
+    while (!worker.heap.empty()) {
+        {
+            // Sleep until the earliest event is due or stop() is called
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stop_cv_.wait_until(lock, worker.heap.front().due, [this] { return !running_; })) {
+                break;
+            }
+        }
+        
+        // Run everything that is due without retaking the lock
+        run_due_events(worker, std::chrono::steady_clock::now());
+    }
+}
+
+void NodeScheduler::run_due_events(Worker& worker, std::chrono::steady_clock::time_point now) {
+    auto& heap = worker.heap;
+    while (!heap.empty() && heap.front().due <= now) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Event>());
+        Event event = heap.back();
+        heap.pop_back();
+        
+        STM32_SensorNode* node = nodes_[event.node];
+        int interval_ms;
+        if (event.kind == EventKind::READING) {
+            interval_ms = node->get_reading_interval_ms();
+            if (node->is_running() && node->perform_reading()) {
+                worker.readings.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            interval_ms = node->get_transmission_interval_ms();
+            if (node->is_running() && node->perform_transmission()) {
+                worker.transmissions.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        
+        int64_t lateness_us = std::chrono::duration_cast<std::chrono::microseconds>(now - event.due).count();
+        if (lateness_us > worker.max_lateness_us.load(std::memory_order_relaxed)) {
+            worker.max_lateness_us.store(lateness_us, std::memory_order_relaxed);
+        }
+        
+        // Fixed rate from the due time; skip missed periods rather than bursting
+        auto interval = std::chrono::milliseconds(std::max(1, interval_ms));
+        event.due += interval;
+        if (event.due < now) {
+            worker.overruns.fetch_add(1, std::memory_order_relaxed);
+            event.due = now + interval;
+        }
+        heap.push_back(event);
+        std::push_heap(heap.begin(), heap.end(), std::greater<Event>());
+    }
+}
+
 //=============================================================================
 // SensorDeployment Implementation
 //=============================================================================
@@ -694,9 +944,42 @@ SensorDeployment::~SensorDeployment() {
     stop_all();
 }
 
+void SensorDeployment::set_execution_mode(DeploymentMode mode, size_t worker_count) {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    mode_ = mode;
+    scheduler_workers_ = worker_count;
+}
+
+void SensorDeployment::set_clock(std::shared_ptr<thermal_monitoring::Clock> clock) {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    clock_ = std::move(clock);
+    for (auto& node : sensor_nodes_) {
+        node->set_clock(clock_);
+    }
+}
+
+void SensorDeployment::run_virtual_for(std::chrono::steady_clock::duration period) {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    auto virtual_clock = std::dynamic_pointer_cast<thermal_monitoring::VirtualClock>(clock_);
+    if (!scheduler_ || !virtual_clock) {
+        THERMAL_LOG_ERROR << "❌ run_virtual_for needs a started SCHEDULED deployment on a VirtualClock";
+        return;
+    }
+    scheduler_->run_until(virtual_clock->now() + period);
+}
+
+NodeScheduler::Stats SensorDeployment::get_scheduler_stats() const {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    return scheduler_ ? scheduler_->get_stats() : last_scheduler_stats_;
+}
+
 void SensorDeployment::add_sensor_node(std::unique_ptr<STM32_SensorNode> node) {
     std::lock_guard<std::mutex> lock(nodes_mutex_);
     
+    if (clock_) {
+        node->set_clock(clock_);
+    }
+    
     // Set up callbacks if global ones are available
     if (global_uart_callback_) {
         node->set_uart_callback(global_uart_callback_);
@@ -706,12 +989,18 @@ void SensorDeployment::add_sensor_node(std::unique_ptr<STM32_SensorNode> node) {
     }
     
     sensor_nodes_.push_back(std::move(node));
-    std::cout << "➕ Added sensor node to deployment (Total: " << sensor_nodes_.size() << ")" << std::endl;
+    THERMAL_LOG_INFO << "➕ Added sensor node to deployment (Total: " << sensor_nodes_.size() << ")";
 }
 
 void SensorDeployment::remove_sensor_node(const std::string& node_id) {
     std::lock_guard<std::mutex> lock(nodes_mutex_);
     
+    // The scheduler holds raw node pointers until stop_all()
+    if (scheduler_) {
+        THERMAL_LOG_WARN << "⚠️ Cannot remove " << node_id << " while the scheduled deployment is running";
+        return;
+    }
+    
     auto it = std::remove_if(sensor_nodes_.begin(), sensor_nodes_.end(),
         [&node_id](const std::unique_ptr<STM32_SensorNode>& node) {
             return node->get_node_id() == node_id;
@@ -719,26 +1008,52 @@ void SensorDeployment::remove_sensor_node(const std::string& node_id) {
     
     if (it != sensor_nodes_.end()) {
         sensor_nodes_.erase(it, sensor_nodes_.end());
-        std::cout << "➖ Removed sensor node " << node_id << " from deployment" << std::endl;
+        THERMAL_LOG_INFO << "➖ Removed sensor node " << node_id << " from deployment";
     }
 }
 
 bool SensorDeployment::start_all() {
     std::lock_guard<std::mutex> lock(nodes_mutex_);
     
-    std::cout << "🚀 Starting sensor deployment (" << sensor_nodes_.size() << " nodes)..." << std::endl;
+    THERMAL_LOG_INFO << "🚀 Starting sensor deployment (" << sensor_nodes_.size() << " nodes)...";
     
     bool all_started = true;
-    for (auto& node : sensor_nodes_) {
-        if (!node->initialize() || !node->start()) {
-            all_started = false;
+    if (mode_ == DeploymentMode::SCHEDULED) {
+        if (scheduler_) {
+            return true;
+        }
+        
+        std::vector<STM32_SensorNode*> nodes;
+        nodes.reserve(sensor_nodes_.size());
+        for (auto& node : sensor_nodes_) {
+            if (!node->initialize() || !node->start(NodeExecution::EXTERNAL_SCHEDULER)) {
+                all_started = false;
+                continue;
+            }
+            nodes.push_back(node.get());
+        }
+        
+        auto virtual_clock = std::dynamic_pointer_cast<thermal_monitoring::VirtualClock>(clock_);
+        size_t workers = scheduler_workers_ != 0 ? scheduler_workers_ :
+            std::max(1u, std::thread::hardware_concurrency());
+        scheduler_ = std::make_unique<NodeScheduler>(virtual_clock ? 1 : workers);
+        if (virtual_clock) {
+            scheduler_->start_virtual(nodes, virtual_clock);
+        } else {
+            scheduler_->start(nodes);
+        }
+    } else {
+        for (auto& node : sensor_nodes_) {
+            if (!node->initialize() || !node->start()) {
+                all_started = false;
+            }
         }
     }
     
     if (all_started) {
-        std::cout << "✅ All sensor nodes started successfully" << std::endl;
+        THERMAL_LOG_INFO << "✅ All sensor nodes started successfully";
     } else {
-        std::cout << "⚠️ Some sensor nodes failed to start" << std::endl;
+        THERMAL_LOG_WARN << "⚠️ Some sensor nodes failed to start";
     }
     
     return all_started;
@@ -747,13 +1062,19 @@ bool SensorDeployment::start_all() {
 void SensorDeployment::stop_all() {
     std::lock_guard<std::mutex> lock(nodes_mutex_);
     
-    std::cout << "🛑 Stopping sensor deployment..." << std::endl;
+    THERMAL_LOG_INFO << "🛑 Stopping sensor deployment...";
     
+    // Scheduler first: no event may run against a stopping node
+    if (scheduler_) {
+        scheduler_->stop();
+        last_scheduler_stats_ = scheduler_->get_stats();
+        scheduler_.reset();
+    }
     for (auto& node : sensor_nodes_) {
         node->stop();
     }
     
-    std::cout << "✅ All sensor nodes stopped" << std::endl;
+    THERMAL_LOG_INFO << "✅ All sensor nodes stopped";
 }
 
 std::vector<std::string> SensorDeployment::get_node_ids() const {
@@ -768,7 +1089,11 @@ std::vector<std::string> SensorDeployment::get_node_ids() const {
 
 std::string SensorDeployment::get_deployment_status() const {
     std::lock_guard<std::mutex> lock(nodes_mutex_);
-    
+    return get_deployment_status_locked();
+}
+
+std::string SensorDeployment::get_deployment_status_locked() const {
+    // Caller holds nodes_mutex_
     std::stringstream ss;
     ss << "Sensor Deployment Status (" << sensor_nodes_.size() << " nodes):\n";
     
@@ -780,9 +1105,12 @@ std::string SensorDeployment::get_deployment_status() const {
 }
 
 void SensorDeployment::simulate_power_outage(int duration_ms) {
+    // Nodes only record when their power returns, so nothing sleeps under
+    // nodes_mutex_; every node goes dark at once and a virtual replay
+    // restores them as run_virtual_for() advances time
     std::lock_guard<std::mutex> lock(nodes_mutex_);
     
-    std::cout << "⚡ Simulating power outage for all nodes (" << duration_ms << "ms)" << std::endl;
+    THERMAL_LOG_INFO << "⚡ Simulating power outage for all nodes (" << duration_ms << "ms)";
     
     for (auto& node : sensor_nodes_) {
         node->simulate_power_loss(duration_ms);
@@ -827,11 +1155,11 @@ void SensorDeployment::save_deployment_log(const std::string& filename) const {
     
     std::ofstream file(filename);
     if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << filename << std::endl;
+        THERMAL_LOG_ERROR << "Failed to open file: " << filename;
         return;
     }
     
-    file << get_deployment_status();
+    file << get_deployment_status_locked();
     
     file << "\nDetailed Readings:\n";
     for (const auto& node : sensor_nodes_) {
@@ -845,7 +1173,7 @@ void SensorDeployment::save_deployment_log(const std::string& filename) const {
         }
     }
     
-    std::cout << "📄 Deployment log saved to: " << filename << std::endl;
+    THERMAL_LOG_INFO << "📄 Deployment log saved to: " << filename;
 }
 
 void SensorDeployment::set_global_uart_callback(std::function<void(const std::string&, const std::vector<uint8_t>&)> callback) {
@@ -9,6 +9,9 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
+#include "../../thermal-monitoring/Clock.h"
+#include "../../thermal-monitoring/RingHistory.h"
 
 namespace stm32_simulation {
 
@@ -49,6 +52,14 @@ enum class EnvironmentPattern {
     ATTIC              // Attic conditions
 };
 
+/**
+ * Who drives a node's read and transmit events
+ */
+enum class NodeExecution {
+    OWN_THREADS,        // Two sleeping threads per node (fidelity tests)
+    EXTERNAL_SCHEDULER  // A deployment-level NodeScheduler calls the step methods
+};
+
 /**
  * Sensor reading structure (raw data from sensor)
  */
@@ -101,6 +112,11 @@ struct SensorNodeConfig {
     int gateway_port = 8888;
     std::string mqtt_broker = "localhost";
     int mqtt_port = 1883;
+    bool mqtt_binary_payloads = false;  // MQTT_DIRECT: packed wire format on sensors/{id}/bin
+    
+    // Simulation settings
+    uint32_t random_seed = 0;           // Per-node RNG stream; 0 seeds from std::random_device
+    bool verbose_logging = true;        // Per-reading/transmission console output
 };
 
 /**
@@ -114,9 +130,17 @@ public:
     
     // Main interface
     bool initialize();
-    bool start();
+    bool start(NodeExecution execution = NodeExecution::OWN_THREADS);
     void stop();
     
+    // One read / one transmit event; the node's own threads loop over these,
+    // and a NodeScheduler calls them directly (never concurrently for one node).
+    // Both return false without doing anything while the node has no power
+    bool perform_reading();
+    bool perform_transmission();
+    int get_reading_interval_ms() const { return config_.reading_interval_ms; }
+    int get_transmission_interval_ms() const { return config_.transmission_interval_ms; }
+    
     // Status queries
     bool is_running() const { return running_.load(); }
     std::string get_node_id() const { return config_.node_id; }
@@ -126,18 +150,26 @@ public:
     SensorReading get_last_reading() const;
     std::vector<SensorReading> get_reading_history(int count = 10) const;
     
+    // Time source for readings, environment patterns and the node's own
+    // threads; set before initialize()
+    void set_clock(std::shared_ptr<thermal_monitoring::Clock> clock);
+    
     // Callbacks for data transmission
     void set_uart_callback(std::function<void(const std::string&, const std::vector<uint8_t>&)> callback);
     void set_mqtt_callback(std::function<void(const std::string&, const std::string&)> callback);
     
     // Simulation controls
     void inject_fault();
+    // The node goes dark until its clock reaches now + duration_ms and then
+    // resumes on its next reading. Returns immediately, so on a VirtualClock
+    // power comes back as the replay advances time
     void simulate_power_loss(int duration_ms);
     void change_environment(EnvironmentPattern new_pattern);
     void update_base_conditions(float temp, float humidity);
     
 private:
     SensorNodeConfig config_;
+    std::shared_ptr<thermal_monitoring::Clock> clock_;
     std::atomic<bool> running_;
     std::atomic<bool> initialized_;
     
@@ -161,8 +193,8 @@ private:
     
     // Data storage
     SensorReading last_reading_;
-    std::vector<SensorReading> reading_history_;
     static const size_t MAX_HISTORY = 100;
+    thermal_monitoring::RingHistory<SensorReading> reading_history_{MAX_HISTORY};  // Oldest overwritten once full
     
     // Sensor state
     bool sensor_fault_;
@@ -171,6 +203,7 @@ private:
     float supply_voltage_;
     uint32_t reading_count_;
     uint32_t transmission_count_;
+    std::atomic<int64_t> power_restore_ns_{0};  // Clock time power returns at; 0 = powered
     
     // Communication callbacks
     std::function<void(const std::string&, const std::vector<uint8_t>&)> uart_callback_;
@@ -191,6 +224,7 @@ private:
     // Data formatting
     std::string format_uart_message(const SensorReading& reading);
     std::string format_mqtt_message(const SensorReading& reading);
+    std::string format_binary_mqtt_message(const SensorReading& reading);
     std::vector<uint8_t> create_binary_packet(const SensorReading& reading);
     
     // Hardware simulation
@@ -205,6 +239,87 @@ private:
     std::string get_environment_pattern_string() const;
 };
 
+/**
+ * Deployment-level event scheduler for large virtual node counts
+ *
+ * Replaces the two sleeping threads per node with a small worker pool.
+ * Nodes are assigned to workers round-robin and each worker owns a binary
+ * min-heap of (due time, node, event) entries, so a node's events always
+ * run on the same thread in order and never need a lock. Events are
+ * rescheduled at a fixed rate from their due time (no drift); an event
+ * that is more than one interval late is rescheduled from now and counted
+ * as an overrun instead of firing in a burst.
+ *
+ * The nodes must outlive the scheduler and stay registered until stop().
+ */
+class NodeScheduler {
+public:
+    struct Stats {
+        uint64_t readings;
+        uint64_t transmissions;
+        uint64_t overruns;
+        int64_t max_lateness_us;
+    };
+    
+    explicit NodeScheduler(size_t worker_count);
+    ~NodeScheduler();
+    
+    NodeScheduler(const NodeScheduler&) = delete;
+    NodeScheduler& operator=(const NodeScheduler&) = delete;
+    
+    bool start(const std::vector<STM32_SensorNode*>& nodes);
+    void stop();
+    
+    // Deterministic replay: no threads; run_until() executes every due event
+    // on the caller's thread, advancing the virtual clock from event to event
+    bool start_virtual(const std::vector<STM32_SensorNode*>& nodes,
+                       std::shared_ptr<thermal_monitoring::VirtualClock> clock);
+    void run_until(std::chrono::steady_clock::time_point end);
+    
+    size_t get_worker_count() const { return worker_count_; }
+    Stats get_stats() const;
+    
+private:
+    enum class EventKind : uint8_t { READING, TRANSMISSION };
+    
+    struct Event {
+        std::chrono::steady_clock::time_point due;
+        uint32_t node;
+        EventKind kind;
+        
+        bool operator>(const Event& other) const { return due > other.due; }
+    };
+    
+    struct Worker {
+        std::vector<Event> heap;        // std::push_heap/pop_heap with std::greater
+        std::thread thread;
+        std::atomic<uint64_t> readings{0};
+        std::atomic<uint64_t> transmissions{0};
+        std::atomic<uint64_t> overruns{0};
+        std::atomic<int64_t> max_lateness_us{0};
+    };
+    
+    const size_t worker_count_;
+    std::shared_ptr<thermal_monitoring::VirtualClock> virtual_clock_;
+    std::vector<STM32_SensorNode*> nodes_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    bool running_;
+    std::mutex mutex_;                  // Guards running_ for the workers' timed waits
+    std::condition_variable stop_cv_;
+    
+    void worker_loop(Worker& worker);
+    void schedule_initial(Worker& worker, size_t node_index, std::chrono::steady_clock::time_point now);
+    void run_due_events(Worker& worker, std::chrono::steady_clock::time_point now);
+};
+
+/**
+ * How SensorDeployment runs its nodes
+ */
+enum class DeploymentMode {
+    THREAD_PER_NODE,    // Each node starts its own threads
+    SCHEDULED           // One NodeScheduler drives every node
+};
+
 /**
  * Multi-sensor deployment manager
  * Manages multiple sensor nodes in a coordinated deployment
@@ -218,6 +333,16 @@ public:
     void add_sensor_node(std::unique_ptr<STM32_SensorNode> node);
     void remove_sensor_node(const std::string& node_id);
     
+    // Takes effect on the next start_all(); worker_count 0 uses one per core
+    void set_execution_mode(DeploymentMode mode, size_t worker_count = 0);
+    
+    // Shared by every node. With a VirtualClock in SCHEDULED mode start_all()
+    // spawns no threads and time only moves through run_virtual_for()
+    void set_clock(std::shared_ptr<thermal_monitoring::Clock> clock);
+    void run_virtual_for(std::chrono::steady_clock::duration period);
+    DeploymentMode get_execution_mode() const { return mode_; }
+    NodeScheduler::Stats get_scheduler_stats() const;
+    
     bool start_all();
     void stop_all();
     
@@ -226,7 +351,7 @@ public:
     std::vector<std::string> get_node_ids() const;
     std::string get_deployment_status() const;
     
-    // Bulk operations
+    // Bulk operations; an outage cuts every node at once without blocking
     void simulate_power_outage(int duration_ms);
     void change_all_environments(EnvironmentPattern pattern);
     void inject_random_faults(float fault_rate = 0.1f);
@@ -243,6 +368,15 @@ private:
     std::vector<std::unique_ptr<STM32_SensorNode>> sensor_nodes_;
     mutable std::mutex nodes_mutex_;
     
+    std::string get_deployment_status_locked() const;
+    
+    // Scheduled mode
+    DeploymentMode mode_ = DeploymentMode::THREAD_PER_NODE;
+    size_t scheduler_workers_ = 0;
+    std::unique_ptr<NodeScheduler> scheduler_;
+    NodeScheduler::Stats last_scheduler_stats_ = {};
+    std::shared_ptr<thermal_monitoring::Clock> clock_;
+    
     // Global callbacks
     std::function<void(const std::string&, const std::vector<uint8_t>&)> global_uart_callback_;
     std::function<void(const std::string&, const std::string&)> global_mqtt_callback_;
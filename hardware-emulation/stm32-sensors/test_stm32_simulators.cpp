@@ -1,10 +1,12 @@
 #include "STM32_SensorNode.h"
+#include "../../thermal-monitoring/Log.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <atomic>
 #include <signal.h>
 #include <iomanip>
+#include <algorithm>
 
 using namespace stm32_simulation;
 
@@ -96,6 +98,23 @@ void test_single_sensor() {
     std::this_thread::sleep_for(std::chrono::seconds(3));
     
     sensor.stop();
+
+    // History keeps the newest 100 readings, oldest first
+    config.verbose_logging = false;
+    STM32_SensorNode quiet(config);
+    quiet.initialize();
+    for (int i = 0; i < 250; ++i) {
+        quiet.perform_reading();
+    }
+    auto history = quiet.get_reading_history(1000);
+    auto recent = quiet.get_reading_history(3);
+    SensorReading last = quiet.get_last_reading();
+    if (history.size() != 100 || recent.size() != 3 ||
+        history.back().temperature_celsius != last.temperature_celsius ||
+        recent.front().temperature_celsius != history[97].temperature_celsius) {
+        std::cerr << "❌ Reading history holds " << history.size() << " readings" << std::endl;
+        return;
+    }
     std::cout << "✅ Single sensor test completed\n";
 }
 
@@ -171,6 +190,157 @@ void test_sensor_deployment() {
     std::cout << "✅ Deployment test completed\n";
 }
 
+// Test the scheduled engine at building scale
+void test_scheduled_deployment() {
+    std::cout << "\n⏱️ Testing Scheduled Deployment (10,000 nodes)\n";
+    std::cout << "===============================================\n";
+    
+    const int node_count = 10000;
+    const int run_seconds = 3;
+    SensorDeployment deployment;
+    deployment.set_execution_mode(DeploymentMode::SCHEDULED, 4);
+    
+    std::atomic<uint64_t> frames{0};
+    deployment.set_global_uart_callback([&frames](const std::string&, const std::vector<uint8_t>&) {
+        frames++;
+    });
+    
+    for (int i = 0; i < node_count; ++i) {
+        auto config = sensor_factory::create_indoor_node("bldg_" + std::to_string(i), 
+                                                         "Floor " + std::to_string(i / 500));
+        config.reading_interval_ms = 1000;
+        config.transmission_interval_ms = 1000;
+        config.random_seed = static_cast<uint32_t>(i + 1);
+        config.verbose_logging = false;
+        deployment.add_sensor_node(std::make_unique<STM32_SensorNode>(config));
+    }
+    
+    if (!deployment.start_all()) {
+        std::cerr << "❌ Failed to start scheduled deployment" << std::endl;
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(run_seconds));
+    deployment.stop_all();
+    
+    auto stats = deployment.get_scheduler_stats();
+    std::cout << "📊 " << stats.readings << " readings, " << stats.transmissions << " transmissions, "
+              << frames.load() << " UART frames, " << stats.overruns << " overruns, max lateness "
+              << stats.max_lateness_us / 1000.0 << " ms\n";
+    
+    // Every node reads about once per second; allow for the startup phase spread
+    uint64_t expected = static_cast<uint64_t>(node_count) * (run_seconds - 1);
+    if (stats.readings < expected || frames.load() == 0) {
+        std::cerr << "❌ Scheduled deployment fell behind" << std::endl;
+        return;
+    }
+    std::cout << "✅ Scheduled deployment test completed\n";
+}
+
+// Replays a day of a seeded heating-cycle deployment on virtual time;
+// returns a checksum over every transmitted frame
+uint64_t replay_heating_day(int node_count, float& min_temp, float& max_temp) {
+    auto clock = std::make_shared<thermal_monitoring::VirtualClock>();
+    SensorDeployment deployment;
+    deployment.set_execution_mode(DeploymentMode::SCHEDULED);
+    deployment.set_clock(clock);
+    
+    uint64_t checksum = 1469598103934665603ull;
+    min_temp = 1000.0f;
+    max_temp = -1000.0f;
+    deployment.set_global_uart_callback([&](const std::string&, const std::vector<uint8_t>& data) {
+        for (uint8_t byte : data) {
+            checksum = (checksum ^ byte) * 1099511628211ull;
+        }
+        float temperature = static_cast<int16_t>((data[6] << 8) | data[7]) / 100.0f;
+        min_temp = std::min(min_temp, temperature);
+        max_temp = std::max(max_temp, temperature);
+    });
+    
+    for (int i = 0; i < node_count; ++i) {
+        auto config = sensor_factory::create_indoor_node("replay_" + std::to_string(i), "Zone " + std::to_string(i));
+        config.environment = EnvironmentPattern::HEATING_CYCLE;
+        config.reading_interval_ms = 10000;
+        config.transmission_interval_ms = 60000;
+        config.random_seed = static_cast<uint32_t>(1000 + i);
+        config.verbose_logging = false;
+        deployment.add_sensor_node(std::make_unique<STM32_SensorNode>(config));
+    }
+    
+    deployment.start_all();
+    deployment.run_virtual_for(std::chrono::hours(24));
+    deployment.stop_all();
+    return checksum;
+}
+
+// Test deterministic accelerated replay
+void test_virtual_time_replay() {
+    std::cout << "\n⏩ Testing Virtual-Time Replay (24h heating cycle)\n";
+    std::cout << "==================================================\n";
+    
+    const int node_count = 50;
+    float min_first, max_first, min_second, max_second;
+    auto wall_start = std::chrono::steady_clock::now();
+    uint64_t first = replay_heating_day(node_count, min_first, max_first);
+    auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - wall_start).count();
+    uint64_t second = replay_heating_day(node_count, min_second, max_second);
+    
+    std::cout << "📊 24h of " << node_count << " nodes replayed in " << wall_ms << " ms, temperature range "
+              << std::fixed << std::setprecision(1) << min_first << "-" << max_first << "°C\n";
+    
+    if (first != second || min_first != min_second || max_first - min_first < 1.0f) {
+        std::cerr << "❌ Replay was not reproducible or did not follow the heating cycle" << std::endl;
+        return;
+    }
+    std::cout << "✅ Replay reproducible (checksum " << std::hex << first << std::dec << ")\n";
+}
+
+// Test a deployment-wide outage on virtual time
+void test_virtual_power_outage() {
+    std::cout << "\n🔌 Testing Power Outage on Virtual Time\n";
+    std::cout << "=======================================\n";
+    
+    auto clock = std::make_shared<thermal_monitoring::VirtualClock>();
+    SensorDeployment deployment;
+    deployment.set_execution_mode(DeploymentMode::SCHEDULED);
+    deployment.set_clock(clock);
+    
+    const int node_count = 20;
+    for (int i = 0; i < node_count; ++i) {
+        auto config = sensor_factory::create_indoor_node("outage_" + std::to_string(i), "Zone " + std::to_string(i));
+        config.reading_interval_ms = 1000;
+        config.transmission_interval_ms = 5000;
+        config.random_seed = static_cast<uint32_t>(2000 + i);
+        config.verbose_logging = false;
+        deployment.add_sensor_node(std::make_unique<STM32_SensorNode>(config));
+    }
+    
+    deployment.start_all();
+    deployment.run_virtual_for(std::chrono::seconds(10));
+    uint64_t before = deployment.get_scheduler_stats().readings;
+    
+    // Returns at once; the nodes stay dark for 30s of virtual time
+    auto wall_start = std::chrono::steady_clock::now();
+    deployment.simulate_power_outage(30000);
+    auto outage_wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - wall_start).count();
+    deployment.run_virtual_for(std::chrono::seconds(29));
+    uint64_t during = deployment.get_scheduler_stats().readings;
+    deployment.run_virtual_for(std::chrono::seconds(11));
+    uint64_t after = deployment.get_scheduler_stats().readings;
+    deployment.stop_all();
+    
+    std::cout << "📊 " << before << " readings before, " << during - before << " during, "
+              << after - during << " after the outage (" << outage_wall_ms << " ms wall time)\n";
+    
+    if (before == 0 || during != before || after - during < static_cast<uint64_t>(node_count) * 10 ||
+        outage_wall_ms > 1000) {
+        std::cerr << "❌ Outage did not pause and restore the deployment on virtual time" << std::endl;
+        return;
+    }
+    std::cout << "✅ Virtual-time outage test completed\n";
+}
+
 // Test different sensor types
 void test_different_sensor_types() {
     std::cout << "\n🔬 Testing Different Sensor Types\n";
@@ -345,9 +515,13 @@ void interactive_demo() {
     std::cout << "✅ Interactive demo completed\n";
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     // Set up signal handler
     signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    
+    // Verbose demo nodes log each reading and transmission at DEBUG
+    thermal_monitoring::Log::set_level(thermal_monitoring::LogLevel::DEBUG);
     
     std::cout << "🚀 STM32 Sensor Node Simulator Test Suite\n";
     std::cout << "==========================================\n";
@@ -373,8 +547,25 @@ int main() {
         
         if (!g_running.load()) return 0;
         
-        // Interactive demo
-        interactive_demo();
+        // Test 5: Scheduled engine at scale
+        test_scheduled_deployment();
+        
+        if (!g_running.load()) return 0;
+        
+        // Test 6: Deterministic virtual-time replay
+        test_virtual_time_replay();
+        
+        if (!g_running.load()) return 0;
+        
+        // Test 7: Deployment-wide outage on virtual time
+        test_virtual_power_outage();
+        
+        if (!g_running.load()) return 0;
+        
+        // Interactive demo runs until Ctrl+C, so only on request
+        if (argc > 1 && std::string(argv[1]) == "--demo") {
+            interactive_demo();
+        }
         
     } catch (const std::exception& e) {
         std::cerr << "❌ Exception caught: " << e.what() << std::endl;
@@ -0,0 +1,223 @@
+/*
+ * HDR-style latency histogram for the MQTT performance test
+ *
+ * Log-linear buckets in the HdrHistogram layout: every power-of-two range
+ * is split into 1024 linear sub-buckets, so any recorded value is kept to
+ * within 0.1% across the whole range (1 us .. ~71 minutes) in a fixed
+ * 184 KiB table. Recording is a couple of shifts plus relaxed atomic
+ * increments and never allocates or locks.
+ *
+ * Each histogram has exactly one writer thread (a publisher or a
+ * subscriber's network thread). Other threads may read it while it is
+ * being written (the periodic stats sampler) and merge it into a
+ * combined histogram once the writers have stopped.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_HALF_MAGNITUDE = 10;
+    static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << (SUB_BUCKET_HALF_MAGNITUDE + 1);
+    static constexpr uint64_t SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT / 2;
+    static constexpr uint64_t SUB_BUCKET_MASK = SUB_BUCKET_COUNT - 1;
+    static constexpr uint64_t MAX_TRACKABLE_VALUE = (uint64_t(1) << 32) - 1;  // In recorded units (us)
+    static constexpr size_t BUCKET_COUNT = 32 - (SUB_BUCKET_HALF_MAGNITUDE + 1) + 1;
+    static constexpr size_t COUNTS_LENGTH = (BUCKET_COUNT + 1) * SUB_BUCKET_HALF_COUNT;
+
+    LatencyHistogram() : counts_(new std::atomic<uint64_t>[COUNTS_LENGTH]) {
+        reset();
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // Values above MAX_TRACKABLE_VALUE are clamped into the top bucket
+    void record(uint64_t value) {
+        value = std::min(value, MAX_TRACKABLE_VALUE);
+        relaxed_add(counts_[counts_index(value)], 1);
+        relaxed_add(total_count_, 1);
+        relaxed_add(total_sum_, value);
+        if (value < min_.load(std::memory_order_relaxed)) {
+            min_.store(value, std::memory_order_relaxed);
+        }
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Adds every count from 'other'; call after other's writer has stopped
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < COUNTS_LENGTH; ++i) {
+            uint64_t count = other.counts_[i].load(std::memory_order_relaxed);
+            if (count) {
+                counts_[i].fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+        total_count_.fetch_add(other.count(), std::memory_order_relaxed);
+        total_sum_.fetch_add(other.total_sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        if (other.count()) {
+            min_.store(std::min(min(), other.min()), std::memory_order_relaxed);
+            max_.store(std::max(max(), other.max()), std::memory_order_relaxed);
+        }
+    }
+
+    void reset() {
+        for (size_t i = 0; i < COUNTS_LENGTH; ++i) {
+            counts_[i].store(0, std::memory_order_relaxed);
+        }
+        total_count_.store(0, std::memory_order_relaxed);
+        total_sum_.store(0, std::memory_order_relaxed);
+        min_.store(UINT64_MAX, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return total_count_.load(std::memory_order_relaxed); }
+    uint64_t min() const { return count() ? min_.load(std::memory_order_relaxed) : 0; }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    double mean() const {
+        uint64_t n = count();
+        return n ? static_cast<double>(total_sum_.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    // Computed from bucket midpoints, so accurate to the bucket resolution
+    double stddev() const {
+        uint64_t n = count();
+        if (n == 0) {
+            return 0.0;
+        }
+        double avg = mean();
+        double squares = 0.0;
+        for (size_t i = 0; i < COUNTS_LENGTH; ++i) {
+            uint64_t c = counts_[i].load(std::memory_order_relaxed);
+            if (c) {
+                double delta = (lowest_equivalent_value(i) + highest_equivalent_value(i)) / 2.0 - avg;
+                squares += delta * delta * c;
+            }
+        }
+        return std::sqrt(squares / n);
+    }
+
+    /**
+     * Smallest recorded value such that 'percentile' percent of all values
+     * are at or below it, reported as the top of its bucket (never
+     * understates a tail). percentile is 0..100.
+     */
+    uint64_t value_at_percentile(double percentile) const {
+        uint64_t total = count();
+        if (total == 0) {
+            return 0;
+        }
+        percentile = std::min(std::max(percentile, 0.0), 100.0);
+        uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100.0 * total + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < COUNTS_LENGTH; ++i) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                return std::min(highest_equivalent_value(i), max());
+            }
+        }
+        return max();
+    }
+
+    /**
+     * Writes the percentile distribution in HdrHistogram's text format
+     * (Value, Percentile, TotalCount, 1/(1-Percentile)) so the output can
+     * be fed to the standard HdrHistogram plotter. 'scale' divides values
+     * on output (1000.0 prints microsecond recordings as milliseconds).
+     */
+    void write_percentile_distribution(std::ostream& out, double scale = 1.0,
+                                       int ticks_per_half_distance = 5) const {
+        uint64_t total = count();
+        out << std::setw(12) << "Value" << " " << std::setw(14) << "Percentile" << " "
+            << std::setw(10) << "TotalCount" << " " << std::setw(14) << "1/(1-Percentile)" << "\n\n";
+        if (total == 0) {
+            return;
+        }
+
+        out << std::fixed;
+        double percentile = 0.0;
+        double step = 50.0 / ticks_per_half_distance;
+        double half_distance = 50.0;
+        while (true) {
+            uint64_t value = value_at_percentile(percentile);
+            uint64_t at_or_below = count_at_or_below(value);
+            double reported = 100.0 * at_or_below / total;
+            out << std::setw(12) << std::setprecision(3) << value / scale << " "
+                << std::setw(14) << std::setprecision(12) << reported / 100.0 << " "
+                << std::setw(10) << at_or_below;
+            if (reported < 100.0) {
+                out << " " << std::setw(14) << std::setprecision(2) << 100.0 / (100.0 - reported);
+            }
+            out << "\n";
+            if (at_or_below >= total) {
+                break;
+            }
+            // Halve the step every time half the remaining distance to 100% is covered
+            percentile += step;
+            if (percentile >= 100.0 - half_distance) {
+                half_distance /= 2.0;
+                step = half_distance / ticks_per_half_distance;
+            }
+        }
+        out << "#[Mean    = " << std::setw(12) << std::setprecision(3) << mean() / scale
+            << ", StdDeviation   = " << std::setw(12) << std::setprecision(3) << stddev() / scale << "]\n"
+            << "#[Max     = " << std::setw(12) << std::setprecision(3) << max() / scale
+            << ", Total count    = " << std::setw(12) << total << "]\n"
+            << "#[Buckets = " << std::setw(12) << BUCKET_COUNT
+            << ", SubBuckets     = " << std::setw(12) << SUB_BUCKET_COUNT << "]\n";
+        out.unsetf(std::ios::floatfield);
+    }
+
+private:
+    // Single writer per histogram, so a load + store beats a locked fetch_add
+    static void relaxed_add(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static size_t counts_index(uint64_t value) {
+        int bucket_index = 64 - __builtin_clzll(value | SUB_BUCKET_MASK) - (SUB_BUCKET_HALF_MAGNITUDE + 1);
+        uint64_t sub_bucket_index = value >> bucket_index;
+        return (static_cast<size_t>(bucket_index + 1) << SUB_BUCKET_HALF_MAGNITUDE) +
+               static_cast<size_t>(sub_bucket_index - SUB_BUCKET_HALF_COUNT);
+    }
+
+    static uint64_t lowest_equivalent_value(size_t index) {
+        int bucket_index = static_cast<int>(index >> SUB_BUCKET_HALF_MAGNITUDE) - 1;
+        if (bucket_index < 0) {
+            // The first half-range is linear with unit width
+            return index;
+        }
+        uint64_t sub_bucket_index = (index & (SUB_BUCKET_HALF_COUNT - 1)) + SUB_BUCKET_HALF_COUNT;
+        return sub_bucket_index << bucket_index;
+    }
+
+    static uint64_t highest_equivalent_value(size_t index) {
+        int bucket_index = std::max(0, static_cast<int>(index >> SUB_BUCKET_HALF_MAGNITUDE) - 1);
+        return lowest_equivalent_value(index) + ((uint64_t(1) << bucket_index) - 1);
+    }
+
+    uint64_t count_at_or_below(uint64_t value) const {
+        size_t last = counts_index(std::min(value, MAX_TRACKABLE_VALUE));
+        uint64_t total = 0;
+        for (size_t i = 0; i <= last; ++i) {
+            total += counts_[i].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> total_count_{0};
+    std::atomic<uint64_t> total_sum_{0};
+    std::atomic<uint64_t> min_{UINT64_MAX};
+    std::atomic<uint64_t> max_{0};
+};
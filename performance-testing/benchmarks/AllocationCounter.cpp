@@ -0,0 +1,35 @@
+/*
+ * Global operator new replacement for the microbenchmarks
+ *
+ * Kept in its own translation unit so GCC cannot inline the replacement
+ * into callers (which trips -Wmismatched-new-delete false positives).
+ */
+
+#include "MicroBenchmark.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+}
+
+uint64_t microbench::allocation_count() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,224 @@
+/*
+ * Microbenchmark harness for the hot-path components
+ *
+ * Runs an operation a fixed number of times on one or more threads, timing
+ * every call individually, and reports throughput, ns/op, heap
+ * allocations/op and p50/p99/p99.9 latency. Results serialise to JSON so
+ * runs can be diffed against a saved baseline.
+ *
+ * Allocation counts come from the global operator new replacement in
+ * AllocationCounter.cpp and cover the whole process, including background
+ * threads the component owns (DataProcessor workers, storage commits).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace microbench {
+
+// Heap allocations since process start (defined with operator new)
+uint64_t allocation_count();
+
+using Params = std::vector<std::pair<std::string, std::string>>;
+
+struct Result {
+    std::string name;
+    Params params;
+    size_t threads = 1;
+    uint64_t ops = 0;
+    double seconds = 0.0;
+    double ns_per_op = 0.0;
+    double ops_per_second = 0.0;
+    double allocs_per_op = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    std::vector<std::pair<std::string, double>> counters;  // Benchmark-specific extras
+
+    std::string label() const {
+        std::string text = name;
+        for (const auto& param : params) {
+            text += " " + param.first + "=" + param.second;
+        }
+        return text;
+    }
+};
+
+struct Options {
+    double scale = 1.0;        // Multiplier on every benchmark's op count
+    std::string filter;        // Substring match on "name param=value ..."
+    uint32_t seed = 42;        // Fixed so every run sees the same inputs
+
+    uint64_t ops(uint64_t base) const {
+        return std::max<uint64_t>(1, static_cast<uint64_t>(base * scale));
+    }
+    bool selected(const std::string& name, const Params& params) const {
+        Result probe;
+        probe.name = name;
+        probe.params = params;
+        return filter.empty() || probe.label().find(filter) != std::string::npos;
+    }
+};
+
+// Keeps a computed value observable so the optimiser cannot drop the work
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+inline uint64_t percentile(std::vector<uint32_t>& samples, double fraction) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+/**
+ * Times op(thread_index, op_index) 'ops' times split across 'threads'.
+ *
+ * An untimed warm-up pass (up to 1000 calls per thread) runs first.
+ * finish() runs inside the timed region after every thread is done, for
+ * pipelines whose work completes asynchronously (wait for the drain there).
+ */
+template <typename Op, typename Finish>
+Result measure(const std::string& name, const Params& params, size_t threads, uint64_t ops,
+               Op&& op, Finish&& finish) {
+    threads = std::max<size_t>(1, threads);
+    const uint64_t per_thread = std::max<uint64_t>(1, ops / threads);
+    const uint64_t warmup = std::min<uint64_t>(1000, per_thread / 10);
+
+    std::vector<std::vector<uint32_t>> samples(threads, std::vector<uint32_t>(per_thread));
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+
+    auto worker = [&](size_t t) {
+        for (uint64_t i = 0; i < warmup; ++i) {
+            op(t, i);
+        }
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        uint32_t* out = samples[t].data();
+        for (uint64_t i = 0; i < per_thread; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            op(t, warmup + i);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            out[i] = static_cast<uint32_t>(std::min<int64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), UINT32_MAX));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) {
+        pool.emplace_back(worker, t);
+    }
+    // Thread 0 is the caller, so single-threaded runs spawn nothing
+    for (uint64_t i = 0; i < warmup; ++i) {
+        op(0, i);
+    }
+    while (ready.load() < threads - 1) {
+        std::this_thread::yield();
+    }
+
+    uint64_t allocations_before = allocation_count();
+    auto started = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+
+    uint32_t* out = samples[0].data();
+    for (uint64_t i = 0; i < per_thread; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        op(0, warmup + i);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        out[i] = static_cast<uint32_t>(std::min<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), UINT32_MAX));
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    finish();
+    auto finished = std::chrono::steady_clock::now();
+    uint64_t allocations = allocation_count() - allocations_before;
+
+    std::vector<uint32_t> merged;
+    merged.reserve(per_thread * threads);
+    for (const auto& thread_samples : samples) {
+        merged.insert(merged.end(), thread_samples.begin(), thread_samples.end());
+    }
+
+    Result result;
+    result.name = name;
+    result.params = params;
+    result.threads = threads;
+    result.ops = per_thread * threads;
+    result.seconds = std::chrono::duration<double>(finished - started).count();
+    result.ns_per_op = result.seconds * 1e9 / result.ops;
+    result.ops_per_second = result.ops / std::max(result.seconds, 1e-9);
+    result.allocs_per_op = static_cast<double>(allocations) / result.ops;
+    result.p50_ns = percentile(merged, 0.50);
+    result.p99_ns = percentile(merged, 0.99);
+    result.p999_ns = percentile(merged, 0.999);
+    return result;
+}
+
+template <typename Op>
+Result measure(const std::string& name, const Params& params, size_t threads, uint64_t ops, Op&& op) {
+    return measure(name, params, threads, ops, std::forward<Op>(op), [] {});
+}
+
+inline std::string json_escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default:   out += c;
+        }
+    }
+    return out;
+}
+
+inline std::string to_json(const std::vector<Result>& results) {
+    std::ostringstream json;
+    json << std::setprecision(6);
+    json << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        json << (i ? ",\n" : "\n") << "    {\"name\": \"" << json_escape(r.name) << "\", \"params\": {";
+        for (size_t p = 0; p < r.params.size(); ++p) {
+            json << (p ? ", " : "") << "\"" << json_escape(r.params[p].first) << "\": \""
+                 << json_escape(r.params[p].second) << "\"";
+        }
+        json << "}, \"threads\": " << r.threads
+             << ", \"ops\": " << r.ops
+             << ", \"seconds\": " << r.seconds
+             << ", \"ops_per_second\": " << r.ops_per_second
+             << ", \"ns_per_op\": " << r.ns_per_op
+             << ", \"allocs_per_op\": " << r.allocs_per_op
+             << ", \"p50_ns\": " << r.p50_ns
+             << ", \"p99_ns\": " << r.p99_ns
+             << ", \"p999_ns\": " << r.p999_ns;
+        for (const auto& counter : r.counters) {
+            json << ", \"" << json_escape(counter.first) << "\": " << counter.second;
+        }
+        json << "}";
+    }
+    json << "\n  ]\n}\n";
+    return json.str();
+}
+
+} // namespace microbench
@@ -0,0 +1,462 @@
+/*
+ * Hot-path microbenchmarks
+ *
+ * Links the real ThermalIsolationTracker, parse_sensor_message, DataProcessor
+ * and StorageManager (plus the bridge MessageBuffer when built with
+ * MICROBENCH_WITH_BRIDGE) and runs each across a parameter grid: sensor
+ * count, history size, thread count and payload format. Inputs come from
+ * a fixed seed, so two runs of the same build measure the same work.
+ *
+ * Usage:
+ *   microbenchmarks [--filter TEXT] [--quick] [--scale X] [--output FILE] [--list]
+ *
+ * JSON goes to --output (or stdout); a one-line summary per benchmark goes
+ * to stderr.
+ */
+
+#include "MicroBenchmark.h"
+#include "../../thermal-monitoring/ThermalIsolationTracker.h"
+#include "../../thermal-monitoring/SensorWireFormat.h"
+#include "../../thermal-monitoring/Log.h"
+#include "../../hardware-emulation/rpi4-gateways/RPi4_Gateway.h"
+#ifdef MICROBENCH_WITH_BRIDGE
+#include "../../communication-backends/cpp-bridge/include/mqtt_ws_bridge.h"
+#endif
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <unistd.h>
+
+using namespace microbench;
+using thermal_monitoring::ThermalConfig;
+using thermal_monitoring::ThermalIsolationTracker;
+
+namespace {
+
+std::vector<std::string> make_sensor_ids(size_t count) {
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < count; ++i) {
+        ids.push_back("sensor_" + std::to_string(i));
+    }
+    return ids;
+}
+
+// Readings stay inside every threshold so alert handling does not skew results
+float steady_temperature(std::mt19937& rng) {
+    return std::uniform_real_distribution<float>(21.0f, 23.0f)(rng);
+}
+
+//=============================================================================
+// parse_sensor_message
+//=============================================================================
+
+void bench_parse(const Options& options, std::vector<Result>& results) {
+    for (const char* format : {"json", "binary"}) {
+        Params params = {{"format", format}};
+        if (!options.selected("parse_sensor_message", params)) {
+            continue;
+        }
+
+        std::mt19937 rng(options.seed);
+        struct Message { std::string topic; std::string payload; };
+        std::vector<Message> messages;
+        for (size_t i = 0; i < 256; ++i) {
+            std::string id = "sensor_" + std::to_string(i);
+            float temperature = steady_temperature(rng);
+            if (std::string(format) == "json") {
+                messages.push_back({"sensors/" + id + "/data",
+                                    "{\"temperature\": " + std::to_string(temperature) +
+                                    ", \"humidity\": 45.5, \"location\": \"room_" + std::to_string(i % 8) + "\"}"});
+            } else {
+                thermal_monitoring::wire::SensorRecord record;
+                record.sensor_id = id;
+                record.location = "room_" + std::to_string(i % 8);
+                record.temperature = temperature;
+                record.humidity = 45.5f;
+                std::vector<uint8_t> packed;
+                thermal_monitoring::wire::encode_sensor_record(record, packed);
+                messages.push_back({"sensors/" + id + "/bin", std::string(packed.begin(), packed.end())});
+            }
+        }
+
+        for (const auto& message : messages) {
+            if (!thermal_monitoring::parse_sensor_message(message.topic, message.payload)) {
+                std::cerr << "❌ Benchmark input does not parse: " << message.topic << std::endl;
+                return;
+            }
+        }
+
+        results.push_back(measure("parse_sensor_message", params, 1, options.ops(500000),
+            [&](size_t, uint64_t i) {
+                const Message& message = messages[i & 255];
+                auto reading = thermal_monitoring::parse_sensor_message(message.topic, message.payload);
+                do_not_optimize(reading);
+            }));
+    }
+}
+
+//=============================================================================
+// ThermalIsolationTracker::process_sensor_data
+//=============================================================================
+
+void bench_tracker(const Options& options, std::vector<Result>& results) {
+    for (size_t sensors : {10, 1000}) {
+        for (size_t history : {100, 1000}) {
+            for (size_t threads : {1, 4}) {
+                Params params = {{"sensors", std::to_string(sensors)},
+                                 {"history", std::to_string(history)},
+                                 {"threads", std::to_string(threads)}};
+                if (!options.selected("tracker.process_sensor_data", params)) {
+                    continue;
+                }
+
+                ThermalConfig config;
+                config.history_size = history;
+                ThermalIsolationTracker tracker(config);  // Not started: no monitor thread
+                auto ids = make_sensor_ids(sensors);
+
+                std::mt19937 rng(options.seed);
+                std::vector<float> temperatures(4096);
+                for (auto& t : temperatures) {
+                    t = steady_temperature(rng);
+                }
+
+                results.push_back(measure("tracker.process_sensor_data", params, threads, options.ops(400000),
+                    [&](size_t t, uint64_t i) {
+                        size_t index = (t * 7919 + i) % sensors;
+                        tracker.process_sensor_data(ids[index], temperatures[i & 4095], 45.0f, "bench");
+                    }));
+            }
+        }
+    }
+}
+
+// One op is a whole batch; "hot" is the percentage of readings that trip
+// a threshold (throttled after the first alert, as in a steady fault)
+void bench_tracker_batch(const Options& options, std::vector<Result>& results) {
+    const size_t sensors = 1000;
+    for (size_t batch : {64, 1024}) {
+        for (size_t hot : {0, 5}) {
+            Params params = {{"sensors", std::to_string(sensors)},
+                             {"batch", std::to_string(batch)},
+                             {"hot", std::to_string(hot)}};
+            if (!options.selected("tracker.process_sensor_batch", params)) {
+                continue;
+            }
+
+            ThermalConfig config;
+            ThermalIsolationTracker tracker(config);
+            auto ids = make_sensor_ids(sensors);
+
+            std::mt19937 rng(options.seed);
+            std::vector<thermal_monitoring::SensorReading> readings(sensors * 4);
+            for (size_t i = 0; i < readings.size(); ++i) {
+                bool tripping = i % 100 < hot;
+                readings[i] = {ids[i % sensors], tripping ? 35.0f : steady_temperature(rng), 45.0f, "bench"};
+            }
+
+            results.push_back(measure("tracker.process_sensor_batch", params, 1,
+                                      std::max<uint64_t>(1, options.ops(400000) / batch),
+                [&](size_t, uint64_t i) {
+                    size_t offset = (i * batch) % (readings.size() - batch);
+                    tracker.process_sensor_batch(readings.data() + offset, batch);
+                }));
+        }
+    }
+}
+
+// One monitor pass over sensors that are all still reporting: the deadline
+// heaps are peeked per shard and no sensor is visited
+void bench_tracker_maintenance(const Options& options, std::vector<Result>& results) {
+    for (size_t sensors : {1000, 10000}) {
+        Params params = {{"sensors", std::to_string(sensors)}};
+        if (!options.selected("tracker.run_maintenance", params)) {
+            continue;
+        }
+
+        ThermalConfig config;
+        config.history_size = 16;
+        ThermalIsolationTracker tracker(config);
+        for (const auto& id : make_sensor_ids(sensors)) {
+            tracker.process_sensor_data(id, 22.0f, 45.0f, "bench");
+        }
+
+        results.push_back(measure("tracker.run_maintenance", params, 1, options.ops(20000),
+            [&](size_t, uint64_t) { tracker.run_maintenance(); }));
+    }
+}
+
+//=============================================================================
+// MessageBuffer (bridge)
+//=============================================================================
+
+void bench_message_buffer(const Options& options, std::vector<Result>& results) {
+#ifdef MICROBENCH_WITH_BRIDGE
+    for (size_t payload_bytes : {64, 1024}) {
+        Params params = {{"payload_bytes", std::to_string(payload_bytes)}};
+        const std::string topic = "sensors/sensor_1/data";
+        const std::vector<uint8_t> payload(payload_bytes, 'x');
+
+        if (options.selected("message_buffer.format", params)) {
+            mqtt_ws::MessageBuffer buffer;
+            results.push_back(measure("message_buffer.format", params, 1, options.ops(500000),
+                [&](size_t, uint64_t) { buffer.format_mqtt_message(topic, payload); }));
+        }
+
+        if (options.selected("message_buffer.parse", params)) {
+            mqtt_ws::MessageBuffer buffer;
+            buffer.format_mqtt_message(topic, payload);
+            std::string parsed_topic;
+            std::vector<uint8_t> parsed_payload;
+            results.push_back(measure("message_buffer.parse", params, 1, options.ops(500000),
+                [&](size_t, uint64_t) { buffer.parse_websocket_message(parsed_topic, parsed_payload); }));
+        }
+    }
+#else
+    (void)options;
+    (void)results;
+#endif
+}
+
+//=============================================================================
+// DataProcessor (ingest through workers to MQTT formatting)
+//=============================================================================
+
+rpi4_gateway::SensorDataPacket make_packet(const std::string& id, float temperature, uint32_t sequence) {
+    rpi4_gateway::SensorDataPacket packet{};
+    packet.sensor_id = id;
+    packet.location = "bench";
+    packet.temperature_celsius = temperature;
+    packet.humidity_percent = 45.0f;
+    packet.pressure_hpa = 1013.0f;
+    packet.supply_voltage = 3.3f;
+    packet.sensor_status = 0x00;
+    packet.timestamp = std::chrono::steady_clock::now();
+    packet.interface_used = rpi4_gateway::CommInterface::UART_INTERFACE;
+    packet.is_valid = true;
+    packet.signal_strength = -50.0f;
+    packet.packet_sequence = sequence;
+    packet.data_confidence = 1.0f;
+    return packet;
+}
+
+void bench_data_processor(const Options& options, std::vector<Result>& results) {
+    for (size_t sensors : {10, 100}) {
+        for (int workers : {1, 4}) {
+            for (const char* format : {"json", "binary"}) {
+                Params params = {{"sensors", std::to_string(sensors)},
+                                 {"workers", std::to_string(workers)},
+                                 {"format", format}};
+                if (!options.selected("data_processor.pipeline", params)) {
+                    continue;
+                }
+
+                const uint64_t ops = options.ops(100000);
+                rpi4_gateway::RPi4GatewayConfig config;
+                config.gateway_id = "bench_gateway";
+                config.processing_strategy = rpi4_gateway::ProcessingStrategy::RAW_FORWARD;
+                config.worker_thread_count = workers;
+                config.max_concurrent_sensors = static_cast<int>(sensors);
+                config.max_queue_size = static_cast<int>(ops + 4096);  // Measure work, not shedding
+                config.mqtt_binary_payloads = std::string(format) == "binary";
+
+                rpi4_gateway::DataProcessor processor(config);
+                std::atomic<uint64_t> published{0};
+                processor.set_mqtt_callback([&](const std::string&, const std::string&) {
+                    published.fetch_add(1, std::memory_order_relaxed);
+                });
+                if (!processor.initialize() || !processor.start()) {
+                    std::cerr << "❌ DataProcessor failed to start" << std::endl;
+                    continue;
+                }
+
+                std::mt19937 rng(options.seed);
+                auto ids = make_sensor_ids(sensors);
+                std::vector<rpi4_gateway::SensorDataPacket> packets;
+                for (size_t i = 0; i < 1024; ++i) {
+                    packets.push_back(make_packet(ids[i % sensors], steady_temperature(rng), static_cast<uint32_t>(i)));
+                }
+
+                // Throughput counts until the workers have drained every packet
+                auto drained = [&] {
+                    for (;;) {
+                        auto queue = processor.get_queue_stats();
+                        size_t processed = 0;
+                        for (const auto& stats : processor.get_all_statistics()) {
+                            processed += stats.total_packets;
+                        }
+                        if (processed >= queue.enqueued_packets) {
+                            return;
+                        }
+                        std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    }
+                };
+
+                Result result = measure("data_processor.pipeline", params, 1, ops,
+                    [&](size_t, uint64_t i) { processor.process_packet(packets[i & 1023]); }, drained);
+                auto queue = processor.get_queue_stats();
+                processor.stop();
+
+                result.counters.push_back({"dropped_packets", static_cast<double>(queue.dropped_packets)});
+                result.counters.push_back({"published", static_cast<double>(published.load())});
+                results.push_back(result);
+            }
+        }
+    }
+}
+
+//=============================================================================
+// StorageManager (segment append and indexed range query)
+//=============================================================================
+
+std::string bench_storage_directory() {
+    return (std::filesystem::temp_directory_path() /
+            ("microbench_storage_" + std::to_string(::getpid()))).string();
+}
+
+void bench_storage(const Options& options, std::vector<Result>& results) {
+    const std::string directory = bench_storage_directory();
+    rpi4_gateway::RPi4GatewayConfig config;
+    config.gateway_id = "bench_gateway";
+    config.data_directory = directory;
+    config.log_directory = directory + "/logs";
+    config.storage_sync_policy = rpi4_gateway::StorageSyncPolicy::NEVER;
+
+    std::mt19937 rng(options.seed);
+    const size_t sensors = 10;
+    auto ids = make_sensor_ids(sensors);
+    std::vector<rpi4_gateway::SensorDataPacket> packets;
+    for (size_t i = 0; i < 1024; ++i) {
+        packets.push_back(make_packet(ids[i % sensors], steady_temperature(rng), static_cast<uint32_t>(i)));
+    }
+
+    Params append_params = {{"sensors", std::to_string(sensors)}};
+    if (options.selected("storage.store_sensor_data", append_params)) {
+        std::filesystem::remove_all(directory);
+        rpi4_gateway::StorageManager storage(config);
+        if (storage.initialize()) {
+            Result result = measure("storage.store_sensor_data", append_params, 1, options.ops(200000),
+                [&](size_t, uint64_t i) { storage.store_sensor_data(packets[i & 1023]); },
+                [&] { storage.cleanup(); });
+            result.counters.push_back({"bytes_written", static_cast<double>(storage.get_segment_stats().bytes_written)});
+            results.push_back(result);
+        }
+    }
+
+    for (size_t history : {1000, 10000}) {
+        Params params = {{"history", std::to_string(history)}, {"sensors", std::to_string(sensors)}};
+        if (!options.selected("storage.retrieve_sensor_data", params)) {
+            continue;
+        }
+        std::filesystem::remove_all(directory);
+        rpi4_gateway::StorageManager storage(config);
+        if (!storage.initialize()) {
+            continue;
+        }
+        for (size_t i = 0; i < history * sensors; ++i) {
+            storage.store_sensor_data(packets[i & 1023]);
+        }
+        storage.cleanup();
+
+        auto now = std::chrono::system_clock::now();
+        size_t returned = 0;
+        Result result = measure("storage.retrieve_sensor_data", params, 1, options.ops(500),
+            [&](size_t, uint64_t i) {
+                returned = storage.retrieve_sensor_data(ids[i % sensors], now - std::chrono::hours(1),
+                                                        now + std::chrono::hours(1)).size();
+            });
+        result.counters.push_back({"readings_per_query", static_cast<double>(returned)});
+        results.push_back(result);
+    }
+    std::filesystem::remove_all(directory);
+}
+
+struct Suite {
+    const char* name;
+    std::function<void(const Options&, std::vector<Result>&)> run;
+};
+
+const std::vector<Suite>& suites() {
+    static const std::vector<Suite> all = {
+        {"parse_sensor_message", bench_parse},
+        {"tracker.process_sensor_data", bench_tracker},
+        {"tracker.process_sensor_batch", bench_tracker_batch},
+        {"tracker.run_maintenance", bench_tracker_maintenance},
+        {"message_buffer", bench_message_buffer},
+        {"data_processor.pipeline", bench_data_processor},
+        {"storage", bench_storage},
+    };
+    return all;
+}
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --filter TEXT   Run only benchmarks whose \"name param=value\" label contains TEXT\n"
+              << "  --quick         Scale every op count by 0.1\n"
+              << "  --scale X       Scale every op count by X\n"
+              << "  --seed N        Input seed (default: 42)\n"
+              << "  --output FILE   Write JSON results to FILE instead of stdout\n"
+              << "  --list          List benchmark suites\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::string output_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--quick") {
+            options.scale = 0.1;
+        } else if (arg == "--scale" && i + 1 < argc) {
+            options.scale = std::atof(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--output" && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (arg == "--list") {
+            for (const auto& suite : suites()) {
+                std::cout << suite.name << "\n";
+            }
+            return 0;
+        } else {
+            print_usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // Component logs would dominate what we are trying to measure
+    thermal_monitoring::Log::set_level(thermal_monitoring::LogLevel::WARN);
+
+    std::vector<Result> results;
+    for (const auto& suite : suites()) {
+        size_t first = results.size();
+        suite.run(options, results);
+        thermal_monitoring::Log::flush();
+        for (size_t i = first; i < results.size(); ++i) {
+            const Result& r = results[i];
+            std::cerr << "⏱️  " << std::left << std::setw(58) << r.label() << std::right << std::fixed
+                      << std::setprecision(0) << std::setw(10) << r.ops_per_second << " ops/s "
+                      << std::setprecision(1) << std::setw(9) << r.ns_per_op << " ns/op "
+                      << std::setprecision(2) << std::setw(7) << r.allocs_per_op << " allocs/op  p50/p99/p99.9 "
+                      << r.p50_ns << "/" << r.p99_ns << "/" << r.p999_ns << " ns" << std::endl;
+        }
+    }
+
+    std::string json = to_json(results);
+    if (output_path.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(output_path);
+        out << json;
+        std::cerr << "📄 Results written to " << output_path << std::endl;
+    }
+    return 0;
+}
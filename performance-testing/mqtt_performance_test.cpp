@@ -1,4 +1,6 @@
 #include "../thermal-monitoring/ThermalIsolationTracker.h"
+#include "../thermal-monitoring/SensorWireFormat.h"
+#include "LatencyHistogram.h"
 #include <mosquitto.h>
 #include <jsoncpp/json/json.h>
 #include <iostream>
@@ -12,12 +14,127 @@
 #include <mutex>
 #include <atomic>
 #include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <optional>
 #include <sys/resource.h>
 #include <sys/time.h>
 #include <unistd.h>
 
 using namespace thermal_monitoring;
 
+//===============================================================================
+// Open-loop load generation
+//===============================================================================
+
+/**
+ * Target publish rate over time for the open-loop load generator.
+ *
+ * CONSTANT holds target_rate for the whole test. LINEAR ramps from
+ * start_rate to target_rate over ramp_seconds and then holds. STEP climbs
+ * from start_rate to target_rate in 'steps' equal plateaus spread across
+ * ramp_seconds, which shows where the latency knee sits.
+ */
+struct RateProfile {
+    enum class Ramp { CONSTANT, LINEAR, STEP };
+
+    Ramp ramp = Ramp::CONSTANT;
+    double target_rate = 0.0;    // msg/s across all publishers; 0 keeps the closed-loop mode
+    double start_rate = 0.0;
+    double ramp_seconds = 0.0;
+    int steps = 4;
+
+    double rate_at(double elapsed_seconds) const {
+        if (ramp == Ramp::CONSTANT || ramp_seconds <= 0.0 || elapsed_seconds >= ramp_seconds) {
+            return target_rate;
+        }
+        double progress = elapsed_seconds / ramp_seconds;
+        if (ramp == Ramp::STEP) {
+            int plateaus = std::max(1, steps);
+            int step = std::min(plateaus - 1, static_cast<int>(progress * plateaus));
+            progress = plateaus == 1 ? 1.0 : static_cast<double>(step) / (plateaus - 1);
+        }
+        return start_rate + (target_rate - start_rate) * progress;
+    }
+
+    static const char* ramp_name(Ramp ramp) {
+        switch (ramp) {
+            case Ramp::LINEAR: return "linear";
+            case Ramp::STEP:   return "step";
+            default:           return "constant";
+        }
+    }
+
+    static bool parse_ramp(const std::string& name, Ramp& ramp) {
+        if (name == "constant") ramp = Ramp::CONSTANT;
+        else if (name == "linear") ramp = Ramp::LINEAR;
+        else if (name == "step") ramp = Ramp::STEP;
+        else return false;
+        return true;
+    }
+};
+
+struct LoadGenConfig {
+    RateProfile profile;
+    int publishers = 1;          // Publisher threads, each with its own connection
+    bool binary = false;         // Wire-format payloads on sensors/<id>/data/bin
+    int qos = 1;
+    double drain_seconds = 2.0;  // How long to wait for in-flight messages after the last send
+    std::string histogram_file;  // HdrHistogram percentile distribution output
+
+    bool enabled() const { return profile.target_rate > 0.0; }
+};
+
+/**
+ * Pulls the send timestamp (microseconds on the steady clock) out of a
+ * test payload without a full decode.
+ *
+ * JSON payloads are scanned for the "send_time" member. Binary payloads
+ * are the wire-format sensor reading with the timestamp appended as an
+ * 8-byte little-endian trailer; wire decoders ignore trailing bytes, so
+ * the bridge still accepts them as ordinary readings.
+ */
+static std::optional<int64_t> ExtractSendTime(const char* payload, size_t len, bool binary) {
+    if (binary) {
+        if (len < 2 + 8 || static_cast<uint8_t>(payload[0]) != wire::WIRE_VERSION ||
+            static_cast<uint8_t>(payload[1]) != static_cast<uint8_t>(wire::MessageType::SENSOR_READING)) {
+            return std::nullopt;
+        }
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i) {
+            value = (value << 8) | static_cast<uint8_t>(payload[len - 8 + i]);
+        }
+        return static_cast<int64_t>(value);
+    }
+
+    static constexpr char KEY[] = "\"send_time\":";
+    const char* end = payload + len;
+    const char* found = std::search(payload, end, KEY, KEY + sizeof(KEY) - 1);
+    if (found == end) {
+        return std::nullopt;
+    }
+    const char* digits = found + sizeof(KEY) - 1;
+    while (digits < end && *digits == ' ') {
+        ++digits;
+    }
+    int64_t value = 0;
+    bool any = false;
+    while (digits < end && *digits >= '0' && *digits <= '9') {
+        value = value * 10 + (*digits++ - '0');
+        any = true;
+    }
+    if (!any) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+static int64_t SteadyMicros(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
 class MQTTPerformanceTest {
 private:
     struct mosquitto* mosq_;
@@ -34,9 +151,37 @@ private:
     std::chrono::steady_clock::time_point start_time_;
     std::chrono::steady_clock::time_point test_start_time_;
     
-    // Latency tracking
-    std::mutex latency_mutex_;
-    std::vector<double> latencies_;
+    // Latency tracking (microseconds). Closed-loop receives all run on the
+    // mosquitto_loop thread, so one histogram has a single writer.
+    LatencyHistogram latency_histogram_;
+
+    /**
+     * One open-loop publisher with its paired subscriber connection.
+     *
+     * The publisher thread owns send_lag; the subscriber's network thread
+     * owns latency. Each connection subscribes only to the exact topics
+     * of the sensors it publishes, so every histogram has one writer and
+     * nothing is shared on the hot path.
+     */
+    struct LoadConnection {
+        MQTTPerformanceTest* test = nullptr;
+        size_t index = 0;
+        struct mosquitto* publisher = nullptr;
+        struct mosquitto* subscriber = nullptr;
+        std::vector<size_t> sensors;
+        std::vector<std::string> topics;
+        std::atomic<size_t> subscriptions_acked{0};
+        std::atomic<bool> publisher_connected{false};
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> publish_errors{0};
+        LatencyHistogram latency;    // Receive time minus intended send time
+        LatencyHistogram send_lag;   // Actual send time minus intended send time
+    };
+
+    std::vector<std::unique_ptr<LoadConnection>> load_connections_;
+    LatencyHistogram load_latency_;   // Merged at the end of an open-loop run
+    LatencyHistogram load_send_lag_;
     
     // System monitoring
     struct SystemStats {
@@ -61,11 +206,16 @@ private:
     std::vector<std::string> sensor_ids_;
     std::vector<std::string> locations_;
     std::mt19937 rng_;
+    
+    // Open-loop mode (enabled by a target rate)
+    LoadGenConfig load_;
+    double load_send_seconds_ = 0.0;
 
 public:
     MQTTPerformanceTest(int num_sensors = 10, 
                        int test_duration = 60,
                        int message_interval = 100,
+                       const LoadGenConfig& load = LoadGenConfig(),
                        const std::string& client_id = "mqtt_perf_test",
                        const std::string& broker_host = "localhost",
                        int broker_port = 1883)
@@ -73,11 +223,15 @@ public:
           broker_host_(broker_host), broker_port_(broker_port),
           num_sensors_(num_sensors), test_duration_seconds_(test_duration),
           message_interval_ms_(message_interval), enable_system_monitoring_(true),
-          rng_(std::chrono::steady_clock::now().time_since_epoch().count()) {
+          rng_(std::chrono::steady_clock::now().time_since_epoch().count()),
+          load_(load) {
         
         start_time_ = std::chrono::steady_clock::now();
         mosquitto_lib_init();
         
+        // Every publisher needs at least one sensor of its own
+        load_.publishers = std::max(1, std::min(load_.publishers, num_sensors_));
+        
         // Initialize sensor IDs and locations
         for (int i = 1; i <= num_sensors; ++i) {
             sensor_ids_.push_back("sensor_" + std::to_string(i));
@@ -101,7 +255,11 @@ public:
         std::cout << "🚀 Starting MQTT Performance Test" << std::endl;
         std::cout << "   Sensors: " << num_sensors_ << std::endl;
         std::cout << "   Duration: " << test_duration_seconds_ << " seconds" << std::endl;
-        std::cout << "   Message Interval: " << message_interval_ms_ << "ms" << std::endl;
+        if (load_.enabled()) {
+            PrintLoadConfig(std::cout);
+        } else {
+            std::cout << "   Message Interval: " << message_interval_ms_ << "ms" << std::endl;
+        }
         
         // Initialize thermal monitoring
         ThermalConfig thermal_config;
@@ -172,6 +330,11 @@ public:
     void RunTest() {
         if (!running_) return;
         
+        if (load_.enabled()) {
+            RunOpenLoopTest();
+            return;
+        }
+        
         std::cout << "🏃 Running performance test..." << std::endl;
         
         // Subscribe to sensor data
@@ -207,6 +370,336 @@ public:
     }
     
 private:
+    //===========================================================================
+    // Open-loop load generator
+    //===========================================================================
+
+    /**
+     * Publishes at the profile's target rate regardless of how fast the
+     * broker answers.
+     *
+     * Every message is stamped with its intended send time from a fixed
+     * schedule rather than the moment it actually left, so when the
+     * broker, the bridge or the generator itself stalls, the messages
+     * queued behind the stall carry the wait in their latency instead of
+     * silently being sent later (coordinated omission).
+     */
+    void RunOpenLoopTest() {
+        std::cout << "🏃 Running open-loop load test..." << std::endl;
+
+        if (!ConnectLoadClients()) {
+            DisconnectLoadClients();
+            return;
+        }
+
+        std::thread monitor_thread([this]() {
+            MonitorSystemResources();
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        auto end = start + std::chrono::seconds(test_duration_seconds_);
+        test_start_time_ = start;
+
+        std::vector<std::thread> publishers;
+        for (auto& connection : load_connections_) {
+            LoadConnection* conn = connection.get();
+            publishers.emplace_back([this, conn, start, end]() {
+                RunPublisher(*conn, start, end);
+            });
+        }
+        for (auto& publisher : publishers) {
+            publisher.join();
+        }
+        load_send_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Late arrivals belong in the tail, not in the loss count
+        auto drain_deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(load_.drain_seconds));
+        while (std::chrono::steady_clock::now() < drain_deadline &&
+               messages_received_.load() < messages_sent_.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        if (monitor_thread.joinable()) monitor_thread.join();
+        DisconnectLoadClients();
+
+        PrintFinalResults();
+        SaveResultsToFile();
+        SaveHistogramFile();
+    }
+
+    bool ConnectLoadClients() {
+        size_t count = static_cast<size_t>(std::max(1, std::min(load_.publishers, num_sensors_)));
+        for (size_t i = 0; i < count; ++i) {
+            auto conn = std::make_unique<LoadConnection>();
+            conn->test = this;
+            conn->index = i;
+            load_connections_.push_back(std::move(conn));
+        }
+        for (int sensor = 0; sensor < num_sensors_; ++sensor) {
+            LoadConnection& conn = *load_connections_[sensor % count];
+            conn.sensors.push_back(sensor);
+            conn.topics.push_back(SensorTopic(sensor));
+        }
+
+        for (auto& conn : load_connections_) {
+            std::string id = client_id_ + "_" + std::to_string(conn->index);
+            conn->subscriber = mosquitto_new((id + "_sub").c_str(), true, conn.get());
+            conn->publisher = mosquitto_new((id + "_pub").c_str(), true, conn.get());
+            if (!conn->subscriber || !conn->publisher) {
+                std::cerr << "❌ Failed to create mosquitto instance for load connection " << conn->index << std::endl;
+                return false;
+            }
+
+            mosquitto_connect_callback_set(conn->subscriber, OnLoadSubscriberConnect);
+            mosquitto_subscribe_callback_set(conn->subscriber, OnLoadSubscribe);
+            mosquitto_message_callback_set(conn->subscriber, OnLoadMessage);
+            mosquitto_connect_callback_set(conn->publisher, OnLoadPublisherConnect);
+
+            if (mosquitto_connect(conn->subscriber, broker_host_.c_str(), broker_port_, 60) != MOSQ_ERR_SUCCESS ||
+                mosquitto_connect(conn->publisher, broker_host_.c_str(), broker_port_, 60) != MOSQ_ERR_SUCCESS) {
+                std::cerr << "❌ Failed to connect load connection " << conn->index << " to MQTT broker" << std::endl;
+                return false;
+            }
+            // Each client gets its own network thread, so receive timestamps
+            // never wait behind another connection's socket
+            if (mosquitto_loop_start(conn->subscriber) != MOSQ_ERR_SUCCESS ||
+                mosquitto_loop_start(conn->publisher) != MOSQ_ERR_SUCCESS) {
+                std::cerr << "❌ Failed to start MQTT network thread for load connection " << conn->index << std::endl;
+                return false;
+            }
+        }
+
+        // Publishing before every SUBACK would count the first messages as lost
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline) {
+            bool ready = true;
+            for (const auto& conn : load_connections_) {
+                ready = ready && conn->publisher_connected.load() &&
+                        conn->subscriptions_acked.load() >= conn->topics.size();
+            }
+            if (ready) {
+                std::cout << "✅ " << load_connections_.size() << " load connection(s) ready" << std::endl;
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        std::cerr << "❌ Timed out waiting for load connections to subscribe" << std::endl;
+        return false;
+    }
+
+    void DisconnectLoadClients() {
+        for (auto& conn : load_connections_) {
+            for (struct mosquitto* client : {conn->publisher, conn->subscriber}) {
+                if (client) {
+                    mosquitto_disconnect(client);
+                    mosquitto_loop_stop(client, false);
+                }
+            }
+        }
+        // Writers have stopped, so the per-connection histograms are stable
+        for (auto& conn : load_connections_) {
+            load_latency_.merge(conn->latency);
+            load_send_lag_.merge(conn->send_lag);
+            for (struct mosquitto* client : {conn->publisher, conn->subscriber}) {
+                if (client) {
+                    mosquitto_destroy(client);
+                }
+            }
+            conn->publisher = nullptr;
+            conn->subscriber = nullptr;
+        }
+    }
+
+    void RunPublisher(LoadConnection& conn, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end) {
+        const double connections = static_cast<double>(load_connections_.size());
+        std::mt19937 rng(static_cast<uint32_t>(conn.index) * 7919u + 1);
+
+        // Per-sensor templates so the send loop only fills in numbers
+        std::vector<wire::SensorRecord> records(conn.sensors.size());
+        for (size_t k = 0; k < conn.sensors.size(); ++k) {
+            records[k].sensor_id = sensor_ids_[conn.sensors[k]];
+            records[k].location = locations_[conn.sensors[k] % locations_.size()];
+            records[k].gateway_id = client_id_;
+            records[k].pressure = 1013.25f;
+            records[k].data_confidence = 1.0f;
+        }
+        std::vector<uint8_t> binary_payload;
+        char json_payload[512];
+
+        // Offset each connection by its share of the interval so the
+        // aggregate stream is evenly spaced rather than bursting N at a time
+        double first_interval_ns = 1e9 * connections / std::max(load_.profile.rate_at(0.0), 1.0);
+        auto intended = start + std::chrono::nanoseconds(
+            static_cast<int64_t>(first_interval_ns * conn.index / connections));
+
+        size_t next = 0;
+        uint32_t sequence = 0;
+        while (running_ && intended < end) {
+            WaitUntil(intended);
+            auto actual = std::chrono::steady_clock::now();
+
+            size_t k = next++ % conn.sensors.size();
+            double temperature = 0.0;
+            double humidity = 0.0;
+            GenerateReading(conn.sensors[k], rng, temperature, humidity);
+            int64_t stamp = SteadyMicros(intended);
+
+            const void* payload = nullptr;
+            int payload_len = 0;
+            if (load_.binary) {
+                wire::SensorRecord& record = records[k];
+                record.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                record.temperature = static_cast<float>(temperature);
+                record.humidity = static_cast<float>(humidity);
+                record.sequence = sequence++;
+                binary_payload.clear();
+                wire::encode_sensor_record(record, binary_payload);
+                for (int i = 0; i < 8; ++i) {
+                    binary_payload.push_back(static_cast<uint8_t>(static_cast<uint64_t>(stamp) >> (8 * i)));
+                }
+                payload = binary_payload.data();
+                payload_len = static_cast<int>(binary_payload.size());
+            } else {
+                payload_len = std::snprintf(json_payload, sizeof(json_payload),
+                    "{\"sensor_id\":\"%s\",\"temperature\":%.2f,\"humidity\":%.2f,\"location\":\"%s\","
+                    "\"timestamp\":%lld,\"send_time\":%lld}",
+                    records[k].sensor_id.c_str(), temperature, humidity, records[k].location.c_str(),
+                    static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count()),
+                    static_cast<long long>(stamp));
+                payload = json_payload;
+                payload_len = std::min<int>(payload_len, sizeof(json_payload) - 1);
+            }
+
+            if (mosquitto_publish(conn.publisher, nullptr, conn.topics[k].c_str(), payload_len, payload,
+                                  load_.qos, false) == MOSQ_ERR_SUCCESS) {
+                conn.sent++;
+                messages_sent_++;
+            } else {
+                conn.publish_errors++;
+            }
+            conn.send_lag.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                actual - intended).count()));
+
+            double elapsed = std::chrono::duration<double>(intended - start).count();
+            double thread_rate = std::max(load_.profile.rate_at(elapsed), 1.0) / connections;
+            intended += std::chrono::nanoseconds(static_cast<int64_t>(1e9 / thread_rate));
+        }
+    }
+
+    // sleep_until overshoots by tens of microseconds, so only sleep while
+    // well ahead of schedule and spin the rest of the way. A publisher that
+    // is behind schedule does not wait at all.
+    static void WaitUntil(std::chrono::steady_clock::time_point deadline) {
+        constexpr auto SPIN_WINDOW = std::chrono::microseconds(200);
+        if (deadline - std::chrono::steady_clock::now() > SPIN_WINDOW) {
+            std::this_thread::sleep_until(deadline - SPIN_WINDOW);
+        }
+        while (std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::string SensorTopic(int sensor_index) const {
+        std::string topic = "sensors/" + sensor_ids_[sensor_index] + "/data";
+        if (load_.binary) {
+            topic += wire::BINARY_TOPIC_SUFFIX;
+        }
+        return topic;
+    }
+
+    // Realistic readings with some variation around a per-sensor baseline
+    void GenerateReading(int sensor_index, std::mt19937& rng, double& temperature, double& humidity) const {
+        double base_temp = 20.0 + (sensor_index % 3) * 2.0;
+        double base_humidity = 40.0 + (sensor_index % 4) * 5.0;
+        
+        std::uniform_real_distribution<> temp_dist(base_temp - 3.0, base_temp + 8.0);
+        std::uniform_real_distribution<> humidity_dist(base_humidity - 15.0, base_humidity + 20.0);
+        
+        temperature = temp_dist(rng);
+        humidity = humidity_dist(rng);
+    }
+
+    void PrintLoadConfig(std::ostream& out) const {
+        const RateProfile& profile = load_.profile;
+        out << "   Target Rate: " << std::fixed << std::setprecision(0) << profile.target_rate << " msg/s";
+        if (profile.ramp != RateProfile::Ramp::CONSTANT && profile.ramp_seconds > 0.0) {
+            out << " (" << RateProfile::ramp_name(profile.ramp) << " ramp from " << profile.start_rate
+                << " over " << std::setprecision(1) << profile.ramp_seconds << "s";
+            if (profile.ramp == RateProfile::Ramp::STEP) {
+                out << ", " << profile.steps << " steps";
+            }
+            out << ")";
+        }
+        out << std::endl;
+        out << "   Publishers: " << load_.publishers << std::endl;
+        out << "   Payload: " << (load_.binary ? "binary (sensors/<id>/data/bin)" : "json (sensors/<id>/data)")
+            << ", QoS " << load_.qos << std::endl;
+    }
+
+    static void PrintLatencyPercentiles(std::ostream& out, const std::string& title, const LatencyHistogram& histogram) {
+        out << "   " << title << " (" << histogram.count() << " samples):" << std::endl;
+        if (histogram.count() == 0) {
+            return;
+        }
+        out << std::fixed << std::setprecision(3)
+            << "      p50=" << histogram.value_at_percentile(50.0) / 1000.0 << "ms"
+            << "  p90=" << histogram.value_at_percentile(90.0) / 1000.0 << "ms"
+            << "  p99=" << histogram.value_at_percentile(99.0) / 1000.0 << "ms" << std::endl
+            << "      p99.9=" << histogram.value_at_percentile(99.9) / 1000.0 << "ms"
+            << "  p99.99=" << histogram.value_at_percentile(99.99) / 1000.0 << "ms"
+            << "  max=" << histogram.max() / 1000.0 << "ms"
+            << "  mean=" << histogram.mean() / 1000.0 << "ms" << std::endl;
+    }
+
+    void PrintLoadResults(std::ostream& out) const {
+        uint64_t sent = 0, received = 0, errors = 0;
+        for (const auto& conn : load_connections_) {
+            sent += conn->sent.load();
+            received += conn->received.load();
+            errors += conn->publish_errors.load();
+        }
+        uint64_t lost = sent > received ? sent - received : 0;
+
+        out << "\nOpen-Loop Load:" << std::endl;
+        out << "   Offered Load: " << std::fixed << std::setprecision(2)
+            << (load_send_seconds_ > 0.0 ? sent / load_send_seconds_ : 0.0) << " of "
+            << load_.profile.target_rate << " msg/sec target" << std::endl;
+        out << "   Lost Messages: " << lost << " (" << std::setprecision(3)
+            << (sent ? 100.0 * lost / sent : 0.0) << "%)" << std::endl;
+        out << "   Publish Errors: " << errors << std::endl;
+        PrintLatencyPercentiles(out, "Latency from intended send time", load_latency_);
+        PrintLatencyPercentiles(out, "Send lag behind schedule", load_send_lag_);
+
+        // A lagging generator means the offered load was lower than asked for
+        if (load_send_lag_.value_at_percentile(99.0) > 1000) {
+            out << "   ⚠️  Publishers fell behind schedule; the latency above includes that queueing."
+                << " Add --publishers to separate generator and broker limits." << std::endl;
+        }
+    }
+
+    void SaveHistogramFile() const {
+        if (load_.histogram_file.empty()) {
+            return;
+        }
+        std::ofstream file(load_.histogram_file);
+        if (!file.is_open()) {
+            std::cerr << "❌ Could not open histogram file " << load_.histogram_file << std::endl;
+            return;
+        }
+        // Milliseconds, matching the rest of the report
+        (load_.enabled() ? load_latency_ : latency_histogram_).write_percentile_distribution(file, 1000.0);
+        std::cout << "💾 Latency distribution saved to " << load_.histogram_file << std::endl;
+    }
+
+    //===========================================================================
+    // Closed-loop sensor simulation
+    //===========================================================================
+
     void SimulateSensors() {
         std::cout << "🔄 Simulating " << num_sensors_ << " sensors..." << std::endl;
         
@@ -226,15 +719,9 @@ private:
         std::string sensor_id = sensor_ids_[sensor_index];
         std::string location = locations_[sensor_index % locations_.size()];
         
-        // Generate realistic sensor data with some variation
-        double base_temp = 20.0 + (sensor_index % 3) * 2.0;
-        double base_humidity = 40.0 + (sensor_index % 4) * 5.0;
-        
-        std::uniform_real_distribution<> temp_dist(base_temp - 3.0, base_temp + 8.0);
-        std::uniform_real_distribution<> humidity_dist(base_humidity - 15.0, base_humidity + 20.0);
-        
-        double temperature = temp_dist(rng_);
-        double humidity = humidity_dist(rng_);
+        double temperature = 0.0;
+        double humidity = 0.0;
+        GenerateReading(sensor_index, rng_, temperature, humidity);
         
         // Process in thermal tracker
         thermal_tracker_->process_sensor_data(sensor_id, temperature, humidity, location);
@@ -308,18 +795,17 @@ private:
         stats.total_messages = messages_sent_.load();
         stats.total_alerts = alerts_generated_.load();
         
-        // Calculate average latency
-        {
-            std::lock_guard<std::mutex> lock(latency_mutex_);
-            if (!latencies_.empty()) {
-                double sum = 0.0;
-                for (double latency : latencies_) {
-                    sum += latency;
-                }
-                stats.avg_latency_ms = sum / latencies_.size();
-            } else {
-                stats.avg_latency_ms = 0.0;
+        // Calculate average latency (histograms can be read while they are written)
+        if (load_.enabled()) {
+            double total_us = 0.0;
+            uint64_t samples = 0;
+            for (const auto& conn : load_connections_) {
+                total_us += conn->latency.mean() * conn->latency.count();
+                samples += conn->latency.count();
             }
+            stats.avg_latency_ms = samples ? total_us / samples / 1000.0 : 0.0;
+        } else {
+            stats.avg_latency_ms = latency_histogram_.mean() / 1000.0;
         }
         
         // Simple CPU usage estimation (this is a simplified approach)
@@ -348,6 +834,8 @@ private:
         auto now = std::chrono::steady_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - test_start_time_);
         double duration_sec = duration.count() / 1000.0;
+        // Open-loop throughput covers the send window, not the drain afterwards
+        double rate_sec = load_.enabled() && load_send_seconds_ > 0.0 ? load_send_seconds_ : duration_sec;
         
         std::cout << "\n" << std::string(60, '=') << std::endl;
         std::cout << "📊 MQTT PERFORMANCE TEST RESULTS" << std::endl;
@@ -356,14 +844,18 @@ private:
         std::cout << "Test Configuration:" << std::endl;
         std::cout << "   Sensors: " << num_sensors_ << std::endl;
         std::cout << "   Duration: " << std::fixed << std::setprecision(2) << duration_sec << "s" << std::endl;
-        std::cout << "   Message Interval: " << message_interval_ms_ << "ms" << std::endl;
+        if (load_.enabled()) {
+            PrintLoadConfig(std::cout);
+        } else {
+            std::cout << "   Message Interval: " << message_interval_ms_ << "ms" << std::endl;
+        }
         
         std::cout << "\nPerformance Metrics:" << std::endl;
         std::cout << "   Messages Sent: " << messages_sent_.load() << std::endl;
         std::cout << "   Messages Received: " << messages_received_.load() << std::endl;
         std::cout << "   Alerts Generated: " << alerts_generated_.load() << std::endl;
         std::cout << "   Throughput: " << std::fixed << std::setprecision(2) 
-                  << (messages_sent_.load() / duration_sec) << " msg/sec" << std::endl;
+                  << (messages_sent_.load() / rate_sec) << " msg/sec" << std::endl;
         
         // Calculate average system stats
         {
@@ -385,12 +877,18 @@ private:
             }
         }
         
+        if (load_.enabled()) {
+            PrintLoadResults(std::cout);
+        } else {
+            PrintLatencyPercentiles(std::cout, "Latency", latency_histogram_);
+        }
+        
         // Get thermal monitoring stats
-        auto sensors = thermal_tracker_->get_all_sensors();
+        auto totals = thermal_tracker_->get_totals();
         auto alerts = thermal_tracker_->get_recent_alerts(10);
         
         std::cout << "\nThermal Monitoring:" << std::endl;
-        std::cout << "   Active Sensors: " << sensors.size() << std::endl;
+        std::cout << "   Active Sensors: " << totals.active_sensors << std::endl;
         std::cout << "   Recent Alerts: " << alerts.size() << std::endl;
         
         std::cout << std::string(60, '=') << std::endl;
@@ -406,18 +904,29 @@ private:
         auto now = std::chrono::steady_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - test_start_time_);
         double duration_sec = duration.count() / 1000.0;
+        double rate_sec = load_.enabled() && load_send_seconds_ > 0.0 ? load_send_seconds_ : duration_sec;
         
         file << "MQTT Performance Test Results" << std::endl;
         file << "=============================" << std::endl;
         file << "Timestamp: " << std::chrono::system_clock::now().time_since_epoch().count() << std::endl;
         file << "Sensors: " << num_sensors_ << std::endl;
         file << "Duration: " << std::fixed << std::setprecision(2) << duration_sec << "s" << std::endl;
-        file << "Message Interval: " << message_interval_ms_ << "ms" << std::endl;
+        if (load_.enabled()) {
+            PrintLoadConfig(file);
+        } else {
+            file << "Message Interval: " << message_interval_ms_ << "ms" << std::endl;
+        }
         file << "Messages Sent: " << messages_sent_.load() << std::endl;
         file << "Messages Received: " << messages_received_.load() << std::endl;
         file << "Alerts Generated: " << alerts_generated_.load() << std::endl;
         file << "Throughput: " << std::fixed << std::setprecision(2) 
-             << (messages_sent_.load() / duration_sec) << " msg/sec" << std::endl;
+             << (messages_sent_.load() / rate_sec) << " msg/sec" << std::endl;
+        
+        if (load_.enabled()) {
+            PrintLoadResults(file);
+        } else {
+            PrintLatencyPercentiles(file, "Latency", latency_histogram_);
+        }
         
         {
             std::lock_guard<std::mutex> lock(stats_mutex_);
@@ -436,28 +945,14 @@ private:
         std::cout << "💾 Results saved to mqtt_performance_results.txt" << std::endl;
     }
     
-    void ProcessIncomingSensorData(const std::string& topic, const std::string& payload) {
+    void ProcessIncomingSensorData(const char* topic, const char* payload, size_t len) {
+        int64_t receive_time = SteadyMicros(std::chrono::steady_clock::now());
         messages_received_++;
         
-        // Parse JSON to calculate latency
-        Json::Value data;
-        Json::Reader reader;
-        if (reader.parse(payload, data)) {
-            if (data.isMember("send_time")) {
-                auto send_time = std::chrono::microseconds(data["send_time"].asInt64());
-                auto receive_time = std::chrono::steady_clock::now().time_since_epoch();
-                auto latency = std::chrono::duration_cast<std::chrono::microseconds>(receive_time - send_time);
-                
-                {
-                    std::lock_guard<std::mutex> lock(latency_mutex_);
-                    latencies_.push_back(latency.count() / 1000.0); // Convert to ms
-                    
-                    // Keep only last 1000 measurements to avoid memory issues
-                    if (latencies_.size() > 1000) {
-                        latencies_.erase(latencies_.begin());
-                    }
-                }
-            }
+        // Only the timestamp is needed, so skip the full JSON parse
+        auto send_time = ExtractSendTime(payload, len, wire::is_binary_topic(topic));
+        if (send_time) {
+            latency_histogram_.record(static_cast<uint64_t>(std::max<int64_t>(0, receive_time - *send_time)));
         }
     }
     
@@ -477,26 +972,165 @@ private:
     
     static void OnMessage(struct mosquitto* mosq, void* userdata, const struct mosquitto_message* msg) {
         MQTTPerformanceTest* test = static_cast<MQTTPerformanceTest*>(userdata);
-        std::string topic = msg->topic;
-        std::string payload(static_cast<char*>(msg->payload), msg->payloadlen);
-        test->ProcessIncomingSensorData(topic, payload);
+        test->ProcessIncomingSensorData(msg->topic, static_cast<const char*>(msg->payload), msg->payloadlen);
+    }
+    
+    static void OnLoadSubscriberConnect(struct mosquitto* mosq, void* userdata, int result) {
+        LoadConnection* conn = static_cast<LoadConnection*>(userdata);
+        if (result != 0) {
+            std::cerr << "❌ Load subscriber " << conn->index << " failed to connect: "
+                      << mosquitto_connack_string(result) << std::endl;
+            return;
+        }
+        // Exact topics only, so this connection sees just its own publisher's messages
+        for (const auto& topic : conn->topics) {
+            mosquitto_subscribe(mosq, nullptr, topic.c_str(), conn->test->load_.qos);
+        }
+    }
+    
+    static void OnLoadSubscribe(struct mosquitto*, void* userdata, int, int, const int*) {
+        static_cast<LoadConnection*>(userdata)->subscriptions_acked++;
+    }
+    
+    static void OnLoadPublisherConnect(struct mosquitto*, void* userdata, int result) {
+        LoadConnection* conn = static_cast<LoadConnection*>(userdata);
+        if (result == 0) {
+            conn->publisher_connected = true;
+        } else {
+            std::cerr << "❌ Load publisher " << conn->index << " failed to connect: "
+                      << mosquitto_connack_string(result) << std::endl;
+        }
+    }
+    
+    static void OnLoadMessage(struct mosquitto*, void* userdata, const struct mosquitto_message* msg) {
+        // Timestamp first so nothing below counts toward latency
+        int64_t receive_time = SteadyMicros(std::chrono::steady_clock::now());
+        LoadConnection* conn = static_cast<LoadConnection*>(userdata);
+        conn->received++;
+        conn->test->messages_received_++;
+        
+        auto send_time = ExtractSendTime(static_cast<const char*>(msg->payload), msg->payloadlen,
+                                         conn->test->load_.binary);
+        if (send_time) {
+            conn->latency.record(static_cast<uint64_t>(std::max<int64_t>(0, receive_time - *send_time)));
+        }
     }
 };
 
+static void PrintUsage(const char* program) {
+    std::cout << "Usage: " << program << " [sensors] [duration_s] [interval_ms] [options]\n"
+              << "\n"
+              << "Without --rate the test runs closed-loop: one thread publishes each sensor\n"
+              << "in turn every interval_ms. With --rate it runs open-loop at a fixed target\n"
+              << "rate and measures latency from each message's intended send time.\n"
+              << "\n"
+              << "Open-loop options:\n"
+              << "  --rate MSG_PER_S      Target publish rate across all publishers\n"
+              << "  --publishers N        Publisher threads/connections (default 1)\n"
+              << "  --ramp PROFILE        constant | linear | step (default constant)\n"
+              << "  --start-rate MSG_PER_S  Rate at the start of a ramp (default 0)\n"
+              << "  --ramp-seconds S      Ramp length (default: the whole test)\n"
+              << "  --steps N             Plateaus for the step profile (default 4)\n"
+              << "  --format json|binary  Payload encoding (default json)\n"
+              << "  --qos 0|1|2           Publish/subscribe QoS (default 1)\n"
+              << "  --drain-seconds S     Wait for in-flight messages after sending (default 2)\n"
+              << "\n"
+              << "Common options:\n"
+              << "  --host HOST           MQTT broker host (default localhost)\n"
+              << "  --port PORT           MQTT broker port (default 1883)\n"
+              << "  --histogram FILE      Write the latency percentile distribution (HdrHistogram format)\n"
+              << "  --help                Show this message\n"
+              << "\n"
+              << "Example: " << program << " 100 60 100 --rate 50000 --publishers 4 --format binary\n";
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "🚀 MQTT Performance Test with 10 Sensors" << std::endl;
     std::cout << "========================================" << std::endl;
     
-    // Parse command line arguments
+    // Parse command line arguments: positional sensors/duration/interval, then options
     int num_sensors = 10;
     int test_duration = 60;
     int message_interval = 100;
+    LoadGenConfig load;
+    std::string broker_host = "localhost";
+    int broker_port = 1883;
+    bool ramp_seconds_set = false;
     
-    if (argc > 1) num_sensors = std::stoi(argv[1]);
-    if (argc > 2) test_duration = std::stoi(argv[2]);
-    if (argc > 3) message_interval = std::stoi(argv[3]);
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "❌ Missing value for " << arg << std::endl;
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage(argv[0]);
+            return 0;
+        } else if (arg == "--rate") {
+            load.profile.target_rate = std::stod(value());
+        } else if (arg == "--publishers") {
+            load.publishers = std::stoi(value());
+        } else if (arg == "--ramp") {
+            std::string name = value();
+            if (!RateProfile::parse_ramp(name, load.profile.ramp)) {
+                std::cerr << "❌ Unknown ramp profile: " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--start-rate") {
+            load.profile.start_rate = std::stod(value());
+        } else if (arg == "--ramp-seconds") {
+            load.profile.ramp_seconds = std::stod(value());
+            ramp_seconds_set = true;
+        } else if (arg == "--steps") {
+            load.profile.steps = std::stoi(value());
+        } else if (arg == "--format") {
+            std::string format = value();
+            if (format != "json" && format != "binary") {
+                std::cerr << "❌ Unknown payload format: " << format << std::endl;
+                return 1;
+            }
+            load.binary = format == "binary";
+        } else if (arg == "--qos") {
+            load.qos = std::stoi(value());
+        } else if (arg == "--drain-seconds") {
+            load.drain_seconds = std::stod(value());
+        } else if (arg == "--host") {
+            broker_host = value();
+        } else if (arg == "--port") {
+            broker_port = std::stoi(value());
+        } else if (arg == "--histogram") {
+            load.histogram_file = value();
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "❌ Unknown option: " << arg << std::endl;
+            PrintUsage(argv[0]);
+            return 1;
+        } else if (positional == 0) {
+            num_sensors = std::stoi(arg);
+            positional++;
+        } else if (positional == 1) {
+            test_duration = std::stoi(arg);
+            positional++;
+        } else if (positional == 2) {
+            message_interval = std::stoi(arg);
+            positional++;
+        }
+    }
+    
+    if (load.profile.ramp != RateProfile::Ramp::CONSTANT && !ramp_seconds_set) {
+        load.profile.ramp_seconds = test_duration;
+    }
+    if (load.qos < 0 || load.qos > 2) {
+        std::cerr << "❌ QoS must be 0, 1 or 2" << std::endl;
+        return 1;
+    }
     
-    MQTTPerformanceTest test(num_sensors, test_duration, message_interval);
+    MQTTPerformanceTest test(num_sensors, test_duration, message_interval, load,
+                             "mqtt_perf_test", broker_host, broker_port);
     
     if (!test.Start()) {
         std::cerr << "❌ Failed to start performance test" << std::endl;
@@ -507,4 +1141,4 @@ int main(int argc, char* argv[]) {
     
     std::cout << "✅ Performance test completed!" << std::endl;
     return 0;
-} 
\ No newline at end of file
+}
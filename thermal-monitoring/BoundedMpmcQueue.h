@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+namespace thermal_monitoring {
+
+/**
+ * Bounded lock-free multi-producer/multi-consumer queue
+ *
+ * Array of cells, each tagged with a sequence number that tells producers
+ * and consumers whether the cell is free for the current lap (Vyukov's
+ * bounded MPMC design). Enqueue and dequeue each claim a position with a
+ * single CAS and never block; a full queue rejects the push, so the
+ * capacity bound holds without a lock.
+ *
+ * Items are swapped in and out rather than copied: a pushed value comes
+ * back holding what the cell held last lap, and a popped slot leaves its
+ * old contents in the cell. Callers that keep reusing the same objects
+ * therefore recycle the strings inside T through the queue, and after
+ * warm-up a push/pop pair allocates nothing. T must be default-constructible
+ * and swappable.
+ *
+ * Usage:
+ *   BoundedMpmcQueue<Packet> queue(10000);
+ *   if (!queue.try_push(std::move(packet))) { shed(); }   // packet is now a spare
+ *   std::vector<Packet> batch(32);                         // Reused every wakeup
+ *   size_t n = queue.try_pop_batch(batch.data(), batch.size());
+ */
+template <typename T>
+class BoundedMpmcQueue {
+public:
+    explicit BoundedMpmcQueue(size_t capacity)
+        : capacity_(capacity > 0 ? capacity : 1), cells_(new Cell[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpmcQueue(const BoundedMpmcQueue&) = delete;
+    BoundedMpmcQueue& operator=(const BoundedMpmcQueue&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    // Approximate under concurrency; exact when producers and consumers are idle
+    size_t size() const {
+        size_t tail = dequeue_pos_.load(std::memory_order_acquire);
+        size_t head = enqueue_pos_.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    bool try_push(T&& value) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos % capacity_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    using std::swap;
+                    swap(cell.value, value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Full: the cell still holds last lap's item
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& out) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos % capacity_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    using std::swap;
+                    swap(out, cell.value);
+                    cell.sequence.store(pos + capacity_, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Swap up to max_items into out[0..n); returns n
+    size_t try_pop_batch(T* out, size_t max_items) {
+        size_t taken = 0;
+        while (taken < max_items && try_pop(out[taken])) {
+            taken++;
+        }
+        return taken;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Producers and consumers each get their own cache line
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+} // namespace thermal_monitoring
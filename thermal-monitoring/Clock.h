@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace thermal_monitoring {
+
+/**
+ * Injectable time source for the simulators, gateway and tracker
+ *
+ * Components read time and sleep through a shared Clock instead of calling
+ * std::chrono::steady_clock directly, so the same code runs against real
+ * time or against a VirtualClock that a replay driver advances as fast as
+ * the CPU allows. Time points stay steady_clock::time_point, which keeps
+ * every existing timestamp field unchanged.
+ *
+ * Usage:
+ *   auto clock = std::make_shared<VirtualClock>();
+ *   ThermalIsolationTracker tracker(config, clock);
+ *   clock->advance(std::chrono::minutes(11));
+ *   tracker.run_maintenance();                  // Offline timeouts fire now
+ */
+class Clock {
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+    using duration = std::chrono::steady_clock::duration;
+
+    virtual ~Clock() = default;
+
+    virtual time_point now() const = 0;
+
+    // Returns once 'duration' of this clock's time has passed, or early
+    // after wake_sleepers() (used by stop() paths)
+    virtual void sleep_for(duration period) = 0;
+    virtual void wake_sleepers() {}
+
+    // Process-wide real clock, the default for every component
+    static std::shared_ptr<Clock> steady();
+};
+
+/**
+ * Real time: steady_clock and std::this_thread sleeps
+ */
+class SteadyClock : public Clock {
+public:
+    time_point now() const override { return std::chrono::steady_clock::now(); }
+    void sleep_for(duration period) override { std::this_thread::sleep_for(period); }
+};
+
+inline std::shared_ptr<Clock> Clock::steady() {
+    static const std::shared_ptr<Clock> instance = std::make_shared<SteadyClock>();
+    return instance;
+}
+
+/**
+ * Manually driven time for deterministic replay
+ *
+ * now() only moves when a driver calls advance()/advance_to(); time never
+ * goes backwards. Threads sleeping on the clock wake once virtual time
+ * reaches their deadline. A single-threaded driver that advances time and
+ * calls into components directly gets bit-for-bit reproducible runs.
+ */
+class VirtualClock : public Clock {
+public:
+    // A non-zero start keeps "never updated" (default) time points distinct
+    explicit VirtualClock(time_point start = time_point(std::chrono::hours(24)))
+        : now_ns_(start.time_since_epoch().count()) {}
+
+    time_point now() const override {
+        return time_point(duration(now_ns_.load(std::memory_order_acquire)));
+    }
+
+    void advance(duration period) { advance_to(now() + period); }
+
+    void advance_to(time_point target) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto target_ns = target.time_since_epoch().count();
+            if (target_ns <= now_ns_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            now_ns_.store(target_ns, std::memory_order_release);
+        }
+        cv_.notify_all();
+    }
+
+    void sleep_for(duration period) override {
+        auto deadline = (now() + period).time_since_epoch().count();
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t generation = wake_generation_;
+        cv_.wait(lock, [&] {
+            return now_ns_.load(std::memory_order_relaxed) >= deadline || wake_generation_ != generation;
+        });
+    }
+
+    void wake_sleepers() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_generation_++;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::atomic<duration::rep> now_ns_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    uint64_t wake_generation_ = 0;
+};
+
+} // namespace thermal_monitoring
@@ -0,0 +1,417 @@
+#include "Log.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace thermal_monitoring {
+
+std::atomic<int> Log::level_{static_cast<int>(LogLevel::INFO)};
+
+namespace {
+
+constexpr uint32_t PADDING_MARKER = 0xFFFFFFFFu;
+constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(10);
+
+struct RecordHeader {
+    uint32_t length;
+    uint32_t level;  // PADDING_MARKER: skip to the start of the ring
+};
+
+size_t record_footprint(size_t len) {
+    return sizeof(RecordHeader) + ((len + 7) & ~size_t(7));
+}
+
+/**
+ * Single-producer/single-consumer byte ring owned by one logging thread
+ *
+ * head/tail are free-running byte counters; records are 8-byte aligned so
+ * a header never straddles the end. A record that does not fit before the
+ * end is preceded by a padding header and written at offset 0.
+ */
+struct ThreadBuffer {
+    static constexpr size_t CAPACITY = Log::THREAD_BUFFER_BYTES;
+    static constexpr size_t MASK = CAPACITY - 1;
+    static_assert((CAPACITY & MASK) == 0, "Thread buffer size must be a power of two");
+
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    std::atomic<bool> retired{false};
+    std::unique_ptr<char[]> data{new char[CAPACITY]};
+
+    bool push(LogLevel level, const char* text, size_t len) {
+        size_t need = record_footprint(len);
+        uint64_t write = head.load(std::memory_order_relaxed);
+        uint64_t read = tail.load(std::memory_order_acquire);
+        size_t offset = write & MASK;
+        size_t contiguous = CAPACITY - offset;
+        size_t padding = need > contiguous ? contiguous : 0;
+
+        if ((write - read) + padding + need > CAPACITY) {
+            return false;
+        }
+        if (padding > 0) {
+            RecordHeader pad{0, PADDING_MARKER};
+            std::memcpy(data.get() + offset, &pad, sizeof(pad));
+            write += padding;
+            offset = 0;
+        }
+
+        RecordHeader header{static_cast<uint32_t>(len), static_cast<uint32_t>(level)};
+        std::memcpy(data.get() + offset, &header, sizeof(header));
+        std::memcpy(data.get() + offset + sizeof(header), text, len);
+        head.store(write + need, std::memory_order_release);
+        return true;
+    }
+
+    size_t used() const {
+        return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed);
+    }
+
+    // Consumer side; appends each record plus '\n' to the stream for its level
+    size_t drain(std::string& out, std::string& err) {
+        uint64_t read = tail.load(std::memory_order_relaxed);
+        uint64_t write = head.load(std::memory_order_acquire);
+        size_t records = 0;
+
+        while (read < write) {
+            size_t offset = read & MASK;
+            RecordHeader header;
+            std::memcpy(&header, data.get() + offset, sizeof(header));
+            if (header.level == PADDING_MARKER) {
+                read += CAPACITY - offset;
+                continue;
+            }
+            std::string& target = header.level >= static_cast<uint32_t>(LogLevel::ERROR) ? err : out;
+            target.append(data.get() + offset + sizeof(header), header.length);
+            target.push_back('\n');
+            read += record_footprint(header.length);
+            records++;
+        }
+        tail.store(read, std::memory_order_release);
+        return records;
+    }
+};
+
+/**
+ * Background writer: owns the registry of thread buffers and drains them
+ * every DRAIN_INTERVAL, or sooner when a producer passes half capacity.
+ * Leaked on purpose so threads that log during static destruction still
+ * find it; the atexit hook stops the thread and drains what is left.
+ */
+class LogWriter {
+public:
+    static LogWriter& instance() {
+        static LogWriter* writer = new LogWriter();
+        return *writer;
+    }
+
+    std::shared_ptr<ThreadBuffer> register_buffer() {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            buffers_.push_back(buffer);
+        }
+        std::call_once(started_, [this] {
+            thread_ = std::thread(&LogWriter::writer_loop, this);
+            std::atexit([] { LogWriter::instance().shutdown(); });
+        });
+        return buffer;
+    }
+
+    void submit(ThreadBuffer& buffer, LogLevel level, const char* text, size_t len) {
+        if (stopped_.load(std::memory_order_acquire)) {
+            // Past shutdown nothing drains the rings; write through instead
+            write_direct(level, text, len);
+            return;
+        }
+        if (!buffer.push(level, text, len)) {
+            if (level >= LogLevel::WARN) {
+                // Warnings and errors are never dropped; pay for the console instead
+                write_direct(level, text, len);
+            } else {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+        if (buffer.used() > ThreadBuffer::CAPACITY / 2) {
+            wake();
+        }
+    }
+
+    void drain_all() {
+        std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+
+        std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            snapshot = buffers_;
+        }
+
+        size_t records = 0;
+        for (const auto& buffer : snapshot) {
+            // Read 'retired' first: once set, the owner has pushed its last record
+            bool retired = buffer->retired.load(std::memory_order_acquire);
+            records += buffer->drain(out_, err_);
+            if (retired) {
+                std::lock_guard<std::mutex> lock(registry_mutex_);
+                buffers_.erase(std::remove(buffers_.begin(), buffers_.end(), buffer), buffers_.end());
+            }
+        }
+
+        uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reported_drops_) {
+            err_ += "⚠️ [Log] " + std::to_string(dropped - reported_drops_) +
+                    " records dropped (thread buffer full)\n";
+            reported_drops_ = dropped;
+        }
+
+        if (!out_.empty()) {
+            std::fwrite(out_.data(), 1, out_.size(), stdout);
+            std::fflush(stdout);
+        }
+        if (!err_.empty()) {
+            std::fwrite(err_.data(), 1, err_.size(), stderr);
+        }
+
+        written_.fetch_add(records, std::memory_order_relaxed);
+        bytes_.fetch_add(out_.size() + err_.size(), std::memory_order_relaxed);
+        passes_.fetch_add(1, std::memory_order_relaxed);
+        out_.clear();
+        err_.clear();
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            running_ = false;
+        }
+        wake_cv_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        drain_all();
+        stopped_.store(true, std::memory_order_release);
+    }
+
+    LogStats get_stats() {
+        LogStats stats;
+        stats.records_written = written_.load(std::memory_order_relaxed);
+        stats.records_dropped = dropped_.load(std::memory_order_relaxed);
+        stats.bytes_written = bytes_.load(std::memory_order_relaxed);
+        stats.drain_passes = passes_.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        stats.thread_buffers = buffers_.size();
+        return stats;
+    }
+
+private:
+    LogWriter() = default;
+
+    void wake() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            wake_requested_ = true;
+        }
+        wake_cv_.notify_one();
+    }
+
+    void writer_loop() {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (running_) {
+            lock.unlock();
+            drain_all();
+            lock.lock();
+            wake_cv_.wait_for(lock, DRAIN_INTERVAL, [this] { return wake_requested_ || !running_; });
+            wake_requested_ = false;
+        }
+    }
+
+    static void write_direct(LogLevel level, const char* text, size_t len) {
+        FILE* target = level >= LogLevel::ERROR ? stderr : stdout;
+        std::fwrite(text, 1, len, target);
+        std::fputc('\n', target);
+    }
+
+    std::mutex registry_mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+    std::mutex drain_mutex_;
+    std::string out_;
+    std::string err_;
+    uint64_t reported_drops_ = 0;
+
+    std::once_flag started_;
+    std::thread thread_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool running_ = true;
+    bool wake_requested_ = false;
+    std::atomic<bool> stopped_{false};
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> passes_{0};
+};
+
+// Registers lazily on a thread's first record; marks the ring retired at
+// thread exit so the writer drops it after the final drain
+struct ThreadBufferHandle {
+    std::shared_ptr<ThreadBuffer> buffer;
+
+    ThreadBuffer& get() {
+        if (!buffer) {
+            buffer = LogWriter::instance().register_buffer();
+        }
+        return *buffer;
+    }
+
+    ~ThreadBufferHandle() {
+        if (buffer) {
+            buffer->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadBufferHandle thread_buffer;
+
+bool apply_environment_level() {
+    const char* name = std::getenv("THERMAL_LOG_LEVEL");
+    LogLevel level;
+    if (name && Log::parse_level(name, level)) {
+        Log::set_level(level);
+    }
+    return true;
+}
+
+[[maybe_unused]] const bool environment_level_applied = apply_environment_level();
+
+} // namespace
+
+//=============================================================================
+// Log
+//=============================================================================
+
+void Log::set_level(LogLevel level) {
+    level_.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Log::get_level() {
+    return static_cast<LogLevel>(level_.load(std::memory_order_relaxed));
+}
+
+namespace {
+
+const std::pair<const char*, LogLevel> LEVEL_NAMES[] = {
+    {"trace", LogLevel::TRACE}, {"debug", LogLevel::DEBUG}, {"info", LogLevel::INFO},
+    {"warn", LogLevel::WARN},   {"error", LogLevel::ERROR}, {"off", LogLevel::OFF}
+};
+
+} // namespace
+
+bool Log::parse_level(const std::string& name, LogLevel& level) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    for (const auto& entry : LEVEL_NAMES) {
+        if (lower == entry.first) {
+            level = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Log::level_name(LogLevel level) {
+    for (const auto& entry : LEVEL_NAMES) {
+        if (entry.second == level) {
+            return entry.first;
+        }
+    }
+    return "unknown";
+}
+
+void Log::write(LogLevel level, const char* data, size_t len) {
+    LogWriter::instance().submit(thread_buffer.get(), level, data, std::min(len, MAX_RECORD_BYTES));
+}
+
+void Log::flush() {
+    LogWriter::instance().drain_all();
+}
+
+LogStats Log::get_stats() {
+    return LogWriter::instance().get_stats();
+}
+
+//=============================================================================
+// LogRecord
+//=============================================================================
+
+/**
+ * Reusable line buffer: the streambuf appends straight into a string
+ * whose capacity survives between records, so formatting a line does not
+ * allocate once the thread has warmed up
+ */
+struct LogRecord::LineStream : std::streambuf {
+    std::string text;
+    std::ostream stream{this};
+    bool busy = false;
+
+    void reset() {
+        text.clear();
+        stream.clear();
+        stream.flags(std::ios_base::dec | std::ios_base::skipws);
+        stream.precision(6);
+        stream.width(0);
+        stream.fill(' ');
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            text.push_back(traits_type::to_char_type(ch));
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+        text.append(data, static_cast<size_t>(count));
+        return count;
+    }
+};
+
+namespace {
+
+thread_local LogRecord::LineStream thread_line;
+
+} // namespace
+
+LogRecord::LogRecord(LogLevel level) : level_(level), line_(&thread_line) {
+    if (line_->busy) {
+        // An argument's operator<< is itself logging; give it its own line
+        nested_.reset(new LineStream());
+        line_ = nested_.get();
+    }
+    line_->busy = true;
+    line_->reset();
+}
+
+LogRecord::~LogRecord() {
+    Log::write(level_, line_->text.data(), line_->text.size());
+    line_->busy = false;
+}
+
+std::ostream& LogRecord::stream() {
+    return line_->stream;
+}
+
+} // namespace thermal_monitoring
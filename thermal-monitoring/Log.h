@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace thermal_monitoring {
+
+/**
+ * Asynchronous, level-gated logging shared by the bridge, tracker, gateway
+ * and simulators
+ *
+ * Hot paths log through the THERMAL_LOG_* macros instead of std::cout:
+ *
+ *   THERMAL_LOG_DEBUG << "📨 [UART] Received packet from " << packet.sensor_id;
+ *
+ * - A disabled level costs one relaxed atomic load and a branch; the
+ *   stream expression after the macro is never evaluated, so arguments
+ *   are not formatted. Levels below THERMAL_LOG_COMPILED_LEVEL are
+ *   removed at compile time (-DTHERMAL_LOG_COMPILED_LEVEL=2 keeps INFO+).
+ * - An enabled record is formatted into a thread-local stream and copied
+ *   into that thread's lock-free SPSC byte ring. A background writer
+ *   drains every ring and writes whole lines to stdout (ERROR to stderr)
+ *   in one call per drain, so producers never touch the console lock.
+ * - A full ring drops TRACE/DEBUG/INFO records and counts them instead of
+ *   blocking (the writer reports drops on its next pass); WARN and ERROR
+ *   records fall back to a direct console write.
+ *
+ * The runtime level defaults to INFO and can be set with set_level() or
+ * the THERMAL_LOG_LEVEL environment variable (trace/debug/info/warn/error/off).
+ * Records from one thread stay in order; records from different threads
+ * are interleaved per drain pass. flush() blocks until everything logged
+ * so far is written and also runs at process exit.
+ */
+
+enum class LogLevel : int {
+    TRACE = 0,
+    DEBUG = 1,
+    INFO = 2,
+    WARN = 3,
+    ERROR = 4,
+    OFF = 5
+};
+
+#ifndef THERMAL_LOG_COMPILED_LEVEL
+#define THERMAL_LOG_COMPILED_LEVEL 0
+#endif
+
+struct LogStats {
+    uint64_t records_written = 0;
+    uint64_t records_dropped = 0;
+    uint64_t bytes_written = 0;
+    uint64_t drain_passes = 0;
+    size_t thread_buffers = 0;
+};
+
+class Log {
+public:
+    static constexpr size_t THREAD_BUFFER_BYTES = 64 * 1024;
+    static constexpr size_t MAX_RECORD_BYTES = 4096;
+
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) >= THERMAL_LOG_COMPILED_LEVEL &&
+               static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    static void set_level(LogLevel level);
+    static LogLevel get_level();
+    static bool parse_level(const std::string& name, LogLevel& level);
+    static const char* level_name(LogLevel level);
+
+    // Queues one formatted line (without trailing newline) for the writer
+    static void write(LogLevel level, const char* data, size_t len);
+
+    // Blocks until every record queued before the call has been written
+    static void flush();
+
+    static LogStats get_stats();
+
+private:
+    static std::atomic<int> level_;
+};
+
+/**
+ * One log line: collects the streamed arguments and queues them on
+ * destruction. Only constructed by the THERMAL_LOG_* macros, after the
+ * level check has passed.
+ */
+class LogRecord {
+public:
+    struct LineStream;
+
+    explicit LogRecord(LogLevel level);
+    ~LogRecord();
+
+    LogRecord(const LogRecord&) = delete;
+    LogRecord& operator=(const LogRecord&) = delete;
+
+    std::ostream& stream();
+
+private:
+    LogLevel level_;
+    std::unique_ptr<LineStream> nested_;  // Only when a record is built inside another
+    LineStream* line_;
+};
+
+} // namespace thermal_monitoring
+
+// The if/else form keeps the macro safe inside unbraced if statements and
+// skips evaluating the streamed arguments when the level is disabled
+#define THERMAL_LOG(level) \
+    if (!::thermal_monitoring::Log::enabled(level)) {} \
+    else ::thermal_monitoring::LogRecord(level).stream()
+
+#define THERMAL_LOG_TRACE THERMAL_LOG(::thermal_monitoring::LogLevel::TRACE)
+#define THERMAL_LOG_DEBUG THERMAL_LOG(::thermal_monitoring::LogLevel::DEBUG)
+#define THERMAL_LOG_INFO  THERMAL_LOG(::thermal_monitoring::LogLevel::INFO)
+#define THERMAL_LOG_WARN  THERMAL_LOG(::thermal_monitoring::LogLevel::WARN)
+#define THERMAL_LOG_ERROR THERMAL_LOG(::thermal_monitoring::LogLevel::ERROR)
@@ -0,0 +1,384 @@
+#include "Metrics.h"
+#include "Log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace thermal_monitoring {
+namespace metrics {
+
+namespace {
+
+void atomic_add(std::atomic<double>& target, double amount) {
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + amount, std::memory_order_relaxed)) {
+    }
+}
+
+std::string format_value(double value) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    char buffer[32];
+    // Integral values (counters, byte counts) print without an exponent
+    if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f", value);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    }
+    return buffer;
+}
+
+std::string escape_help(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out;
+}
+
+const char* type_name(MetricType type) {
+    switch (type) {
+        case MetricType::COUNTER:   return "counter";
+        case MetricType::GAUGE:     return "gauge";
+        case MetricType::HISTOGRAM: return "histogram";
+    }
+    return "untyped";
+}
+
+// name{labels} value, with extra appended inside the braces (histogram "le")
+void write_sample(std::ostringstream& out, const std::string& name, const std::string& labels,
+                  const std::string& extra, double value) {
+    out << name;
+    std::string all = join_labels({labels, extra});
+    if (!all.empty()) {
+        out << '{' << all << '}';
+    }
+    out << ' ' << format_value(value) << '\n';
+}
+
+double process_cpu_seconds() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+double process_resident_bytes() {
+    // statm: size resident shared ... in pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0.0;
+    }
+    return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE));
+}
+
+} // namespace
+
+//=============================================================================
+// Counter / Gauge / Histogram
+//=============================================================================
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& stripe : stripes_) {
+        total += stripe.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Gauge::add(double amount) {
+    atomic_add(value_, amount);
+}
+
+Histogram::Histogram(std::vector<double> bounds) : bounds_(std::move(bounds)) {
+    std::sort(bounds_.begin(), bounds_.end());
+    bounds_.erase(std::unique(bounds_.begin(), bounds_.end()), bounds_.end());
+    if (bounds_.size() > MAX_HISTOGRAM_BUCKETS) {
+        bounds_.resize(MAX_HISTOGRAM_BUCKETS);
+    }
+}
+
+void Histogram::observe(double value) {
+    // First bucket whose upper bound is >= value; past the end is +Inf
+    size_t index = static_cast<size_t>(std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin());
+    Stripe& stripe = stripes_[thread_stripe()];
+    stripe.buckets[index].fetch_add(1, std::memory_order_relaxed);
+    stripe.count.fetch_add(1, std::memory_order_relaxed);
+    atomic_add(stripe.sum, value);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.bounds = bounds_;
+    snapshot.cumulative_counts.assign(bounds_.size() + 1, 0);
+    for (const auto& stripe : stripes_) {
+        for (size_t i = 0; i <= bounds_.size(); ++i) {
+            snapshot.cumulative_counts[i] += stripe.buckets[i].load(std::memory_order_relaxed);
+        }
+        snapshot.count += stripe.count.load(std::memory_order_relaxed);
+        snapshot.sum += stripe.sum.load(std::memory_order_relaxed);
+    }
+    for (size_t i = 1; i < snapshot.cumulative_counts.size(); ++i) {
+        snapshot.cumulative_counts[i] += snapshot.cumulative_counts[i - 1];
+    }
+    // Stripes are read one at a time, so keep _count consistent with +Inf
+    snapshot.count = snapshot.cumulative_counts.back();
+    return snapshot;
+}
+
+std::vector<double> exponential_buckets(double start, double factor, size_t count) {
+    std::vector<double> bounds;
+    double bound = start;
+    for (size_t i = 0; i < count; ++i) {
+        bounds.push_back(bound);
+        bound *= factor;
+    }
+    return bounds;
+}
+
+std::vector<double> latency_buckets_seconds() {
+    return exponential_buckets(1e-6, 2.0, 21);
+}
+
+//=============================================================================
+// CallbackHandle
+//=============================================================================
+
+CallbackHandle::CallbackHandle(CallbackHandle&& other) noexcept
+    : registry_(other.registry_), ids_(std::move(other.ids_)) {
+    other.registry_ = nullptr;
+    other.ids_.clear();
+}
+
+CallbackHandle& CallbackHandle::operator=(CallbackHandle&& other) noexcept {
+    if (this != &other) {
+        reset();
+        registry_ = other.registry_;
+        ids_ = std::move(other.ids_);
+        other.registry_ = nullptr;
+        other.ids_.clear();
+    }
+    return *this;
+}
+
+void CallbackHandle::reset() {
+    if (registry_) {
+        for (uint64_t id : ids_) {
+            registry_->remove_callback(id);
+        }
+    }
+    ids_.clear();
+}
+
+//=============================================================================
+// Registry
+//=============================================================================
+
+struct Registry::Series {
+    std::string labels;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+    uint64_t callback_id = 0;
+    std::function<double()> read;
+};
+
+struct Registry::Family {
+    std::string name;
+    std::string help;
+    MetricType type;
+    std::vector<std::unique_ptr<Series>> series;
+};
+
+Registry::Registry() = default;
+Registry::~Registry() = default;
+
+Registry& Registry::global() {
+    // Never destroyed: components may still record while statics unwind
+    static Registry* registry = [] {
+        auto* instance = new Registry();
+        instance->add_callback("process_cpu_seconds_total", "User and system CPU time of this process",
+                               MetricType::COUNTER, process_cpu_seconds);
+        instance->add_callback("process_resident_memory_bytes", "Resident set size of this process",
+                               MetricType::GAUGE, process_resident_bytes);
+        instance->add_callback("thermal_log_records_written_total", "Log records written by the async logger",
+                               MetricType::COUNTER, [] { return static_cast<double>(Log::get_stats().records_written); });
+        instance->add_callback("thermal_log_records_dropped_total", "Log records dropped because a thread buffer was full",
+                               MetricType::COUNTER, [] { return static_cast<double>(Log::get_stats().records_dropped); });
+        instance->add_callback("thermal_log_bytes_written_total", "Bytes written by the async logger",
+                               MetricType::COUNTER, [] { return static_cast<double>(Log::get_stats().bytes_written); });
+        return instance;
+    }();
+    return *registry;
+}
+
+Registry::Family& Registry::family(const std::string& name, const std::string& help, MetricType type) {
+    // Caller holds mutex_
+    for (auto& existing : families_) {
+        if (existing->name == name) {
+            return *existing;
+        }
+    }
+    families_.push_back(std::make_unique<Family>());
+    Family& created = *families_.back();
+    created.name = name;
+    created.help = help;
+    created.type = type;
+    return created;
+}
+
+Registry::Series* Registry::find_series(Family& family, const std::string& labels) {
+    for (auto& series : family.series) {
+        if (series->labels == labels && !series->read) {
+            return series.get();
+        }
+    }
+    family.series.push_back(std::make_unique<Series>());
+    family.series.back()->labels = labels;
+    return family.series.back().get();
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series* series = find_series(family(name, help, MetricType::COUNTER), labels);
+    if (!series->counter) {
+        series->counter = std::make_unique<Counter>();
+    }
+    return *series->counter;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series* series = find_series(family(name, help, MetricType::GAUGE), labels);
+    if (!series->gauge) {
+        series->gauge = std::make_unique<Gauge>();
+    }
+    return *series->gauge;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help,
+                               const std::vector<double>& bounds, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series* series = find_series(family(name, help, MetricType::HISTOGRAM), labels);
+    if (!series->histogram) {
+        series->histogram = std::make_unique<Histogram>(bounds);
+    }
+    return *series->histogram;
+}
+
+uint64_t Registry::add_callback(const std::string& name, const std::string& help, MetricType type,
+                                std::function<double()> read, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family& owner = family(name, help, type == MetricType::COUNTER ? MetricType::COUNTER : MetricType::GAUGE);
+    owner.series.push_back(std::make_unique<Series>());
+    Series& series = *owner.series.back();
+    series.labels = labels;
+    series.read = std::move(read);
+    series.callback_id = next_callback_id_++;
+    return series.callback_id;
+}
+
+void Registry::remove_callback(uint64_t id) {
+    std::lock_guard<std::mutex> scrape_lock(scrape_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& owner : families_) {
+        auto& series = owner->series;
+        auto it = std::find_if(series.begin(), series.end(),
+                               [id](const std::unique_ptr<Series>& s) { return s->callback_id == id; });
+        if (it != series.end()) {
+            series.erase(it);
+            return;
+        }
+    }
+}
+
+std::string Registry::render_prometheus() const {
+    std::lock_guard<std::mutex> scrape_lock(scrape_mutex_);
+    
+    // Snapshot the structure, then read values without mutex_ so a
+    // callback that takes component locks never blocks registration
+    struct FamilyView {
+        const Family* family;
+        std::vector<const Series*> series;
+    };
+    std::vector<FamilyView> views;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& owner : families_) {
+            FamilyView view{owner.get(), {}};
+            for (const auto& series : owner->series) {
+                view.series.push_back(series.get());
+            }
+            if (!view.series.empty()) {
+                views.push_back(std::move(view));
+            }
+        }
+    }
+    
+    std::ostringstream out;
+    for (const auto& view : views) {
+        const Family& owner = *view.family;
+        out << "# HELP " << owner.name << ' ' << escape_help(owner.help) << '\n';
+        out << "# TYPE " << owner.name << ' ' << type_name(owner.type) << '\n';
+        
+        for (const Series* series : view.series) {
+            if (series->read) {
+                write_sample(out, owner.name, series->labels, "", series->read());
+            } else if (series->counter) {
+                write_sample(out, owner.name, series->labels, "", static_cast<double>(series->counter->value()));
+            } else if (series->gauge) {
+                write_sample(out, owner.name, series->labels, "", series->gauge->value());
+            } else if (series->histogram) {
+                Histogram::Snapshot snapshot = series->histogram->snapshot();
+                for (size_t i = 0; i < snapshot.bounds.size(); ++i) {
+                    write_sample(out, owner.name + "_bucket", series->labels,
+                                 "le=\"" + format_value(snapshot.bounds[i]) + "\"",
+                                 static_cast<double>(snapshot.cumulative_counts[i]));
+                }
+                write_sample(out, owner.name + "_bucket", series->labels, "le=\"+Inf\"",
+                             static_cast<double>(snapshot.count));
+                write_sample(out, owner.name + "_sum", series->labels, "", snapshot.sum);
+                write_sample(out, owner.name + "_count", series->labels, "", static_cast<double>(snapshot.count));
+            }
+        }
+    }
+    return out.str();
+}
+
+//=============================================================================
+// Labels
+//=============================================================================
+
+std::string label(const std::string& name, const std::string& value) {
+    std::string out = name + "=\"";
+    for (char c : value) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '"') out += "\\\"";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    out += '"';
+    return out;
+}
+
+std::string join_labels(std::initializer_list<std::string> labels) {
+    std::string out;
+    for (const auto& pair : labels) {
+        if (pair.empty()) continue;
+        if (!out.empty()) out += ',';
+        out += pair;
+    }
+    return out;
+}
+
+} // namespace metrics
+} // namespace thermal_monitoring
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace thermal_monitoring {
+namespace metrics {
+
+/**
+ * In-process instrumentation shared by the bridge and the gateway
+ *
+ * Hot paths record into per-thread stripes and never take a lock:
+ *
+ *   static auto& ingested = Registry::global().counter(
+ *       "thermal_bridge_ingested_messages_total", "Sensor messages ingested from MQTT");
+ *   ingested.inc();
+ *
+ *   ScopedTimer timer(parse_seconds);   // Observes elapsed seconds on destruction
+ *
+ * - Counter, Gauge and Histogram values are spread over STRIPES
+ *   cache-line-aligned slots. Each thread is assigned a slot on first use,
+ *   so concurrent writers on different threads do not share a cache line
+ *   and an update is one uncontended relaxed atomic add. Slots are summed
+ *   only when the registry is scraped.
+ * - Values owned elsewhere (queue depth, connection counts, component stats
+ *   structs) are registered as callbacks and read at scrape time, so they
+ *   cost nothing between scrapes.
+ * - render_prometheus() produces the Prometheus text exposition format
+ *   (version 0.0.4). # HELP / # TYPE are written once per metric name, and
+ *   the same name can carry several label sets.
+ *
+ * Metrics are created through a Registry and live as long as it does, so
+ * references returned by counter()/gauge()/histogram() stay valid; asking
+ * twice for the same name and labels returns the same object. Callbacks
+ * must be removed (or held in a CallbackHandle) before whatever they read
+ * is destroyed.
+ */
+
+constexpr size_t STRIPES = 16;
+constexpr size_t MAX_HISTOGRAM_BUCKETS = 24;
+
+// Stripe index for the calling thread, assigned round-robin on first use
+inline size_t thread_stripe() {
+    static std::atomic<size_t> next_stripe{0};
+    thread_local const size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+    return stripe;
+}
+
+enum class MetricType {
+    COUNTER,
+    GAUGE,
+    HISTOGRAM
+};
+
+class Counter {
+public:
+    void inc(uint64_t amount = 1) {
+        stripes_[thread_stripe()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Stripe, STRIPES> stripes_;
+};
+
+/**
+ * Value that can go up and down. set() is a single store, so unlike
+ * Counter and Histogram a gauge is not striped; use add() for values
+ * adjusted from several threads.
+ */
+class Gauge {
+public:
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    void add(double amount);
+    double value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+/**
+ * Fixed-bucket histogram with Prometheus "le" semantics
+ *
+ * Bucket upper bounds are fixed at creation (at most
+ * MAX_HISTOGRAM_BUCKETS, ascending); an implicit +Inf bucket catches the
+ * rest. Counts per bucket are kept per stripe, non-cumulative, and
+ * accumulated when rendered.
+ */
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> bounds);
+
+    void observe(double value);
+    void observe_duration(std::chrono::steady_clock::duration elapsed) {
+        observe(std::chrono::duration<double>(elapsed).count());
+    }
+
+    struct Snapshot {
+        std::vector<double> bounds;
+        std::vector<uint64_t> cumulative_counts;  // One per bound, then +Inf
+        uint64_t count = 0;
+        double sum = 0.0;
+    };
+    Snapshot snapshot() const;
+
+    const std::vector<double>& bounds() const { return bounds_; }
+
+private:
+    struct alignas(64) Stripe {
+        std::array<std::atomic<uint64_t>, MAX_HISTOGRAM_BUCKETS + 1> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<double> sum{0.0};
+    };
+    std::vector<double> bounds_;
+    std::array<Stripe, STRIPES> stripes_;
+};
+
+// Upper bounds start, start*factor, ... (count of them)
+std::vector<double> exponential_buckets(double start, double factor, size_t count);
+
+// 1 µs .. ~1 s in powers of two: parse, tracker update and per-packet work
+std::vector<double> latency_buckets_seconds();
+
+/**
+ * Observes the time from construction to destruction into a histogram.
+ * A null histogram makes the timer a no-op.
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram* histogram)
+        : histogram_(histogram),
+          start_(histogram ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+    explicit ScopedTimer(Histogram& histogram) : ScopedTimer(&histogram) {}
+    ~ScopedTimer() {
+        if (histogram_) {
+            histogram_->observe_duration(std::chrono::steady_clock::now() - start_);
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+class Registry;
+
+/**
+ * Owns a set of registered callbacks and removes them on destruction,
+ * so a component's callbacks cannot outlive the component
+ */
+class CallbackHandle {
+public:
+    CallbackHandle() = default;
+    CallbackHandle(Registry* registry, std::vector<uint64_t> ids) : registry_(registry), ids_(std::move(ids)) {}
+    ~CallbackHandle() { reset(); }
+
+    CallbackHandle(CallbackHandle&& other) noexcept;
+    CallbackHandle& operator=(CallbackHandle&& other) noexcept;
+    CallbackHandle(const CallbackHandle&) = delete;
+    CallbackHandle& operator=(const CallbackHandle&) = delete;
+
+    void add(uint64_t id) { ids_.push_back(id); }
+    void reset();
+
+private:
+    Registry* registry_ = nullptr;
+    std::vector<uint64_t> ids_;
+};
+
+class Registry {
+public:
+    Registry();
+    ~Registry();
+
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    // Process-wide registry; also exports process and Log metrics
+    static Registry& global();
+
+    /**
+     * Labels are pre-rendered Prometheus label pairs without braces, e.g.
+     * label("gateway", id) or label("type", "TEMP_TOO_HIGH"). The first
+     * registration of a name fixes its help text and type.
+     */
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         const std::vector<double>& bounds, const std::string& labels = "");
+
+    // Read at scrape time; type is COUNTER or GAUGE. Returns an id for remove_callback()
+    uint64_t add_callback(const std::string& name, const std::string& help, MetricType type,
+                          std::function<double()> read, const std::string& labels = "");
+    void remove_callback(uint64_t id);
+
+    std::string render_prometheus() const;
+
+private:
+    struct Series;
+    struct Family;
+
+    Family& family(const std::string& name, const std::string& help, MetricType type);
+    Series* find_series(Family& family, const std::string& labels);
+
+    // Neither lock is touched on the record path. scrape_mutex_ is held
+    // while callbacks run, so remove_callback() waits out a scrape in flight
+    mutable std::mutex scrape_mutex_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Family>> families_;
+    uint64_t next_callback_id_ = 1;
+};
+
+// Renders one label pair, escaping the value: label("gateway", "gw_1") -> gateway="gw_1"
+std::string label(const std::string& name, const std::string& value);
+
+// Joins pre-rendered label pairs with commas, skipping empty ones
+std::string join_labels(std::initializer_list<std::string> labels);
+
+} // namespace metrics
+} // namespace thermal_monitoring
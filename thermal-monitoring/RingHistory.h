@@ -0,0 +1,142 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <chrono>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+namespace thermal_monitoring {
+
+/**
+ * Fixed-capacity ring buffer of time-stamped samples, stored column-wise
+ *
+ * Timestamps and each value column live in their own contiguous array
+ * (structure of arrays), so scans over a single column touch only that
+ * column's cache lines and compile to tight loops. Capacity is fixed at
+ * construction/reset(); once full, push() overwrites the oldest sample in
+ * O(1) and memory per sensor never changes.
+ *
+ * Index 0 is the oldest sample, size() - 1 the newest. Timestamps are
+ * expected to be non-decreasing, which first_index_since() relies on.
+ *
+ * Usage:
+ *   RingHistory<float, float> history(100);          // temperature, humidity
+ *   history.push(now, 21.5f, 48.0f);
+ *   history.for_each<0>([&](float t) { sum += t; }); // temperatures, oldest first
+ */
+template <typename... Columns>
+class RingHistory {
+public:
+    using Timestamp = std::chrono::steady_clock::time_point;
+
+    /**
+     * One column as at most two contiguous runs, oldest first
+     */
+    template <typename T>
+    struct Segments {
+        const T* first;
+        size_t first_size;
+        const T* second;
+        size_t second_size;
+    };
+
+    explicit RingHistory(size_t capacity = 0) { reset(capacity); }
+
+    void reset(size_t capacity) {
+        capacity_ = capacity;
+        head_ = 0;
+        size_ = 0;
+        timestamps_.assign(capacity, Timestamp{});
+        std::apply([capacity](auto&... column) { (column.assign(capacity, {}), ...); }, columns_);
+    }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == capacity_; }
+
+    void push(Timestamp timestamp, Columns... values) {
+        if (capacity_ == 0) return;
+
+        size_t slot = (head_ + size_) % capacity_;
+        if (size_ == capacity_) {
+            head_ = (head_ + 1) % capacity_;
+        } else {
+            size_++;
+        }
+
+        timestamps_[slot] = timestamp;
+        store(slot, std::index_sequence_for<Columns...>{}, values...);
+    }
+
+    Timestamp timestamp(size_t index) const { return timestamps_[physical(index)]; }
+    Timestamp newest_timestamp() const { return timestamp(size_ - 1); }
+
+    template <size_t C>
+    const auto& value(size_t index) const { return std::get<C>(columns_)[physical(index)]; }
+
+    template <size_t C>
+    const auto& newest() const { return value<C>(size_ - 1); }
+
+    template <size_t C>
+    auto segments() const {
+        using T = std::tuple_element_t<C, std::tuple<Columns...>>;
+        return make_segments<T>(std::get<C>(columns_).data());
+    }
+
+    Segments<Timestamp> timestamp_segments() const {
+        return make_segments<Timestamp>(timestamps_.data());
+    }
+
+    // Visit column C from oldest to newest, starting at logical index 'from'
+    template <size_t C, typename Fn>
+    void for_each(Fn&& fn, size_t from = 0) const {
+        auto seg = segments<C>();
+        size_t i = from;
+        for (; i < seg.first_size; ++i) fn(seg.first[i]);
+        for (i -= seg.first_size; i < seg.second_size; ++i) fn(seg.second[i]);
+    }
+
+    // Logical index of the oldest sample at or after 'cutoff' (size() if none)
+    size_t first_index_since(Timestamp cutoff) const {
+        size_t lo = 0, hi = size_;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (timestamp(mid) < cutoff) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+private:
+    size_t capacity_ = 0;
+    size_t head_ = 0;
+    size_t size_ = 0;
+    std::vector<Timestamp> timestamps_;
+    std::tuple<std::vector<Columns>...> columns_;
+
+    size_t physical(size_t index) const { return (head_ + index) % capacity_; }
+
+    template <size_t... I>
+    void store(size_t slot, std::index_sequence<I...>, Columns... values) {
+        ((std::get<I>(columns_)[slot] = values), ...);
+    }
+
+    template <typename T>
+    Segments<T> make_segments(const T* base) const {
+        size_t first_size = std::min(size_, capacity_ - head_);
+        return {base + head_, first_size, base, size_ - first_size};
+    }
+};
+
+} // namespace thermal_monitoring
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace thermal_monitoring {
+
+/**
+ * Streaming mean/variance/min/max over every sample seen (Welford)
+ */
+class RunningStats {
+public:
+    void add(double x) {
+        count_++;
+        double delta = x - mean_;
+        mean_ += delta / count_;
+        m2_ += delta * (x - mean_);
+        if (count_ == 1 || x < min_) min_ = x;
+        if (count_ == 1 || x > max_) max_ = x;
+    }
+
+    void clear() { *this = RunningStats(); }
+
+    // Resume from a summary taken with count()/mean()/variance()/min()/max()
+    static RunningStats restore(size_t count, double mean, double variance, double min, double max) {
+        RunningStats stats;
+        if (count == 0) return stats;
+        stats.count_ = count;
+        stats.mean_ = mean;
+        stats.m2_ = count > 1 ? variance * static_cast<double>(count - 1) : 0.0;
+        stats.min_ = min;
+        stats.max_ = max;
+        return stats;
+    }
+
+    size_t count() const { return count_; }
+    double mean() const { return mean_; }
+    double variance() const { return count_ > 1 ? m2_ / (count_ - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+    double min() const { return min_; }
+    double max() const { return max_; }
+
+private:
+    size_t count_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    double min_ = 0.0;
+    double max_ = 0.0;
+};
+
+/**
+ * Windowed mean, variance, min/max and regression slope in O(1) per sample
+ *
+ * Mirrors a FIFO window such as a RingHistory column: call add() for each
+ * new sample and remove_oldest() with the value that drops out of the
+ * window. Mean/variance use Welford updates with subtract-on-evict;
+ * min/max use monotonic queues (amortised O(1)). The regression is
+ * against the sample index (0 = oldest), matching a least-squares fit
+ * over the window's samples in order.
+ *
+ * The monotonic queues hold at most one entry per windowed sample, so
+ * reset() with the window's capacity sizes them once and add()/
+ * remove_oldest()/clear() never allocate afterwards. A window used
+ * without reset() grows its queues on demand.
+ */
+class WindowedStats {
+public:
+    explicit WindowedStats(size_t capacity = 0) { reset(capacity); }
+
+    // Empty the window and size the queues for 'capacity' samples
+    void reset(size_t capacity) {
+        clear();
+        min_queue_.reset(capacity);
+        max_queue_.reset(capacity);
+    }
+
+    void add(double y) {
+        // New sample sits at x = count_
+        sum_xy_ += static_cast<double>(count_) * y;
+        sum_y_ += y;
+
+        count_++;
+        double delta = y - mean_;
+        mean_ += delta / count_;
+        m2_ += delta * (y - mean_);
+
+        uint64_t seq = next_seq_++;
+        while (!min_queue_.empty() && min_queue_.back().value >= y) min_queue_.pop_back();
+        min_queue_.push_back({seq, y});
+        while (!max_queue_.empty() && max_queue_.back().value <= y) max_queue_.pop_back();
+        max_queue_.push_back({seq, y});
+    }
+
+    void remove_oldest(double y) {
+        if (count_ == 0) return;
+        if (count_ == 1) {
+            clear();
+            return;
+        }
+
+        // Remaining samples each move one index closer to the front
+        sum_y_ -= y;
+        sum_xy_ -= sum_y_;
+
+        double old_mean = mean_;
+        mean_ = (count_ * mean_ - y) / (count_ - 1);
+        m2_ -= (y - old_mean) * (y - mean_);
+        if (m2_ < 0.0) m2_ = 0.0;
+        count_--;
+
+        uint64_t seq = oldest_seq_++;
+        if (!min_queue_.empty() && min_queue_.front().seq == seq) min_queue_.pop_front();
+        if (!max_queue_.empty() && max_queue_.front().seq == seq) max_queue_.pop_front();
+    }
+
+    // Empty the window, keeping the queue storage
+    void clear() {
+        count_ = 0;
+        mean_ = 0.0;
+        m2_ = 0.0;
+        sum_y_ = 0.0;
+        sum_xy_ = 0.0;
+        next_seq_ = 0;
+        oldest_seq_ = 0;
+        min_queue_.clear();
+        max_queue_.clear();
+    }
+
+    size_t count() const { return count_; }
+    double mean() const { return mean_; }
+    double variance() const { return count_ > 1 ? m2_ / (count_ - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+    double min() const { return min_queue_.empty() ? 0.0 : min_queue_.front().value; }
+    double max() const { return max_queue_.empty() ? 0.0 : max_queue_.front().value; }
+
+    // Least-squares slope per sample and intercept at the oldest sample
+    double slope() const {
+        if (count_ < 2) return 0.0;
+        double n = static_cast<double>(count_);
+        double sum_x = n * (n - 1) / 2.0;
+        double sum_x2 = (n - 1) * n * (2 * n - 1) / 6.0;
+        double denom = n * sum_x2 - sum_x * sum_x;
+        return denom != 0.0 ? (n * sum_xy_ - sum_x * sum_y_) / denom : 0.0;
+    }
+
+    double intercept() const {
+        if (count_ == 0) return 0.0;
+        double n = static_cast<double>(count_);
+        return (sum_y_ - slope() * n * (n - 1) / 2.0) / n;
+    }
+
+private:
+    struct Entry {
+        uint64_t seq;
+        double value;
+    };
+
+    // Double-ended queue over a fixed circular array
+    class EntryQueue {
+    public:
+        void reset(size_t capacity) {
+            entries_.assign(capacity, Entry{});
+            head_ = 0;
+            size_ = 0;
+        }
+
+        void clear() {
+            head_ = 0;
+            size_ = 0;
+        }
+
+        bool empty() const { return size_ == 0; }
+        const Entry& front() const { return entries_[head_]; }
+        const Entry& back() const { return entries_[physical(size_ - 1)]; }
+
+        void push_back(Entry entry) {
+            if (size_ == entries_.size()) grow();
+            entries_[physical(size_)] = entry;
+            size_++;
+        }
+
+        void pop_back() { size_--; }
+
+        void pop_front() {
+            head_ = (head_ + 1) % entries_.size();
+            size_--;
+        }
+
+    private:
+        std::vector<Entry> entries_;
+        size_t head_ = 0;
+        size_t size_ = 0;
+
+        size_t physical(size_t index) const { return (head_ + index) % entries_.size(); }
+
+        void grow() {
+            std::vector<Entry> grown(std::max<size_t>(8, entries_.size() * 2));
+            for (size_t i = 0; i < size_; ++i) grown[i] = entries_[physical(i)];
+            entries_.swap(grown);
+            head_ = 0;
+        }
+    };
+
+    size_t count_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    double sum_y_ = 0.0;
+    double sum_xy_ = 0.0;
+    uint64_t next_seq_ = 0;
+    uint64_t oldest_seq_ = 0;
+    EntryQueue min_queue_;
+    EntryQueue max_queue_;
+};
+
+} // namespace thermal_monitoring
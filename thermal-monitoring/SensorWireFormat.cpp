@@ -0,0 +1,226 @@
+#include "SensorWireFormat.h"
+#include <algorithm>
+#include <cstring>
+
+namespace thermal_monitoring {
+namespace wire {
+
+namespace {
+
+void put_u8(std::vector<uint8_t>& out, uint8_t value) {
+    out.push_back(value);
+}
+
+void put_u16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void put_u32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void put_i64(std::vector<uint8_t>& out, int64_t value) {
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<uint8_t>(bits >> shift));
+    }
+}
+
+void put_f32(std::vector<uint8_t>& out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u32(out, bits);
+}
+
+void put_str8(std::vector<uint8_t>& out, const std::string& value) {
+    size_t len = std::min<size_t>(value.size(), 0xFF);
+    put_u8(out, static_cast<uint8_t>(len));
+    out.insert(out.end(), value.begin(), value.begin() + len);
+}
+
+void put_str16(std::vector<uint8_t>& out, const std::string& value) {
+    size_t len = std::min<size_t>(value.size(), 0xFFFF);
+    put_u16(out, static_cast<uint16_t>(len));
+    out.insert(out.end(), value.begin(), value.begin() + len);
+}
+
+/**
+ * Bounds-checked little-endian reader; any short read latches failure
+ */
+class Reader {
+private:
+    const uint8_t* data_;
+    size_t len_;
+    size_t pos_;
+    bool ok_;
+
+    bool take(size_t n) {
+        if (!ok_ || len_ - pos_ < n) {
+            ok_ = false;
+            return false;
+        }
+        return true;
+    }
+
+public:
+    Reader(const uint8_t* data, size_t len) : data_(data), len_(len), pos_(0), ok_(data != nullptr) {}
+
+    bool ok() const { return ok_; }
+
+    uint8_t u8() {
+        if (!take(1)) return 0;
+        return data_[pos_++];
+    }
+
+    uint16_t u16() {
+        if (!take(2)) return 0;
+        uint16_t value = static_cast<uint16_t>(data_[pos_] | (data_[pos_ + 1] << 8));
+        pos_ += 2;
+        return value;
+    }
+
+    uint32_t u32() {
+        if (!take(4)) return 0;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(data_[pos_ + i]) << (8 * i);
+        }
+        pos_ += 4;
+        return value;
+    }
+
+    int64_t i64() {
+        if (!take(8)) return 0;
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(data_[pos_ + i]) << (8 * i);
+        }
+        pos_ += 8;
+        return static_cast<int64_t>(value);
+    }
+
+    float f32() {
+        uint32_t bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string str(size_t n) {
+        if (!take(n)) return std::string();
+        std::string value(reinterpret_cast<const char*>(data_ + pos_), n);
+        pos_ += n;
+        return value;
+    }
+};
+
+bool read_header(Reader& reader, MessageType expected) {
+    uint8_t version = reader.u8();
+    uint8_t type = reader.u8();
+    return reader.ok() && version == WIRE_VERSION && type == static_cast<uint8_t>(expected);
+}
+
+int64_t to_millis(std::chrono::steady_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(timestamp.time_since_epoch()).count();
+}
+
+} // namespace
+
+bool is_binary_topic(std::string_view topic) {
+    return topic.size() >= BINARY_TOPIC_SUFFIX.size() &&
+           topic.substr(topic.size() - BINARY_TOPIC_SUFFIX.size()) == BINARY_TOPIC_SUFFIX;
+}
+
+void encode_sensor_record(const SensorRecord& record, std::vector<uint8_t>& out) {
+    out.reserve(out.size() + 40 + 3 + record.sensor_id.size() + record.location.size() + record.gateway_id.size());
+
+    put_u8(out, WIRE_VERSION);
+    put_u8(out, static_cast<uint8_t>(MessageType::SENSOR_READING));
+    put_u8(out, record.status);
+    put_u8(out, record.interface);
+    put_u32(out, record.sequence);
+    put_i64(out, record.timestamp_ms);
+    put_f32(out, record.temperature);
+    put_f32(out, record.humidity);
+    put_f32(out, record.pressure);
+    put_f32(out, record.supply_voltage);
+    put_f32(out, record.signal_strength);
+    put_f32(out, record.data_confidence);
+    put_str8(out, record.sensor_id);
+    put_str8(out, record.location);
+    put_str8(out, record.gateway_id);
+}
+
+void encode_alert(const Alert& alert, std::vector<uint8_t>& out) {
+    out.reserve(out.size() + 23 + 4 + alert.sensor_id.size() + alert.location.size() + alert.message.size());
+
+    put_u8(out, WIRE_VERSION);
+    put_u8(out, static_cast<uint8_t>(MessageType::ALERT));
+    put_u8(out, static_cast<uint8_t>(alert.alert_type));
+    put_i64(out, to_millis(alert.timestamp));
+    put_f32(out, alert.temperature);
+    put_f32(out, alert.humidity);
+    put_f32(out, alert.temp_rate);
+    put_str8(out, alert.sensor_id);
+    put_str8(out, alert.location);
+    put_str16(out, alert.message);
+}
+
+std::optional<SensorRecord> decode_sensor_record(const uint8_t* data, size_t len) {
+    Reader reader(data, len);
+    if (!read_header(reader, MessageType::SENSOR_READING)) {
+        return std::nullopt;
+    }
+
+    SensorRecord record;
+    record.status = reader.u8();
+    record.interface = reader.u8();
+    record.sequence = reader.u32();
+    record.timestamp_ms = reader.i64();
+    record.temperature = reader.f32();
+    record.humidity = reader.f32();
+    record.pressure = reader.f32();
+    record.supply_voltage = reader.f32();
+    record.signal_strength = reader.f32();
+    record.data_confidence = reader.f32();
+    record.sensor_id = reader.str(reader.u8());
+    record.location = reader.str(reader.u8());
+    record.gateway_id = reader.str(reader.u8());
+
+    if (!reader.ok()) {
+        return std::nullopt;
+    }
+    return record;
+}
+
+std::optional<Alert> decode_alert(const uint8_t* data, size_t len) {
+    Reader reader(data, len);
+    if (!read_header(reader, MessageType::ALERT)) {
+        return std::nullopt;
+    }
+
+    Alert alert;
+    uint8_t alert_type = reader.u8();
+    if (alert_type > static_cast<uint8_t>(AlertType::SENSOR_OFFLINE)) {
+        return std::nullopt;
+    }
+    alert.alert_type = static_cast<AlertType>(alert_type);
+    alert.timestamp = std::chrono::steady_clock::time_point(std::chrono::milliseconds(reader.i64()));
+    alert.temperature = reader.f32();
+    alert.humidity = reader.f32();
+    alert.temp_rate = reader.f32();
+    alert.sensor_id = reader.str(reader.u8());
+    alert.location = reader.str(reader.u8());
+    alert.message = reader.str(reader.u16());
+
+    if (!reader.ok()) {
+        return std::nullopt;
+    }
+    return alert;
+}
+
+} // namespace wire
+} // namespace thermal_monitoring
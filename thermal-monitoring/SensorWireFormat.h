@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include "ThermalIsolationTracker.h"
+
+namespace thermal_monitoring {
+namespace wire {
+
+/**
+ * Versioned binary encoding for sensor readings and alerts
+ *
+ * Fixed little-endian packed layout, negotiated by topic suffix: topics
+ * ending in "/bin" carry this encoding, everything else stays JSON text.
+ *
+ * Every message starts with a 2-byte header: [version][message type].
+ * Strings are length-prefixed (u8, or u16 for alert messages).
+ *
+ * Sensor reading, version 1 (40 bytes + length-prefixed strings):
+ *   u8  version | u8 type | u8 status | u8 interface | u32 sequence
+ *   i64 timestamp_ms
+ *   f32 temperature | f32 humidity | f32 pressure | f32 supply_voltage
+ *   f32 signal_strength | f32 data_confidence
+ *   u8 len + sensor_id | u8 len + location | u8 len + gateway_id
+ *
+ * Alert, version 1 (23 bytes + length-prefixed strings):
+ *   u8  version | u8 type | u8 alert_type | i64 timestamp_ms
+ *   f32 temperature | f32 humidity | f32 temp_rate
+ *   u8 len + sensor_id | u8 len + location | u16 len + message
+ */
+
+constexpr uint8_t WIRE_VERSION = 1;
+constexpr std::string_view BINARY_TOPIC_SUFFIX = "/bin";
+
+enum class MessageType : uint8_t {
+    SENSOR_READING = 1,
+    ALERT = 2
+};
+
+/**
+ * Transport-neutral sensor reading, filled from the gateway's
+ * SensorDataPacket or an STM32 node reading
+ */
+struct SensorRecord {
+    std::string sensor_id;
+    std::string location;
+    std::string gateway_id;
+    int64_t timestamp_ms = 0;
+    float temperature = 0.0f;
+    float humidity = 0.0f;
+    float pressure = 0.0f;
+    float supply_voltage = 0.0f;
+    float signal_strength = 0.0f;
+    float data_confidence = 0.0f;
+    uint32_t sequence = 0;
+    uint8_t status = 0;
+    uint8_t interface = 0;
+};
+
+// True for topics that carry the binary encoding
+bool is_binary_topic(std::string_view topic);
+
+// Encoders append to 'out' so callers can reuse one buffer
+void encode_sensor_record(const SensorRecord& record, std::vector<uint8_t>& out);
+void encode_alert(const Alert& alert, std::vector<uint8_t>& out);
+
+std::optional<SensorRecord> decode_sensor_record(const uint8_t* data, size_t len);
+std::optional<Alert> decode_alert(const uint8_t* data, size_t len);
+
+} // namespace wire
+} // namespace thermal_monitoring
@@ -0,0 +1,320 @@
+#include "StateSnapshot.h"
+#include "Log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace thermal_monitoring {
+
+namespace {
+
+constexpr char MAGIC[8] = {'T', 'H', 'R', 'M', 'S', 'N', 'A', 'P'};
+constexpr size_t HEADER_SIZE = 64;
+constexpr size_t INITIAL_SLOTS = 64;
+
+// Header field offsets
+constexpr size_t HEADER_LAYOUT = 8;
+constexpr size_t HEADER_SCHEMA = 12;
+constexpr size_t HEADER_SLOT_SIZE = 16;
+constexpr size_t HEADER_SLOT_COUNT = 20;
+
+// Slot field offsets
+constexpr size_t SLOT_LENGTH = 0;
+constexpr size_t SLOT_CHECKSUM = 4;
+constexpr size_t SLOT_SEQUENCE = 8;
+constexpr size_t SLOT_KEY_LENGTH = 16;
+constexpr size_t SLOT_HEADER_SIZE = 18;
+
+template <typename T>
+T load_at(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void store_at(uint8_t* p, T value) {
+    std::memcpy(p, &value, sizeof(T));
+}
+
+// FNV-1a over sequence, key and record
+uint32_t slot_checksum(const uint8_t* slot, size_t key_length, size_t record_length) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const uint8_t* data, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+    };
+    mix(slot + SLOT_SEQUENCE, sizeof(uint64_t));
+    mix(slot + SLOT_HEADER_SIZE, key_length + record_length);
+    return hash;
+}
+
+size_t slot_size_for(size_t max_record) {
+    size_t size = SLOT_HEADER_SIZE + StateSnapshotFile::MAX_KEY_LENGTH + max_record;
+    return (size + 63) / 64 * 64;
+}
+
+}
+
+StateSnapshotFile::StateSnapshotFile(std::string path, uint32_t schema, size_t max_record)
+    : path_(std::move(path)), schema_(schema), slot_size_(slot_size_for(max_record)) {}
+
+StateSnapshotFile::~StateSnapshotFile() {
+    close();
+}
+
+bool StateSnapshotFile::open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) {
+        return true;
+    }
+
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        THERMAL_LOG_ERROR << "❌ [StateSnapshot] Cannot open " << path_ << ": " << std::strerror(errno);
+        return false;
+    }
+
+    // Keep an existing file only if it is one we can read back as-is
+    struct stat info;
+    uint8_t header[HEADER_SIZE];
+    bool compatible = fstat(fd_, &info) == 0 && static_cast<size_t>(info.st_size) >= HEADER_SIZE &&
+                      pread(fd_, header, HEADER_SIZE, 0) == static_cast<ssize_t>(HEADER_SIZE) &&
+                      std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0 &&
+                      load_at<uint32_t>(header + HEADER_LAYOUT) == LAYOUT_VERSION &&
+                      load_at<uint32_t>(header + HEADER_SCHEMA) == schema_;
+    size_t stored_slot_size = compatible ? load_at<uint32_t>(header + HEADER_SLOT_SIZE) : 0;
+    size_t stored_slots = compatible ? load_at<uint32_t>(header + HEADER_SLOT_COUNT) : 0;
+    compatible = compatible && stored_slot_size >= slot_size_ && stored_slot_size % 64 == 0 && stored_slots > 0 &&
+                 static_cast<size_t>(info.st_size) >= HEADER_SIZE + stored_slots * stored_slot_size;
+
+    if (!compatible) {
+        if (info.st_size > 0) {
+            THERMAL_LOG_WARN << "⚠️ [StateSnapshot] " << path_ << " has another layout or schema, starting cold";
+        }
+        if (!create_locked()) {
+            unmap_locked();
+            return false;
+        }
+        return true;
+    }
+
+    slot_size_ = stored_slot_size;
+    if (!map_locked(stored_slots)) {
+        unmap_locked();
+        return false;
+    }
+
+    // Index intact records; torn ones are freed
+    for (size_t i = slot_count_; i-- > 0;) {
+        uint8_t* p = slot(static_cast<uint32_t>(i));
+        uint32_t length = load_at<uint32_t>(p + SLOT_LENGTH);
+        if (length == 0) {
+            free_slots_.push_back(static_cast<uint32_t>(i));
+            continue;
+        }
+
+        size_t key_length = load_at<uint16_t>(p + SLOT_KEY_LENGTH);
+        bool intact = key_length > 0 && key_length <= MAX_KEY_LENGTH &&
+                      SLOT_HEADER_SIZE + key_length + length <= slot_size_ &&
+                      load_at<uint32_t>(p + SLOT_CHECKSUM) == slot_checksum(p, key_length, length);
+        std::string key(reinterpret_cast<const char*>(p + SLOT_HEADER_SIZE), intact ? key_length : 0);
+        if (!intact || slots_.count(key)) {
+            stats_.corrupt_records++;
+            store_at<uint32_t>(p + SLOT_LENGTH, 0);
+            free_slots_.push_back(static_cast<uint32_t>(i));
+            continue;
+        }
+
+        sequence_ = std::max(sequence_, load_at<uint64_t>(p + SLOT_SEQUENCE));
+        slots_.emplace(std::move(key), static_cast<uint32_t>(i));
+    }
+
+    THERMAL_LOG_INFO << "💾 [StateSnapshot] Mapped " << path_ << " with " << slots_.size() << " records"
+                     << (stats_.corrupt_records ? ", " + std::to_string(stats_.corrupt_records) + " torn" : "");
+    return true;
+}
+
+void StateSnapshotFile::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_) {
+        msync(base_, HEADER_SIZE + slot_count_ * slot_size_, MS_SYNC);
+    }
+    unmap_locked();
+}
+
+bool StateSnapshotFile::is_open() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return base_ != nullptr;
+}
+
+size_t StateSnapshotFile::load(const Visitor& visit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t visited = 0;
+    for (size_t i = 0; base_ && i < slot_count_; ++i) {
+        const uint8_t* p = slot(static_cast<uint32_t>(i));
+        uint32_t length = load_at<uint32_t>(p + SLOT_LENGTH);
+        if (length == 0) {
+            continue;
+        }
+        size_t key_length = load_at<uint16_t>(p + SLOT_KEY_LENGTH);
+        visit(std::string_view(reinterpret_cast<const char*>(p + SLOT_HEADER_SIZE), key_length),
+              p + SLOT_HEADER_SIZE + key_length, length);
+        visited++;
+    }
+    return visited;
+}
+
+bool StateSnapshotFile::put(std::string_view key, const uint8_t* record, size_t length) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!base_) {
+        return false;
+    }
+    if (key.empty() || key.size() > MAX_KEY_LENGTH || length == 0 ||
+        SLOT_HEADER_SIZE + key.size() + length > slot_size_) {
+        stats_.rejected_records++;
+        return false;
+    }
+
+    uint32_t index;
+    auto it = slots_.find(std::string(key));
+    if (it != slots_.end()) {
+        index = it->second;
+    } else {
+        if (free_slots_.empty() && !grow_locked()) {
+            return false;
+        }
+        index = free_slots_.back();
+        free_slots_.pop_back();
+        slots_.emplace(std::string(key), index);
+    }
+
+    // Checksum last, so a torn slot never passes as intact
+    uint8_t* p = slot(index);
+    store_at<uint64_t>(p + SLOT_SEQUENCE, ++sequence_);
+    store_at<uint16_t>(p + SLOT_KEY_LENGTH, static_cast<uint16_t>(key.size()));
+    std::memcpy(p + SLOT_HEADER_SIZE, key.data(), key.size());
+    std::memcpy(p + SLOT_HEADER_SIZE + key.size(), record, length);
+    store_at<uint32_t>(p + SLOT_LENGTH, static_cast<uint32_t>(length));
+    store_at<uint32_t>(p + SLOT_CHECKSUM, slot_checksum(p, key.size(), length));
+
+    stats_.writes++;
+    stats_.bytes_written += length;
+    return true;
+}
+
+void StateSnapshotFile::erase(std::string_view key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slots_.find(std::string(key));
+    if (it == slots_.end()) {
+        return;
+    }
+    store_at<uint32_t>(slot(it->second) + SLOT_LENGTH, 0);
+    free_slots_.push_back(it->second);
+    slots_.erase(it);
+}
+
+void StateSnapshotFile::sync(bool wait) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_) {
+        msync(base_, HEADER_SIZE + slot_count_ * slot_size_, wait ? MS_SYNC : MS_ASYNC);
+    }
+}
+
+StateSnapshotFile::Stats StateSnapshotFile::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.records = slots_.size();
+    stats.slot_count = slot_count_;
+    stats.file_bytes = base_ ? HEADER_SIZE + slot_count_ * slot_size_ : 0;
+    return stats;
+}
+
+uint8_t* StateSnapshotFile::slot(uint32_t index) const {
+    return base_ + HEADER_SIZE + static_cast<size_t>(index) * slot_size_;
+}
+
+bool StateSnapshotFile::create_locked() {
+    // Truncating first zeroes every slot of the old contents
+    if (ftruncate(fd_, 0) != 0 || !map_locked(INITIAL_SLOTS)) {
+        THERMAL_LOG_ERROR << "❌ [StateSnapshot] Cannot create " << path_ << ": " << std::strerror(errno);
+        return false;
+    }
+
+    std::memcpy(base_, MAGIC, sizeof(MAGIC));
+    store_at<uint32_t>(base_ + HEADER_LAYOUT, LAYOUT_VERSION);
+    store_at<uint32_t>(base_ + HEADER_SCHEMA, schema_);
+    store_at<uint32_t>(base_ + HEADER_SLOT_SIZE, static_cast<uint32_t>(slot_size_));
+    store_at<uint32_t>(base_ + HEADER_SLOT_COUNT, static_cast<uint32_t>(slot_count_));
+    for (size_t i = slot_count_; i-- > 0;) {
+        free_slots_.push_back(static_cast<uint32_t>(i));
+    }
+    return true;
+}
+
+bool StateSnapshotFile::map_locked(size_t slot_count) {
+    size_t bytes = HEADER_SIZE + slot_count * slot_size_;
+    struct stat info;
+    if (fstat(fd_, &info) != 0 ||
+        (static_cast<size_t>(info.st_size) < bytes && ftruncate(fd_, static_cast<off_t>(bytes)) != 0)) {
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        THERMAL_LOG_ERROR << "❌ [StateSnapshot] Cannot map " << path_ << ": " << std::strerror(errno);
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(mapping);
+    slot_count_ = slot_count;
+    return true;
+}
+
+bool StateSnapshotFile::grow_locked() {
+    // Doubling keeps remaps (and their page faults) rare
+    size_t old_count = slot_count_;
+    size_t new_count = old_count * 2;
+    if (new_count > UINT32_MAX) {
+        stats_.rejected_records++;
+        return false;
+    }
+
+    munmap(base_, HEADER_SIZE + old_count * slot_size_);
+    base_ = nullptr;
+    if (!map_locked(new_count)) {
+        // Fall back to the old size so existing records stay writable
+        if (!map_locked(old_count)) {
+            unmap_locked();
+        }
+        stats_.rejected_records++;
+        return false;
+    }
+
+    store_at<uint32_t>(base_ + HEADER_SLOT_COUNT, static_cast<uint32_t>(new_count));
+    for (size_t i = new_count; i-- > old_count;) {
+        free_slots_.push_back(static_cast<uint32_t>(i));
+    }
+    return true;
+}
+
+void StateSnapshotFile::unmap_locked() {
+    if (base_) {
+        munmap(base_, HEADER_SIZE + slot_count_ * slot_size_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    slot_count_ = 0;
+    slots_.clear();
+    free_slots_.clear();
+}
+
+} // namespace thermal_monitoring
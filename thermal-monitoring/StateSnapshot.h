@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace thermal_monitoring {
+
+/**
+ * Memory-mapped, versioned store of per-sensor state for warm restarts
+ *
+ * The file is a 64-byte header followed by equal-sized slots, one per key
+ * (sensor id). put() rewrites only its key's slot in the mapping, so a
+ * periodic pass that saves just the sensors changed since the previous
+ * pass costs O(changed sensors); the kernel writes dirty pages back on its
+ * own schedule and sync() forces them out. On startup the file is mapped
+ * and its records handed to load() without replaying anything.
+ *
+ * Layout (host byte order; the file never leaves the machine that wrote it):
+ *   header: char magic[8] "THRMSNAP" | u32 layout version | u32 schema
+ *           u32 slot_size | u32 slot_count | zero padding
+ *   slot:   u32 record_length (0 = free) | u32 checksum | u64 sequence
+ *           u16 key_length | key | record
+ *
+ * The checksum covers the sequence, key and record, and is written last: a
+ * slot torn by a crash mid-write fails it on open() and only that key
+ * starts cold. A file with another layout version or schema (the caller's
+ * record format version), or with slots too small for max_record, is
+ * discarded rather than misread; the file grows by doubling as keys arrive.
+ *
+ * Thread-safe; the mapping is only touched under the store's mutex.
+ */
+class StateSnapshotFile {
+public:
+    static constexpr uint32_t LAYOUT_VERSION = 1;
+    static constexpr size_t MAX_KEY_LENGTH = 255;
+
+    struct Stats {
+        size_t records = 0;
+        size_t slot_count = 0;
+        size_t file_bytes = 0;
+        uint64_t writes = 0;
+        uint64_t bytes_written = 0;
+        uint64_t rejected_records = 0;      // Key or record too large for a slot
+        uint64_t corrupt_records = 0;       // Failed their checksum on open()
+    };
+
+    using Visitor = std::function<void(std::string_view key, const uint8_t* record, size_t length)>;
+
+    StateSnapshotFile(std::string path, uint32_t schema, size_t max_record);
+    ~StateSnapshotFile();
+
+    StateSnapshotFile(const StateSnapshotFile&) = delete;
+    StateSnapshotFile& operator=(const StateSnapshotFile&) = delete;
+
+    // Maps the file, creating or resetting it when it is missing or incompatible
+    bool open();
+    void close();
+    bool is_open() const;
+
+    // Calls visit for every intact record, in slot order; returns how many.
+    // visit runs under the store's lock and must not call back into it
+    size_t load(const Visitor& visit) const;
+
+    bool put(std::string_view key, const uint8_t* record, size_t length);
+    bool put(std::string_view key, const std::string& record) {
+        return put(key, reinterpret_cast<const uint8_t*>(record.data()), record.size());
+    }
+    void erase(std::string_view key);
+
+    // Schedules (or with wait, completes) write-back of the mapping
+    void sync(bool wait = false);
+
+    Stats get_stats() const;
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    uint32_t schema_;
+    size_t slot_size_;
+
+    mutable std::mutex mutex_;
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    size_t slot_count_ = 0;
+    uint64_t sequence_ = 0;
+    std::unordered_map<std::string, uint32_t> slots_;
+    std::vector<uint32_t> free_slots_;
+    Stats stats_;
+
+    uint8_t* slot(uint32_t index) const;
+    bool create_locked();
+    bool map_locked(size_t slot_count);
+    bool grow_locked();
+    void unmap_locked();
+};
+
+} // namespace thermal_monitoring
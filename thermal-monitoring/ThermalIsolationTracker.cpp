@@ -1,72 +1,469 @@
 #include "ThermalIsolationTracker.h"
-#include <iostream>
+#include "SensorWireFormat.h"
+#include "StateSnapshot.h"
+#include "Log.h"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 #include <cmath>
+#include <charconv>
+#include <cstring>
 
 namespace thermal_monitoring {
 
+namespace {
+
+//=============================================================================
+// Sensor State Records (warm restart)
+//=============================================================================
+
+/**
+ * One sensor's state as kept in the state snapshot file, version 1:
+ *   u64 wall_clock_ms at encode
+ *   u8 len + sensor_id | u8 len + location
+ *   f32 temperature | f32 humidity | f32 temp_rate | u8 is_active
+ *   i64 last_update age_ns | u8 alerted | i64 last_alert age_ns x ALERT_TYPE_COUNT
+ *   u32 samples, each i64 age_ns | f32 temperature | f32 humidity
+ *
+ * Steady-clock time points do not survive a restart, so they are stored as
+ * ages and rebased on load, also counting the wall-clock time the process
+ * was down. Little-endian like the wire format.
+ */
+constexpr uint32_t SENSOR_STATE_SCHEMA = 1;
+constexpr size_t SENSOR_STATE_SAMPLE_SIZE = 16;
+
+size_t max_sensor_state_size(size_t history_size) {
+    return 8 + 2 * 256 + 13 + 9 + 8 * ALERT_TYPE_COUNT + 4 + history_size * SENSOR_STATE_SAMPLE_SIZE;
+}
+
+int64_t wall_clock_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void put_u8(std::string& out, uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+void put_u32(std::string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>(value >> shift));
+    }
+}
+
+void put_u64(std::string& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<char>(value >> shift));
+    }
+}
+
+void put_f32(std::string& out, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u32(out, bits);
+}
+
+void put_str8(std::string& out, const std::string& value) {
+    size_t len = std::min<size_t>(value.size(), 0xFF);
+    put_u8(out, static_cast<uint8_t>(len));
+    out.append(value.data(), len);
+}
+
+void put_age(std::string& out, std::chrono::steady_clock::time_point now,
+             std::chrono::steady_clock::time_point time) {
+    put_u64(out, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - time).count()));
+}
+
+// Bounds-checked little-endian reads; a short buffer latches ok = false
+struct Reader {
+    const uint8_t* data;
+    size_t length;
+    size_t offset = 0;
+    bool ok = true;
+    
+    bool need(size_t count) {
+        if (ok && length - offset < count) {
+            ok = false;
+        }
+        return ok;
+    }
+    uint8_t u8() {
+        return need(1) ? data[offset++] : 0;
+    }
+    uint32_t u32() {
+        uint32_t value = 0;
+        if (need(4)) {
+            for (int i = 0; i < 4; ++i) {
+                value |= static_cast<uint32_t>(data[offset++]) << (8 * i);
+            }
+        }
+        return value;
+    }
+    uint64_t u64() {
+        uint64_t value = 0;
+        if (need(8)) {
+            for (int i = 0; i < 8; ++i) {
+                value |= static_cast<uint64_t>(data[offset++]) << (8 * i);
+            }
+        }
+        return value;
+    }
+    int64_t i64() { return static_cast<int64_t>(u64()); }
+    float f32() {
+        uint32_t bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    std::string str8() {
+        size_t len = u8();
+        if (!need(len)) {
+            return std::string();
+        }
+        std::string value(reinterpret_cast<const char*>(data + offset), len);
+        offset += len;
+        return value;
+    }
+};
+
+void encode_sensor_state(const SensorData& sensor, std::chrono::steady_clock::time_point now,
+                         int64_t wall_ms, std::string& out) {
+    out.clear();
+    put_u64(out, static_cast<uint64_t>(wall_ms));
+    put_str8(out, sensor.sensor_id);
+    put_str8(out, sensor.location);
+    put_f32(out, sensor.temperature);
+    put_f32(out, sensor.humidity);
+    put_f32(out, sensor.temp_rate);
+    put_u8(out, sensor.is_active ? 1 : 0);
+    put_age(out, now, sensor.last_update);
+    put_u8(out, sensor.alerted);
+    for (const auto& time : sensor.last_alert) {
+        put_age(out, now, time);
+    }
+    
+    const auto& history = sensor.history;
+    put_u32(out, static_cast<uint32_t>(history.size()));
+    for (size_t i = 0; i < history.size(); ++i) {
+        put_age(out, now, history.timestamp(i));
+        put_f32(out, history.value<SensorData::TEMPERATURE>(i));
+        put_f32(out, history.value<SensorData::HUMIDITY>(i));
+    }
+}
+
+// Keeps the newest history_size samples and rebuilds the windowed stats from them
+bool decode_sensor_state(const uint8_t* data, size_t length, std::chrono::steady_clock::time_point now,
+                         int64_t wall_ms, size_t history_size, SensorData& sensor) {
+    Reader in{data, length};
+    int64_t down_ms = std::max<int64_t>(0, wall_ms - in.i64());
+    auto rebase = [now, down_ms](int64_t age) {
+        return now - std::chrono::milliseconds(down_ms) -
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(age));
+    };
+    
+    sensor.sensor_id = in.str8();
+    sensor.location = in.str8();
+    sensor.temperature = in.f32();
+    sensor.humidity = in.f32();
+    sensor.temp_rate = in.f32();
+    sensor.is_active = in.u8() != 0;
+    sensor.last_update = rebase(in.i64());
+    sensor.alerted = in.u8();
+    for (auto& time : sensor.last_alert) {
+        time = rebase(in.i64());
+    }
+    
+    uint32_t count = in.u32();
+    if (!in.ok || sensor.sensor_id.empty() || !in.need(static_cast<size_t>(count) * SENSOR_STATE_SAMPLE_SIZE)) {
+        return false;
+    }
+    
+    sensor.history.reset(history_size);
+    sensor.temperature_stats.reset(history_size);
+    size_t skip = count > history_size ? count - history_size : 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        int64_t age = in.i64();
+        float temperature = in.f32();
+        float humidity = in.f32();
+        if (i < skip) {
+            continue;
+        }
+        sensor.temperature_stats.add(temperature);
+        sensor.history.push(rebase(age), temperature, humidity);
+    }
+    return in.ok;
+}
+
+} // namespace
+
 //=============================================================================
 // ThermalIsolationTracker Implementation
 //=============================================================================
 
-ThermalIsolationTracker::ThermalIsolationTracker(const ThermalConfig& config) 
-    : config_(config), running_(false) {
-    std::cout << "🌡️  ThermalIsolationTracker initialized with " << config_.sensor_locations.size() << " locations" << std::endl;
+ThermalIsolationTracker::ThermalIsolationTracker(const ThermalConfig& config, std::shared_ptr<Clock> clock) 
+    : config_(config), clock_(clock ? std::move(clock) : Clock::steady()), running_(false),
+      // Offline once a whole minute past the timeout has gone without a reading
+      offline_after_(std::chrono::minutes(config.sensor_timeout_minutes + 1)),
+      throttle_after_(std::chrono::minutes(config.alert_throttle_minutes)) {
+    size_t shard_count = std::max<size_t>(1, config_.sensor_shards);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<SensorShard>());
+    }
+    intern("");     // Handle 0: no location
+    alert_journal_.resize(std::max<size_t>(1, config_.max_alerts_history));
+    
+    last_state_snapshot_ = clock_->now();
+    if (!config_.state_snapshot_path.empty()) {
+        size_t history_size = std::max<size_t>(1, config_.history_size);
+        state_store_ = std::make_unique<StateSnapshotFile>(config_.state_snapshot_path, SENSOR_STATE_SCHEMA,
+                                                           max_sensor_state_size(history_size));
+        if (state_store_->open()) {
+            restore_state_snapshot();
+        } else {
+            state_store_.reset();
+        }
+    }
+    THERMAL_LOG_INFO << "🌡️  ThermalIsolationTracker initialized with " << config_.sensor_locations.size() << " locations";
 }
 
 ThermalIsolationTracker::~ThermalIsolationTracker() {
     stop();
+    save_state_snapshot();
 }
 
 bool ThermalIsolationTracker::start() {
     if (running_.load()) {
-        std::cout << "⚠️  ThermalIsolationTracker already running" << std::endl;
+        THERMAL_LOG_WARN << "⚠️  ThermalIsolationTracker already running";
         return false;
     }
     
     running_ = true;
+    last_status_ = clock_->now();
     
     // Start monitoring thread
     monitor_thread_ = std::thread(&ThermalIsolationTracker::monitoring_loop, this);
     
-    std::cout << "🚀 ThermalIsolationTracker started" << std::endl;
+    THERMAL_LOG_INFO << "🚀 ThermalIsolationTracker started";
     return true;
 }
 
 void ThermalIsolationTracker::stop() {
     if (running_.load()) {
         running_ = false;
+        clock_->wake_sleepers();
         if (monitor_thread_.joinable()) {
             monitor_thread_.join();
         }
-        std::cout << "🛑 ThermalIsolationTracker stopped" << std::endl;
+        save_state_snapshot();
+        THERMAL_LOG_INFO << "🛑 ThermalIsolationTracker stopped";
     }
 }
 
+size_t ThermalIsolationTracker::shard_index(const std::string& sensor_id) const {
+    return std::hash<std::string>{}(sensor_id) % shards_.size();
+}
+
+ThermalIsolationTracker::SensorShard& ThermalIsolationTracker::shard_for(const std::string& sensor_id) const {
+    return *shards_[shard_index(sensor_id)];
+}
+
 bool ThermalIsolationTracker::process_sensor_data(const std::string& sensor_id, 
                                                  float temperature, 
                                                  float humidity,
                                                  const std::string& location) {
-    std::lock_guard<std::mutex> lock(sensors_mutex_);
+    SensorShard& shard = shard_for(sensor_id);
+    std::string sensor_location;
+    const bool log_reading = Log::enabled(LogLevel::DEBUG);
+    float temp_rate;
     
-    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        SensorData& sensor = update_sensor(shard, sensor_id, temperature, humidity, location, clock_->now());
+        temp_rate = sensor.temp_rate;
+        
+        // Check thresholds; resulting alerts are only queued here
+        uint8_t bits = threshold_bits(temperature, humidity, temp_rate);
+        if (bits) {
+            raise_threshold_alerts(sensor, bits, temperature, humidity, temp_rate);
+        }
+        
+        if (log_reading) {
+            sensor_location = sensor.location;
+        }
+    }
+    
+    if (log_reading) {
+        LogRecord record(LogLevel::DEBUG);
+        record.stream() << "📊 [" << sensor_id << "] Temp: " << std::fixed << std::setprecision(1) 
+                        << temperature << "°C, Humidity: " << humidity << "%, Location: " << sensor_location;
+        if (temp_rate != 0.0f) {
+            record.stream() << ", Rate: " << std::setprecision(2) << temp_rate << "°C/min";
+        }
+    }
+    
+    dispatch_pending_alerts();
+    
+    return true;
+}
+
+namespace {
+
+// Per-thread working set of process_sensor_batch(), reused across calls
+// so a steady stream of batches does not allocate
+struct BatchScratch {
+    std::vector<uint32_t> shard_of;         // Shard index per reading
+    std::vector<uint32_t> shard_start;      // Counting-sort offsets: shard s is [start[s], start[s+1])
+    std::vector<uint32_t> cursor;           // Next free position per shard while sorting
+    std::vector<uint32_t> order;            // Reading indices grouped by shard, batch order kept
+    
+    // Columns for the shard being processed
+    std::vector<SensorData*> slots;
+    std::vector<float> temperature;
+    std::vector<float> humidity;
+    std::vector<float> temp_rate;
+    std::vector<uint8_t> bits;
+};
+
+} // namespace
+
+size_t ThermalIsolationTracker::process_sensor_batch(const SensorReading* readings, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    
+    thread_local BatchScratch scratch;
+    const size_t shard_count = shards_.size();
+    
+    // Group readings by shard (stable counting sort) so each lock is taken once
+    scratch.shard_of.resize(count);
+    scratch.shard_start.assign(shard_count + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t index = static_cast<uint32_t>(shard_index(readings[i].sensor_id));
+        scratch.shard_of[i] = index;
+        scratch.shard_start[index + 1]++;
+    }
+    for (size_t s = 0; s < shard_count; ++s) {
+        scratch.shard_start[s + 1] += scratch.shard_start[s];
+    }
+    scratch.order.resize(count);
+    scratch.cursor.assign(scratch.shard_start.begin(), scratch.shard_start.end() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        scratch.order[scratch.cursor[scratch.shard_of[i]]++] = static_cast<uint32_t>(i);
+    }
+    
+    const float temp_min = config_.temp_min;
+    const float temp_max = config_.temp_max;
+    const float humidity_max = config_.humidity_max;
+    const float rate_limit = config_.temp_rate_limit;
+    auto now = clock_->now();
+    size_t shards_touched = 0;
+    
+    for (size_t s = 0; s < shard_count; ++s) {
+        const size_t begin = scratch.shard_start[s];
+        const size_t n = scratch.shard_start[s + 1] - begin;
+        if (n == 0) {
+            continue;
+        }
+        shards_touched++;
+        
+        scratch.slots.resize(n);
+        scratch.temperature.resize(n);
+        scratch.humidity.resize(n);
+        scratch.temp_rate.resize(n);
+        scratch.bits.resize(n);
+        float* temperature = scratch.temperature.data();
+        float* humidity = scratch.humidity.data();
+        float* temp_rate = scratch.temp_rate.data();
+        uint8_t* bits = scratch.bits.data();
+        
+        SensorShard& shard = *shards_[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        // Resolve each sensor once and apply its reading
+        for (size_t j = 0; j < n; ++j) {
+            const SensorReading& reading = readings[scratch.order[begin + j]];
+            SensorData& sensor = update_sensor(shard, reading.sensor_id, reading.temperature,
+                                               reading.humidity, reading.location, now);
+            scratch.slots[j] = &sensor;
+            temperature[j] = reading.temperature;
+            humidity[j] = reading.humidity;
+            temp_rate[j] = sensor.temp_rate;
+        }
+        
+        // Branch-free over the columns so the compiler can vectorise it;
+        // same rules as threshold_bits()
+        uint8_t any = 0;
+        for (size_t j = 0; j < n; ++j) {
+            const bool too_low = temperature[j] < temp_min;
+            const bool too_high = !too_low & (temperature[j] > temp_max);
+            const bool too_humid = humidity[j] > humidity_max;
+            const bool too_fast = std::fabs(temp_rate[j]) > rate_limit;
+            const bool rising = temp_rate[j] > 0.0f;
+            bits[j] = static_cast<uint8_t>((too_low << static_cast<unsigned>(AlertType::TEMP_TOO_LOW)) |
+                                           (too_high << static_cast<unsigned>(AlertType::TEMP_TOO_HIGH)) |
+                                           (too_humid << static_cast<unsigned>(AlertType::HUMIDITY_TOO_HIGH)) |
+                                           ((too_fast & rising) << static_cast<unsigned>(AlertType::TEMP_RISING_FAST)) |
+                                           ((too_fast & !rising) << static_cast<unsigned>(AlertType::TEMP_FALLING_FAST)));
+            any |= bits[j];
+        }
+        if (!any) {
+            continue;
+        }
+        
+        for (size_t j = 0; j < n; ++j) {
+            if (bits[j]) {
+                raise_threshold_alerts(*scratch.slots[j], bits[j], temperature[j], humidity[j], temp_rate[j]);
+            }
+        }
+    }
     
+    THERMAL_LOG_DEBUG << "📊 Batch of " << count << " readings across " << shards_touched << " shards";
+    
+    dispatch_pending_alerts();
+    
+    return count;
+}
+
+SensorData& ThermalIsolationTracker::update_sensor(
+        SensorShard& shard, const std::string& sensor_id, float temperature, float humidity,
+        const std::string& location, std::chrono::steady_clock::time_point now) {
+    // Caller holds shard.mutex
     // Create or update sensor data
-    SensorData& sensor = sensors_[sensor_id];
+    SensorData& sensor = shard.sensors[sensor_id];
     
     // Store previous values for rate calculation
     float prev_temp = sensor.temperature;
     auto prev_time = sensor.last_update;
     
-    // Update sensor data
-    sensor.sensor_id = sensor_id;
+    // Update sensor data; names are interned when they first appear
+    if (sensor.sensor_id.empty()) {
+        sensor.sensor_id = sensor_id;
+        sensor.id_handle = intern(sensor_id);
+    }
     sensor.temperature = temperature;
     sensor.humidity = humidity;
-    sensor.location = location.empty() ? get_sensor_location(sensor_id) : location;
+    // Readings without a location fall back to the configured one each
+    // time; the handle is only re-interned when the location changes
+    std::string configured;
+    const std::string& current = location.empty() ? (configured = get_sensor_location(sensor_id)) : location;
+    if (current != sensor.location) {
+        sensor.location = current;
+        sensor.location_handle = intern(sensor.location);
+    }
     sensor.last_update = now;
-    sensor.is_active = true;
+    
+    // Was-active sensors already have a heap entry; the later
+    // last_update alone moves their deadline forward
+    if (sensor.is_active) {
+        shard.active_temperature_sum += static_cast<double>(temperature) - prev_temp;
+    } else {
+        sensor.is_active = true;
+        shard.active_sensors++;
+        shard.active_temperature_sum += temperature;
+        shard.offline_heap.push_back({now + offline_after_, &sensor});
+        std::push_heap(shard.offline_heap.begin(), shard.offline_heap.end(), std::greater<>());
+    }
     
     // Calculate temperature rate of change
     if (prev_time != std::chrono::steady_clock::time_point{}) {
@@ -77,111 +474,175 @@ bool ThermalIsolationTracker::process_sensor_data(const std::string& sensor_id,
     }
     
     // Add to history
-    sensor.temperature_history.push_back({temperature, now});
-    if (sensor.temperature_history.size() > config_.history_size) {
-        sensor.temperature_history.pop_front();
-    }
-    
-    sensor.humidity_history.push_back({humidity, now});
-    if (sensor.humidity_history.size() > config_.history_size) {
-        sensor.humidity_history.pop_front();
+    if (sensor.history.capacity() == 0) {
+        sensor.history.reset(std::max<size_t>(1, config_.history_size));
+        sensor.temperature_stats.reset(sensor.history.capacity());
     }
-    
-    std::cout << "📊 [" << sensor_id << "] Temp: " << std::fixed << std::setprecision(1) 
-              << temperature << "°C, Humidity: " << humidity << "%, Location: " << sensor.location;
-    
-    if (sensor.temp_rate != 0.0f) {
-        std::cout << ", Rate: " << std::setprecision(2) << sensor.temp_rate << "°C/min";
+    if (sensor.history.full()) {
+        sensor.temperature_stats.remove_oldest(sensor.history.value<SensorData::TEMPERATURE>(0));
     }
-    std::cout << std::endl;
-    
-    // Check thresholds
-    check_thresholds(sensor_id, sensor);
+    sensor.history.push(now, temperature, humidity);
+    sensor.temperature_stats.add(temperature);
     
-    return true;
+    mark_state_dirty(shard, sensor);
+    return sensor;
 }
 
-void ThermalIsolationTracker::check_thresholds(const std::string& sensor_id, const SensorData& sensor) {
-    std::vector<AlertType> alerts;
+uint8_t ThermalIsolationTracker::threshold_bits(float temperature, float humidity, float temp_rate) const {
+    // Offline is not a threshold: it is detected from the deadline heaps
+    uint8_t bits = 0;
     
     // Temperature thresholds
-    if (sensor.temperature < config_.temp_min) {
-        alerts.push_back(AlertType::TEMP_TOO_LOW);
-    } else if (sensor.temperature > config_.temp_max) {
-        alerts.push_back(AlertType::TEMP_TOO_HIGH);
+    if (temperature < config_.temp_min) {
+        bits |= alert_bit(AlertType::TEMP_TOO_LOW);
+    } else if (temperature > config_.temp_max) {
+        bits |= alert_bit(AlertType::TEMP_TOO_HIGH);
     }
     
     // Humidity threshold
-    if (sensor.humidity > config_.humidity_max) {
-        alerts.push_back(AlertType::HUMIDITY_TOO_HIGH);
+    if (humidity > config_.humidity_max) {
+        bits |= alert_bit(AlertType::HUMIDITY_TOO_HIGH);
     }
     
     // Temperature rate of change
-    if (std::abs(sensor.temp_rate) > config_.temp_rate_limit) {
-        if (sensor.temp_rate > 0) {
-            alerts.push_back(AlertType::TEMP_RISING_FAST);
-        } else {
-            alerts.push_back(AlertType::TEMP_FALLING_FAST);
-        }
-    }
-    
-    // Sensor offline check
-    auto now = std::chrono::steady_clock::now();
-    auto time_since_update = std::chrono::duration_cast<std::chrono::minutes>(now - sensor.last_update);
-    if (time_since_update.count() > config_.sensor_timeout_minutes) {
-        alerts.push_back(AlertType::SENSOR_OFFLINE);
+    if (std::abs(temp_rate) > config_.temp_rate_limit) {
+        bits |= alert_bit(temp_rate > 0 ? AlertType::TEMP_RISING_FAST : AlertType::TEMP_FALLING_FAST);
     }
     
-    // Generate alerts
-    for (AlertType alert : alerts) {
-        generate_alert(sensor_id, alert, sensor);
+    return bits;
+}
+
+void ThermalIsolationTracker::raise_threshold_alerts(SensorData& sensor, uint8_t bits,
+                                                     float temperature, float humidity, float temp_rate) {
+    // Caller holds the sensor's shard mutex
+    for (size_t type = 0; type < ALERT_TYPE_COUNT; ++type) {
+        if (bits & (1u << type)) {
+            generate_alert(sensor, static_cast<AlertType>(type), temperature, humidity, temp_rate);
+        }
     }
 }
 
-void ThermalIsolationTracker::generate_alert(const std::string& sensor_id, 
+void ThermalIsolationTracker::generate_alert(SensorData& sensor,
                                            AlertType alert_type, 
-                                           const SensorData& sensor) {
+                                           float temperature,
+                                           float humidity,
+                                           float temp_rate) {
+    // Caller holds the sensor's shard mutex
+    auto now = clock_->now();
+    
     // Check if we should throttle this alert
-    if (should_throttle_alert(sensor_id, alert_type)) {
+    if (should_throttle_alert(sensor, alert_type, now)) {
         return;
     }
     
-    Alert alert;
-    alert.sensor_id = sensor_id;
-    alert.alert_type = alert_type;
-    alert.location = sensor.location;
-    alert.timestamp = std::chrono::steady_clock::now();
-    alert.temperature = sensor.temperature;
-    alert.humidity = sensor.humidity;
-    alert.temp_rate = sensor.temp_rate;
-    
-    // Set alert message
-    alert.message = format_alert_message(alert);
-    
-    // Store alert
+    AlertRecord record;
+    record.timestamp = now;
+    record.sensor = sensor.id_handle;
+    record.location = sensor.location_handle;
+    record.alert_type = alert_type;
+    record.temperature = temperature;
+    record.humidity = humidity;
+    record.temp_rate = temp_rate;
+    
+    // Journal the record; the oldest is overwritten once the ring is full
     {
         std::lock_guard<std::mutex> lock(alerts_mutex_);
-        recent_alerts_.push_back(alert);
-        if (recent_alerts_.size() > config_.max_alerts_history) {
-            recent_alerts_.pop_front();
-        }
+        alert_journal_[alerts_journaled_ % alert_journal_.size()] = record;
+        alerts_journaled_++;
     }
     
     // Update alert throttling
-    alert_throttle_[sensor_id][alert_type] = alert.timestamp;
+    sensor.alerted |= alert_bit(alert_type);
+    sensor.last_alert[static_cast<size_t>(alert_type)] = now;
     
-    // Print alert
-    std::cout << "🚨 ALERT [" << sensor_id << "] " << alert.message << std::endl;
-    
-    // Call alert callback if set
-    if (alert_callback_) {
-        alert_callback_(alert);
+    // Hand over to the dispatcher; rendering, printing and callbacks happen unlocked
+    {
+        std::lock_guard<std::mutex> lock(alert_queue_mutex_);
+        alert_queue_.push_back(record);
     }
 }
 
-std::string ThermalIsolationTracker::format_alert_message(const Alert& alert) {
-    std::stringstream ss;
+void ThermalIsolationTracker::dispatch_pending_alerts() {
+    while (true) {
+        {
+            // Whoever holds the dispatcher role drains alerts queued by
+            // every other thread, which keeps callbacks serialised
+            std::unique_lock<std::mutex> dispatch(dispatch_mutex_, std::try_to_lock);
+            if (!dispatch.owns_lock()) {
+                return;
+            }
+            
+            while (true) {
+                std::vector<AlertRecord> batch;
+                {
+                    std::lock_guard<std::mutex> lock(alert_queue_mutex_);
+                    if (alert_queue_.empty()) break;
+                    batch.swap(alert_queue_);
+                }
+                
+                for (const AlertRecord& record : batch) {
+                    // Print alert, rendered straight into the log line
+                    if (Log::enabled(LogLevel::INFO)) {
+                        LogRecord line(LogLevel::INFO);
+                        line.stream() << "🚨 ALERT [" << name_of(record.sensor) << "] ";
+                        write_alert_message(line.stream(), record);
+                    }
+                    
+                    // Call alert callbacks if set
+                    if (alert_record_callback_) {
+                        alert_record_callback_(record);
+                    }
+                    if (alert_callback_) {
+                        alert_callback_(materialize(record));
+                    }
+                }
+            }
+        }
+        
+        // An alert queued while we were releasing the dispatcher role would
+        // otherwise wait for the next reading
+        std::lock_guard<std::mutex> lock(alert_queue_mutex_);
+        if (alert_queue_.empty()) {
+            return;
+        }
+    }
+}
+
+uint32_t ThermalIsolationTracker::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    auto it = name_handles_.find(name);
+    if (it != name_handles_.end()) {
+        return it->second;
+    }
+    uint32_t handle = static_cast<uint32_t>(names_.size());
+    names_.push_back(name);
+    name_handles_.emplace(names_.back(), handle);
+    return handle;
+}
+
+std::string_view ThermalIsolationTracker::name_of(uint32_t handle) const {
+    // deque::push_back never moves existing elements, so the view outlives the lock
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    return handle < names_.size() ? std::string_view(names_[handle]) : std::string_view();
+}
+
+Alert ThermalIsolationTracker::materialize(const AlertRecord& record) const {
+    Alert alert;
+    alert.sensor_id = std::string(name_of(record.sensor));
+    alert.alert_type = record.alert_type;
+    alert.location = std::string(name_of(record.location));
+    alert.timestamp = record.timestamp;
+    alert.temperature = record.temperature;
+    alert.humidity = record.humidity;
+    alert.temp_rate = record.temp_rate;
     
+    std::ostringstream message;
+    write_alert_message(message, record);
+    alert.message = message.str();
+    return alert;
+}
+
+void ThermalIsolationTracker::write_alert_message(std::ostream& ss, const AlertRecord& alert) const {
     switch (alert.alert_type) {
         case AlertType::TEMP_TOO_LOW:
             ss << "Temperature too low: " << std::fixed << std::setprecision(1) 
@@ -208,25 +669,19 @@ std::string ThermalIsolationTracker::format_alert_message(const Alert& alert) {
             break;
     }
     
-    if (!alert.location.empty()) {
-        ss << " in " << alert.location;
+    std::string_view location = name_of(alert.location);
+    if (!location.empty()) {
+        ss << " in " << location;
     }
-    
-    return ss.str();
 }
 
-bool ThermalIsolationTracker::should_throttle_alert(const std::string& sensor_id, AlertType alert_type) {
-    auto& sensor_throttle = alert_throttle_[sensor_id];
-    auto it = sensor_throttle.find(alert_type);
-    
-    if (it == sensor_throttle.end()) {
+bool ThermalIsolationTracker::should_throttle_alert(const SensorData& sensor, AlertType alert_type,
+                                                    std::chrono::steady_clock::time_point now) const {
+    if (!(sensor.alerted & alert_bit(alert_type))) {
         return false; // First alert of this type
     }
     
-    auto now = std::chrono::steady_clock::now();
-    auto time_since_last = std::chrono::duration_cast<std::chrono::minutes>(now - it->second);
-    
-    return time_since_last.count() < config_.alert_throttle_minutes;
+    return now - sensor.last_alert[static_cast<size_t>(alert_type)] < throttle_after_;
 }
 
 std::string ThermalIsolationTracker::get_sensor_location(const std::string& sensor_id) {
@@ -238,35 +693,89 @@ std::string ThermalIsolationTracker::get_sensor_location(const std::string& sens
 }
 
 std::vector<SensorData> ThermalIsolationTracker::get_all_sensors() const {
-    std::lock_guard<std::mutex> lock(sensors_mutex_);
-    
+    // Full copy including histories; prefer get_snapshot() for dashboards
     std::vector<SensorData> result;
-    for (const auto& pair : sensors_) {
-        result.push_back(pair.second);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& pair : shard->sensors) {
+            result.push_back(pair.second);
+        }
     }
     
     return result;
 }
 
+std::shared_ptr<const TrackerSnapshot> ThermalIsolationTracker::get_snapshot() const {
+    auto max_age = std::chrono::milliseconds(config_.snapshot_max_age_ms);
+    
+    // Fast path: readers share the published snapshot without locking
+    auto current = std::atomic_load(&snapshot_);
+    if (current && clock_->now() - current->taken_at <= max_age) {
+        return current;
+    }
+    
+    // One reader rebuilds, the others pick up its result
+    std::lock_guard<std::mutex> rebuild(snapshot_rebuild_mutex_);
+    current = std::atomic_load(&snapshot_);
+    if (current && clock_->now() - current->taken_at <= max_age) {
+        return current;
+    }
+    
+    auto snapshot = std::make_shared<TrackerSnapshot>();
+    float total_temp = 0.0f;
+    for (const auto& shard : shards_) {
+        // Each shard is held only while its summaries are copied
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& pair : shard->sensors) {
+            const SensorData& sensor = pair.second;
+            snapshot->sensors.push_back({sensor.sensor_id, sensor.location, sensor.temperature,
+                                         sensor.humidity, sensor.temp_rate, sensor.is_active,
+                                         sensor.last_update});
+            if (sensor.is_active) {
+                snapshot->active_sensors++;
+                total_temp += sensor.temperature;
+            }
+        }
+    }
+    if (snapshot->active_sensors > 0) {
+        snapshot->avg_temperature = total_temp / snapshot->active_sensors;
+    }
+    snapshot->taken_at = clock_->now();
+    
+    std::shared_ptr<const TrackerSnapshot> published = std::move(snapshot);
+    std::atomic_store(&snapshot_, published);
+    return published;
+}
+
 std::vector<Alert> ThermalIsolationTracker::get_recent_alerts(int count) const {
-    std::lock_guard<std::mutex> lock(alerts_mutex_);
+    // Copy the records out, then render them without holding the journal
+    std::vector<AlertRecord> records;
+    {
+        std::lock_guard<std::mutex> lock(alerts_mutex_);
+        uint64_t stored = std::min<uint64_t>(alerts_journaled_, alert_journal_.size());
+        uint64_t wanted = std::min<uint64_t>(stored, static_cast<uint64_t>(std::max(0, count)));
+        records.reserve(wanted);
+        for (uint64_t i = alerts_journaled_ - wanted; i < alerts_journaled_; ++i) {
+            records.push_back(alert_journal_[i % alert_journal_.size()]);
+        }
+    }
     
     std::vector<Alert> result;
-    int start = std::max(0, static_cast<int>(recent_alerts_.size()) - count);
-    
-    for (int i = start; i < static_cast<int>(recent_alerts_.size()); ++i) {
-        result.push_back(recent_alerts_[i]);
+    result.reserve(records.size());
+    for (const AlertRecord& record : records) {
+        result.push_back(materialize(record));
     }
     
     return result;
 }
 
 SensorStats ThermalIsolationTracker::get_sensor_stats(const std::string& sensor_id) const {
-    std::lock_guard<std::mutex> lock(sensors_mutex_);
+    SensorShard& shard = shard_for(sensor_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     
     SensorStats stats = {};
-    auto it = sensors_.find(sensor_id);
-    if (it == sensors_.end()) {
+    auto it = shard.sensors.find(sensor_id);
+    if (it == shard.sensors.end()) {
         return stats;
     }
     
@@ -276,24 +785,19 @@ SensorStats ThermalIsolationTracker::get_sensor_stats(const std::string& sensor_
     stats.current_humidity = sensor.humidity;
     stats.location = sensor.location;
     
-    // Calculate statistics from history
-    if (!sensor.temperature_history.empty()) {
-        float sum = 0, min_temp = sensor.temperature_history[0].value, max_temp = min_temp;
-        
-        for (const auto& reading : sensor.temperature_history) {
-            sum += reading.value;
-            min_temp = std::min(min_temp, reading.value);
-            max_temp = std::max(max_temp, reading.value);
-        }
-        
-        stats.avg_temp = sum / sensor.temperature_history.size();
-        stats.min_temp = min_temp;
-        stats.max_temp = max_temp;
+    // Windowed statistics are maintained incrementally on ingestion
+    const WindowedStats& temp_stats = sensor.temperature_stats;
+    if (temp_stats.count() > 0) {
+        stats.avg_temp = static_cast<float>(temp_stats.mean());
+        stats.min_temp = static_cast<float>(temp_stats.min());
+        stats.max_temp = static_cast<float>(temp_stats.max());
+        stats.temp_stddev = static_cast<float>(temp_stats.stddev());
+        stats.temp_trend = static_cast<float>(temp_stats.slope());
     }
     
     // Calculate uptime
     if (sensor.last_update != std::chrono::steady_clock::time_point{}) {
-        auto now = std::chrono::steady_clock::now();
+        auto now = clock_->now();
         stats.uptime_minutes = std::chrono::duration_cast<std::chrono::minutes>(
             now - sensor.last_update).count();
     }
@@ -302,66 +806,182 @@ SensorStats ThermalIsolationTracker::get_sensor_stats(const std::string& sensor_
 }
 
 void ThermalIsolationTracker::monitoring_loop() {
-    std::cout << "🔄 ThermalIsolationTracker monitoring loop started" << std::endl;
+    THERMAL_LOG_INFO << "🔄 ThermalIsolationTracker monitoring loop started";
     
     while (running_.load()) {
-        // Check for offline sensors
-        check_offline_sensors();
-        
-        // Print status every 30 seconds
-        static auto last_status = std::chrono::steady_clock::now();
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::seconds>(now - last_status).count() >= 30) {
-            print_status();
-            last_status = now;
-        }
-        
-        std::this_thread::sleep_for(std::chrono::seconds(5));
+        run_maintenance();
+        clock_->sleep_for(std::chrono::seconds(5));
     }
     
-    std::cout << "🏁 ThermalIsolationTracker monitoring loop finished" << std::endl;
+    THERMAL_LOG_INFO << "🏁 ThermalIsolationTracker monitoring loop finished";
 }
 
-void ThermalIsolationTracker::check_offline_sensors() {
-    std::lock_guard<std::mutex> lock(sensors_mutex_);
+void ThermalIsolationTracker::run_maintenance() {
+    // Check for offline sensors
+    check_offline_sensors();
     
-    auto now = std::chrono::steady_clock::now();
+    // Print status every 30 seconds
+    auto now = clock_->now();
+    if (std::chrono::duration_cast<std::chrono::seconds>(now - last_status_).count() >= 30) {
+        print_status();
+        last_status_ = now;
+    }
+    
+    // Persist what changed since the last pass for a warm restart
+    if (state_store_ && now - last_state_snapshot_ >= std::chrono::milliseconds(config_.state_snapshot_interval_ms)) {
+        save_state_snapshot();
+    }
+}
+
+void ThermalIsolationTracker::check_offline_sensors() {
+    auto now = clock_->now();
     
-    for (auto& pair : sensors_) {
-        const std::string& sensor_id = pair.first;
-        SensorData& sensor = pair.second;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        auto& heap = shard->offline_heap;
         
-        if (sensor.is_active) {
-            auto time_since_update = std::chrono::duration_cast<std::chrono::minutes>(
-                now - sensor.last_update);
+        // Only entries whose (possibly stale) deadline has passed are touched
+        while (!heap.empty() && heap.front().deadline <= now) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+            SensorData& sensor = *heap.back().sensor;
+            
+            auto deadline = sensor.last_update + offline_after_;
+            if (deadline > now) {
+                // Heard from since the entry was scheduled
+                heap.back().deadline = deadline;
+                std::push_heap(heap.begin(), heap.end(), std::greater<>());
+                continue;
+            }
+            heap.pop_back();
             
-            if (time_since_update.count() > config_.sensor_timeout_minutes) {
-                sensor.is_active = false;
-                generate_alert(sensor_id, AlertType::SENSOR_OFFLINE, sensor);
+            sensor.is_active = false;
+            shard->active_sensors--;
+            shard->active_temperature_sum -= sensor.temperature;
+            if (shard->active_sensors == 0) {
+                shard->active_temperature_sum = 0.0;  // Drop accumulated rounding error
             }
+            generate_alert(sensor, AlertType::SENSOR_OFFLINE, sensor.temperature, sensor.humidity, sensor.temp_rate);
+            mark_state_dirty(*shard, sensor);
         }
     }
+    
+    dispatch_pending_alerts();
 }
 
-void ThermalIsolationTracker::print_status() {
-    std::lock_guard<std::mutex> lock(sensors_mutex_);
+void ThermalIsolationTracker::mark_state_dirty(SensorShard& shard, SensorData& sensor) {
+    // Caller holds shard.mutex
+    if (state_store_ && !sensor.state_dirty) {
+        sensor.state_dirty = true;
+        shard.state_dirty.push_back(&sensor);
+    }
+}
+
+void ThermalIsolationTracker::save_state_snapshot() {
+    if (!state_store_) {
+        return;
+    }
     
-    int active_sensors = 0;
-    float total_temp = 0.0f;
+    std::lock_guard<std::mutex> pass(state_snapshot_mutex_);
+    auto now = clock_->now();
+    int64_t wall_ms = wall_clock_ms();
+    size_t saved = 0;
     
-    for (const auto& pair : sensors_) {
-        if (pair.second.is_active) {
-            active_sensors++;
-            total_temp += pair.second.temperature;
+    for (const auto& shard : shards_) {
+        // Encode under the shard lock, copy into the mapping after releasing it
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            for (SensorData* sensor : shard->state_dirty) {
+                if (count == state_batch_.size()) {
+                    state_batch_.emplace_back();
+                }
+                state_batch_[count].first = sensor->sensor_id;
+                encode_sensor_state(*sensor, now, wall_ms, state_batch_[count].second);
+                sensor->state_dirty = false;
+                count++;
+            }
+            shard->state_dirty.clear();
+        }
+        
+        for (size_t i = 0; i < count; ++i) {
+            saved += state_store_->put(state_batch_[i].first, state_batch_[i].second);
+        }
+    }
+    
+    state_store_->sync();
+    last_state_snapshot_ = now;
+    if (saved > 0) {
+        THERMAL_LOG_DEBUG << "💾 Saved state of " << saved << " sensors to " << state_store_->path();
+    }
+}
+
+void ThermalIsolationTracker::restore_state_snapshot() {
+    auto started = std::chrono::steady_clock::now();
+    auto now = clock_->now();
+    int64_t wall_ms = wall_clock_ms();
+    size_t history_size = std::max<size_t>(1, config_.history_size);
+    size_t restored = 0;
+    std::vector<std::string> unreadable;
+    
+    state_store_->load([&](std::string_view key, const uint8_t* record, size_t length) {
+        SensorData sensor;
+        if (!decode_sensor_state(record, length, now, wall_ms, history_size, sensor) || sensor.sensor_id != key) {
+            unreadable.emplace_back(key);
+            return;
+        }
+        
+        SensorShard& shard = shard_for(sensor.sensor_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        SensorData& slot = shard.sensors[sensor.sensor_id];
+        slot = std::move(sensor);
+        slot.id_handle = intern(slot.sensor_id);
+        slot.location_handle = intern(slot.location);
+        
+        // Sensors that went quiet while we were down time out on the next check
+        if (slot.is_active) {
+            shard.active_sensors++;
+            shard.active_temperature_sum += slot.temperature;
+            shard.offline_heap.push_back({slot.last_update + offline_after_, &slot});
+            std::push_heap(shard.offline_heap.begin(), shard.offline_heap.end(), std::greater<>());
         }
+        restored++;
+    });
+    for (const std::string& key : unreadable) {
+        state_store_->erase(key);
+    }
+    if (restored == 0 && unreadable.empty()) {
+        return;
+    }
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+    THERMAL_LOG_INFO << "♻️  Restored " << restored << " sensors from " << state_store_->path() << " in "
+                     << std::fixed << std::setprecision(1) << elapsed.count() / 1000.0 << " ms"
+                     << (unreadable.empty() ? "" : ", " + std::to_string(unreadable.size()) + " unreadable");
+}
+
+TrackerTotals ThermalIsolationTracker::get_totals() const {
+    TrackerTotals totals;
+    double temperature_sum = 0.0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        totals.sensors += shard->sensors.size();
+        totals.active_sensors += shard->active_sensors;
+        temperature_sum += shard->active_temperature_sum;
+    }
+    if (totals.active_sensors > 0) {
+        totals.avg_temperature = static_cast<float>(temperature_sum / totals.active_sensors);
     }
+    return totals;
+}
+
+void ThermalIsolationTracker::print_status() {
+    TrackerTotals totals = get_totals();
     
-    if (active_sensors > 0) {
-        float avg_temp = total_temp / active_sensors;
-        std::cout << "📊 Status: " << active_sensors << " active sensors, "
-                  << "avg temp: " << std::fixed << std::setprecision(1) << avg_temp << "°C" << std::endl;
+    if (totals.active_sensors > 0) {
+        THERMAL_LOG_INFO << "📊 Status: " << totals.active_sensors << " active sensors, "
+                         << "avg temp: " << std::fixed << std::setprecision(1) << totals.avg_temperature << "°C";
     } else {
-        std::cout << "📊 Status: No active sensors" << std::endl;
+        THERMAL_LOG_INFO << "📊 Status: No active sensors";
     }
 }
 
@@ -369,27 +989,134 @@ void ThermalIsolationTracker::print_status() {
 // Message Parsing Utilities
 //=============================================================================
 
-std::optional<SensorReading> parse_sensor_message(const std::string& topic, const std::string& payload) {
+namespace {
+
+bool is_json_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+std::string_view trim_view(std::string_view text) {
+    while (!text.empty() && is_json_space(text.front())) text.remove_prefix(1);
+    while (!text.empty() && is_json_space(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+/**
+ * One pass over a flat JSON object, calling field(key, value, is_string)
+ * for every member. Values are raw views into the input (strings without
+ * their quotes, escapes left as-is); nested objects and arrays are skipped
+ */
+template <typename FieldFn>
+bool scan_json_object(std::string_view json, FieldFn&& field) {
+    size_t i = 0;
+    const size_t n = json.size();
+    auto skip_space = [&]() { while (i < n && is_json_space(json[i])) ++i; };
+    auto read_string = [&](std::string_view& out) {
+        // Called on the opening quote
+        size_t start = ++i;
+        while (i < n && json[i] != '"') {
+            i += (json[i] == '\\') ? 2 : 1;
+        }
+        if (i >= n) return false;
+        out = json.substr(start, i - start);
+        ++i;
+        return true;
+    };
+    
+    skip_space();
+    if (i >= n || json[i] != '{') return false;
+    ++i;
+    
+    while (true) {
+        skip_space();
+        if (i < n && json[i] == '}') return true;
+        
+        std::string_view key;
+        if (i >= n || json[i] != '"' || !read_string(key)) return false;
+        skip_space();
+        if (i >= n || json[i] != ':') return false;
+        ++i;
+        skip_space();
+        if (i >= n) return false;
+        
+        if (json[i] == '"') {
+            std::string_view value;
+            if (!read_string(value)) return false;
+            field(key, value, true);
+        } else if (json[i] == '{' || json[i] == '[') {
+            int depth = 0;
+            do {
+                if (json[i] == '"') {
+                    std::string_view ignored;
+                    if (!read_string(ignored)) return false;
+                    continue;
+                }
+                if (json[i] == '{' || json[i] == '[') ++depth;
+                else if (json[i] == '}' || json[i] == ']') --depth;
+                ++i;
+            } while (i < n && depth > 0);
+            if (depth > 0) return false;
+        } else {
+            size_t start = i;
+            while (i < n && json[i] != ',' && json[i] != '}' && !is_json_space(json[i])) ++i;
+            field(key, json.substr(start, i - start), false);
+        }
+        
+        skip_space();
+        if (i >= n) return false;
+        if (json[i] == ',') { ++i; continue; }
+        if (json[i] == '}') return true;
+        return false;
+    }
+}
+
+} // namespace
+
+bool parse_float(std::string_view text, float& value) {
+    text = trim_view(text);
+    if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+    if (text.empty()) return false;
+    
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+std::optional<SensorReading> parse_sensor_message(std::string_view topic, std::string_view payload) {
     SensorReading reading;
     
-    // Parse topic: sensors/{sensor_id}/{data_type}
-    std::vector<std::string> topic_parts = split_string(topic, '/');
-    if (topic_parts.size() < 3 || topic_parts[0] != "sensors") {
+    // Parse topic: sensors/{sensor_id}/{data_type}[/...], data_type is data, bin, temperature or humidity
+    constexpr std::string_view prefix = "sensors/";
+    if (topic.substr(0, prefix.size()) != prefix) {
         return std::nullopt;
     }
+    topic.remove_prefix(prefix.size());
     
-    reading.sensor_id = topic_parts[1];
-    std::string data_type = topic_parts[2];
+    size_t id_end = topic.find('/');
+    if (id_end == std::string_view::npos) {
+        return std::nullopt;
+    }
+    std::string_view data_type = topic.substr(id_end + 1);
+    data_type = data_type.substr(0, data_type.find('/'));
+    
+    reading.sensor_id.assign(topic.data(), id_end);
     
     if (data_type == "data") {
         // Parse JSON payload: {"temperature": 25.5, "humidity": 60.2, "location": "room1"}
         return parse_json_sensor_data(payload, reading);
+    } else if (data_type == "bin") {
+        // Packed binary reading (SensorWireFormat.h)
+        auto record = wire::decode_sensor_record(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+        if (!record) return std::nullopt;
+        reading.temperature = record->temperature;
+        reading.humidity = record->humidity;
+        reading.location = std::move(record->location);
+        return reading;
     } else if (data_type == "temperature") {
-        reading.temperature = std::stof(payload);
+        if (!parse_float(payload, reading.temperature)) return std::nullopt;
         reading.humidity = 0.0f; // Default
         return reading;
     } else if (data_type == "humidity") {
-        reading.humidity = std::stof(payload);
+        if (!parse_float(payload, reading.humidity)) return std::nullopt;
         reading.temperature = 0.0f; // Default
         return reading;
     }
@@ -397,38 +1124,52 @@ std::optional<SensorReading> parse_sensor_message(const std::string& topic, cons
     return std::nullopt;
 }
 
-std::optional<SensorReading> parse_json_sensor_data(const std::string& json_str, SensorReading& reading) {
-    // Simple JSON parser for sensor data
+std::optional<SensorReading> parse_sensor_message(std::string_view topic, const uint8_t* payload, size_t len) {
+    return parse_sensor_message(topic, std::string_view(reinterpret_cast<const char*>(payload), len));
+}
+
+std::optional<SensorReading> parse_json_sensor_data(std::string_view json_str, SensorReading& reading) {
     // Format: {"temperature": 25.5, "humidity": 60.2, "location": "room1"}
-    
-    try {
-        size_t temp_pos = json_str.find("\"temperature\":");
-        size_t hum_pos = json_str.find("\"humidity\":");
-        size_t loc_pos = json_str.find("\"location\":");
-        
-        if (temp_pos != std::string::npos) {
-            size_t start = json_str.find(':', temp_pos) + 1;
-            size_t end = json_str.find_first_of(",}", start);
-            reading.temperature = std::stof(json_str.substr(start, end - start));
+    bool valid = true;
+    bool ok = scan_json_object(json_str, [&](std::string_view key, std::string_view value, bool is_string) {
+        if (key == "temperature") {
+            valid = valid && !is_string && parse_float(value, reading.temperature);
+        } else if (key == "humidity") {
+            valid = valid && !is_string && parse_float(value, reading.humidity);
+        } else if (key == "location" && is_string) {
+            reading.location.assign(value.data(), value.size());
         }
-        
-        if (hum_pos != std::string::npos) {
-            size_t start = json_str.find(':', hum_pos) + 1;
-            size_t end = json_str.find_first_of(",}", start);
-            reading.humidity = std::stof(json_str.substr(start, end - start));
-        }
-        
-        if (loc_pos != std::string::npos) {
-            size_t start = json_str.find('"', json_str.find(':', loc_pos)) + 1;
-            size_t end = json_str.find('"', start);
-            reading.location = json_str.substr(start, end - start);
+    });
+    
+    if (!ok || !valid) {
+        return std::nullopt;
+    }
+    return reading;
+}
+
+std::optional<SensorReading> parse_client_sensor_message(std::string_view json_str) {
+    // Format: {"type": "sensor_data", "sensor_id": "...", "temperature": ..., ...}
+    SensorReading reading;
+    bool is_sensor_data = false;
+    bool valid = true;
+    bool ok = scan_json_object(json_str, [&](std::string_view key, std::string_view value, bool is_string) {
+        if (key == "type") {
+            is_sensor_data = is_string && value == "sensor_data";
+        } else if (key == "sensor_id" && is_string) {
+            reading.sensor_id.assign(value.data(), value.size());
+        } else if (key == "temperature") {
+            valid = valid && !is_string && parse_float(value, reading.temperature);
+        } else if (key == "humidity") {
+            valid = valid && !is_string && parse_float(value, reading.humidity);
+        } else if (key == "location" && is_string) {
+            reading.location.assign(value.data(), value.size());
         }
-        
-        return reading;
-    } catch (const std::exception& e) {
-        std::cerr << "❌ Error parsing JSON sensor data: " << e.what() << std::endl;
+    });
+    
+    if (!ok || !valid || !is_sensor_data) {
         return std::nullopt;
     }
+    return reading;
 }
 
 std::vector<std::string> split_string(const std::string& str, char delimiter) {
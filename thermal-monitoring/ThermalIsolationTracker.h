@@ -1,18 +1,28 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <deque>
 #include <chrono>
+#include <ostream>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <functional>
 #include <optional>
+#include <memory>
+#include "RingHistory.h"
+#include "RollingStats.h"
+#include "Clock.h"
 
 namespace thermal_monitoring {
 
+class StateSnapshotFile;
+
 /**
  * Alert types for temperature monitoring
  */
@@ -25,6 +35,13 @@ enum class AlertType {
     SENSOR_OFFLINE
 };
 
+constexpr size_t ALERT_TYPE_COUNT = 6;
+
+// One bit per AlertType in threshold masks and throttle state
+constexpr uint8_t alert_bit(AlertType type) {
+    return static_cast<uint8_t>(1u << static_cast<unsigned>(type));
+}
+
 /**
  * Configuration for thermal monitoring
  */
@@ -42,21 +59,21 @@ struct ThermalConfig {
     int alert_throttle_minutes = 5;
     
     // History settings
-    size_t history_size = 100;
+    size_t history_size = 100;              // Samples per sensor; 0 keeps just the latest
     size_t max_alerts_history = 1000;
     
+    // Concurrency settings
+    size_t sensor_shards = 32;              // Sensor map partitions, keyed by sensor id hash
+    int snapshot_max_age_ms = 500;          // How stale a shared read snapshot may get
+    
+    // Warm restart: per-sensor state kept in a memory-mapped file (StateSnapshot.h)
+    std::string state_snapshot_path;        // Empty disables
+    int state_snapshot_interval_ms = 5000;  // How often changed sensors are written
+    
     // Sensor locations mapping
     std::unordered_map<std::string, std::string> sensor_locations;
 };
 
-/**
- * Time-stamped sensor reading
- */
-struct TimestampedReading {
-    float value;
-    std::chrono::steady_clock::time_point timestamp;
-};
-
 /**
  * Sensor data structure
  */
@@ -69,13 +86,27 @@ struct SensorData {
     bool is_active = false;
     float temp_rate = 0.0f; // degrees per minute
     
-    // Historical data
-    std::deque<TimestampedReading> temperature_history;
-    std::deque<TimestampedReading> humidity_history;
+    // Historical data: fixed ring of config.history_size samples
+    static constexpr size_t TEMPERATURE = 0;
+    static constexpr size_t HUMIDITY = 1;
+    RingHistory<float, float> history;
+    WindowedStats temperature_stats;    // Over the temperatures in history
+    
+    // Interned sensor_id and location, referenced by AlertRecord
+    uint32_t id_handle = 0;
+    uint32_t location_handle = 0;
+    
+    // Alert throttling: a set alert_bit() in alerted means last_alert
+    // holds when that type last fired for this sensor
+    uint8_t alerted = 0;
+    std::array<std::chrono::steady_clock::time_point, ALERT_TYPE_COUNT> last_alert{};
+    
+    bool state_dirty = false;           // Changed since the last state snapshot pass
 };
 
 /**
- * Alert structure
+ * Alert with its names and message rendered, built on demand from an
+ * AlertRecord (ThermalIsolationTracker::materialize)
  */
 struct Alert {
     std::string sensor_id;
@@ -88,6 +119,21 @@ struct Alert {
     std::string message;
 };
 
+/**
+ * Alert as the tracker journals and queues it: interned names and raw
+ * values, no text. Trivially copyable, so an alert storm only copies
+ * these into a fixed ring; messages are rendered when a consumer asks
+ */
+struct AlertRecord {
+    std::chrono::steady_clock::time_point timestamp;
+    uint32_t sensor = 0;                // Interned sensor_id
+    uint32_t location = 0;              // Interned location when the alert fired
+    AlertType alert_type = AlertType::TEMP_TOO_LOW;
+    float temperature = 0.0f;
+    float humidity = 0.0f;
+    float temp_rate = 0.0f;
+};
+
 /**
  * Sensor statistics
  */
@@ -99,9 +145,43 @@ struct SensorStats {
     float avg_temp = 0.0f;
     float min_temp = 0.0f;
     float max_temp = 0.0f;
+    float temp_stddev = 0.0f;
+    float temp_trend = 0.0f;            // Degrees per sample across the history window
     int uptime_minutes = 0;
 };
 
+/**
+ * Current state of one sensor, without its history
+ */
+struct SensorSummary {
+    std::string sensor_id;
+    std::string location;
+    float temperature = 0.0f;
+    float humidity = 0.0f;
+    float temp_rate = 0.0f;
+    bool is_active = false;
+    std::chrono::steady_clock::time_point last_update;
+};
+
+/**
+ * Immutable point-in-time view of all sensors, shared between readers
+ */
+struct TrackerSnapshot {
+    std::chrono::steady_clock::time_point taken_at;
+    std::vector<SensorSummary> sensors;
+    size_t active_sensors = 0;
+    float avg_temperature = 0.0f;       // Over active sensors
+};
+
+/**
+ * Sensor counts and average, maintained incrementally on ingestion
+ */
+struct TrackerTotals {
+    size_t sensors = 0;
+    size_t active_sensors = 0;
+    float avg_temperature = 0.0f;       // Over active sensors
+};
+
 /**
  * Parsed sensor reading from MQTT message
  */
@@ -117,67 +197,159 @@ struct SensorReading {
  */
 class ThermalIsolationTracker {
 public:
-    explicit ThermalIsolationTracker(const ThermalConfig& config);
+    // With config.state_snapshot_path set, sensors saved by a previous run
+    // (history, rolling stats, throttles, offline deadlines) are restored here
+    explicit ThermalIsolationTracker(const ThermalConfig& config,
+                                     std::shared_ptr<Clock> clock = Clock::steady());
     ~ThermalIsolationTracker();
     
     // Main interface
     bool start();
     void stop();
     
+    // One pass of the monitoring thread's work (offline detection, status);
+    // replay drivers call this on virtual time instead of start()
+    void run_maintenance();
+    
+    // Writes the sensors changed since the previous pass to the state
+    // snapshot file; run_maintenance() calls it every state_snapshot_interval_ms
+    // and stop() and the destructor once more
+    void save_state_snapshot();
+    
     // Sensor data processing
     bool process_sensor_data(const std::string& sensor_id, 
                            float temperature, 
                            float humidity,
                            const std::string& location = "");
     
+    /**
+     * Ingests a burst of readings, taking each shard lock once. Readings
+     * are applied in order (a sensor may appear more than once) with one
+     * timestamp for the whole batch; thresholds are then evaluated over
+     * per-shard columns, so a batch in which nothing trips raises no
+     * alert work at all. Returns the number of readings processed.
+     */
+    size_t process_sensor_batch(const SensorReading* readings, size_t count);
+    size_t process_sensor_batch(const std::vector<SensorReading>& readings) {
+        return process_sensor_batch(readings.data(), readings.size());
+    }
+    
     // Data retrieval
     std::vector<SensorData> get_all_sensors() const;
-    std::vector<Alert> get_recent_alerts(int count = 10) const;
+    std::shared_ptr<const TrackerSnapshot> get_snapshot() const;
+    TrackerTotals get_totals() const;   // O(shards), no per-sensor work
+    std::vector<Alert> get_recent_alerts(int count = 10) const;   // Oldest first, rendered
     SensorStats get_sensor_stats(const std::string& sensor_id) const;
     
-    // Alert callback
+    // Renders names and message; valid for any record this tracker produced
+    Alert materialize(const AlertRecord& record) const;
+    std::string_view name_of(uint32_t handle) const;    // AlertRecord::sensor / location
+    
+    // Alert callbacks; the record callback gets alerts unrendered
     void set_alert_callback(std::function<void(const Alert&)> callback) {
         alert_callback_ = callback;
     }
+    void set_alert_record_callback(std::function<void(const AlertRecord&)> callback) {
+        alert_record_callback_ = callback;
+    }
     
 private:
     ThermalConfig config_;
+    std::shared_ptr<Clock> clock_;
     std::atomic<bool> running_;
     std::thread monitor_thread_;
+    std::chrono::steady_clock::time_point last_status_;
+    
+    // A sensor goes offline at last_update + offline_after_. Every active
+    // sensor has exactly one entry in its shard's heap; the entry's deadline
+    // may be stale (earlier) because readings only touch last_update, so
+    // an expired entry is either a real timeout or gets rescheduled
+    struct OfflineDeadline {
+        std::chrono::steady_clock::time_point deadline;
+        SensorData* sensor;             // unordered_map nodes never move
+        
+        // std::greater<> over this keeps the earliest deadline on top
+        bool operator>(const OfflineDeadline& other) const { return deadline > other.deadline; }
+    };
     
-    // Sensor data storage
-    mutable std::mutex sensors_mutex_;
-    std::unordered_map<std::string, SensorData> sensors_;
+    // Sensor data storage, sharded by sensor id so ingestion threads
+    // working on different sensors do not contend
+    struct SensorShard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, SensorData> sensors;
+        std::vector<OfflineDeadline> offline_heap;      // Min-heap on deadline
+        std::vector<SensorData*> state_dirty;           // Sensors with state_dirty set
+        size_t active_sensors = 0;
+        double active_temperature_sum = 0.0;
+    };
+    std::chrono::steady_clock::duration offline_after_;
+    std::chrono::steady_clock::duration throttle_after_;
+    std::vector<std::unique_ptr<SensorShard>> shards_;
     
-    // Alert storage
+    // Interned sensor ids and locations; append-only, so a handle (and a
+    // view of its string) stays valid for the tracker's lifetime
+    mutable std::mutex names_mutex_;
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, uint32_t> name_handles_;
+    
+    // Alert journal: the last max_alerts_history records in a fixed ring
     mutable std::mutex alerts_mutex_;
-    std::deque<Alert> recent_alerts_;
+    std::vector<AlertRecord> alert_journal_;
+    uint64_t alerts_journaled_ = 0;
+    
+    // Alerts raised under a shard lock wait here; callbacks run outside
+    // every tracker lock, one dispatcher at a time
+    std::mutex alert_queue_mutex_;
+    std::vector<AlertRecord> alert_queue_;  // Not a deque: an empty deque still allocates
+    std::mutex dispatch_mutex_;
+    
+    // Published read snapshot (swapped with std::atomic_load/store)
+    mutable std::mutex snapshot_rebuild_mutex_;
+    mutable std::shared_ptr<const TrackerSnapshot> snapshot_;
     
-    // Alert throttling
-    std::unordered_map<std::string, 
-        std::unordered_map<AlertType, std::chrono::steady_clock::time_point>> alert_throttle_;
+    // Warm restart state; passes are serialised by state_snapshot_mutex_
+    std::unique_ptr<StateSnapshotFile> state_store_;
+    std::mutex state_snapshot_mutex_;
+    std::chrono::steady_clock::time_point last_state_snapshot_;
+    std::vector<std::pair<std::string, std::string>> state_batch_;  // Reused (sensor id, record) buffers
     
-    // Alert callback
+    // Alert callbacks
     std::function<void(const Alert&)> alert_callback_;
+    std::function<void(const AlertRecord&)> alert_record_callback_;
     
     // Internal methods
     void monitoring_loop();
-    void check_thresholds(const std::string& sensor_id, const SensorData& sensor);
-    void generate_alert(const std::string& sensor_id, AlertType alert_type, const SensorData& sensor);
+    SensorShard& shard_for(const std::string& sensor_id) const;
+    size_t shard_index(const std::string& sensor_id) const;
+    SensorData& update_sensor(SensorShard& shard, const std::string& sensor_id, float temperature,
+                              float humidity, const std::string& location,
+                              std::chrono::steady_clock::time_point now);
+    uint8_t threshold_bits(float temperature, float humidity, float temp_rate) const;
+    void raise_threshold_alerts(SensorData& sensor, uint8_t bits, float temperature, float humidity, float temp_rate);
+    void generate_alert(SensorData& sensor, AlertType alert_type, float temperature, float humidity, float temp_rate);
+    void dispatch_pending_alerts();
     void check_offline_sensors();
     void print_status();
+    void restore_state_snapshot();
+    void mark_state_dirty(SensorShard& shard, SensorData& sensor);
     
     // Utility methods
-    std::string format_alert_message(const Alert& alert);
-    bool should_throttle_alert(const std::string& sensor_id, AlertType alert_type);
+    uint32_t intern(const std::string& name);
+    void write_alert_message(std::ostream& out, const AlertRecord& record) const;
+    bool should_throttle_alert(const SensorData& sensor, AlertType alert_type,
+                               std::chrono::steady_clock::time_point now) const;
     std::string get_sensor_location(const std::string& sensor_id);
 };
 
 /**
  * Message parsing utilities
+ * Single pass over views of the topic and payload; no intermediate strings
  */
-std::optional<SensorReading> parse_sensor_message(const std::string& topic, const std::string& payload);
-std::optional<SensorReading> parse_json_sensor_data(const std::string& json_str, SensorReading& reading);
+std::optional<SensorReading> parse_sensor_message(std::string_view topic, std::string_view payload);
+std::optional<SensorReading> parse_sensor_message(std::string_view topic, const uint8_t* payload, size_t len);
+std::optional<SensorReading> parse_json_sensor_data(std::string_view json_str, SensorReading& reading);
+std::optional<SensorReading> parse_client_sensor_message(std::string_view json_str);
+bool parse_float(std::string_view text, float& value);
 std::vector<std::string> split_string(const std::string& str, char delimiter);
 
 } // namespace thermal_monitoring 
\ No newline at end of file
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace thermal_monitoring {
+
+// Non-empty; '+' and '#' only as whole levels, '#' only as the last one
+inline bool valid_topic_filter(std::string_view filter) {
+    if (filter.empty()) {
+        return false;
+    }
+    size_t start = 0;
+    while (true) {
+        size_t end = filter.find('/', start);
+        std::string_view level = filter.substr(start, end == std::string_view::npos ? end : end - start);
+        bool wildcard_char = level.find_first_of("+#") != std::string_view::npos;
+        if (wildcard_char && level != "+" && level != "#") {
+            return false;
+        }
+        if (level == "#" && end != std::string_view::npos) {
+            return false;
+        }
+        if (end == std::string_view::npos) {
+            return true;
+        }
+        start = end + 1;
+    }
+}
+
+// One filter against one topic, by the same rules as TopicTrie::match();
+// for callers that hold a handful of filters and no index
+inline bool topic_matches(std::string_view filter, std::string_view topic) {
+    if (filter.empty() || topic.empty()) {
+        return false;
+    }
+    if (topic.front() == '$' && (filter.front() == '+' || filter.front() == '#')) {
+        return false;
+    }
+    size_t start = 0;
+    size_t topic_start = 0;
+    while (true) {
+        size_t end = filter.find('/', start);
+        std::string_view level = filter.substr(start, end == std::string_view::npos ? end : end - start);
+        if (level == "#") {
+            return true;
+        }
+        if (topic_start > topic.size()) {
+            return false;
+        }
+        size_t topic_end = topic.find('/', topic_start);
+        std::string_view topic_level = topic.substr(
+            topic_start, topic_end == std::string_view::npos ? topic_end : topic_end - topic_start);
+        if (level != "+" && level != topic_level) {
+            return false;
+        }
+        topic_start = topic_end == std::string_view::npos ? topic.size() + 1 : topic_end + 1;
+        if (end == std::string_view::npos) {
+            return topic_start > topic.size();
+        }
+        start = end + 1;
+    }
+}
+
+/**
+ * MQTT topic filters indexed level by level
+ *
+ * Every filter ("sensors/+/temperature", "alerts/#", "floor2/room5/data")
+ * is a path of trie nodes, one per '/'-separated level, and its
+ * subscriber values are stored on the node where the path ends. Matching
+ * a topic walks its levels once, following at each node the exact child,
+ * the '+' child and the '#' child, so the cost is proportional to the
+ * topic's depth (and the number of wildcard branches taken) rather than to
+ * the number of filters or subscribers.
+ *
+ * Matching follows MQTT 3.1.1 rules: '+' matches exactly one (possibly
+ * empty) level, a trailing '#' matches the parent level and everything
+ * below it, and topics starting with '$' are not matched by a wildcard in
+ * the first level.
+ *
+ * Usage:
+ *   TopicTrie<Route> routes;
+ *   routes.insert("sensors/+/temperature", route);
+ *   routes.match("sensors/s1/temperature", [&](const Route& r) { ... });
+ *   routes.erase_if("sensors/+/temperature", [&](const Route& r) { return r.id == id; });
+ *
+ * Not thread-safe; callers serialise access.
+ */
+template <typename T>
+class TopicTrie {
+public:
+    // Caller checks valid_topic_filter(); values are not de-duplicated
+    void insert(std::string_view filter, T value) {
+        Node* node = &root_;
+        for_each_level(filter, [&](std::string_view level) {
+            node = node->child_or_create(level);
+        });
+        if (node->values.empty()) {
+            filters_++;
+        }
+        node->values.push_back(std::move(value));
+        values_++;
+    }
+
+    /**
+     * Removes the filter's values for which pred(value) is true and prunes
+     * nodes left empty. Returns the number of values the filter still has.
+     */
+    template <typename Pred>
+    size_t erase_if(std::string_view filter, Pred&& pred) {
+        std::vector<Node*> path{&root_};
+        bool found = true;
+        for_each_level(filter, [&](std::string_view level) {
+            Node* next = found ? path.back()->child(level) : nullptr;
+            found = next != nullptr;
+            if (found) {
+                path.push_back(next);
+            }
+        });
+        if (!found) {
+            return 0;
+        }
+
+        auto& values = path.back()->values;
+        bool had_values = !values.empty();
+        size_t before = values.size();
+        values.erase(std::remove_if(values.begin(), values.end(), pred), values.end());
+        size_t remaining = values.size();
+        values_ -= before - remaining;
+        if (had_values && remaining == 0) {
+            filters_--;
+        }
+
+        // Drop now-empty nodes from the leaf upwards
+        for (size_t i = path.size() - 1; i > 0 && path[i]->empty(); --i) {
+            path[i - 1]->remove_child(path[i]);
+        }
+        return remaining;
+    }
+
+    // Calls fn(value) for every value of every filter matching topic
+    template <typename Fn>
+    void match(std::string_view topic, Fn&& fn) const {
+        if (topic.empty()) {
+            return;
+        }
+        match_level(root_, topic, 0, topic.front() == '$', fn);
+    }
+
+    // Values stored under exactly this filter (no wildcard matching), or null
+    const std::vector<T>* values(std::string_view filter) const {
+        const Node* node = &root_;
+        for_each_level(filter, [&](std::string_view level) {
+            node = node ? node->child(level) : nullptr;
+        });
+        return node && !node->values.empty() ? &node->values : nullptr;
+    }
+
+    void clear() {
+        root_ = Node();
+        filters_ = 0;
+        values_ = 0;
+    }
+
+    size_t filter_count() const { return filters_; }
+    size_t size() const { return values_; }     // Values across all filters
+    bool empty() const { return filters_ == 0; }
+
+private:
+    struct Node {
+        std::string level;
+        // Keys view each child's own level string, so lookups by a
+        // string_view of the topic never allocate
+        std::unordered_map<std::string_view, std::unique_ptr<Node>> children;
+        std::unique_ptr<Node> plus;         // '+' child
+        std::unique_ptr<Node> hash;         // '#' child
+        std::vector<T> values;
+
+        bool empty() const { return values.empty() && children.empty() && !plus && !hash; }
+
+        Node* child(std::string_view name) const {
+            if (name == "+") return plus.get();
+            if (name == "#") return hash.get();
+            auto it = children.find(name);
+            return it == children.end() ? nullptr : it->second.get();
+        }
+
+        Node* child_or_create(std::string_view name) {
+            std::unique_ptr<Node>* slot;
+            if (name == "+") {
+                slot = &plus;
+            } else if (name == "#") {
+                slot = &hash;
+            } else {
+                auto it = children.find(name);
+                if (it != children.end()) {
+                    return it->second.get();
+                }
+                auto node = std::make_unique<Node>();
+                node->level.assign(name.data(), name.size());
+                Node* raw = node.get();
+                children.emplace(std::string_view(raw->level), std::move(node));
+                return raw;
+            }
+            if (!*slot) {
+                *slot = std::make_unique<Node>();
+                (*slot)->level.assign(name.data(), name.size());
+            }
+            return slot->get();
+        }
+
+        void remove_child(const Node* node) {
+            if (plus.get() == node) {
+                plus.reset();
+            } else if (hash.get() == node) {
+                hash.reset();
+            } else {
+                children.erase(std::string_view(node->level));
+            }
+        }
+    };
+
+    template <typename Fn>
+    static void for_each_level(std::string_view path, Fn&& fn) {
+        size_t start = 0;
+        while (true) {
+            size_t end = path.find('/', start);
+            if (end == std::string_view::npos) {
+                fn(path.substr(start));
+                return;
+            }
+            fn(path.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    // node has matched every level before 'start'; start > topic.size()
+    // once the last level is consumed
+    template <typename Fn>
+    static void match_level(const Node& node, std::string_view topic, size_t start, bool system, Fn& fn) {
+        const bool first_level = start == 0;
+        const bool wildcards = !(first_level && system);
+
+        // '#' covers the rest, including nothing: "a/#" matches "a"
+        if (node.hash && wildcards) {
+            for (const T& value : node.hash->values) {
+                fn(value);
+            }
+        }
+        if (start > topic.size()) {
+            for (const T& value : node.values) {
+                fn(value);
+            }
+            return;
+        }
+
+        size_t end = topic.find('/', start);
+        std::string_view level = topic.substr(start, end == std::string_view::npos ? end : end - start);
+        size_t next = end == std::string_view::npos ? topic.size() + 1 : end + 1;
+
+        auto it = node.children.find(level);
+        if (it != node.children.end()) {
+            match_level(*it->second, topic, next, system, fn);
+        }
+        if (node.plus && wildcards) {
+            match_level(*node.plus, topic, next, system, fn);
+        }
+    }
+
+    Node root_;
+    size_t filters_ = 0;
+    size_t values_ = 0;
+};
+
+} // namespace thermal_monitoring